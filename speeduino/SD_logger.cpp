@@ -12,6 +12,7 @@
 #include "logger.h"
 #include "rtc_common.h"
 #include "maths.h"
+#include "cycle_logger.h"
 
 //List of logger field names. This must be in the same order and length as logger_updateLogdataCSV()
 constexpr char header_0[] PROGMEM = "secl";
@@ -275,6 +276,27 @@ uint8_t SD_status = SD_STATUS_OFF;
 uint16_t currentLogFileNumber;
 bool manualLogActive = false;
 uint32_t logStartTime = 0; //In ms
+static uint32_t logStartMicros = 0; //For the cycle log records, which are timed in uS
+static uint16_t droppedRecords = 0; //Binary records that did not fit in the ring buffer, see getSDLogDroppedRecords()
+
+/** The file extension for the current log format */
+static const char* logFileExtension()
+{
+  if(configPage13.onboard_log_file_style == LOGGER_BINARY) { return LOG_FILE_EXTENSION_BINARY; }
+  return LOG_FILE_EXTENSION;
+}
+
+/** The rate that log entries are written at (LOGGER_RATE_*). The fast and cycle rates are only available for binary logs, CSV formatting is too slow for them */
+uint8_t getSDLogRate()
+{
+  if(configPage13.onboard_log_file_style == LOGGER_BINARY)
+  {
+    if(configPage13.onboard_log_cycle_mode != CYCLE_LOG_OFF) { return LOGGER_RATE_CYCLE; }
+    if(configPage13.onboard_log_fast_rate == LOGGER_FAST_RATE_50HZ) { return LOGGER_RATE_50HZ; }
+    if(configPage13.onboard_log_fast_rate == LOGGER_FAST_RATE_200HZ) { return LOGGER_RATE_200HZ; }
+  }
+  return configPage13.onboard_log_file_rate;
+}
 
 void initSD()
 {
@@ -332,7 +354,7 @@ bool createLogFile()
   //Create the filename
   //sprintf(filenameBuffer, "%s%04d.%s", LOG_FILE_PREFIX, currentLogFileNumber, LOG_FILE_EXTENSION);
   if(currentLogFileNumber > MAX_LOG_FILES) { currentLogFileNumber = 1; } //If we've run out of file numbers, start again from 1
-  snprintf(filenameBuffer, 13, "%s%04d.%s", LOG_FILE_PREFIX, currentLogFileNumber, LOG_FILE_EXTENSION);
+  snprintf(filenameBuffer, 13, "%s%04d.%s", LOG_FILE_PREFIX, currentLogFileNumber, logFileExtension());
 
   logFile.close();
   if (logFile.open(filenameBuffer, O_RDWR | O_CREAT | O_TRUNC)) 
@@ -347,13 +369,13 @@ uint16_t getNextSDLogFileNumber()
 {
   uint16_t nextFileNumber = 1;
   char filenameBuffer[13]; //8 + 1 + 3 + 1
-  sprintf(filenameBuffer, "%s%04d.%s", LOG_FILE_PREFIX, nextFileNumber, LOG_FILE_EXTENSION);
+  sprintf(filenameBuffer, "%s%04d.%s", LOG_FILE_PREFIX, nextFileNumber, logFileExtension());
 
   //Lookup the next available file number
   while( (nextFileNumber < MAX_LOG_FILES) && (sd.exists(filenameBuffer)) )
   {
     nextFileNumber++;
-    sprintf(filenameBuffer, "%s%04d.%s", LOG_FILE_PREFIX, nextFileNumber, LOG_FILE_EXTENSION);
+    sprintf(filenameBuffer, "%s%04d.%s", LOG_FILE_PREFIX, nextFileNumber, logFileExtension());
   }
 
   return nextFileNumber;
@@ -367,7 +389,7 @@ bool getSDLogFileDetails(uint8_t* buffer, uint16_t logNumber)
 
   char filenameBuffer[13]; //8 + 1 + 3 + 1
   if(logNumber > MAX_LOG_FILES) { logNumber = MAX_LOG_FILES; } //If we've run out of file numbers, start again from 1
-  snprintf(filenameBuffer, 13, "%s%04d.%s", LOG_FILE_PREFIX, logNumber, LOG_FILE_EXTENSION);
+  snprintf(filenameBuffer, 13, "%s%04d.%s", LOG_FILE_PREFIX, logNumber, logFileExtension());
   
   if(sd.exists(filenameBuffer))
   {
@@ -462,17 +484,23 @@ void beginSDLogging()
 
     //initialise the RingBuf.
     rb.begin(&logFile);
+    droppedRecords = 0;
 
     //Write a header row
     writeSDLogHeader();
 
     //Note the start time
     logStartTime = millis();
+    logStartMicros = micros();
+
+    if(getSDLogRate() == LOGGER_RATE_CYCLE) { startCycleLogger(configPage13.onboard_log_cycle_mode, configPage13.onboard_log_cycle_teeth); }
   }
 }
 
 void endSDLogging()
 {
+  stopCycleLogger();
+
   if(SD_status == SD_STATUS_ACTIVE)
   {
     // Write any RingBuf data to file.
@@ -491,6 +519,111 @@ void endSDLogging()
 void checkForSDStart();
 void checkForSDStop();
 
+/** 
+ * Write 1 sector from the ring buffer to the card, if there is a full sector waiting and the card is not already busy
+ */
+static void writeOutSDLogSector()
+{
+  if( (rb.bytesUsed() >= SD_SECTOR_SIZE) && !logFile.isBusy() )
+  {
+    uint16_t bytesWritten = rb.writeOut(SD_SECTOR_SIZE); 
+    //Make sure that the entire sector was written successfully
+    if (SD_SECTOR_SIZE != bytesWritten) 
+    {
+      SD_status = SD_STATUS_ERROR_WRITE_FAIL;
+    }
+  }
+}
+
+/** 
+ * Make room in the ring buffer for length bytes of the header, waiting on the card to write sectors out if needed.
+ * Only the header may wait on the card, it is written once when the log starts. The records are dropped instead (See writeSDLogBinaryBytes())
+ * @return false if the card did not take a sector in time. The log is marked as failed
+ */
+static bool reserveSDLogHeaderSpace(uint16_t length)
+{
+  while( (rb.bytesFree() < length) && (SD_status == SD_STATUS_ACTIVE) )
+  {
+    uint32_t waitStart = millis();
+    while(logFile.isBusy())
+    {
+      if( (millis() - waitStart) > SD_HEADER_WRITE_TIMEOUT ) { SD_status = SD_STATUS_ERROR_WRITE_FAIL; return false; }
+    }
+    //The buffer holds more than a sector plus the longest header field, so there is always a full sector to write out here
+    writeOutSDLogSector();
+  }
+  return (SD_status == SD_STATUS_ACTIVE);
+}
+
+/** 
+ * Write a whole binary record to the ring buffer, or drop it if it does not fit. A partial record would break every record after it
+ */
+static void writeSDLogBinaryBytes(const uint8_t *pRecord, uint16_t length)
+{
+  if(rb.bytesFree() >= length) { rb.write(pRecord, length); }
+  else if(droppedRecords < UINT16_MAX) { droppedRecords++; }
+  else { /* Counter is saturated */ }
+}
+
+/** Number of records dropped from the current log because the ring buffer was full (The card was busy for too long) */
+uint16_t getSDLogDroppedRecords()
+{
+  return droppedRecords;
+}
+
+static inline uint8_t* writeSDLogBinaryValue(uint8_t *pValue, uint16_t value)
+{
+  pValue[0] = lowByte(value);
+  pValue[1] = highByte(value);
+  return pValue + 2;
+}
+
+static inline uint8_t* writeSDLogBinaryTime(uint8_t *pRecord, uint32_t time)
+{
+  pRecord[0] = SD_LOG_BINARY_RECORD_MARKER;
+  pRecord[1] = (uint8_t)time;
+  pRecord[2] = (uint8_t)(time >> 8U);
+  pRecord[3] = (uint8_t)(time >> 16U);
+  pRecord[4] = (uint8_t)(time >> 24U);
+  return pRecord + 5;
+}
+
+/** 
+ * Write a binary log record (See SD_logger.h) to the ring buffer. The values are copied as they are, which is far quicker than formatting them as text
+ */
+static void writeSDLogBinaryRecord(uint32_t duration)
+{
+  uint8_t record[5U + (SD_LOG_NUM_FIELDS * 2U)];
+  uint8_t *pValue = writeSDLogBinaryTime(record, duration);
+  for(byte x=0; x<SD_LOG_NUM_FIELDS; x++)
+  {
+    pValue = writeSDLogBinaryValue(pValue, (uint16_t)getReadableLogEntry(x));
+  }
+  writeSDLogBinaryBytes(record, sizeof(record));
+}
+
+/** 
+ * Write every waiting cycle logger snapshot to the ring buffer as a binary record (See SD_logger.h and cycle_logger.h)
+ */
+static void writeSDLogCycleRecords()
+{
+  cycleLogEntry entry;
+  while(readCycleLogEntry(entry))
+  {
+    uint8_t record[5U + (SD_LOG_CYCLE_NUM_FIELDS * 2U)];
+    uint8_t *pValue = writeSDLogBinaryTime(record, entry.toothTime - logStartMicros);
+    pValue = writeSDLogBinaryValue(pValue, entry.revolution);
+    pValue = writeSDLogBinaryValue(pValue, entry.RPM);
+    pValue = writeSDLogBinaryValue(pValue, entry.MAP);
+    pValue = writeSDLogBinaryValue(pValue, entry.PW1);
+    pValue = writeSDLogBinaryValue(pValue, (uint16_t)(int16_t)entry.advance);
+    pValue = writeSDLogBinaryValue(pValue, entry.knockCount);
+    pValue = writeSDLogBinaryValue(pValue, entry.knockRetard);
+    (void)writeSDLogBinaryValue(pValue, entry.status2);
+    writeSDLogBinaryBytes(record, sizeof(record));
+  }
+}
+
 void writeSDLogEntry()
 {
   //Check if we're already running a log
@@ -500,7 +633,15 @@ void writeSDLogEntry()
     checkForSDStart();
   }
 
-  if(SD_status == SD_STATUS_ACTIVE)
+  if( (SD_status == SD_STATUS_ACTIVE) && (getSDLogRate() == LOGGER_RATE_CYCLE) )
+  {
+    writeSDLogCycleRecords();
+  }
+  else if( (SD_status == SD_STATUS_ACTIVE) && (configPage13.onboard_log_file_style == LOGGER_BINARY) )
+  {
+    writeSDLogBinaryRecord(millis() - logStartTime);
+  }
+  else if(SD_status == SD_STATUS_ACTIVE)
   {
     //Write the timestamp (x.yyy seconds format)
     uint32_t duration = millis() - logStartTime;
@@ -526,18 +667,14 @@ void writeSDLogEntry()
       if(x < (SD_LOG_NUM_FIELDS - 1)) { rb.print(","); }
     }
     rb.println("");
+  }
+  else { /* Not logging */ }
 
+  if(SD_status == SD_STATUS_ACTIVE)
+  {
     //Check if write to SD from ringbuffer is needed
     //We write to SD when there is more than 1 sector worth of data in the ringbuffer and there is not already a write being performed
-    if( (rb.bytesUsed() >= SD_SECTOR_SIZE) && !logFile.isBusy() )
-    {
-      uint16_t bytesWritten = rb.writeOut(SD_SECTOR_SIZE); 
-      //Make sure that the entire sector was written successfully
-      if (SD_SECTOR_SIZE != bytesWritten) 
-      {
-        SD_status = SD_STATUS_ERROR_WRITE_FAIL;
-      }
-    }
+    writeOutSDLogSector();
 
     //Check whether we should stop logging
     checkForSDStop();
@@ -553,8 +690,77 @@ void writeSDLogEntry()
   setTS_SD_status();
 }
 
+//Field names for the cycle log records, in record order
+constexpr char cycleHeader_0[] PROGMEM = "Revolution";
+constexpr char cycleHeader_1[] PROGMEM = "RPM";
+constexpr char cycleHeader_2[] PROGMEM = "MAP";
+constexpr char cycleHeader_3[] PROGMEM = "PW";
+constexpr char cycleHeader_4[] PROGMEM = "Advance";
+constexpr char cycleHeader_5[] PROGMEM = "Knock count";
+constexpr char cycleHeader_6[] PROGMEM = "Knock retard";
+constexpr char cycleHeader_7[] PROGMEM = "Status2";
+constexpr const char* cycleHeader_table[] PROGMEM = { cycleHeader_0, cycleHeader_1, cycleHeader_2, cycleHeader_3, cycleHeader_4, cycleHeader_5, cycleHeader_6, cycleHeader_7 };
+static_assert(sizeof(cycleHeader_table) == (sizeof(char*) * SD_LOG_CYCLE_NUM_FIELDS), "Number of cycle header titles must match number of cycle log fields");
+
+/** 
+ * Write 1 field descriptor of the binary log header
+ * @param nameTable Either header_table or cycleHeader_table (Both are in PROGMEM on AVR)
+ */
+static bool writeSDLogBinaryField(const char* const nameTable[], uint8_t index, uint16_t divisor, uint8_t flags)
+{
+  char name[30];
+  #ifdef CORE_AVR
+    strcpy_P(name, (char *)pgm_read_word(&(nameTable[index])));
+  #else
+    strcpy(name, nameTable[index]);
+  #endif
+  const uint8_t field[4] = { lowByte(divisor), highByte(divisor), flags, (uint8_t)strlen(name) };
+
+  //The header is bigger than the ring buffer, so it is written out as it goes
+  if(!reserveSDLogHeaderSpace(sizeof(field) + field[3])) { return false; }
+  rb.write(field, sizeof(field));
+  rb.write((const uint8_t*)name, field[3]);
+  return true;
+}
+
+/** 
+ * Write the binary log header (See SD_logger.h), which describes every field once
+ */
+static void writeSDLogBinaryHeader()
+{
+  const bool isCycleLog = (getSDLogRate() == LOGGER_RATE_CYCLE);
+  const uint8_t fieldCount = isCycleLog ? SD_LOG_CYCLE_NUM_FIELDS : SD_LOG_NUM_FIELDS;
+  const uint16_t recordSize = 5U + (fieldCount * 2U);
+  const uint8_t header[9] = { SD_LOG_BINARY_MAGIC[0], SD_LOG_BINARY_MAGIC[1], SD_LOG_BINARY_MAGIC[2], SD_LOG_BINARY_MAGIC[3], SD_LOG_BINARY_VERSION, fieldCount, lowByte(recordSize), highByte(recordSize), 
+                              (uint8_t)(isCycleLog ? SD_LOG_BINARY_TIME_US : SD_LOG_BINARY_TIME_MS) };
+  rb.write(header, sizeof(header));
+
+  if(isCycleLog)
+  {
+    for(byte x=0; x<SD_LOG_CYCLE_NUM_FIELDS; x++)
+    {
+      uint16_t divisor = (x == 3U) ? 1000U : 1U; //PW is recorded in uS, shown in mS
+      uint8_t flags = (x == 4U) ? 0U : SD_LOG_BINARY_FLAG_UNSIGNED; //Only advance can be negative
+      if(!writeSDLogBinaryField(cycleHeader_table, x, divisor, flags)) { return; }
+    }
+  }
+  else
+  {
+    for(byte x=0; x<SD_LOG_NUM_FIELDS; x++)
+    {
+      if(!writeSDLogBinaryField(header_table, x, getReadableLogEntryDivisor(x), isReadableLogEntryUnsigned(x) ? SD_LOG_BINARY_FLAG_UNSIGNED : 0U)) { return; }
+    }
+  }
+}
+
 void writeSDLogHeader()
 {
+  if(configPage13.onboard_log_file_style == LOGGER_BINARY)
+  {
+    writeSDLogBinaryHeader();
+    return;
+  }
+
   //Write header for Time field
   rb.print("Time,");
 
@@ -767,7 +973,7 @@ void deleteLogFile(char log1, char log2, char log3, char log4)
   logFileName[6] = log3;
   logFileName[7] = log4;
   logFileName[8] = '.';
-  strcpy(logFileName + 9, LOG_FILE_EXTENSION);
+  strcpy(logFileName + 9, logFileExtension());
   //logFileName[8] = '\0';
 
   if(sd.exists(logFileName))
@@ -52,7 +52,38 @@
 #define MAX_LOG_FILES     9999
 #define LOG_FILE_PREFIX "SPD_"
 #define LOG_FILE_EXTENSION "csv"
+#define LOG_FILE_EXTENSION_BINARY "sdl"
+
+/*
+Binary log format (onboard_log_file_style == LOGGER_BINARY). All values are little endian.
+Header, written once:
+  4 bytes   SD_LOG_BINARY_MAGIC
+  1 byte    SD_LOG_BINARY_VERSION
+  1 byte    Number of fields
+  2 bytes   Record size
+  1 byte    Time unit of the records (SD_LOG_BINARY_TIME_*). Version 2 onwards, version 1 logs are always mS
+  Then for each field:
+    2 bytes   Divisor. The readable value is the stored value / divisor (See getReadableLogEntryDivisor())
+    1 byte    Flags (SD_LOG_BINARY_FLAG_*)
+    1 byte    Name length
+    n bytes   Name (Not terminated)
+Records, one per log entry:
+  1 byte    SD_LOG_BINARY_RECORD_MARKER. Records that do not fit in the ring buffer are dropped whole (See getSDLogDroppedRecords()),
+            so the records stay in step. Readers resync on the next marker if they find anything else
+  4 bytes   Time since the log started
+  2 bytes   Each field. Time based logs record every getReadableLogEntry() value, at 1 record per log interval.
+            Cycle logs (See cycle_logger.h) record SD_LOG_CYCLE_NUM_FIELDS values, at 1 record per engine cycle or every N teeth
+tools/sd_log_to_csv.py converts these logs to CSV.
+*/
+#define SD_LOG_BINARY_MAGIC           "SPDL"
+#define SD_LOG_BINARY_VERSION         2
+#define SD_LOG_BINARY_RECORD_MARKER   0xA5
+#define SD_LOG_BINARY_FLAG_UNSIGNED   0x01 //The field is a uint16_t rather than an int16_t
+#define SD_LOG_BINARY_TIME_MS         0
+#define SD_LOG_BINARY_TIME_US         1
+#define SD_LOG_CYCLE_NUM_FIELDS       8
 #define RING_BUF_CAPACITY (SD_LOG_ENTRY_SIZE * 10) //Allow for 10 entries in the ringbuffer. Will need tuning
+#define SD_HEADER_WRITE_TIMEOUT       100 //mS to wait for the card to take a sector while the binary header is written
 
 /*
 Standard FAT16/32
@@ -75,6 +106,7 @@ void writetSDLogHeader();
 void beginSDLogging();
 void endSDLogging();
 void syncSDLog();
+uint8_t getSDLogRate();
 void setTS_SD_status();
 void formatExFat();
 void deleteLogFile(char, char, char, char);
@@ -84,6 +116,7 @@ uint16_t getNextSDLogFileNumber();
 bool getSDLogFileDetails(uint8_t* , uint16_t);
 void readSDSectors(uint8_t*, uint32_t, uint16_t);
 uint32_t sectorCount();
+uint16_t getSDLogDroppedRecords();
 
 
 
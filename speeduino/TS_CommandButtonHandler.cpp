@@ -10,6 +10,8 @@
 #include "scheduledIO.h"
 #include "sensors.h"
 #include "storage.h"
+#include "pages.h"
+#include "page_crc.h"
 #include "SD_logger.h"
 #ifdef USE_MC33810
   #include "acc_mc33810.h"
@@ -296,6 +298,7 @@ bool TS_CommandButtonsHandler(uint16_t buttonCommand)
         {
           //Calculate the ratio of VSS reading from Aux input and actual VSS (assuming that actual VSS is really 60km/h).
           configPage2.vssPulsesPerKm = (currentStatus.canin[configPage2.vssAuxCh] / 60);
+          invalidatePageCRC32(veSetPage);
           writeConfig(1); // Need to manually save the new config value as it will not trigger a burn in tunerStudio due to use of ControllerPriority
           BIT_SET(currentStatus.status3, BIT_STATUS3_VSS_REFRESH); //Set the flag to trigger the UI reset
         }
@@ -306,6 +309,7 @@ bool TS_CommandButtonsHandler(uint16_t buttonCommand)
           if( calibrationGap > 0 )
           {
             configPage2.vssPulsesPerKm = MICROS_PER_MIN / calibrationGap;
+            invalidatePageCRC32(veSetPage);
             writeConfig(1); // Need to manually save the new config value as it will not trigger a burn in tunerStudio due to use of ControllerPriority
             BIT_SET(currentStatus.status3, BIT_STATUS3_VSS_REFRESH); //Set the flag to trigger the UI reset
           }
@@ -318,6 +322,7 @@ bool TS_CommandButtonsHandler(uint16_t buttonCommand)
       if(currentStatus.vss > 0)
       {
         configPage2.vssRatio1 = (currentStatus.vss * 10000UL) / currentStatus.RPM;
+        invalidatePageCRC32(veSetPage);
         writeConfig(1); // Need to manually save the new config value as it will not trigger a burn in tunerStudio due to use of ControllerPriority
         BIT_SET(currentStatus.status3, BIT_STATUS3_VSS_REFRESH); //Set the flag to trigger the UI reset
       }
@@ -327,6 +332,7 @@ bool TS_CommandButtonsHandler(uint16_t buttonCommand)
       if(currentStatus.vss > 0)
       {
         configPage2.vssRatio2 = (currentStatus.vss * 10000UL) / currentStatus.RPM;
+        invalidatePageCRC32(veSetPage);
         writeConfig(1); // Need to manually save the new config value as it will not trigger a burn in tunerStudio due to use of ControllerPriority
         BIT_SET(currentStatus.status3, BIT_STATUS3_VSS_REFRESH); //Set the flag to trigger the UI reset
       }
@@ -336,6 +342,7 @@ bool TS_CommandButtonsHandler(uint16_t buttonCommand)
       if(currentStatus.vss > 0)
       {
         configPage2.vssRatio3 = (currentStatus.vss * 10000UL) / currentStatus.RPM;
+        invalidatePageCRC32(veSetPage);
         writeConfig(1); // Need to manually save the new config value as it will not trigger a burn in tunerStudio due to use of ControllerPriority
         BIT_SET(currentStatus.status3, BIT_STATUS3_VSS_REFRESH); //Set the flag to trigger the UI reset
       }
@@ -345,6 +352,7 @@ bool TS_CommandButtonsHandler(uint16_t buttonCommand)
       if(currentStatus.vss > 0)
       {
         configPage2.vssRatio4 = (currentStatus.vss * 10000UL) / currentStatus.RPM;
+        invalidatePageCRC32(veSetPage);
         writeConfig(1); // Need to manually save the new config value as it will not trigger a burn in tunerStudio due to use of ControllerPriority
         BIT_SET(currentStatus.status3, BIT_STATUS3_VSS_REFRESH); //Set the flag to trigger the UI reset
       }
@@ -354,6 +362,7 @@ bool TS_CommandButtonsHandler(uint16_t buttonCommand)
       if(currentStatus.vss > 0)
       {
         configPage2.vssRatio5 = (currentStatus.vss * 10000UL) / currentStatus.RPM;
+        invalidatePageCRC32(veSetPage);
         writeConfig(1); // Need to manually save the new config value as it will not trigger a burn in tunerStudio due to use of ControllerPriority
         BIT_SET(currentStatus.status3, BIT_STATUS3_VSS_REFRESH); //Set the flag to trigger the UI reset
       }
@@ -363,6 +372,7 @@ bool TS_CommandButtonsHandler(uint16_t buttonCommand)
       if(currentStatus.vss > 0)
       {
         configPage2.vssRatio6 = (currentStatus.vss * 10000UL) / currentStatus.RPM;
+        invalidatePageCRC32(veSetPage);
         writeConfig(1); // Need to manually save the new config value as it will not trigger a burn in tunerStudio due to use of ControllerPriority
         BIT_SET(currentStatus.status3, BIT_STATUS3_VSS_REFRESH); //Set the flag to trigger the UI reset
       }
@@ -0,0 +1,190 @@
+/** @file
+ * Background scan of the analog inputs. See adc_scan.h
+ */
+#include "adc_scan.h"
+
+static uint8_t scanPins[ADC_SCAN_MAX_CHANNELS];
+static bool scanIsFast[ADC_SCAN_MAX_CHANNELS];
+static uint8_t scanChannelCount = 0U;
+static uint8_t scanSlowCount = 0U;
+static uint8_t scanNextSlow = 0U; //Index (Of all the channels) of the slow channel converted by the next pass
+
+static volatile uint16_t scanResults[2][ADC_SCAN_MAX_CHANNELS];
+static volatile uint8_t scanPublished = 0U;    //The buffer holding the latest results. The pass fills the other one
+static volatile uint8_t scanPublishCount = 0U; //8 bit so that it can be read atomically on AVR
+static volatile bool scanRunning = false;
+static volatile bool scanHasResults = false;   //Every channel has been converted since the scan was started
+
+//The pass in progress
+static volatile uint8_t passChannel = ADC_SCAN_NO_CHANNEL; //Channel being converted, or ADC_SCAN_NO_CHANNEL between passes
+static uint8_t passSlow = ADC_SCAN_NO_CHANNEL;             //The slow channel converted by this pass
+static bool passAll = false;                               //This pass converts every channel
+
+/** Stop the scan and remove all channels */
+void adcScanReset(void)
+{
+  scanRunning = false;
+  scanHasResults = false;
+  passChannel = ADC_SCAN_NO_CHANNEL; //A conversion that is still running is ignored when it completes
+  scanChannelCount = 0U;
+  scanSlowCount = 0U;
+  scanNextSlow = 0U;
+}
+
+/** Add a pin to the scan. Must be called while the scan is stopped (After adcScanReset()).
+ * Adding a pin that is already in the scan only changes it, to fast, if isFast is set.
+ * @param pin Analog pin
+ * @param isFast Convert this pin on every tick rather than in turn with the other slow channels
+ * @return false if there is no room for the pin
+ */
+bool adcScanAddChannel(uint8_t pin, bool isFast)
+{
+  for(uint8_t x = 0U; x < scanChannelCount; x++)
+  {
+    if(scanPins[x] == pin)
+    {
+      if( (isFast == true) && (scanIsFast[x] == false) )
+      {
+        scanIsFast[x] = true;
+        scanSlowCount--;
+      }
+      return true;
+    }
+  }
+  if(scanChannelCount >= ADC_SCAN_MAX_CHANNELS) { return false; }
+
+  scanPins[scanChannelCount] = pin;
+  scanIsFast[scanChannelCount] = isFast;
+  scanResults[0][scanChannelCount] = 0U;
+  scanResults[1][scanChannelCount] = 0U;
+  if(isFast == false) { scanSlowCount++; }
+  scanChannelCount++;
+  return true;
+}
+
+uint8_t adcScanChannelCount(void)
+{
+  return scanChannelCount;
+}
+
+static inline uint8_t findChannel(uint8_t pin)
+{
+  for(uint8_t x = 0U; x < scanChannelCount; x++)
+  {
+    if(scanPins[x] == pin) { return x; }
+  }
+  return ADC_SCAN_NO_CHANNEL;
+}
+
+/** Start the scan. The first pass converts every channel, so that all of them have a result before the first read */
+void adcScanStart(void)
+{
+  scanHasResults = false;
+  passAll = true;
+  scanRunning = true;
+}
+
+/** @return The first channel from the given one that is converted by this pass, or ADC_SCAN_NO_CHANNEL if there are none left */
+static inline uint8_t nextPassChannel(uint8_t channel)
+{
+  for(; channel < scanChannelCount; channel++)
+  {
+    if( (passAll == true) || (scanIsFast[channel] == true) || (channel == passSlow) ) { return channel; }
+  }
+  return ADC_SCAN_NO_CHANNEL;
+}
+
+/** Called from the 1ms timer interrupt. Begins a pass of the fast channels and the next slow channel, unless the last pass is still converting */
+void adcScanTick(void)
+{
+  if( (scanRunning == false) || (scanChannelCount == 0U) || (passChannel != ADC_SCAN_NO_CHANNEL) ) { return; }
+
+  //Find the slow channel for this pass. A pass of every channel does not take a turn from them
+  passSlow = ADC_SCAN_NO_CHANNEL;
+  if( (scanSlowCount > 0U) && (passAll == false) )
+  {
+    uint8_t slow = scanNextSlow;
+    while( (slow >= scanChannelCount) || (scanIsFast[slow] == true) )
+    {
+      slow++;
+      if(slow >= scanChannelCount) { slow = 0U; }
+    }
+    passSlow = slow;
+  }
+
+  //Channels that are not converted by this pass keep their last result
+  uint8_t published = scanPublished;
+  uint8_t fill = published ^ 1U;
+  for(uint8_t x = 0U; x < scanChannelCount; x++) { scanResults[fill][x] = scanResults[published][x]; }
+
+  uint8_t channel = nextPassChannel(0U); //There is always a fast channel or a slow one
+  passChannel = channel;
+  adcScanStartConversion(scanPins[channel]);
+}
+
+/** Called by the board layer with the result of the conversion started by adcScanStartConversion(). Starts the next
+ * conversion of the pass, or publishes the results if this was the last one
+ */
+void adcScanConversionComplete(uint16_t result)
+{
+  uint8_t channel = passChannel;
+  if(channel == ADC_SCAN_NO_CHANNEL) { return; } //The scan was reset during the conversion
+
+  uint8_t fill = scanPublished ^ 1U;
+  scanResults[fill][channel] = result;
+
+  channel = nextPassChannel(channel + 1U);
+  if(channel != ADC_SCAN_NO_CHANNEL)
+  {
+    passChannel = channel;
+    adcScanStartConversion(scanPins[channel]);
+  }
+  else
+  {
+    if(passSlow != ADC_SCAN_NO_CHANNEL) { scanNextSlow = passSlow + 1U; }
+    passAll = false;
+    scanPublished = fill;
+    scanPublishCount++;
+    scanHasResults = true;
+    passChannel = ADC_SCAN_NO_CHANNEL;
+  }
+}
+
+/** Latest result for a pin
+ * @return false if the pin is not in the scan, or the scan has not converted every channel yet
+ */
+bool adcScanRead(uint8_t pin, uint16_t &value)
+{
+  if( (scanRunning == false) || (scanHasResults == false) ) { return false; }
+  uint8_t channel = findChannel(pin);
+  if(channel == ADC_SCAN_NO_CHANNEL) { return false; }
+
+  uint8_t count;
+  do
+  {
+    count = scanPublishCount;
+    value = scanResults[scanPublished][channel];
+  } while(count != scanPublishCount);
+  return true;
+}
+
+/** Copy the latest results of every channel, all from the same pass, in the order they were added
+ * @return Number of channels copied
+ */
+uint8_t adcScanSnapshot(uint16_t *pValues)
+{
+  uint8_t count;
+  do
+  {
+    count = scanPublishCount;
+    uint8_t published = scanPublished;
+    for(uint8_t x = 0U; x < scanChannelCount; x++) { pValues[x] = scanResults[published][x]; }
+  } while(count != scanPublishCount);
+  return scanChannelCount;
+}
+
+/** Incremented every time a new set of results is published */
+uint8_t adcScanPublishCount(void)
+{
+  return scanPublishCount;
+}
@@ -0,0 +1,40 @@
+/** @file
+ * Background scan of the analog inputs.
+ *
+ * On the boards that define ANALOG_SCAN (STM32F4, see ADC_CONVERSION_ISR_AVAILABLE), the analog inputs are converted in the
+ * background rather than by blocking reads in the main loop. Each 1ms timer tick begins a pass that converts every fast
+ * channel (MAP, EMAP, analog knock) and the next of the slow channels (Temperatures, TPS, O2, battery etc.) in turn.
+ *
+ * The tick does not wait for any conversion. It asks the board layer to start the first one through adcScanStartConversion(),
+ * and the board's end of conversion interrupt hands each result to adcScanConversionComplete(), which starts the next
+ * conversion of the pass. A tick that arrives while the last pass is still converting is skipped.
+ *
+ * Results are double buffered. Each pass fills one buffer (Starting from a copy of the last published results) and then
+ * publishes it, so readers always see a complete set of conversions. adcScanRead() reads a single channel and
+ * adcScanSnapshot() copies all of them from the same pass. The first pass after adcScanStart() converts every channel,
+ * and nothing can be read until it has been published.
+ */
+#ifndef ADC_SCAN_H
+#define ADC_SCAN_H
+
+#include <stdint.h>
+
+#define ADC_SCAN_MAX_CHANNELS   24U
+#define ADC_SCAN_NO_CHANNEL     0xFFU
+
+void adcScanReset(void);
+bool adcScanAddChannel(uint8_t pin, bool isFast);
+uint8_t adcScanChannelCount(void);
+void adcScanStart(void);
+void adcScanTick(void);
+void adcScanConversionComplete(uint16_t result);
+bool adcScanRead(uint8_t pin, uint16_t &value);
+uint8_t adcScanSnapshot(uint16_t *pValues);
+uint8_t adcScanPublishCount(void);
+
+/** Board layer start of a conversion, called from adcScanTick() and adcScanConversionComplete().
+ * The result must be passed to adcScanConversionComplete(), which can be later if the ADC is busy with something else.
+ */
+void adcScanStartConversion(uint8_t pin);
+
+#endif // ADC_SCAN_H
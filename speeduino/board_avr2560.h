@@ -127,6 +127,18 @@ static inline void IGN6_TIMER_DISABLE(void) { TIMSK4 &= ~(1 << OCIE4B); } //Repl
 static inline void IGN7_TIMER_DISABLE(void) { TIMSK3 &= ~(1 << OCIE3C); } //Replaces injector 3
 static inline void IGN8_TIMER_DISABLE(void) { TIMSK3 &= ~(1 << OCIE3B); } //Replaces injector 2
 
+  //USE_SCHEDULE_QUEUE: Fuel 5-8 share the injector 5 compare unit and ignition 4-8 share the ignition 4 one (See schedule_queue.h)
+  #define FUEL_QUEUE_COUNTER        TCNT4
+  #define FUEL_QUEUE_COMPARE        OCR4C
+  #define FUEL_QUEUE_VECTOR         TIMER4_COMPC_vect
+  #define FUEL_QUEUE_TIMER_ENABLE   FUEL5_TIMER_ENABLE
+  #define FUEL_QUEUE_TIMER_DISABLE  FUEL5_TIMER_DISABLE
+  #define IGN_QUEUE_COUNTER         TCNT4
+  #define IGN_QUEUE_COMPARE         OCR4A
+  #define IGN_QUEUE_VECTOR          TIMER4_COMPA_vect
+  #define IGN_QUEUE_TIMER_ENABLE    IGN4_TIMER_ENABLE
+  #define IGN_QUEUE_TIMER_DISABLE   IGN4_TIMER_DISABLE
+
   #define MAX_TIMER_PERIOD 262140UL //The longest period of time (in uS) that the timer can permit (IN this case it is 65535 * 4, as each timer tick is 4uS)
   #define uS_TO_TIMER_COMPARE(uS1) ((uS1) >> 2) //Converts a given number of uS into the required number of timer ticks until that time has passed
 
@@ -154,6 +166,13 @@ static inline void IGN8_TIMER_DISABLE(void) { TIMSK3 &= ~(1 << OCIE3B); } //Repl
   #define IDLE_TIMER_ENABLE() TIMSK1 |= (1 << OCIE1C)
   #define IDLE_TIMER_DISABLE() TIMSK1 &= ~(1 << OCIE1C)
 
+/*
+***********************************************************************************************************
+* Trigger input capture
+*/
+  //The trigger inputs are on the external interrupt pins, which are not connected to an input capture unit (ICP4/5 are on pins 48/49).
+  //TRIGGER_CAPTURE_AVAILABLE is not defined, so the trigger edge times come from micros()
+
 /*
 ***********************************************************************************************************
 * CAN / Second serial
@@ -8,6 +8,7 @@
 #include "HardwareTimer.h"
 #include "timers.h"
 #include "comms_secondary.h"
+#include "sensors.h"
 
 #if HAL_CAN_MODULE_ENABLED
 //This activates CAN1 interface on STM32, but it's named as Can0, because that's how Teensy implementation is done
@@ -346,6 +347,113 @@ STM32RTC& rtc = STM32RTC::getInstance();
     #endif
   }
 
+  #if defined(USE_TRIGGER_CAPTURE)
+  /*
+  ***********************************************************************************************************
+  * Trigger input capture
+  * The trigger ISRs are still called from the EXTI interrupt of the pin. The timer channel only latches the time of the edge
+  */
+  triggerCapture triggerCaptures[TRIGGER_INPUT_COUNT];
+  static HardwareTimer *captureTimers[TRIGGER_INPUT_COUNT];
+
+  static bool isTimerInUse(const TIM_TypeDef *instance)
+  {
+    if( (instance == TIM1) || (instance == TIM2) || (instance == TIM3) || (instance == TIM4) ) { return true; }
+  #if !defined(ARDUINO_BLUEPILL_F103C8) && !defined(ARDUINO_BLUEPILL_F103CB)
+    if( instance == TIM5 ) { return true; }
+    if( instance == Timer11.getHandle()->Instance ) { return true; }
+  #endif
+    return false;
+  }
+
+  void initTriggerCapture(uint8_t input, uint8_t pin, uint8_t edge)
+  {
+    triggerCaptures[input].pCounter = nullptr;
+    triggerCaptures[input].pCapture = nullptr;
+
+    PinName pinName = digitalPinToPinName(pin);
+    TIM_TypeDef *instance = (TIM_TypeDef *)pinmap_peripheral(pinName, PinMap_TIM);
+    if( (instance == nullptr) || isTimerInUse(instance) ) { return; } //Not a timer pin. This input uses micros()
+    uint32_t channel = STM_PIN_CHANNEL(pinmap_function(pinName, PinMap_TIM));
+
+    //This is called every time the triggers are initialised (Including on every main loop while the engine is stalled), so an
+    //existing timer is always reused. Two trigger inputs on the same timer share it
+    HardwareTimer *timer = nullptr;
+    bool isPreviousShared = false;
+    for(uint8_t other = 0; other < TRIGGER_INPUT_COUNT; other++)
+    {
+      if(captureTimers[other] == nullptr) { continue; }
+      if(captureTimers[other]->getHandle()->Instance == instance) { timer = captureTimers[other]; }
+      if( (other != input) && (captureTimers[other] == captureTimers[input]) ) { isPreviousShared = true; }
+    }
+    if(timer == nullptr)
+    {
+      //The pin of this input has moved to a different timer
+      if( (captureTimers[input] != nullptr) && (isPreviousShared == false) ) { delete captureTimers[input]; }
+      timer = new HardwareTimer(instance);
+      timer->setPrescaleFactor(timer->getTimerClkFreq() / 1000000U); //1uS per tick
+      timer->setOverflow(0x10000U, TICK_FORMAT);
+    }
+    captureTimers[input] = timer;
+
+    TimerModes_t mode = TIMER_INPUT_CAPTURE_BOTHEDGE; //Decoders that select the edge themselves (Eg CHANGE)
+    if(edge == RISING) { mode = TIMER_INPUT_CAPTURE_RISING; }
+    else if(edge == FALLING) { mode = TIMER_INPUT_CAPTURE_FALLING; }
+    timer->setMode(channel, mode, pin);
+    timer->resume();
+
+    triggerCaptures[input].counterMask = 0xFFFFU;
+    triggerCaptures[input].usPerTickShift = 0U;
+    triggerCaptures[input].pCapture = &(instance->CCR1) + (channel - 1U); //CCR1-4 are consecutive
+    triggerCaptures[input].pCounter = &(instance->CNT);
+  }
+  #endif
+
+  #if defined(ADC_CONVERSION_ISR_AVAILABLE)
+  /*
+  ***********************************************************************************************************
+  * ADC conversions completed by interrupt (See map_sampling.h)
+  * analogRead() sets up and tears down ADC1 through the HAL on every call. ADC2 is set up once here and then only needs
+  * its channel selected to start a conversion, which is cheap enough for the trigger interrupt
+  */
+  #ifndef EXTI_IRQ_PRIO
+    #define EXTI_IRQ_PRIO 6 //STM32duino default for the pin (Trigger) interrupts
+  #endif
+
+  void initADCConversion(void)
+  {
+    __HAL_RCC_ADC2_CLK_ENABLE();
+    //The prescaler is shared by all 3 ADCs. analogRead() sets its own, which is also within the ADC clock limit
+    ADC123_COMMON->CCR = (ADC123_COMMON->CCR & ~ADC_CCR_ADCPRE) | ADC_CCR_ADCPRE_0; //PCLK2 / 4
+
+    ADC2->CR2 = 0U;
+    ADC2->CR1 = ADC_CR1_RES_0 | ADC_CR1_EOCIE; //10 bit, as analogRead() (See initialiseADC())
+    ADC2->SQR1 = 0U; //1 conversion
+    ADC2->SMPR1 = 0U;
+    ADC2->SMPR2 = 0U;
+    for(uint8_t channel = 0; channel < 10U; channel++) { ADC2->SMPR2 |= ADC_SAMPLETIME_56CYCLES << (3U * channel); }
+    for(uint8_t channel = 0; channel < 9U; channel++) { ADC2->SMPR1 |= ADC_SAMPLETIME_56CYCLES << (3U * channel); }
+    ADC2->CR2 = ADC_CR2_ADON; //Single conversion, right aligned
+
+    //Same priority as the trigger interrupts, so a conversion completing never preempts the decoder (Or the reverse)
+    HAL_NVIC_SetPriority(ADC_IRQn, EXTI_IRQ_PRIO, 0);
+    HAL_NVIC_EnableIRQ(ADC_IRQn);
+  }
+
+  void startADCConversion(uint8_t pin)
+  {
+    //The pin is already in analog mode, the same pins are read by analogRead()
+    ADC2->SQR3 = STM_PIN_CHANNEL(pinmap_function(digitalPinToPinName(pin), PinMap_ADC));
+    ADC2->CR2 |= ADC_CR2_SWSTART;
+  }
+
+  extern "C" void ADC_IRQHandler(void)
+  {
+    //Reading DR clears EOC
+    if( (ADC2->SR & ADC_SR_EOC) != 0U ) { adcConversionComplete((uint16_t)ADC2->DR); }
+  }
+  #endif
+
   /*
   ***********************************************************************************************************
   * Interrupt callback functions
@@ -377,6 +377,32 @@ void ignitionSchedule8Interrupt(HardwareTimer*);
 #endif
 #endif //End core<=1.8
 
+/*
+***********************************************************************************************************
+* Trigger input capture (See trigger_capture.h)
+* Enabled with USE_TRIGGER_CAPTURE. Only trigger pins that are a channel of an otherwise unused timer are captured, the other inputs use micros()
+*/
+#if defined(USE_TRIGGER_CAPTURE)
+#define TRIGGER_CAPTURE_AVAILABLE
+#include "trigger_capture.h"
+extern triggerCapture triggerCaptures[TRIGGER_INPUT_COUNT];
+void initTriggerCapture(uint8_t input, uint8_t pin, uint8_t edge);
+static inline unsigned long getTriggerCaptureTime(uint8_t input) { return captureEdgeTime(triggerCaptures[input], micros()); }
+#endif
+
+/*
+***********************************************************************************************************
+* ADC conversions completed by interrupt, for the crank angle triggered MAP samples (See map_sampling.h) and the
+* background scan of the analog inputs (See adc_scan.h)
+* These use ADC2, which analogRead() never selects (It takes the first ADC listed for a pin, ADC1)
+*/
+#if defined(STM32F4) && defined(ADC2)
+#define ADC_CONVERSION_ISR_AVAILABLE
+#define ANALOG_SCAN
+void initADCConversion(void);
+void startADCConversion(uint8_t pin);
+#endif
+
 /*
 ***********************************************************************************************************
 * CAN / Second serial
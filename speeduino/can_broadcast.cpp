@@ -0,0 +1,146 @@
+/** @file
+ * Table driven CAN broadcast scheduler. See can_broadcast.h
+ */
+#include "can_broadcast.h"
+
+struct canTxQueueEntry
+{
+  uint32_t nextDue; ///< millis() value that the frame is next due at
+  uint16_t period;  ///< mS
+  uint8_t frame;
+};
+
+//Sorted by nextDue, soonest first
+static canTxQueueEntry canTxQueue[CAN_TX_MAX_FRAMES];
+static uint8_t canTxCount = 0U;
+
+/** Whether time a is before time b, allowing for millis() wrapping */
+static inline bool isBefore(uint32_t a, uint32_t b)
+{
+  return (int32_t)(a - b) < 0;
+}
+
+/** Insert an entry in nextDue order. Entries with the same due time keep the order they were added in */
+static void insertEntry(const canTxQueueEntry &entry)
+{
+  uint8_t position = canTxCount;
+  while( (position > 0U) && isBefore(entry.nextDue, canTxQueue[position - 1U].nextDue) )
+  {
+    canTxQueue[position] = canTxQueue[position - 1U];
+    position--;
+  }
+  canTxQueue[position] = entry;
+  canTxCount++;
+}
+
+/** Remove all of the frames */
+void canTxReset(void)
+{
+  canTxCount = 0U;
+}
+
+/** Add a frame to the queue
+ * @param frame Frame number, returned by canTxNextDueFrame() whenever the frame is due
+ * @param period Time (mS) between each transmission of the frame
+ * @param now Current millis()
+ * @return false if the queue is full or the period is 0
+ */
+bool canTxAddFrame(uint8_t frame, uint16_t period, uint32_t now)
+{
+  if( (canTxCount >= CAN_TX_MAX_FRAMES) || (period == 0U) ) { return false; }
+
+  //Stagger the first transmissions so that frames with the same period do not all go out in the same loop
+  canTxQueueEntry entry;
+  entry.nextDue = now + (canTxCount % period);
+  entry.period = period;
+  entry.frame = frame;
+  insertEntry(entry);
+  return true;
+}
+
+/** The next frame that is due to be sent, which is then rescheduled for its next transmission.
+ * Call repeatedly until it returns CAN_TX_FRAME_NONE to send every frame that is due.
+ * @param now Current millis()
+ * @return Frame number or CAN_TX_FRAME_NONE
+ */
+uint8_t canTxNextDueFrame(uint32_t now)
+{
+  if( (canTxCount == 0U) || isBefore(now, canTxQueue[0].nextDue) ) { return CAN_TX_FRAME_NONE; }
+
+  canTxQueueEntry entry = canTxQueue[0];
+  canTxCount--;
+  for(uint8_t x = 0U; x < canTxCount; x++) { canTxQueue[x] = canTxQueue[x + 1U]; }
+
+  //Keep to a fixed grid of transmissions, unless a whole period has been missed
+  entry.nextDue += entry.period;
+  if( !isBefore(now, entry.nextDue) ) { entry.nextDue = now + entry.period; }
+  insertEntry(entry);
+
+  return entry.frame;
+}
+
+uint8_t canTxFrameCount(void)
+{
+  return canTxCount;
+}
+
+/** Number of bytes that a signal type occupies in the frame (0 for CAN_TX_SIGNAL_OFF or an invalid type) */
+uint8_t canTxSignalWidth(uint8_t type)
+{
+  switch(type)
+  {
+    case CAN_TX_SIGNAL_U08:
+    case CAN_TX_SIGNAL_S08:
+      return 1U;
+    case CAN_TX_SIGNAL_U16:
+    case CAN_TX_SIGNAL_S16:
+      return 2U;
+    default:
+      return 0U;
+  }
+}
+
+/** value * multiply / divide + offset. A divide of 0 is treated as 1 */
+int32_t scaleCANSignal(int32_t value, uint8_t multiply, uint8_t divide, int8_t offset)
+{
+  value = value * (int32_t)multiply;
+  if(divide > 1U) { value = value / (int32_t)divide; }
+  return value + offset;
+}
+
+/** Write a value into a frame, limited to the range of the signal type
+ * @param pData The 8 data bytes of the frame
+ * @param type CAN_TX_SIGNAL_*
+ * @param startByte First byte of the frame that the signal occupies
+ * @param isBigEndian Most significant byte first (Motorola) rather than least significant first (Intel)
+ * @return false if the signal is off or does not fit in the frame
+ */
+bool packCANSignal(uint8_t *pData, uint8_t type, uint8_t startByte, bool isBigEndian, int32_t value)
+{
+  uint8_t width = canTxSignalWidth(type);
+  if( (width == 0U) || ((startByte + width) > 8U) ) { return false; }
+
+  int32_t minimum = 0;
+  int32_t maximum = UINT8_MAX;
+  if(type == CAN_TX_SIGNAL_S08) { minimum = INT8_MIN; maximum = INT8_MAX; }
+  else if(type == CAN_TX_SIGNAL_U16) { maximum = UINT16_MAX; }
+  else if(type == CAN_TX_SIGNAL_S16) { minimum = INT16_MIN; maximum = INT16_MAX; }
+  else { /* U08 limits */ }
+  if(value < minimum) { value = minimum; }
+  else if(value > maximum) { value = maximum; }
+  else { /* In range */ }
+
+  uint16_t raw = (uint16_t)value;
+  if(width == 1U) { pData[startByte] = (uint8_t)raw; }
+  else if(isBigEndian)
+  {
+    pData[startByte] = (uint8_t)(raw >> 8U);
+    pData[startByte + 1U] = (uint8_t)raw;
+  }
+  else
+  {
+    pData[startByte] = (uint8_t)raw;
+    pData[startByte + 1U] = (uint8_t)(raw >> 8U);
+  }
+  return true;
+}
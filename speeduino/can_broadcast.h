@@ -0,0 +1,45 @@
+/** @file
+ * Table driven CAN broadcast scheduler.
+ *
+ * Each broadcast frame has its own period in mS. Rather than sending groups of frames from the fixed rate LOOP_TIMER
+ * blocks, the frames are kept in a small queue ordered by when each is next due. canTxNextDueFrame() is called from
+ * every main loop and only has to look at the head of the queue, so most calls do nothing.
+ *
+ * Frames that fall behind (Eg the loop was held up) are sent once and then rescheduled from the current time, rather
+ * than being sent repeatedly to catch up.
+ *
+ * The frames come from 2 places:
+ * - The built in dash protocols (CANBroadcastProtocol), which are built by DashMessage() in comms_CAN.cpp
+ * - Up to CAN_TX_USER_FRAMES user defined frames (Page 15). Each of these is made up of up to CAN_TX_USER_SIGNALS
+ *   signals, which copy a value from the live data (The same offsets as the TunerStudio output channels) into the frame
+ *   with a scale and offset. See packCANSignal()
+ */
+#ifndef CAN_BROADCAST_H
+#define CAN_BROADCAST_H
+
+#include <stdint.h>
+
+#define CAN_TX_MAX_FRAMES       16U   ///< Maximum number of frames in the queue (Built in + user)
+#define CAN_TX_FRAME_NONE       0xFFU ///< Returned by canTxNextDueFrame() when no frame is due
+#define CAN_TX_USER_FRAME_BASE  0x80U ///< Frame numbers from here are the user frames, below it are the built in protocol frames
+
+#define CAN_TX_USER_FRAMES      4U
+#define CAN_TX_USER_SIGNALS     4U    ///< Signals per user frame
+
+//Signal types (canTxSigType). The value is read from the live data in this format and written to the frame with the same width
+#define CAN_TX_SIGNAL_OFF       0U
+#define CAN_TX_SIGNAL_U08       1U
+#define CAN_TX_SIGNAL_S08       2U
+#define CAN_TX_SIGNAL_U16       3U
+#define CAN_TX_SIGNAL_S16       4U
+
+void canTxReset(void);
+bool canTxAddFrame(uint8_t frame, uint16_t period, uint32_t now);
+uint8_t canTxNextDueFrame(uint32_t now);
+uint8_t canTxFrameCount(void);
+
+uint8_t canTxSignalWidth(uint8_t type);
+bool packCANSignal(uint8_t *pData, uint8_t type, uint8_t startByte, bool isBigEndian, int32_t value);
+int32_t scaleCANSignal(int32_t value, uint8_t multiply, uint8_t divide, int8_t offset);
+
+#endif // CAN_BROADCAST_H
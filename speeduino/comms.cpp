@@ -18,7 +18,9 @@ A full copy of the license may be found in the projects root directory
 #include "pages.h"
 #include "page_crc.h"
 #include "logger.h"
+#include "toothlog_compact.h"
 #include "comms_legacy.h"
+#include "isr_timing.h"
 #include "src/FastCRC/FastCRC.h"
 #include <avr/pgmspace.h>
 #ifdef RTC_ENABLED
@@ -44,10 +46,12 @@ void sendToothLog(void);
 /** @brief Should be called when ::serialStatusFlag == LOG_SEND_COMPOSITE */
 void sendCompositeLog(void);
 
+static void sendCompactToothLog(void);
+
 /// @defgroup group-serial-return-codes Serial return codes sent to TS
 /// @{
 static constexpr byte SERIAL_RC_OK         = 0x00U; //!< Success
-static constexpr byte SERIAL_RC_REALTIME   = 0x01U; //!< Unused
+static constexpr byte SERIAL_RC_REALTIME   = 0x01U; //!< Live data frame pushed by a subscription (See 'l' command)
 static constexpr byte SERIAL_RC_PAGE       = 0x02U; //!< Unused
 static constexpr byte SERIAL_RC_BURN_OK    = 0x04U; //!< EEPROM write succeeded
 static constexpr byte SERIAL_RC_TIMEOUT    = 0x80U; //!< Timeout error
@@ -84,6 +88,21 @@ static uint16_t serialBytesRxTx = 0;
 static constexpr uint16_t SERIAL_TIMEOUT = 700; //!< Timeout threshold in milliseconds
 static uint32_t serialReceiveStartTime = 0; //!< The time in milliseconds at which the serial receive started. Used for calculating whether a timeout has occurred
 
+/// @defgroup group-serial-live-stream Live data subscription
+/// The 'l' command registers a list of live data ranges and an interval. The ECU then pushes
+/// a frame (SERIAL_RC_REALTIME + the ranges back to back) every interval with no request from the client.
+/// @{
+static constexpr uint8_t LIVE_STREAM_MAX_RANGES = 8U; //!< Maximum number of ranges in a subscription
+struct liveDataRange {
+  uint16_t offset;
+  uint16_t length;
+};
+static liveDataRange liveStreamRanges[LIVE_STREAM_MAX_RANGES];
+static uint8_t liveStreamRangeCount = 0U; //!< 0 when there is no subscription
+static uint16_t liveStreamInterval = 0U; //!< Time between frames in milliseconds
+static uint32_t liveStreamNextTime = 0U; //!< The time in milliseconds at which the next frame is due
+/// @}
+
 static FastCRC32 CRC32_serial; //!< Support accumulation of a CRC during non-blocking operations
 using crc_t = uint32_t;
 
@@ -331,6 +350,52 @@ static bool updatePageValues(uint8_t pageNum, uint16_t offset, const byte *buffe
   return false;
 }
 
+/** @brief Is [offset, offset+length) entirely within a page? */
+static bool isPageRangeValid(uint8_t pageNum, uint16_t offset, uint16_t length)
+{
+  return (pageNum < getPageCount()) && ( ((uint32_t)offset + length) <= getPageSize(pageNum) );
+}
+
+static constexpr uint8_t PAGE_BATCH_HEADER_SIZE = 3U; //!< Command, CAN ID (Unused, as per the other page commands) and range count
+
+/**
+ * @brief Update several page ranges from a batched write ('W' command) in serialPayload
+ * 
+ * Command structure: "W", <CAN ID (1 byte)>, <range count (1 byte)>, then for each range <page (1 byte)>, <offset (2 bytes)>, <length (2 bytes)>, <data (length bytes)>.
+ * The CAN ID and little endian offsets and lengths are the same as the 'M' command. Ranges can be on different pages.
+ * 
+ * The whole packet is checked before anything is written, so either every range is applied or none are.
+ * 
+ * @return true if all the ranges were written
+ */
+static bool updatePageRanges(void)
+{
+  if(serialPayloadLength < PAGE_BATCH_HEADER_SIZE) { return false; }
+  uint8_t rangeCount = serialPayload[2];
+
+  //First pass: check that every range is within its page and the packet holds all of the data
+  uint16_t index = PAGE_BATCH_HEADER_SIZE;
+  for(uint8_t range = 0; range < rangeCount; range++)
+  {
+    if( (index + 5U) > serialPayloadLength ) { return false; }
+    uint16_t length = word(serialPayload[index+4U], serialPayload[index+3U]);
+    if( !isPageRangeValid(serialPayload[index], word(serialPayload[index+2U], serialPayload[index+1U]), length) ) { return false; }
+    index = index + 5U;
+    if( ((uint32_t)index + length) > serialPayloadLength ) { return false; }
+    index = index + length;
+  }
+
+  //Second pass: apply them
+  index = PAGE_BATCH_HEADER_SIZE;
+  for(uint8_t range = 0; range < rangeCount; range++)
+  {
+    uint16_t length = word(serialPayload[index+4U], serialPayload[index+3U]);
+    (void)updatePageValues(serialPayload[index], word(serialPayload[index+2U], serialPayload[index+1U]), &serialPayload[index+5U], length);
+    index = index + 5U + length;
+  }
+  return true;
+}
+
 /**
  * @brief Loads a pages contents into a buffer
  * 
@@ -347,13 +412,58 @@ static void loadPageValuesToBuffer(uint8_t pageNum, uint16_t offset, byte *buffe
   }
 }
 
+static constexpr uint8_t PAGE_BATCH_MAX_READ_RANGES = 8U; //!< Maximum number of ranges in a batched page read
+
+/**
+ * @brief Load several page ranges for a batched read ('P' command) into serialPayload
+ * 
+ * Command structure: "P", <CAN ID (1 byte)>, <range count (1 byte)>, then for each range <page (1 byte)>, <offset (2 bytes)>, <length (2 bytes)>.
+ * The response is SERIAL_RC_OK followed by the data of each range back to back.
+ * 
+ * @return The length of the response in serialPayload, or 0 if the request was not valid
+ */
+static uint16_t loadPageRangesToBuffer(void)
+{
+  struct pageRange {
+    uint8_t pageNum;
+    uint16_t offset;
+    uint16_t length;
+  };
+  pageRange ranges[PAGE_BATCH_MAX_READ_RANGES];
+  if(serialPayloadLength < PAGE_BATCH_HEADER_SIZE) { return 0U; }
+  uint8_t rangeCount = serialPayload[2];
+
+  if( (rangeCount == 0U) || (rangeCount > PAGE_BATCH_MAX_READ_RANGES) || (serialPayloadLength < (PAGE_BATCH_HEADER_SIZE + (rangeCount * 5U))) ) { return 0U; }
+
+  //The request is overwritten by the response, so take a copy of the ranges first
+  uint32_t totalLength = 1U;
+  for(uint8_t range = 0; range < rangeCount; range++)
+  {
+    const byte *pRange = &serialPayload[PAGE_BATCH_HEADER_SIZE + (range * 5U)];
+    ranges[range].pageNum = pRange[0];
+    ranges[range].offset = word(pRange[2], pRange[1]);
+    ranges[range].length = word(pRange[4], pRange[3]);
+    totalLength = totalLength + ranges[range].length;
+    if( !isPageRangeValid(ranges[range].pageNum, ranges[range].offset, ranges[range].length) || (totalLength > SERIAL_BUFFER_SIZE) ) { return 0U; }
+  }
+
+  serialPayload[0] = SERIAL_RC_OK;
+  uint16_t payloadLength = 1U;
+  for(uint8_t range = 0; range < rangeCount; range++)
+  {
+    loadPageValuesToBuffer(ranges[range].pageNum, ranges[range].offset, &serialPayload[payloadLength], ranges[range].length);
+    payloadLength = payloadLength + ranges[range].length;
+  }
+  return payloadLength;
+}
+
 /** @brief Send a status record back to tuning/logging SW.
  * This will "live" information from @ref currentStatus struct.
  * @param offset - Start field number
  * @param packetLength - Length of actual message (after possible ack/confirm headers)
  * E.g. tuning sw command 'A' (Send all values) will send data from field number 0, LOG_ENTRY_SIZE fields.
  */
-static void generateLiveValues(uint16_t offset, uint16_t packetLength)
+static uint16_t generateLiveValueRanges(byte returnCode, const liveDataRange *pRanges, uint8_t rangeCount)
 {  
   if(firstCommsRequest) 
   { 
@@ -363,13 +473,74 @@ static void generateLiveValues(uint16_t offset, uint16_t packetLength)
 
   currentStatus.status2 ^= (-currentStatus.hasSync ^ currentStatus.status2) & (1U << BIT_STATUS2_SYNC); //Set the sync bit of the Spark variable to match the hasSync variable
 
-  serialPayload[0] = SERIAL_RC_OK;
-  for(uint16_t x=0; x<packetLength; x++)
+  serialPayload[0] = returnCode;
+  uint16_t payloadLength = 1U;
+  for(uint8_t range = 0; range < rangeCount; range++)
   {
-    serialPayload[x+1U] = getTSLogEntry(offset+x); 
+    getTSLogEntries(pRanges[range].offset, pRanges[range].length, &serialPayload[payloadLength]);
+    payloadLength = payloadLength + pRanges[range].length;
   }
   // Reset any flags that are being used to trigger page refreshes
   BIT_CLEAR(currentStatus.status3, BIT_STATUS3_VSS_REFRESH);
+  return payloadLength;
+}
+
+static void generateLiveValues(uint16_t offset, uint16_t packetLength)
+{  
+  liveDataRange range = { offset, packetLength };
+  (void)generateLiveValueRanges(SERIAL_RC_OK, &range, 1U);
+}
+
+/**
+ * @brief Register (Or cancel) a live data subscription from serialPayload
+ * 
+ * Command structure: "l", <interval ms (2 bytes)>, <range count (1 byte)>, then for each range <offset (2 bytes)>, <length (2 bytes)>.
+ * All values are little endian, the same as the 'r' command. An interval or range count of 0 cancels the subscription.
+ * 
+ * @return true if the subscription was accepted
+ */
+static bool subscribeLiveData(void)
+{
+  liveStreamRangeCount = 0U; //Any existing subscription is replaced, even if the new one is rejected
+  if(serialPayloadLength < 4U) { return false; }
+
+  uint16_t interval = word(serialPayload[2], serialPayload[1]);
+  uint8_t rangeCount = serialPayload[3];
+  if( (interval == 0U) || (rangeCount == 0U) ) { return true; }
+  if( (rangeCount > LIVE_STREAM_MAX_RANGES) || (serialPayloadLength < (4U + (rangeCount * 4U))) ) { return false; }
+
+  uint32_t totalLength = 0U;
+  for(uint8_t range = 0; range < rangeCount; range++)
+  {
+    const byte *pRange = &serialPayload[4U + (range * 4U)];
+    liveStreamRanges[range].offset = word(pRange[1], pRange[0]);
+    liveStreamRanges[range].length = word(pRange[3], pRange[2]);
+    totalLength = totalLength + liveStreamRanges[range].length;
+    if( (liveStreamRanges[range].length == 0U) || (liveStreamRanges[range].offset >= LOG_ENTRY_SIZE) || (totalLength >= SERIAL_BUFFER_SIZE) ) { return false; }
+  }
+
+  liveStreamInterval = interval;
+  liveStreamNextTime = millis();
+  liveStreamRangeCount = rangeCount;
+  return true;
+}
+
+/** @brief Start sending the next subscription frame if one is due */
+static void sendLiveDataStream(void)
+{
+  uint32_t now = millis();
+  if( (int32_t)(now - liveStreamNextTime) < 0 ) { return; }
+
+  //Frames stay on a fixed grid so the samples are evenly spaced. If the link has fallen a whole interval behind, start a new grid instead of bursting to catch up
+  liveStreamNextTime = liveStreamNextTime + liveStreamInterval;
+  if( (int32_t)(now - liveStreamNextTime) >= 0 ) { liveStreamNextTime = now + liveStreamInterval; }
+
+  sendSerialPayloadNonBlocking(generateLiveValueRanges(SERIAL_RC_REALTIME, liveStreamRanges, liveStreamRangeCount));
+}
+
+bool isLiveDataStreamActive(void)
+{
+  return liveStreamRangeCount > 0U;
 }
 
 /**
@@ -481,6 +652,8 @@ void serialReceive(void)
     if(highByte == 'F')
     {
       //F command is always allowed as it provides the initial serial protocol version. 
+      //It is the first thing a new client sends, so any subscription from a previous client is finished
+      liveStreamRangeCount = 0U;
       legacySerialCommand();
       return;
     }
@@ -567,6 +740,10 @@ void serialTransmit(void)
       serialStatusFlag = serialBytesRxTx==serialPayloadLength+sizeof(crc_t) ? SERIAL_INACTIVE : SERIAL_TRANSMIT_INPROGRESS;
       break;
 
+    case SERIAL_INACTIVE:
+      if(isLiveDataStreamActive()) { sendLiveDataStream(); }
+      break;
+
     default: // Nothing to do
       break;
   }
@@ -582,7 +759,7 @@ void processSerialCommand(void)
       break;
 
     case 'b': // New EEPROM burn command to only burn a single page at a time 
-      if( (micros() > deferEEPROMWritesUntil)) { writeConfig(serialPayload[2]); } //Read the table number and perform burn. Note that byte 1 in the array is unused
+      if( (micros() > deferEEPROMWritesUntil)) { writeDirtyConfig(serialPayload[2]); } //Read the table number and burn the parts of it that have changed. Note that byte 1 in the array is unused
       else { BIT_SET(currentStatus.status4, BIT_STATUS4_BURNPENDING); }
       
       sendReturnCodeMsg(SERIAL_RC_BURN_OK);
@@ -591,7 +768,7 @@ void processSerialCommand(void)
     case 'B': // Same as above, but for the comms compat mode. Slows down the burn rate and increases the defer time
       BIT_SET(currentStatus.status4, BIT_STATUS4_COMMS_COMPAT); //Force the compat mode
       deferEEPROMWritesUntil += (EEPROM_DEFER_DELAY/4); //Add 25% more to the EEPROM defer time
-      if( (micros() > deferEEPROMWritesUntil)) { writeConfig(serialPayload[2]); } //Read the table number and perform burn. Note that byte 1 in the array is unused
+      if( (micros() > deferEEPROMWritesUntil)) { writeDirtyConfig(serialPayload[2]); } //Read the table number and burn the parts of it that have changed. Note that byte 1 in the array is unused
       else { BIT_SET(currentStatus.status4, BIT_STATUS4_BURNPENDING); }
       
       sendReturnCodeMsg(SERIAL_RC_BURN_OK);
@@ -643,6 +820,24 @@ void processSerialCommand(void)
       sendReturnCodeMsg(SERIAL_RC_OK);
       break;
 
+#if defined(ISR_TIMING)
+    case 'i': //Send the execution time statistics of an ISR. Command structure: "i", <ISR index>, [reset flag]
+    {
+      //The ISR index is required, the reset flag is optional
+      if( (serialPayloadLength >= 2U) && (serialPayload[1] < ISR_TIMING_COUNT) )
+      {
+        uint8_t isrIndex = serialPayload[1];
+        bool resetAfterRead = (serialPayloadLength > 2U) && (serialPayload[2] != 0U);
+        serialPayload[0] = SERIAL_RC_OK;
+        uint16_t length = loadIsrTimingStats(isrIndex, &serialPayload[1]);
+        if(resetAfterRead == true) { resetIsrTiming(); }
+        sendSerialPayloadNonBlocking(length + 1U);
+      }
+      else { sendReturnCodeMsg(SERIAL_RC_RANGE_ERR); }
+      break;
+    }
+#endif
+
     case 'I': // send CAN ID
       (void)memcpy_P(serialPayload, canId, sizeof(canId) );
       sendSerialPayloadNonBlocking(sizeof(serialVersion));
@@ -668,6 +863,10 @@ void processSerialCommand(void)
       break;
     }
 
+    case 'l': //Subscribe to (Or cancel) a stream of live data. See subscribeLiveData()
+      sendReturnCodeMsg(subscribeLiveData() ? SERIAL_RC_OK : SERIAL_RC_RANGE_ERR);
+      break;
+
     case 'M':
     {
       //New write command
@@ -726,6 +925,14 @@ void processSerialCommand(void)
       break;
     }
 
+    case 'P': //Batched read of several page ranges. See loadPageRangesToBuffer()
+    {
+      uint16_t payloadLength = loadPageRangesToBuffer();
+      if(payloadLength > 0U) { sendSerialPayloadNonBlocking(payloadLength); }
+      else { sendReturnCodeMsg(SERIAL_RC_RANGE_ERR); }
+      break;
+    }
+
     case 'Q': // send code version
       (void)memcpy_P(serialPayload, codeVersion, sizeof(codeVersion) );
       sendSerialPayloadNonBlocking(sizeof(codeVersion));
@@ -879,6 +1086,10 @@ void processSerialCommand(void)
       else { /* MISRA no-op */ }
       break;
 
+    case 'Y': //Send the tooth or composite log in the compact format (See toothlog_compact.h)
+      sendCompactToothLog();
+      break;
+
     case 't': // receive new Calibration info. Command structure: "t", <tble_idx> <data array>.
     {
       uint8_t cmd = serialPayload[2];
@@ -924,6 +1135,10 @@ void processSerialCommand(void)
       }
       break;
 
+    case 'W': //Batched write of several page ranges. See updatePageRanges()
+      sendReturnCodeMsg(updatePageRanges() ? SERIAL_RC_OK : SERIAL_RC_RANGE_ERR);
+      break;
+
     case 'w':
     {
 #ifdef COMMS_SD
@@ -1068,22 +1283,25 @@ void processSerialCommand(void)
 */
 void sendToothLog(void)
 {
-  //We need TOOTH_LOG_SIZE number of records to send to TunerStudio. If there aren't that many in the buffer then we just return and wait for the next call
+  //We need TOOTH_LOG_SIZE number of records to send to TunerStudio. The logger carries on filling the other buffer while this one is sent
   if (BIT_CHECK(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY) == false) 
   {
     //If the buffer is not yet full but TS has timed out, pad the rest of the buffer with 0s
-    while(toothHistoryIndex < TOOTH_LOG_SIZE)
+    uint8_t logEntries = readyPartialToothLog();
+    const uint8_t paddingBuffer = getToothLogReadyBuffer();
+    while(logEntries < TOOTH_LOG_SIZE)
     {
-      toothHistory[toothHistoryIndex] = 0;
-      toothHistoryIndex++;
+      toothHistory[paddingBuffer][logEntries] = 0;
+      logEntries++;
     }
   }
+  const uint8_t logBuffer = getToothLogReadyBuffer();
 
   uint32_t CRC32_val = 0U;
   if(logItemsTransmitted == 0U)
   {
     //Transmit the size of the packet
-    (void)serialWrite((uint16_t)(sizeof(toothHistory) + 1U)); //Size of the tooth log (uint32_t values) plus the return code
+    (void)serialWrite((uint16_t)(sizeof(toothHistory[0]) + 1U)); //Size of the tooth log (uint32_t values) plus the return code
     //Begin new CRC hash
     const uint8_t returnCode = SERIAL_RC_OK;
     CRC32_val = CRC32_serial.crc32(&returnCode, 1, false);
@@ -1103,12 +1321,11 @@ void sendToothLog(void)
     }
 
     //Transmit the tooth time
-    uint32_t transmitted = serialWrite(toothHistory[logItemsTransmitted]);
+    uint32_t transmitted = serialWrite(toothHistory[logBuffer][logItemsTransmitted]);
     CRC32_val = CRC32_serial.crc32_upd((const byte*)&transmitted, sizeof(transmitted), false);
   }
   BIT_CLEAR(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY);
   serialStatusFlag = SERIAL_INACTIVE;
-  toothHistoryIndex = 0;
   logItemsTransmitted = 0;
 
   //Apply the CRC reflection
@@ -1118,24 +1335,64 @@ void sendToothLog(void)
   (void)serialWrite(CRC32_val);
 }
 
+/** 
+ * Sends whichever of the tooth or composite logs is running, in the compact format from toothlog_compact.h.
+ * Unlike sendToothLog() and sendCompositeLog(), a partially filled log is sent as it is, without padding. The log is
+ * copied into the payload up front, so the logger can have the buffer back before the transmission has completed.
+ * If the log does not fit in the serial buffer, the rest of it is sent on the following requests.
+*/
+static void sendCompactToothLog(void)
+{
+  static uint8_t compactLogEntries = 0U; //Number of entries in the log being sent
+  static uint8_t compactLogEntriesSent = 0U;
+
+  bool isComposite = (currentStatus.toothLogEnabled == false) && (currentStatus.compositeTriggerUsed > 0U);
+  if( (currentStatus.toothLogEnabled == false) && (isComposite == false) )
+  {
+    sendReturnCodeMsg(SERIAL_RC_RANGE_ERR); //No logger is running
+    return;
+  }
+
+  if( (BIT_CHECK(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY) == false) || (compactLogEntriesSent >= compactLogEntries) )
+  {
+    //Start a new log
+    compactLogEntries = TOOTH_LOG_SIZE;
+    compactLogEntriesSent = 0U;
+    if (BIT_CHECK(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY) == false) { compactLogEntries = readyPartialToothLog(); }
+  }
+  const uint8_t logBuffer = getToothLogReadyBuffer();
+
+  uint8_t logEntries = compactLogEntries - compactLogEntriesSent;
+  serialPayload[0] = SERIAL_RC_OK;
+  uint16_t encodedLength = encodeCompactToothLog(&toothHistory[logBuffer][compactLogEntriesSent], isComposite ? &compositeLogHistory[logBuffer][compactLogEntriesSent] : nullptr,
+                                                 logEntries, &serialPayload[1], sizeof(serialPayload) - 1U);
+  compactLogEntriesSent += logEntries;
+  if(compactLogEntriesSent >= compactLogEntries) { BIT_CLEAR(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY); }
+
+  sendSerialPayloadNonBlocking(encodedLength + 1U);
+}
+
 void sendCompositeLog(void)
 {
   if ( BIT_CHECK(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY) == false )
   {
     //If the buffer is not yet full but TS has timed out, pad the rest of the buffer with 0s
-    while(toothHistoryIndex < TOOTH_LOG_SIZE)
+    uint8_t logEntries = readyPartialToothLog();
+    const uint8_t paddingBuffer = getToothLogReadyBuffer();
+    while(logEntries < TOOTH_LOG_SIZE)
     {
-      toothHistory[toothHistoryIndex] = toothHistory[toothHistoryIndex-1U]; //Composite logger needs a realistic time value to display correctly. Copy the last value
-      compositeLogHistory[toothHistoryIndex] = 0U;
-      toothHistoryIndex++;
+      toothHistory[paddingBuffer][logEntries] = (logEntries > 0U) ? toothHistory[paddingBuffer][logEntries-1U] : 0U; //Composite logger needs a realistic time value to display correctly. Copy the last value
+      compositeLogHistory[paddingBuffer][logEntries] = 0U;
+      logEntries++;
     }
   }
+  const uint8_t logBuffer = getToothLogReadyBuffer();
 
   uint32_t CRC32_val = 0;
   if(logItemsTransmitted == 0U)
   { 
     //Transmit the size of the packet
-    (void)serialWrite((uint16_t)(sizeof(toothHistory) + sizeof(compositeLogHistory) + 1U)); //Size of the tooth log (uint32_t values) plus the return code
+    (void)serialWrite((uint16_t)(sizeof(toothHistory[0]) + sizeof(compositeLogHistory[0]) + 1U)); //Size of the tooth log (uint32_t values) plus the return code
     
     //Begin new CRC hash
     const uint8_t returnCode = SERIAL_RC_OK;
@@ -1148,22 +1405,21 @@ void sendCompositeLog(void)
   for (; logItemsTransmitted < TOOTH_LOG_SIZE; logItemsTransmitted++)
   {
     //Check whether the tx buffer still has space
-    if((uint16_t)primarySerial.availableForWrite() < sizeof(toothHistory[logItemsTransmitted])+sizeof(compositeLogHistory[logItemsTransmitted])) 
+    if((uint16_t)primarySerial.availableForWrite() < sizeof(toothHistory[logBuffer][logItemsTransmitted])+sizeof(compositeLogHistory[logBuffer][logItemsTransmitted])) 
     { 
       //tx buffer is full. Store the current state so it can be resumed later
       serialStatusFlag = SERIAL_TRANSMIT_COMPOSITE_INPROGRESS;
       return;
     }
 
-    uint32_t transmitted = serialWrite(toothHistory[logItemsTransmitted]); //This combined runtime (in us) that the log was going for by this record
+    uint32_t transmitted = serialWrite(toothHistory[logBuffer][logItemsTransmitted]); //This combined runtime (in us) that the log was going for by this record
     (void)CRC32_serial.crc32_upd((const byte*)&transmitted, sizeof(transmitted), false);
 
     //The status byte (Indicates the trigger edge, whether it was a pri/sec pulse, the sync status)
-    writeByteReliableBlocking(compositeLogHistory[logItemsTransmitted]);
-    CRC32_val = CRC32_serial.crc32_upd((const byte*)&compositeLogHistory[logItemsTransmitted], sizeof(compositeLogHistory[logItemsTransmitted]), false);
+    writeByteReliableBlocking(compositeLogHistory[logBuffer][logItemsTransmitted]);
+    CRC32_val = CRC32_serial.crc32_upd((const byte*)&compositeLogHistory[logBuffer][logItemsTransmitted], sizeof(compositeLogHistory[logBuffer][logItemsTransmitted]), false);
   }
   BIT_CLEAR(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY);
-  toothHistoryIndex = 0;
   serialStatusFlag = SERIAL_INACTIVE;
   logItemsTransmitted = 0;
 
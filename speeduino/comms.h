@@ -31,7 +31,12 @@ extern Stream *pPrimarySerial;
 void serialReceive(void);
 
 /** @brief The serial transmit pump. Should be called when ::serialStatusFlag indicates a transmit
- * operation is in progress */
+ * operation is in progress, or when ::isLiveDataStreamActive() */
 void serialTransmit(void);
 
+/** @brief Has the client subscribed to a stream of live data? (See the 'l' command)
+ * 
+ * While this is true, ::serialTransmit pushes live data frames whenever one is due and the link is idle */
+bool isLiveDataStreamActive(void);
+
 #endif // COMMS_H
@@ -13,6 +13,8 @@ This is for handling the data broadcasted to various CAN dashes and instrument c
 #include "comms_CAN.h"
 #include "utilities.h"
 #include "maths.h"
+#include "can_broadcast.h"
+#include "logger.h"
 
 CAN_message_t inMsg;
 CAN_message_t outMsg;
@@ -58,73 +60,123 @@ void CAN_write()
   Can0.write(outMsg);
 }
 
-void sendCANBroadcast(uint8_t frequency)
+#define CAN_TX_MAX_PER_CALL 4U //Limit on frames sent per sendCANBroadcast() call, so that a backlog cannot hold up the main loop
+
+struct canTxBuiltinFrame
+{
+  uint16_t id;      ///< Passed to DashMessage()
+  uint16_t period;  ///< mS
+};
+
+static const canTxBuiltinFrame canTxBMWFrames[] = { {CAN_BMW_DME1, 33U}, {CAN_BMW_DME2, 33U}, {CAN_BMW_DME4, 100U} };
+static const canTxBuiltinFrame canTxVAGFrames[] = { {CAN_VAG_RPM, 33U}, {CAN_VAG_VSS, 33U} };
+static const canTxBuiltinFrame canTxHaltechFrames[] = { 
+  {CAN_HALTECH_DATA1, 20U}, {CAN_HALTECH_DATA2, 20U}, {CAN_HALTECH_DATA3, 20U}, {CAN_HALTECH_PW, 20U},
+  {CAN_HALTECH_LAMBDA, 50U}, {CAN_HALTECH_TRIGGER, 50U}, {CAN_HALTECH_VSS, 50U},
+  {CAN_HALTECH_DATA4, 100U}, {CAN_HALTECH_DATA5, 100U},
+};
+
+//The config that the broadcast queue was last built from
+static uint8_t canTxQueueProtocol = UINT8_MAX;
+static uint16_t canTxQueueUserPeriods[CAN_TX_USER_FRAMES];
+
+static const canTxBuiltinFrame* getBuiltinCANFrames(uint8_t protocol, uint8_t &count)
 {
-  switch(configPage4.CANBroadcastProtocol)
+  switch(protocol)
   {
-    case CAN_BROADCAST_PROTOCOL_OFF:
-      break;
     case CAN_BROADCAST_PROTOCOL_BMW:
-      if(frequency == 30)
-      {
-        outMsg.flags.extended = 0; //Make sure to set this to standard
-        DashMessage(CAN_BMW_DME1);
-        Can0.write(outMsg);
-        DashMessage(CAN_BMW_DME2);
-        Can0.write(outMsg);
-      }
-      else if(frequency == 10)
-      {
-        outMsg.flags.extended = 0; //Make sure to set this to standard
-        DashMessage(CAN_BMW_DME4);
-        Can0.write(outMsg);
-      }
-      break;
+      count = _countof(canTxBMWFrames);
+      return canTxBMWFrames;
     case CAN_BROADCAST_PROTOCOL_VAG:
-      //All VAG broadcasts are at 30Hz
-      if(frequency == 30)
-      {
-        outMsg.flags.extended = 0; //Make sure to set this to standard
-        DashMessage(CAN_VAG_RPM);
-        Can0.write(outMsg);
-        DashMessage(CAN_VAG_VSS);
-        Can0.write(outMsg);
-      }
-      break;
+      count = _countof(canTxVAGFrames);
+      return canTxVAGFrames;
     case CAN_BROADCAST_PROTOCOL_HALTECH:
-      //Haltech has broadcasts over multiple frequencies
-      if(frequency == 50)
-      {
-        DashMessage(CAN_HALTECH_DATA1);
-        Can0.write(outMsg);
-        DashMessage(CAN_HALTECH_DATA2);
-        Can0.write(outMsg);
-        DashMessage(CAN_HALTECH_DATA3);
-        Can0.write(outMsg);
-        DashMessage(CAN_HALTECH_PW);
-        Can0.write(outMsg);
-      }
-      else if(frequency == 15)
-      {
-        //Note: Haltech lists these as being 20Hz messages, but as we don't have a 20Hz flag we'll use 15Hz instead
-        DashMessage(CAN_HALTECH_LAMBDA);
-        Can0.write(outMsg);
-        DashMessage(CAN_HALTECH_TRIGGER);
-        Can0.write(outMsg);
-        DashMessage(CAN_HALTECH_VSS);
-        Can0.write(outMsg);
-      }
-      else if(frequency == 10)
-      {
-        DashMessage(CAN_HALTECH_DATA4);
-        Can0.write(outMsg);
-        DashMessage(CAN_HALTECH_DATA5);
-        Can0.write(outMsg);
-      }
-      break;
-    
+      count = _countof(canTxHaltechFrames);
+      return canTxHaltechFrames;
     default:
-      break;
+      count = 0U;
+      return nullptr;
+  }
+}
+
+/** Rebuild the broadcast queue if the protocol or any of the user frame periods have changed */
+static void updateCANBroadcastQueue(uint32_t now)
+{
+  bool isChanged = (canTxQueueProtocol != configPage4.CANBroadcastProtocol);
+  for(uint8_t frame = 0U; frame < CAN_TX_USER_FRAMES; frame++)
+  {
+    if(canTxQueueUserPeriods[frame] != configPage15.canTxPeriod[frame]) { isChanged = true; }
+  }
+  if(isChanged == false) { return; }
+
+  canTxReset();
+  canTxQueueProtocol = configPage4.CANBroadcastProtocol;
+  uint8_t builtinCount;
+  const canTxBuiltinFrame *pBuiltin = getBuiltinCANFrames(canTxQueueProtocol, builtinCount);
+  for(uint8_t frame = 0U; frame < builtinCount; frame++) { canTxAddFrame(frame, pBuiltin[frame].period, now); }
+
+  for(uint8_t frame = 0U; frame < CAN_TX_USER_FRAMES; frame++)
+  {
+    canTxQueueUserPeriods[frame] = configPage15.canTxPeriod[frame];
+    canTxAddFrame(CAN_TX_USER_FRAME_BASE + frame, canTxQueueUserPeriods[frame], now); //A period of 0 is not added
+  }
+}
+
+/** Build a user defined frame (See can_broadcast.h) into outMsg */
+static void buildUserCANFrame(uint8_t frame)
+{
+  outMsg.id = configPage15.canTxId[frame] & 0x7FFU;
+  outMsg.flags.extended = 0;
+  outMsg.len = 0;
+  memset(outMsg.buf, 0, sizeof(outMsg.buf));
+  bool isBigEndian = BIT_CHECK(configPage15.canTxBigEndian, frame);
+
+  for(uint8_t signal = frame * CAN_TX_USER_SIGNALS; signal < ((frame + 1U) * CAN_TX_USER_SIGNALS); signal++)
+  {
+    uint8_t type = configPage15.canTxSigType[signal];
+    uint8_t source = configPage15.canTxSigSource[signal];
+    int32_t value;
+    //The live data is little endian. It is read passively, so the frames do not disturb what TunerStudio is shown
+    switch(type)
+    {
+      case CAN_TX_SIGNAL_U08: value = getPassiveTSLogEntry(source); break;
+      case CAN_TX_SIGNAL_S08: value = (int8_t)getPassiveTSLogEntry(source); break;
+      case CAN_TX_SIGNAL_U16: value = word(getPassiveTSLogEntry(source + 1U), getPassiveTSLogEntry(source)); break;
+      case CAN_TX_SIGNAL_S16: value = (int16_t)word(getPassiveTSLogEntry(source + 1U), getPassiveTSLogEntry(source)); break;
+      default: continue; //Signal not used
+    }
+    value = scaleCANSignal(value, configPage15.canTxSigMultiply[signal], configPage15.canTxSigDivide[signal], configPage15.canTxSigOffset[signal]);
+
+    uint8_t startByte = configPage15.canTxSigByte[signal];
+    if(packCANSignal(outMsg.buf, type, startByte, isBigEndian, value))
+    {
+      uint8_t endByte = startByte + canTxSignalWidth(type);
+      if(endByte > outMsg.len) { outMsg.len = endByte; }
+    }
+  }
+}
+
+/** Send every broadcast frame that is due. Called from every main loop, each frame has its own period (See can_broadcast.h) */
+void sendCANBroadcast(void)
+{
+  uint32_t now = millis();
+  updateCANBroadcastQueue(now);
+
+  uint8_t builtinCount;
+  const canTxBuiltinFrame *pBuiltin = getBuiltinCANFrames(canTxQueueProtocol, builtinCount);
+  for(uint8_t sent = 0U; sent < CAN_TX_MAX_PER_CALL; sent++)
+  {
+    uint8_t frame = canTxNextDueFrame(now);
+    if(frame == CAN_TX_FRAME_NONE) { break; }
+
+    if(frame >= CAN_TX_USER_FRAME_BASE) { buildUserCANFrame(frame - CAN_TX_USER_FRAME_BASE); }
+    else if(frame < builtinCount)
+    {
+      outMsg.flags.extended = 0; //Make sure to set this to standard
+      DashMessage(pBuiltin[frame].id);
+    }
+    else { continue; }
+    Can0.write(outMsg);
   }
 }
 
@@ -40,7 +40,7 @@
 void initCAN();
 int CAN_read();
 void CAN_write();
-void sendCANBroadcast(uint8_t);
+void sendCANBroadcast(void);
 void receiveCANwbo();
 void DashMessages(uint16_t DashMessageID);
 void can_Command(void);
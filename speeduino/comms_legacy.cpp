@@ -464,6 +464,8 @@ void legacySerialCommand(void)
 
       if (primarySerial.available() >= 1) {
         configPage4.bootloaderCaps = primarySerial.read();
+        invalidatePageCRC32(ignSetPage);
+        markConfigDirty(ignSetPage, &configPage4.bootloaderCaps, sizeof(configPage4.bootloaderCaps));
         serialStatusFlag = SERIAL_INACTIVE;
       }
       break;
@@ -522,7 +524,7 @@ void legacySerialHandler(byte cmd, Stream &targetPort, SerialStatus &targetStatu
       if (targetPort.available() >= 2)
       {
         targetPort.read(); //Ignore the first table value, it's always 0
-        writeConfig(targetPort.read());
+        writeDirtyConfig(targetPort.read());
         targetStatusFlag = SERIAL_INACTIVE;
       }
       break;
@@ -533,7 +535,7 @@ void legacySerialHandler(byte cmd, Stream &targetPort, SerialStatus &targetStatu
       if (targetPort.available() >= 2)
       {
         targetPort.read(); //Ignore the first table value, it's always 0
-        writeConfig(targetPort.read());
+        writeDirtyConfig(targetPort.read());
         targetStatusFlag = SERIAL_INACTIVE;
       }
       break;
@@ -1259,16 +1261,16 @@ void sendToothLog_legacy(byte startOffset) /* Blocking */
   if (BIT_CHECK(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY)) //Sanity check. Flagging system means this should always be true
   {
       serialStatusFlag = SERIAL_TRANSMIT_TOOTH_INPROGRESS_LEGACY; 
+      const uint8_t logBuffer = getToothLogReadyBuffer();
       for (uint8_t x = startOffset; x < TOOTH_LOG_SIZE; ++x)
       {
-        primarySerial.write(toothHistory[x] >> 24);
-        primarySerial.write(toothHistory[x] >> 16);
-        primarySerial.write(toothHistory[x] >> 8);
-        primarySerial.write(toothHistory[x]);
+        primarySerial.write(toothHistory[logBuffer][x] >> 24);
+        primarySerial.write(toothHistory[logBuffer][x] >> 16);
+        primarySerial.write(toothHistory[logBuffer][x] >> 8);
+        primarySerial.write(toothHistory[logBuffer][x]);
       }
       BIT_CLEAR(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY);
       serialStatusFlag = SERIAL_INACTIVE; 
-      toothHistoryIndex = 0;
   }
   else 
   { 
@@ -1286,6 +1288,7 @@ void sendCompositeLog_legacy(byte startOffset) /* Non-blocking */
   if (BIT_CHECK(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY)) //Sanity check. Flagging system means this should always be true
   {
       serialStatusFlag = SERIAL_TRANSMIT_COMPOSITE_INPROGRESS_LEGACY;
+      const uint8_t logBuffer = getToothLogReadyBuffer();
 
       for (uint8_t x = startOffset; x < TOOTH_LOG_SIZE; ++x)
       {
@@ -1297,17 +1300,16 @@ void sendCompositeLog_legacy(byte startOffset) /* Non-blocking */
           return;
         }
 
-        uint32_t inProgressCompositeTime = toothHistory[x]; //This combined runtime (in us) that the log was going for by this record)
+        uint32_t inProgressCompositeTime = toothHistory[logBuffer][x]; //This combined runtime (in us) that the log was going for by this record)
         
         primarySerial.write(inProgressCompositeTime >> 24);
         primarySerial.write(inProgressCompositeTime >> 16);
         primarySerial.write(inProgressCompositeTime >> 8);
         primarySerial.write(inProgressCompositeTime);
 
-        primarySerial.write(compositeLogHistory[x]); //The status byte (Indicates the trigger edge, whether it was a pri/sec pulse, the sync status)
+        primarySerial.write(compositeLogHistory[logBuffer][x]); //The status byte (Indicates the trigger edge, whether it was a pri/sec pulse, the sync status)
       }
       BIT_CLEAR(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY);
-      toothHistoryIndex = 0;
       serialStatusFlag = SERIAL_INACTIVE; 
   }
   else 
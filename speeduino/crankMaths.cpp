@@ -1,14 +1,18 @@
 #include "globals.h"
 #include "crankMaths.h"
+#include "decoders.h"
+#include "crank_prediction.h"
 #include "bit_shifts.h"
 
-#define SECOND_DERIV_ENABLED                0          
-
-//These are only part of the experimental 2nd deriv calcs
-#if SECOND_DERIV_ENABLED!=0
-byte deltaToothCount = 0; //The last tooth that was used with the deltaV calc
-int rpmDelta;
-#endif
+/** @brief The acceleration aware prediction. Only used by decoders that set BIT_DECODER_2ND_DERIV
+ * 
+ * The prediction is read from the trigger and schedule ISRs (Through the angle/time conversions below), but updated from
+ * the main loop. The update is made to a separate copy, which is then published in one go with interrupts disabled so that
+ * the ISRs never see a half updated prediction.
+ */
+static crankSpeedPrediction crankPrediction;
+static crankSpeedPrediction crankPredictionUpdate;
+static uint8_t predictionSyncLossCounter;
 
 typedef uint32_t UQ24X8_t;
 static constexpr uint8_t UQ24X8_Shift = 8U;
@@ -33,54 +37,49 @@ void setAngleConverterRevolutionTime(uint32_t revolutionTime) {
 }
 
 uint32_t angleToTimeMicroSecPerDegree(uint16_t angle) {
+  if(isCrankSpeedPredictionValid(crankPrediction)) { return predictAngleToTime(crankPrediction, angle); }
+
   UQ24X8_t micros = (uint32_t)angle * (uint32_t)microsPerDegree;
   return rshift_round<microsPerDegree_Shift>(micros);
 }
 
 uint16_t timeToAngleDegPerMicroSec(uint32_t time) {
+    if(isCrankSpeedPredictionValid(crankPrediction)) { return predictTimeToAngle(crankPrediction, time); }
+
     uint32_t degFixed = time * (uint32_t)degreesPerMicro;
     return rshift_round<degreesPerMicro_Shift>(degFixed);
 }
 
-#if SECOND_DERIV_ENABLED!=0
-void doCrankSpeedCalcs(void)
+static inline void publishCrankPrediction(void)
 {
-     //********************************************************
-      //How fast are we going? Need to know how long (uS) it will take to get from one tooth to the next. We then use that to estimate how far we are between the last tooth and the next one
-      //We use a 1st Deriv acceleration prediction, but only when there is an even spacing between primary sensor teeth
-      //Any decoder that has uneven spacing has its triggerToothAngle set to 0
-      //THIS IS CURRENTLY DISABLED FOR ALL DECODERS! It needs more work. 
-      if( (BIT_CHECK(decoderState, BIT_DECODER_2ND_DERIV)) && (toothHistoryIndex >= 3) && (currentStatus.RPM < 2000) ) //toothHistoryIndex must be greater than or equal to 3 as we need the last 3 entries. Currently this mode only runs below 3000 rpm
-      {
-        //Only recalculate deltaV if the tooth has changed since last time (DeltaV stays the same until the next tooth)
-        //if (deltaToothCount != toothCurrentCount)
-        {
-          deltaToothCount = toothCurrentCount;
-          int angle1, angle2; //These represent the crank angles that are travelled for the last 2 pulses
-          if(configPage4.TrigPattern == 4)
-          {
-            //Special case for 70/110 pattern on 4g63
-            angle2 = triggerToothAngle; //Angle 2 is the most recent
-            if (angle2 == 70) { angle1 = 110; }
-            else { angle1 = 70; }
-          }
-          else if(configPage4.TrigPattern == 0)
-          {
-            //Special case for missing tooth decoder where the missing tooth was one of the last 2 seen
-            if(toothCurrentCount == 1) { angle2 = 2*triggerToothAngle; angle1 = triggerToothAngle; }
-            else if(toothCurrentCount == 2) { angle1 = 2*triggerToothAngle; angle2 = triggerToothAngle; }
-            else { angle1 = triggerToothAngle; angle2 = triggerToothAngle; }
-          }
-          else { angle1 = triggerToothAngle; angle2 = triggerToothAngle; }
-
-          uint32_t toothDeltaV = (MICROS_PER_SEC * angle2 / toothHistory[toothHistoryIndex]) - (MICROS_PER_SEC * angle1 / toothHistory[toothHistoryIndex-1]);
-          uint32_t toothDeltaT = toothHistory[toothHistoryIndex];
-          //long timeToLastTooth = micros() - toothLastToothTime;
+  noInterrupts();
+  crankPrediction = crankPredictionUpdate;
+  interrupts();
+}
 
-          rpmDelta = lshift<10>(toothDeltaV) / (6 * toothDeltaT);
-        }
+void doCrankSpeedCalcs(void)
+{
+  //Decoders that have an accurate angle for every tooth maintain toothAngleTotal and set BIT_DECODER_2ND_DERIV
+  //The prediction is started again whenever sync is lost, as the teeth seen without sync are not counted
+  if( BIT_CHECK(decoderState, BIT_DECODER_2ND_DERIV) && HasAnySync(currentStatus) && (predictionSyncLossCounter == currentStatus.syncLossCounter) )
+  {
+    noInterrupts();
+    uint32_t toothTime = toothLastToothTime;
+    uint16_t angleTotal = toothAngleTotal;
+    interrupts();
 
-          timePerDegreex16 = ldiv( 2666656L, currentStatus.RPM + rpmDelta).quot; //This gives accuracy down to 0.1 of a degree and can provide noticeably better timing results on low resolution triggers
-      }
+    uint32_t previousToothTime = crankPredictionUpdate.lastToothTime;
+    uint8_t previousWindowCount = crankPredictionUpdate.windowCount;
+    (void)addCrankSpeedSample(crankPredictionUpdate, toothTime, angleTotal);
+    if( (crankPredictionUpdate.lastToothTime != previousToothTime) || (crankPredictionUpdate.windowCount != previousWindowCount) ) { publishCrankPrediction(); }
+  }
+  else
+  {
+    if(crankPredictionUpdate.windowCount != 0U)
+    {
+      resetCrankSpeedPrediction(crankPredictionUpdate);
+      publishCrankPrediction();
+    }
+    predictionSyncLossCounter = currentStatus.syncLossCounter;
+  }
 }
-#endif
\ No newline at end of file
@@ -56,6 +56,9 @@ void setAngleConverterRevolutionTime(uint32_t revolutionTime);
 /**
  * @name Converts angular degrees to the time interval that amount of rotation
  * will take at current RPM.
+ *
+ * When the decoder supports it (See doCrankSpeedCalcs()), the current rate of acceleration is also
+ * taken into account.
  * 
  * Based on angle of [0,720] and min/max RPM, result ranges from
  * 9 (MAX_RPM, 1 deg) to 2926828 (MIN_RPM, 720 deg)
@@ -76,4 +79,13 @@ uint32_t angleToTimeMicroSecPerDegree(uint16_t angle);
  */
 uint16_t timeToAngleDegPerMicroSec(uint32_t time);
 
+/**
+ * @brief Update the acceleration aware crank speed prediction from the latest tooth (See crank_prediction.h)
+ * 
+ * Only decoders that set BIT_DECODER_2ND_DERIV (And maintain toothAngleTotal) use the prediction, for all others
+ * the angle<->time conversions stay based on the last revolution time. Must be called each loop, before any of
+ * the conversions are used.
+ */
+void doCrankSpeedCalcs(void);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,148 @@
+/** @file
+ * Acceleration aware crank speed prediction. See crank_prediction.h
+ */
+#include "crank_prediction.h"
+
+#define MAX_PERIOD_RATE           (INT32_C(1) << 17)  //Q32. About 3e-5 per uS, eg 30000 RPM/s at 1000 RPM
+#define MAX_CORRECTION_FRACTION   INT32_C(32767)      //Q16. Just under 0.5
+#define MAX_SAMPLE_GAP            (UINT32_C(1) << 22) //uS. Teeth further apart than this (4 seconds) are too old to be related
+
+/** (numerator << shift) / denominator, keeping as much precision as 32 bits allow */
+static int32_t shiftedDivide(int32_t numerator, uint32_t denominator, uint8_t shift)
+{
+  bool isNegative = (numerator < 0);
+  uint32_t magnitude = isNegative ? (uint32_t)(-numerator) : (uint32_t)numerator;
+
+  //Shift the numerator up as far as it will go, then the denominator down for whatever is left
+  while( (shift > 0U) && (magnitude < (UINT32_C(1) << 30)) ) { magnitude <<= 1U; shift--; }
+  denominator >>= shift;
+  if(denominator == 0U) { return isNegative ? -INT32_MAX : INT32_MAX; }
+
+  uint32_t quotient = magnitude / denominator;
+  if(quotient > (uint32_t)INT32_MAX) { quotient = INT32_MAX; }
+  return isNegative ? -(int32_t)quotient : (int32_t)quotient;
+}
+
+/** The correction r * time / 2 as a Q16 fraction, limited to +/-MAX_CORRECTION_FRACTION */
+static int32_t correctionFraction(int32_t periodRate, uint32_t time)
+{
+  //|periodRate| <= 2^17 and (time >> 9) < 2^14 keeps the product within 31 bits
+  if(time >= (UINT32_C(1) << 23)) { time = (UINT32_C(1) << 23) - 1U; }
+  int32_t fraction = (periodRate * (int32_t)(time >> 9U)) / (INT32_C(1) << 8);
+
+  if(fraction > MAX_CORRECTION_FRACTION) { fraction = MAX_CORRECTION_FRACTION; }
+  else if(fraction < -MAX_CORRECTION_FRACTION) { fraction = -MAX_CORRECTION_FRACTION; }
+  return fraction;
+}
+
+/** value * (1 + fraction), where fraction is Q16 and |fraction| < 0.5. The multiply is split to stay within 32 bits */
+static uint32_t applyFraction(uint32_t value, int32_t fraction)
+{
+  int32_t high = (int32_t)(value >> 16U) * fraction;
+  int32_t low = ((int32_t)(value & 0xFFFFU) * fraction) / (INT32_C(1) << 16);
+  return value + (uint32_t)(high + low);
+}
+
+void resetCrankSpeedPrediction(crankSpeedPrediction &prediction)
+{
+  prediction.lastToothTime = 0U;
+  prediction.windowStartTime = 0U;
+  prediction.windowStartAngle = 0U;
+  prediction.lastMidTime = 0U;
+  prediction.lastMicrosPerDegree = 0U;
+  prediction.microsPerDegree = 0U;
+  prediction.degreesPerMicro = 0U;
+  prediction.periodRate = 0;
+  prediction.windowCount = 0U;
+}
+
+static inline void startWindow(crankSpeedPrediction &prediction, uint32_t toothTime, uint16_t angleTotal)
+{
+  prediction.windowStartTime = toothTime;
+  prediction.windowStartAngle = angleTotal;
+}
+
+/** Update the prediction with the most recent tooth.
+ * Calling this again with the same tooth has no effect, so it can be called from every loop.
+ * @param toothTime Time (uS) of the tooth
+ * @param angleTotal Running total (Wrapping) of the crank angle of every tooth seen, up to and including this one
+ * @return Whether the prediction is valid
+ */
+bool addCrankSpeedSample(crankSpeedPrediction &prediction, uint32_t toothTime, uint16_t angleTotal)
+{
+  if( (prediction.windowCount > 0U) && (toothTime == prediction.lastToothTime) ) { return isCrankSpeedPredictionValid(prediction); }
+  prediction.lastToothTime = toothTime;
+  if(prediction.windowCount == 0U)
+  {
+    startWindow(prediction, toothTime, angleTotal);
+    prediction.windowCount = 1U;
+    return false;
+  }
+
+  uint32_t windowTime = toothTime - prediction.windowStartTime;
+  uint16_t windowAngle = angleTotal - prediction.windowStartAngle;
+  if( (windowAngle == 0U) || (windowAngle > 720U) || (windowTime == 0U) || (windowTime > MAX_SAMPLE_GAP) )
+  {
+    //The samples are not from the same run of teeth (Eg sync was lost). Start again from this one
+    resetCrankSpeedPrediction(prediction);
+    prediction.lastToothTime = toothTime;
+    startWindow(prediction, toothTime, angleTotal);
+    prediction.windowCount = 1U;
+    return false;
+  }
+
+  if(windowAngle >= CRANK_PREDICTION_WINDOW)
+  {
+    uint32_t microsPerDegree = (windowTime << 8U) / windowAngle;
+    uint32_t midTime = prediction.windowStartTime + (windowTime >> 1U);
+    int32_t change = (int32_t)(microsPerDegree - prediction.lastMicrosPerDegree);
+    int32_t changeLimit = (int32_t)(microsPerDegree >> 2U);
+
+    //A change of more than 25% between windows is not something the linear model can follow. Restart the rate from this window
+    if( (prediction.windowCount < 2U) || (change > changeLimit) || (change < -changeLimit) )
+    {
+      prediction.windowCount = 2U;
+      prediction.periodRate = 0;
+    }
+    else
+    {
+      //Relative change (Q16) over the time between the 2 windows gives the rate (Q32 per uS)
+      int32_t relativeChange = shiftedDivide(change, microsPerDegree, 16U);
+      int32_t periodRate = shiftedDivide(relativeChange, midTime - prediction.lastMidTime, 16U);
+      if(periodRate > MAX_PERIOD_RATE) { periodRate = MAX_PERIOD_RATE; }
+      else if(periodRate < -MAX_PERIOD_RATE) { periodRate = -MAX_PERIOD_RATE; }
+      prediction.periodRate = periodRate;
+      if(prediction.windowCount < UINT8_MAX) { prediction.windowCount++; }
+    }
+
+    prediction.lastMidTime = midTime;
+    prediction.lastMicrosPerDegree = microsPerDegree;
+    startWindow(prediction, toothTime, angleTotal);
+  }
+
+  if(prediction.windowCount >= 2U)
+  {
+    //Extrapolate from the middle of the last window to this tooth. correctionFraction() halves the time, so it is doubled here
+    uint32_t timeFromMid = toothTime - prediction.lastMidTime;
+    if(timeFromMid > MAX_SAMPLE_GAP) { timeFromMid = MAX_SAMPLE_GAP; }
+    prediction.microsPerDegree = applyFraction(prediction.lastMicrosPerDegree, correctionFraction(prediction.periodRate, timeFromMid << 1U));
+    if(prediction.microsPerDegree < 256U) { prediction.microsPerDegree = 256U; } //Limit of UQ1.15 degreesPerMicro (1 degree per uS)
+    prediction.degreesPerMicro = (uint16_t)(((UINT32_C(1) << 23) + (prediction.microsPerDegree >> 1U)) / prediction.microsPerDegree);
+  }
+
+  return isCrankSpeedPredictionValid(prediction);
+}
+
+/** Predicted time (uS) for the crank to rotate through angle degrees from the last tooth */
+uint32_t predictAngleToTime(const crankSpeedPrediction &prediction, uint16_t angle)
+{
+  uint32_t constantSpeedTime = ((uint32_t)angle * prediction.microsPerDegree + 128U) >> 8U;
+  return applyFraction(constantSpeedTime, correctionFraction(prediction.periodRate, constantSpeedTime));
+}
+
+/** Predicted angle that the crank rotates through in time uS from the last tooth */
+uint16_t predictTimeToAngle(const crankSpeedPrediction &prediction, uint32_t time)
+{
+  uint32_t constantSpeedAngle = (time * prediction.degreesPerMicro + (UINT32_C(1) << 14)) >> 15U;
+  return (uint16_t)applyFraction(constantSpeedAngle, -correctionFraction(prediction.periodRate, time));
+}
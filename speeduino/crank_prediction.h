@@ -0,0 +1,51 @@
+/** @file
+ * Acceleration aware crank speed prediction.
+ *
+ * The standard angle<->time conversions (See crankMaths.h) assume that the engine turns at a constant speed, taken
+ * from the time of the last full revolution. When the engine is accelerating or decelerating, that speed is both out
+ * of date (It is the average over the last revolution) and wrong for the future (The speed keeps changing while the
+ * schedule is pending), so the further ahead an event is scheduled, the larger the angle error.
+ *
+ * This predictor is fed the time of the most recent tooth along with a running total of the crank angle of all the
+ * teeth seen (So it does not need to see every tooth). The teeth are grouped into windows of at least
+ * CRANK_PREDICTION_WINDOW degrees. Each window gives the average time per degree at its middle, and the change
+ * between 2 windows gives the rate that the time per degree is changing. Measuring over a window rather than a single
+ * tooth keeps the timing resolution and tooth spacing errors from swamping the rate. Both are then extrapolated:
+ * - The time per degree at the last tooth, p
+ * - The relative rate of change of p per uS, r (Negative when accelerating)
+ * With p changing linearly over time, the time to rotate through an angle A is T0 * (1 + r*T0/2), where T0 = p * A
+ * is the constant speed prediction, and the angle rotated in time t is t/p * (1 - r*t/2).
+ *
+ * Everything is integer maths. The (r * T0 / 2) correction is limited to +/-50%, beyond which the linear model is no
+ * longer meaningful.
+ */
+#ifndef CRANK_PREDICTION_H
+#define CRANK_PREDICTION_H
+
+#include <stdint.h>
+
+#define CRANK_PREDICTION_WINDOW   90U //Minimum crank angle that each speed measurement is made over
+
+struct crankSpeedPrediction {
+  uint32_t lastToothTime;       ///< Time of the most recent tooth
+  uint32_t windowStartTime;     ///< Time of the tooth that the current window started on
+  uint16_t windowStartAngle;    ///< Angle total at the start of the current window
+  uint32_t lastMidTime;         ///< Time of the middle of the last complete window
+  uint32_t lastMicrosPerDegree; ///< Average uS per degree over the last complete window (UQ24.8)
+  uint32_t microsPerDegree;     ///< Predicted uS per degree at lastToothTime (UQ24.8)
+  uint16_t degreesPerMicro;     ///< Predicted degrees per uS at lastToothTime (UQ1.15)
+  int32_t periodRate;           ///< Relative rate of change of microsPerDegree per uS (Q32). Negative when accelerating
+  uint8_t windowCount;          ///< Number of windows the prediction is based on, plus 1 once a window has been started
+};
+
+void resetCrankSpeedPrediction(crankSpeedPrediction &prediction);
+bool addCrankSpeedSample(crankSpeedPrediction &prediction, uint32_t toothTime, uint16_t angleTotal);
+uint32_t predictAngleToTime(const crankSpeedPrediction &prediction, uint16_t angle);
+uint16_t predictTimeToAngle(const crankSpeedPrediction &prediction, uint32_t time);
+
+static inline bool isCrankSpeedPredictionValid(const crankSpeedPrediction &prediction)
+{
+  return prediction.windowCount >= 3U; //The rate needs 2 complete windows
+}
+
+#endif // CRANK_PREDICTION_H
@@ -0,0 +1,135 @@
+/** @file
+ * Crank angle synchronous logging. See cycle_logger.h
+ */
+#include "cycle_logger.h"
+#include "decoders.h"
+
+#define CYCLE_LOG_INDEX_MASK (CYCLE_LOG_BUFFER_SIZE - 1U)
+static_assert((CYCLE_LOG_BUFFER_SIZE & CYCLE_LOG_INDEX_MASK) == 0U, "CYCLE_LOG_BUFFER_SIZE must be a power of 2");
+
+static volatile cycleLogEntry cycleLogBuffer[CYCLE_LOG_BUFFER_SIZE];
+static volatile uint8_t cycleLogHead = 0U; //Next entry to write. Only changed by the trigger interrupt
+static volatile uint8_t cycleLogTail = 0U; //Next entry to read. Only changed by the main loop
+static volatile uint16_t cycleLogOverruns = 0U;
+static volatile bool cycleLogActive = false;
+
+static uint8_t cycleLogMode = CYCLE_LOG_OFF;
+static uint8_t cycleLogTeeth = 1U;
+static uint8_t cycleLogToothCount = 0U;
+static uint32_t cycleLogLastRevolution = 0U;
+static bool cycleLogFirstCapture = true;
+
+/** Clear the buffer and set how often snapshots are taken. Must be called while the logger is inactive
+ * @param mode CYCLE_LOG_PER_CYCLE or CYCLE_LOG_PER_TEETH
+ * @param teeth Number of teeth between snapshots for CYCLE_LOG_PER_TEETH
+ */
+void resetCycleLog(uint8_t mode, uint8_t teeth)
+{
+  cycleLogActive = false;
+  cycleLogMode = mode;
+  cycleLogTeeth = (teeth == 0U) ? 1U : teeth;
+  cycleLogToothCount = 0U;
+  cycleLogFirstCapture = true;
+  cycleLogHead = 0U;
+  cycleLogTail = 0U;
+  cycleLogOverruns = 0U;
+}
+
+void setCycleLogActive(bool active)
+{
+  cycleLogActive = active && (cycleLogMode != CYCLE_LOG_OFF);
+}
+
+bool isCycleLogActive(void)
+{
+  return cycleLogActive;
+}
+
+static inline void writeCycleLogEntry(void)
+{
+  uint8_t nextHead = (cycleLogHead + 1U) & CYCLE_LOG_INDEX_MASK;
+  if(nextHead == cycleLogTail)
+  {
+    //Buffer is full. The oldest snapshots are kept, as the reader is part way through them
+    if(cycleLogOverruns < UINT16_MAX) { cycleLogOverruns++; }
+    return;
+  }
+
+  volatile cycleLogEntry &entry = cycleLogBuffer[cycleLogHead];
+  entry.toothTime = toothLastToothTime;
+  entry.revolution = (uint16_t)currentStatus.startRevolutions;
+  entry.RPM = currentStatus.RPM;
+  entry.MAP = (uint16_t)currentStatus.MAP;
+  entry.PW1 = currentStatus.PW1;
+  entry.advance = currentStatus.advance;
+  entry.knockCount = currentStatus.knockCount;
+  entry.knockRetard = currentStatus.knockRetard;
+  entry.status2 = currentStatus.status2;
+
+  //Only publish the entry once it is complete
+  cycleLogHead = nextHead;
+}
+
+/** Called from the primary trigger interrupt after each valid tooth. Takes a snapshot when one is due */
+void captureCycleLogTooth(void)
+{
+  if(cycleLogActive == false) { return; }
+
+  if(cycleLogMode == CYCLE_LOG_PER_CYCLE)
+  {
+    //startRevolutions is incremented by the decoders once per crank revolution
+    uint32_t revolutionsPerCycle = (configPage2.strokes == FOUR_STROKE) ? 2U : 1U;
+    uint32_t revolution = currentStatus.startRevolutions;
+    if(cycleLogFirstCapture == true)
+    {
+      cycleLogFirstCapture = false;
+      cycleLogLastRevolution = revolution;
+    }
+    else if((revolution - cycleLogLastRevolution) >= revolutionsPerCycle)
+    {
+      //This only becomes true on the tooth that incremented startRevolutions, so every snapshot is taken at the same crank angle
+      cycleLogLastRevolution = revolution;
+      writeCycleLogEntry();
+    }
+    else { /* Not due yet */ }
+  }
+  else
+  {
+    cycleLogToothCount++;
+    if(cycleLogToothCount >= cycleLogTeeth)
+    {
+      cycleLogToothCount = 0U;
+      writeCycleLogEntry();
+    }
+  }
+}
+
+/** Read the oldest snapshot from the buffer
+ * @return Whether there was a snapshot to read
+ */
+bool readCycleLogEntry(cycleLogEntry &entry)
+{
+  uint8_t tail = cycleLogTail;
+  if(tail == cycleLogHead) { return false; }
+
+  const volatile cycleLogEntry &source = cycleLogBuffer[tail];
+  entry.toothTime = source.toothTime;
+  entry.revolution = source.revolution;
+  entry.RPM = source.RPM;
+  entry.MAP = source.MAP;
+  entry.PW1 = source.PW1;
+  entry.advance = source.advance;
+  entry.knockCount = source.knockCount;
+  entry.knockRetard = source.knockRetard;
+  entry.status2 = source.status2;
+
+  //Only free the slot once it has been copied
+  cycleLogTail = (tail + 1U) & CYCLE_LOG_INDEX_MASK;
+  return true;
+}
+
+/** Number of snapshots dropped because the buffer was full */
+uint16_t getCycleLogOverruns(void)
+{
+  return cycleLogOverruns;
+}
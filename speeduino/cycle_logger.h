@@ -0,0 +1,48 @@
+/** @file
+ * Crank angle synchronous logging.
+ *
+ * The time based loggers sample at fixed rates (Eg 30Hz), which alias against the engine cycle at anything but low RPM.
+ * The cycle logger instead takes a snapshot of the values that change from one engine event to the next (MAP, advance,
+ * pulse width, knock) from the primary trigger interrupt, either once per engine cycle or every N teeth.
+ *
+ * Snapshots are written by the trigger interrupt and read by the main loop (The SD logger), so they are passed through
+ * a single producer/single consumer ring buffer. Each side only ever writes its own index, so no interrupt locking is
+ * needed. When the buffer is full, new snapshots are dropped and counted rather than overwriting unread ones.
+ */
+#ifndef CYCLE_LOGGER_H
+#define CYCLE_LOGGER_H
+
+#include "globals.h"
+
+#define CYCLE_LOG_OFF         0U
+#define CYCLE_LOG_PER_CYCLE   1U ///< 1 snapshot per engine cycle (720 degrees for 4 stroke, 360 for 2 stroke)
+#define CYCLE_LOG_PER_TEETH   2U ///< 1 snapshot every onboard_log_cycle_teeth primary teeth
+
+//Must be a power of 2 so that the indexes can wrap with a mask
+#if defined(CORE_AVR)
+  #define CYCLE_LOG_BUFFER_SIZE 8U
+#else
+  #define CYCLE_LOG_BUFFER_SIZE 64U
+#endif
+
+struct cycleLogEntry
+{
+  uint32_t toothTime;   ///< Time (uS) of the tooth that the snapshot was taken on
+  uint16_t revolution;  ///< Low 16 bits of currentStatus.startRevolutions
+  uint16_t RPM;
+  uint16_t MAP;
+  uint16_t PW1;         ///< uS
+  int8_t advance;
+  uint8_t knockCount;
+  uint8_t knockRetard;
+  uint8_t status2;      ///< currentStatus.status2 (Cuts, launch, spark errors)
+};
+
+void resetCycleLog(uint8_t mode, uint8_t teeth);
+void setCycleLogActive(bool active);
+bool isCycleLogActive(void);
+void captureCycleLogTooth(void);
+bool readCycleLogEntry(cycleLogEntry &entry);
+uint16_t getCycleLogOverruns(void);
+
+#endif // CYCLE_LOGGER_H
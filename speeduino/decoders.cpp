@@ -35,6 +35,7 @@ A full copy of the license may be found in the projects root directory
  * - To compare Speeduino Doxyfile to default config, do: `doxygen -g Doxyfile.default ; diff Doxyfile.default Doxyfile`
  */
 #include <limits.h>
+#include <stddef.h>
 #include "globals.h"
 #include "decoders.h"
 #include "scheduledIO.h"
@@ -42,6 +43,14 @@ A full copy of the license may be found in the projects root directory
 #include "crankMaths.h"
 #include "timers.h"
 #include "schedule_calcs.h"
+#include "isr_timing.h"
+#include "trigger_patterns.h"
+#include "trigger_capture.h"
+#include "cycle_logger.h"
+#include "map_sampling.h"
+#include "pages.h"
+#include "page_crc.h"
+#include "storage.h"
 
 void nullTriggerHandler (void){return;} //initialisation function for triggerhandlers, does exactly nothing
 uint16_t nullGetRPM(void){return 0;} //initialisation function for getRpm, returns safe value of 0
@@ -57,6 +66,20 @@ void (*triggerSetEndTeeth)(void) = triggerSetEndTeeth_missingTooth; ///Pointer t
 static void triggerRoverMEMSCommon(void);
 static inline void triggerRecordVVT1Angle (void);
 
+/** The time of the edge that caused the current trigger interrupt.
+ * On boards with trigger input capture this is the time latched by the hardware (See trigger_capture.h), so it does not
+ * include the interrupt latency. Otherwise it is micros() on entry to the ISR.
+ */
+static inline unsigned long getTriggerEdgeTime(uint8_t input)
+{
+#if defined(TRIGGER_CAPTURE_AVAILABLE)
+  return getTriggerCaptureTime(input);
+#else
+  (void)input;
+  return micros();
+#endif
+}
+
 volatile unsigned long curTime;
 volatile unsigned long curGap;
 volatile unsigned long curTime2;
@@ -102,6 +125,7 @@ volatile uint8_t decoderState = 0;
 
 unsigned int triggerSecFilterTime_duration; // The shortest valid time (in uS) pulse DURATION
 volatile uint16_t triggerToothAngle; //The number of crank degrees that elapse per tooth
+volatile uint16_t toothAngleTotal = 0; //Running total (Wrapping) of the crank angle of the teeth seen. Only needs to be correct while synced, and is only maintained by decoders that set BIT_DECODER_2ND_DERIV
 byte checkSyncToothCount; //How many teeth must've been seen on this revolution before we try to confirm sync (Useful for missing tooth type decoders)
 unsigned long elapsedTime;
 unsigned long lastCrankAngleCalc;
@@ -116,6 +140,15 @@ uint16_t ignition6EndTooth = 0;
 uint16_t ignition7EndTooth = 0;
 uint16_t ignition8EndTooth = 0;
 
+uint16_t injector1StartTooth = 0;
+uint16_t injector2StartTooth = 0;
+uint16_t injector3StartTooth = 0;
+uint16_t injector4StartTooth = 0;
+uint16_t injector5StartTooth = 0;
+uint16_t injector6StartTooth = 0;
+uint16_t injector7StartTooth = 0;
+uint16_t injector8StartTooth = 0;
+
 int16_t toothAngles[24]; //An array for storing fixed tooth angles. Currently sized at 24 for the GM 24X decoder, but may grow later if there are other decoders that use this style
 
 #ifdef USE_LIBDIVIDE
@@ -133,12 +166,13 @@ static libdivide::libdivide_s16_t divTriggerToothAngle;
 
 /** Add tooth log entry to toothHistory (array).
  * Enabled by (either) currentStatus.toothLogEnabled and currentStatus.compositeTriggerUsed.
+ * Entries go into the @ref toothHistoryBuffer half of the log. When it is full the halves are swapped, so logging carries on while comms
+ * sends the full one. If comms has not finished with the previous buffer by then, the new one is refilled and currentStatus.toothLogOverruns is incremented.
  * @param toothTime - Tooth Time
  * @param whichTooth - 0 for Primary (Crank), 2 for Secondary (Cam) 3 for Tertiary (Cam)
  */
 static inline void addToothLogEntry(unsigned long toothTime, byte whichTooth)
 {
-  if(BIT_CHECK(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY)) { return; }
   //High speed tooth logging history
   if( (currentStatus.toothLogEnabled == true) || (currentStatus.compositeTriggerUsed > 0) ) 
   {
@@ -148,55 +182,70 @@ static inline void addToothLogEntry(unsigned long toothTime, byte whichTooth)
       //Tooth log only works on the Crank tooth
       if(whichTooth == TOOTH_CRANK)
       { 
-        toothHistory[toothHistoryIndex] = toothTime; //Set the value in the log. 
+        toothHistory[toothHistoryBuffer][toothHistoryIndex] = toothTime; //Set the value in the log. 
         valueLogged = true;
       } 
     }
     else if(currentStatus.compositeTriggerUsed > 0)
     {
-      compositeLogHistory[toothHistoryIndex] = 0;
+      volatile uint8_t &compositeEntry = compositeLogHistory[toothHistoryBuffer][toothHistoryIndex];
+      compositeEntry = 0;
       if(currentStatus.compositeTriggerUsed == 4)
       {
         // we want to display both cams so swap the values round to display primary as cam1 and secondary as cam2, include the crank in the data as the third output
-        if(READ_SEC_TRIGGER() == true) { BIT_SET(compositeLogHistory[toothHistoryIndex], COMPOSITE_LOG_PRI); }
-        if(READ_THIRD_TRIGGER() == true) { BIT_SET(compositeLogHistory[toothHistoryIndex], COMPOSITE_LOG_SEC); }
-        if(READ_PRI_TRIGGER() == true) { BIT_SET(compositeLogHistory[toothHistoryIndex], COMPOSITE_LOG_THIRD); }
-        if(whichTooth > TOOTH_CAM_SECONDARY) { BIT_SET(compositeLogHistory[toothHistoryIndex], COMPOSITE_LOG_TRIG); }
+        if(READ_SEC_TRIGGER() == true) { BIT_SET(compositeEntry, COMPOSITE_LOG_PRI); }
+        if(READ_THIRD_TRIGGER() == true) { BIT_SET(compositeEntry, COMPOSITE_LOG_SEC); }
+        if(READ_PRI_TRIGGER() == true) { BIT_SET(compositeEntry, COMPOSITE_LOG_THIRD); }
+        if(whichTooth > TOOTH_CAM_SECONDARY) { BIT_SET(compositeEntry, COMPOSITE_LOG_TRIG); }
       }
       else
       {
         // we want to display crank and one of the cams
-        if(READ_PRI_TRIGGER() == true) { BIT_SET(compositeLogHistory[toothHistoryIndex], COMPOSITE_LOG_PRI); }
+        if(READ_PRI_TRIGGER() == true) { BIT_SET(compositeEntry, COMPOSITE_LOG_PRI); }
         if(currentStatus.compositeTriggerUsed == 3)
         { 
           // display cam2 and also log data for cam 1
-          if(READ_THIRD_TRIGGER() == true) { BIT_SET(compositeLogHistory[toothHistoryIndex], COMPOSITE_LOG_SEC); } // only the COMPOSITE_LOG_SEC value is visualised hence the swapping of the data
-          if(READ_SEC_TRIGGER() == true) { BIT_SET(compositeLogHistory[toothHistoryIndex], COMPOSITE_LOG_THIRD); } 
+          if(READ_THIRD_TRIGGER() == true) { BIT_SET(compositeEntry, COMPOSITE_LOG_SEC); } // only the COMPOSITE_LOG_SEC value is visualised hence the swapping of the data
+          if(READ_SEC_TRIGGER() == true) { BIT_SET(compositeEntry, COMPOSITE_LOG_THIRD); } 
         } 
         else
         { 
           // display cam1 and also log data for cam 2 - this is the historic composite view
-          if(READ_SEC_TRIGGER() == true) { BIT_SET(compositeLogHistory[toothHistoryIndex], COMPOSITE_LOG_SEC); } 
-          if(READ_THIRD_TRIGGER() == true) { BIT_SET(compositeLogHistory[toothHistoryIndex], COMPOSITE_LOG_THIRD); }
+          if(READ_SEC_TRIGGER() == true) { BIT_SET(compositeEntry, COMPOSITE_LOG_SEC); } 
+          if(READ_THIRD_TRIGGER() == true) { BIT_SET(compositeEntry, COMPOSITE_LOG_THIRD); }
         }
-        if(whichTooth > TOOTH_CRANK) { BIT_SET(compositeLogHistory[toothHistoryIndex], COMPOSITE_LOG_TRIG); }
+        if(whichTooth > TOOTH_CRANK) { BIT_SET(compositeEntry, COMPOSITE_LOG_TRIG); }
       }  
-      if(currentStatus.hasSync == true) { BIT_SET(compositeLogHistory[toothHistoryIndex], COMPOSITE_LOG_SYNC); }
+      if(currentStatus.hasSync == true) { BIT_SET(compositeEntry, COMPOSITE_LOG_SYNC); }
 
       if(revolutionOne == 1)
-      { BIT_SET(compositeLogHistory[toothHistoryIndex], COMPOSITE_ENGINE_CYCLE);}
+      { BIT_SET(compositeEntry, COMPOSITE_ENGINE_CYCLE);}
       else
-      { BIT_CLEAR(compositeLogHistory[toothHistoryIndex], COMPOSITE_ENGINE_CYCLE);}
+      { BIT_CLEAR(compositeEntry, COMPOSITE_ENGINE_CYCLE);}
 
-      toothHistory[toothHistoryIndex] = micros();
+      toothHistory[toothHistoryBuffer][toothHistoryIndex] = micros();
       valueLogged = true;
     }
 
     //If there has been a value logged above, update the indexes
     if(valueLogged == true)
     {
-     if(toothHistoryIndex < (TOOTH_LOG_SIZE-1)) { toothHistoryIndex++; BIT_CLEAR(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY); }
-     else { BIT_SET(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY); }
+      toothHistoryIndex++;
+      if(toothHistoryIndex >= TOOTH_LOG_SIZE)
+      {
+        //The buffer is full. Hand it over to comms and carry on logging in the other one
+        if(BIT_CHECK(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY))
+        {
+          //The other buffer has not been sent yet, so this one is discarded and filled again
+          if(currentStatus.toothLogOverruns < UINT8_MAX) { currentStatus.toothLogOverruns++; }
+        }
+        else
+        {
+          toothHistoryBuffer ^= 1U;
+          BIT_SET(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY);
+        }
+        toothHistoryIndex = 0;
+      }
     }
 
 
@@ -209,6 +258,7 @@ static inline void addToothLogEntry(unsigned long toothTime, byte whichTooth)
 */
 void loggerPrimaryISR(void)
 {
+  ISR_TIMING_START();
   BIT_CLEAR(decoderState, BIT_DECODER_VALID_TRIGGER); //This value will be set to the return value of the decoder function, indicating whether or not this pulse passed the filters
   bool validEdge = false; //This is set true below if the edge 
   /* 
@@ -222,6 +272,7 @@ void loggerPrimaryISR(void)
   {
     triggerHandler();
     validEdge = true;
+    if(BIT_CHECK(decoderState, BIT_DECODER_VALID_TRIGGER)) { captureCycleLogTooth(); }
   }
   if( (currentStatus.toothLogEnabled == true) && (BIT_CHECK(decoderState, BIT_DECODER_VALID_TRIGGER)) )
   {
@@ -236,6 +287,19 @@ void loggerPrimaryISR(void)
     //Composite logger adds an entry regardless of which edge it was
     addToothLogEntry(curGap, TOOTH_CRANK);
   }
+  ISR_TIMING_END(ISR_TIMING_TRIGGER_PRI);
+}
+
+/** Interrupt handler for primary trigger while the cycle logger is running (And the tooth/composite loggers are not).
+* Calls the standard decoder trigger and then lets the cycle logger take a snapshot if one is due on this tooth.
+*/
+void cycleLogPrimaryISR(void)
+{
+  ISR_TIMING_START();
+  BIT_CLEAR(decoderState, BIT_DECODER_VALID_TRIGGER); //This value will be set to the return value of the decoder function, indicating whether or not this pulse passed the filters
+  triggerHandler();
+  if(BIT_CHECK(decoderState, BIT_DECODER_VALID_TRIGGER)) { captureCycleLogTooth(); }
+  ISR_TIMING_END(ISR_TIMING_TRIGGER_PRI);
 }
 
 /** Interrupt handler for secondary trigger.
@@ -243,6 +307,7 @@ void loggerPrimaryISR(void)
 */
 void loggerSecondaryISR(void)
 {
+  ISR_TIMING_START();
   BIT_CLEAR(decoderState, BIT_DECODER_VALID_TRIGGER); //This value will be set to the return value of the decoder function, indicating whether or not this pulse passed the filters
   BIT_SET(decoderState, BIT_DECODER_VALID_TRIGGER); //This value will be set to the return value of the decoder function, indicating whether or not this pulse passed the filters
   /* 3 checks here:
@@ -261,6 +326,7 @@ void loggerSecondaryISR(void)
     //Composite logger adds an entry regardless of which edge it was
     addToothLogEntry(curGap2, TOOTH_CAM_SECONDARY);
   }
+  ISR_TIMING_END(ISR_TIMING_TRIGGER_SEC);
 }
 
 /** Interrupt handler for third trigger.
@@ -268,6 +334,7 @@ void loggerSecondaryISR(void)
 */
 void loggerTertiaryISR(void)
 {
+  ISR_TIMING_START();
   BIT_CLEAR(decoderState, BIT_DECODER_VALID_TRIGGER); //This value will be set to the return value of the decoder function, indicating whether or not this pulse passed the filters
   BIT_SET(decoderState, BIT_DECODER_VALID_TRIGGER); //This value will be set to the return value of the decoder function, indicating whether or not this pulse passed the filters
   /* 3 checks here:
@@ -288,7 +355,34 @@ void loggerTertiaryISR(void)
     //Composite logger adds an entry regardless of which edge it was
     addToothLogEntry(curGap3, TOOTH_CAM_TERTIARY);
   }  
+  ISR_TIMING_END(ISR_TIMING_TRIGGER_TER);
+}
+
+#if defined(ISR_TIMING)
+/** Interrupt handlers used in place of the decoder functions when ISR timing is enabled.
+* They call the selected decoder function and record how long it took.
+*/
+void timedPrimaryISR(void)
+{
+  ISR_TIMING_START();
+  triggerHandler();
+  ISR_TIMING_END(ISR_TIMING_TRIGGER_PRI);
+}
+
+void timedSecondaryISR(void)
+{
+  ISR_TIMING_START();
+  triggerSecondaryHandler();
+  ISR_TIMING_END(ISR_TIMING_TRIGGER_SEC);
+}
+
+void timedTertiaryISR(void)
+{
+  ISR_TIMING_START();
+  triggerTertiaryHandler();
+  ISR_TIMING_END(ISR_TIMING_TRIGGER_TER);
 }
+#endif
 
 #if false
 #if !defined(UNIT_TEST)
@@ -452,6 +546,7 @@ On decoders that are enabled for per tooth based timing adjustments, this functi
 For each ignition channel, a check is made whether we're at the relevant tooth and whether that ignition schedule is currently running
 Only if both these conditions are met will the schedule be updated with the latest timing information.
 If it's the correct tooth, but the schedule is not yet started, calculate and an end compare value (This situation occurs when both the start and end of the ignition pulse happen after the end tooth, but before the next tooth)
+On decoders that set the injector start teeth, pending injection schedules are re-anchored to their start tooth in the same way (See adjustFuelStartAngle())
 */
 static inline void checkPerToothTiming(int16_t crankAngle, uint16_t currentTooth)
 {
@@ -497,8 +592,41 @@ static inline void checkPerToothTiming(int16_t crankAngle, uint16_t currentTooth
       adjustCrankAngle(ignitionSchedule8, ignition8EndAngle, crankAngle);
     }
 #endif
+
+    //Injection is checked separately as an injector may open on the same tooth that a spark happens. Several injectors can also share a start tooth
+    if (currentTooth == injector1StartTooth) { adjustFuelStartAngle(fuelSchedule1, channel1InjDegrees, injector1StartAngle, crankAngle); }
+    if (currentTooth == injector2StartTooth) { adjustFuelStartAngle(fuelSchedule2, channel2InjDegrees, injector2StartAngle, crankAngle); }
+    if (currentTooth == injector3StartTooth) { adjustFuelStartAngle(fuelSchedule3, channel3InjDegrees, injector3StartAngle, crankAngle); }
+    if (currentTooth == injector4StartTooth) { adjustFuelStartAngle(fuelSchedule4, channel4InjDegrees, injector4StartAngle, crankAngle); }
+#if INJ_CHANNELS >= 5
+    if (currentTooth == injector5StartTooth) { adjustFuelStartAngle(fuelSchedule5, channel5InjDegrees, injector5StartAngle, crankAngle); }
+#endif
+#if INJ_CHANNELS >= 6
+    if (currentTooth == injector6StartTooth) { adjustFuelStartAngle(fuelSchedule6, channel6InjDegrees, injector6StartAngle, crankAngle); }
+#endif
+#if INJ_CHANNELS >= 7
+    if (currentTooth == injector7StartTooth) { adjustFuelStartAngle(fuelSchedule7, channel7InjDegrees, injector7StartAngle, crankAngle); }
+#endif
+#if INJ_CHANNELS >= 8
+    if (currentTooth == injector8StartTooth) { adjustFuelStartAngle(fuelSchedule8, channel8InjDegrees, injector8StartAngle, crankAngle); }
+#endif
   }
 }
+
+/** Disable per tooth injection timing. The start teeth are only set by decoders that support it (See triggerSetEndTeeth_missingTooth()),
+ * so this is called whenever the decoder is changed. A tooth number of 0 is never matched.
+ */
+void clearInjectorStartTeeth(void)
+{
+  injector1StartTooth = 0;
+  injector2StartTooth = 0;
+  injector3StartTooth = 0;
+  injector4StartTooth = 0;
+  injector5StartTooth = 0;
+  injector6StartTooth = 0;
+  injector7StartTooth = 0;
+  injector8StartTooth = 0;
+}
 /** @} */
   
 /** A (single) multi-tooth wheel with one of more 'missing' teeth.
@@ -527,7 +655,8 @@ void triggerSetup_missingTooth(void)
   {
     triggerSecFilterTime = (MICROS_PER_SEC / (MAX_RPM / 60U));
   }
-  BIT_CLEAR(decoderState, BIT_DECODER_2ND_DERIV);
+  BIT_SET(decoderState, BIT_DECODER_2ND_DERIV);
+  BIT_SET(decoderState, BIT_DECODER_MAP_ANGLE);
   checkSyncToothCount = (configPage4.triggerTeeth) >> 1; //50% of the total teeth.
   toothLastMinusOneToothTime = 0;
   toothCurrentCount = 0;
@@ -546,7 +675,7 @@ void triggerSetup_missingTooth(void)
 
 void triggerPri_missingTooth(void)
 {
-   curTime = micros();
+   curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);
    curGap = curTime - toothLastToothTime;
    if ( curGap >= triggerFilterTime ) //Pulses should never be less than triggerFilterTime, so if they are it means a false trigger. (A 36-1 wheel at 8000pm will have triggers approx. every 200uS)
    {
@@ -626,6 +755,7 @@ void triggerPri_missingTooth(void)
                 triggerFilterTime = 0; //This is used to prevent a condition where serious intermittent signals (Eg someone furiously plugging the sensor wire in and out) can leave the filter in an unrecoverable state
                 toothLastMinusOneToothTime = toothLastToothTime;
                 toothLastToothTime = curTime;
+                toothAngleTotal += triggerToothAngle * (configPage4.triggerMissingTeeth + 1U);
                 BIT_CLEAR(decoderState, BIT_DECODER_TOOTH_ANG_CORRECT); //The tooth angle is double at this point
             }
           }
@@ -637,6 +767,7 @@ void triggerPri_missingTooth(void)
           setFilter(curGap);
           toothLastMinusOneToothTime = toothLastToothTime;
           toothLastToothTime = curTime;
+          toothAngleTotal += triggerToothAngle;
           BIT_SET(decoderState, BIT_DECODER_TOOTH_ANG_CORRECT);
         }
       }
@@ -646,7 +777,14 @@ void triggerPri_missingTooth(void)
         toothLastMinusOneToothTime = toothLastToothTime;
         toothLastToothTime = curTime;
       }
-     
+
+      //Crank angle triggered MAP sampling
+      if( (isMAPAngleSamplingActive() == true) && ((currentStatus.hasSync == true) || BIT_CHECK(currentStatus.status3, BIT_STATUS3_HALFSYNC)) )
+      {
+        int16_t crankAngle = ( (toothCurrentCount-1) * triggerToothAngle ) + configPage4.triggerAngle;
+        if( (revolutionOne == true) && (configPage4.TrigSpeed == CRANK_SPEED) ) { crankAngle += 360; }
+        sampleMAPAtTooth(crankAngle);
+      }
 
       //NEW IGNITION MODE
       if( (configPage2.perToothIgn == true) && (!BIT_CHECK(currentStatus.engine, BIT_ENGINE_CRANK)) ) 
@@ -665,7 +803,7 @@ void triggerPri_missingTooth(void)
 
 void triggerSec_missingTooth(void)
 {
-  curTime2 = micros();
+  curTime2 = getTriggerEdgeTime(TRIGGER_INPUT_SECONDARY);
   curGap2 = curTime2 - toothLastSecToothTime;
 
   //Safety check for initial startup
@@ -750,7 +888,7 @@ void triggerThird_missingTooth(void)
 //NB no filtering of this signal with current implementation unlike Cam (VVT1)
 
   int16_t curAngle;
-  curTime3 = micros();
+  curTime3 = getTriggerEdgeTime(TRIGGER_INPUT_TERTIARY);
   curGap3 = curTime3 - toothLastThirdToothTime;
 
   //Safety check for initial startup
@@ -868,6 +1006,28 @@ void triggerSetEndTeeth_missingTooth(void)
 #if IGN_CHANNELS >= 8
   ignition8EndTooth = calcEndTeeth_missingTooth(ignition8EndAngle, toothAdder);
 #endif
+
+  //The injection start teeth use the same tooth numbering as ignition, so they can only be used when both cover the same crank angle range
+  if(CRANK_ANGLE_MAX_INJ == CRANK_ANGLE_MAX_IGN)
+  {
+    injector1StartTooth = calcEndTeeth_missingTooth(injector1StartAngle, toothAdder);
+    injector2StartTooth = calcEndTeeth_missingTooth(injector2StartAngle, toothAdder);
+    injector3StartTooth = calcEndTeeth_missingTooth(injector3StartAngle, toothAdder);
+    injector4StartTooth = calcEndTeeth_missingTooth(injector4StartAngle, toothAdder);
+#if INJ_CHANNELS >= 5
+    injector5StartTooth = calcEndTeeth_missingTooth(injector5StartAngle, toothAdder);
+#endif
+#if INJ_CHANNELS >= 6
+    injector6StartTooth = calcEndTeeth_missingTooth(injector6StartAngle, toothAdder);
+#endif
+#if INJ_CHANNELS >= 7
+    injector7StartTooth = calcEndTeeth_missingTooth(injector7StartAngle, toothAdder);
+#endif
+#if INJ_CHANNELS >= 8
+    injector8StartTooth = calcEndTeeth_missingTooth(injector8StartAngle, toothAdder);
+#endif
+  }
+  else { clearInjectorStartTeeth(); }
 }
 /** @} */
 
@@ -886,7 +1046,8 @@ void triggerSetup_DualWheel(void)
   toothCurrentCount = UINT8_MAX; //Default value
   triggerFilterTime = (MICROS_PER_SEC / (MAX_RPM / 60U * configPage4.triggerTeeth)); //Trigger filter time is the shortest possible time (in uS) that there can be between crank teeth (ie at max RPM). Any pulses that occur faster than this time will be discarded as noise
   triggerSecFilterTime = (MICROS_PER_SEC / (MAX_RPM / 60U * 2U)) / 2U; //Same as above, but fixed at 2 teeth on the secondary input and divided by 2 (for cam speed)
-  BIT_CLEAR(decoderState, BIT_DECODER_2ND_DERIV);
+  BIT_SET(decoderState, BIT_DECODER_2ND_DERIV);
+  BIT_SET(decoderState, BIT_DECODER_MAP_ANGLE);
   BIT_SET(decoderState, BIT_DECODER_IS_SEQUENTIAL);
   BIT_SET(decoderState, BIT_DECODER_TOOTH_ANG_CORRECT); //This is always true for this pattern
   BIT_SET(decoderState, BIT_DECODER_HAS_SECONDARY);
@@ -901,7 +1062,7 @@ void triggerSetup_DualWheel(void)
  * */
 void triggerPri_DualWheel(void)
 {
-    curTime = micros();
+    curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);
     curGap = curTime - toothLastToothTime;
     if ( curGap >= triggerFilterTime )
     {
@@ -910,6 +1071,7 @@ void triggerPri_DualWheel(void)
 
       toothLastMinusOneToothTime = toothLastToothTime;
       toothLastToothTime = curTime;
+      toothAngleTotal += triggerToothAngle;
 
       if ( currentStatus.hasSync == true )
       {
@@ -924,6 +1086,14 @@ void triggerPri_DualWheel(void)
         }
 
         setFilter(curGap); //Recalc the new filter value
+
+        //Crank angle triggered MAP sampling
+        if(isMAPAngleSamplingActive() == true)
+        {
+          int16_t crankAngle = ( (toothCurrentCount-1) * triggerToothAngle ) + configPage4.triggerAngle;
+          if( (revolutionOne == true) && (configPage4.TrigSpeed == CRANK_SPEED) ) { crankAngle += 360; }
+          sampleMAPAtTooth(crankAngle);
+        }
       }
 
       //NEW IGNITION MODE
@@ -946,7 +1116,7 @@ void triggerPri_DualWheel(void)
  * */
 void triggerSec_DualWheel(void)
 {
-  curTime2 = micros();
+  curTime2 = getTriggerEdgeTime(TRIGGER_INPUT_SECONDARY);
   curGap2 = curTime2 - toothLastSecToothTime;
   if ( curGap2 >= triggerSecFilterTime )
   {
@@ -1064,6 +1234,28 @@ void triggerSetEndTeeth_DualWheel(void)
 #if IGN_CHANNELS >= 8
   ignition8EndTooth = calcEndTeeth_DualWheel(ignition8EndAngle, toothAdder);
 #endif
+
+  //See triggerSetEndTeeth_missingTooth()
+  if(CRANK_ANGLE_MAX_INJ == CRANK_ANGLE_MAX_IGN)
+  {
+    injector1StartTooth = calcEndTeeth_DualWheel(injector1StartAngle, toothAdder);
+    injector2StartTooth = calcEndTeeth_DualWheel(injector2StartAngle, toothAdder);
+    injector3StartTooth = calcEndTeeth_DualWheel(injector3StartAngle, toothAdder);
+    injector4StartTooth = calcEndTeeth_DualWheel(injector4StartAngle, toothAdder);
+#if INJ_CHANNELS >= 5
+    injector5StartTooth = calcEndTeeth_DualWheel(injector5StartAngle, toothAdder);
+#endif
+#if INJ_CHANNELS >= 6
+    injector6StartTooth = calcEndTeeth_DualWheel(injector6StartAngle, toothAdder);
+#endif
+#if INJ_CHANNELS >= 7
+    injector7StartTooth = calcEndTeeth_DualWheel(injector7StartAngle, toothAdder);
+#endif
+#if INJ_CHANNELS >= 8
+    injector8StartTooth = calcEndTeeth_DualWheel(injector8StartAngle, toothAdder);
+#endif
+  }
+  else { clearInjectorStartTeeth(); }
 }
 /** @} */
 
@@ -1099,7 +1291,7 @@ void triggerSetup_BasicDistributor(void)
 
 void triggerPri_BasicDistributor(void)
 {
-  curTime = micros();
+  curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);
   curGap = curTime - toothLastToothTime;
   if ( (curGap >= triggerFilterTime) )
   {
@@ -1293,7 +1485,7 @@ void triggerSetup_GM7X(void)
 void triggerPri_GM7X(void)
 {
     lastGap = curGap;
-    curTime = micros();
+    curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);
     curGap = curTime - toothLastToothTime;
     toothCurrentCount++; //Increment the tooth counter
     BIT_SET(decoderState, BIT_DECODER_VALID_TRIGGER); //Flag this pulse as being a valid trigger (ie that it passed filters)
@@ -1471,7 +1663,7 @@ void triggerSetup_4G63(void)
 
 void triggerPri_4G63(void)
 {
-  curTime = micros();
+  curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);
   curGap = curTime - toothLastToothTime;
   if ( (curGap >= triggerFilterTime) || (currentStatus.startRevolutions == 0) )
   {
@@ -1670,7 +1862,7 @@ void triggerSec_4G63(void)
   }
 
 
-  curTime2 = micros();
+  curTime2 = getTriggerEdgeTime(TRIGGER_INPUT_SECONDARY);
   curGap2 = curTime2 - toothLastSecToothTime;
   if ( (curGap2 >= triggerSecFilterTime) )//|| (currentStatus.startRevolutions == 0) )
   {
@@ -1890,7 +2082,7 @@ void triggerPri_24X(void)
   if(toothCurrentCount == 25) { currentStatus.hasSync = false; } //Indicates sync has not been achieved (Still waiting for 1 revolution of the crank to take place)
   else
   {
-    curTime = micros();
+    curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);
     curGap = curTime - toothLastToothTime;
 
     if(toothCurrentCount == 0)
@@ -1999,7 +2191,7 @@ void triggerPri_Jeep2000(void)
   if(toothCurrentCount == 13) { currentStatus.hasSync = false; } //Indicates sync has not been achieved (Still waiting for 1 revolution of the crank to take place)
   else
   {
-    curTime = micros();
+    curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);
     curGap = curTime - toothLastToothTime;
     if ( curGap >= triggerFilterTime )
     {
@@ -2090,7 +2282,7 @@ void triggerSetup_Audi135(void)
 
 void triggerPri_Audi135(void)
 {
-   curTime = micros();
+   curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);
    curGap = curTime - toothSystemLastToothTime;
    if ( (curGap > triggerFilterTime) || (currentStatus.startRevolutions == 0) )
    {
@@ -2129,7 +2321,7 @@ void triggerPri_Audi135(void)
 void triggerSec_Audi135(void)
 {
   /*
-  curTime2 = micros();
+  curTime2 = getTriggerEdgeTime(TRIGGER_INPUT_SECONDARY);
   curGap2 = curTime2 - toothLastSecToothTime;
   if ( curGap2 < triggerSecFilterTime ) { return; }
   toothLastSecToothTime = curTime2;
@@ -2204,7 +2396,7 @@ void triggerSetup_HondaD17(void)
 void triggerPri_HondaD17(void)
 {
    lastGap = curGap;
-   curTime = micros();
+   curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);
    curGap = curTime - toothLastToothTime;
    toothCurrentCount++; //Increment the tooth counter
 
@@ -2325,7 +2517,7 @@ void triggerPri_HondaJ32(void)
   // This function is called only on rising edges, which occur as we lose sight of a tooth.
   // This function sets the following state variables for use in other functions:
   // toothLastToothTime, toothOneTime, revolutionOne (just toggles - not correct)
-  curTime = micros();
+  curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);
   curGap = curTime - toothLastToothTime;
   toothLastToothTime = curTime;
 
@@ -2478,7 +2670,7 @@ void triggerSetup_Miata9905(void)
 
 void triggerPri_Miata9905(void)
 {
-  curTime = micros();
+  curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);
   curGap = curTime - toothLastToothTime;
   if ( (curGap >= triggerFilterTime) || (currentStatus.startRevolutions == 0) )
   {
@@ -2565,7 +2757,7 @@ void triggerPri_Miata9905(void)
 
 void triggerSec_Miata9905(void)
 {
-  curTime2 = micros();
+  curTime2 = getTriggerEdgeTime(TRIGGER_INPUT_SECONDARY);
   curGap2 = curTime2 - toothLastSecToothTime;
 
   if(BIT_CHECK(currentStatus.engine, BIT_ENGINE_CRANK) || (currentStatus.hasSync == false) )
@@ -2729,7 +2921,7 @@ void triggerSetup_MazdaAU(void)
 
 void triggerPri_MazdaAU(void)
 {
-  curTime = micros();
+  curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);
   curGap = curTime - toothLastToothTime;
   if ( curGap >= triggerFilterTime )
   {
@@ -2766,7 +2958,7 @@ void triggerPri_MazdaAU(void)
 
 void triggerSec_MazdaAU(void)
 {
-  curTime2 = micros();
+  curTime2 = getTriggerEdgeTime(TRIGGER_INPUT_SECONDARY);
   lastGap = curGap2;
   curGap2 = curTime2 - toothLastSecToothTime;
   //if ( curGap2 < triggerSecFilterTime ) { return; }
@@ -2945,7 +3137,7 @@ void triggerSetup_Nissan360(void)
 
 void triggerPri_Nissan360(void)
 {
-   curTime = micros();
+   curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);
    curGap = curTime - toothLastToothTime;
    //if ( curGap < triggerFilterTime ) { return; }
    toothCurrentCount++; //Increment the tooth counter
@@ -2986,7 +3178,7 @@ void triggerPri_Nissan360(void)
 
 void triggerSec_Nissan360(void)
 {
-  curTime2 = micros();
+  curTime2 = getTriggerEdgeTime(TRIGGER_INPUT_SECONDARY);
   curGap2 = curTime2 - toothLastSecToothTime;
   //if ( curGap2 < triggerSecFilterTime ) { return; }
   toothLastSecToothTime = curTime2;
@@ -3185,7 +3377,7 @@ void triggerSetup_Subaru67(void)
 
 void triggerPri_Subaru67(void)
 {
-  curTime = micros();
+  curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);
   curGap = curTime - toothLastToothTime;
   if ( curGap < triggerFilterTime ) 
   { return; }
@@ -3306,7 +3498,7 @@ void triggerSec_Subaru67(void)
 {
   if( ((toothSystemCount == 0) || (toothSystemCount == 3)) )
   {
-    curTime2 = micros();
+    curTime2 = getTriggerEdgeTime(TRIGGER_INPUT_SECONDARY);
     curGap2 = curTime2 - toothLastSecToothTime;
     
     if ( curGap2 > triggerSecFilterTime ) 
@@ -3460,7 +3652,7 @@ void triggerSetup_Daihatsu(void)
 
 void triggerPri_Daihatsu(void)
 {
-  curTime = micros();
+  curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);
   curGap = curTime - toothLastToothTime;
 
   //if ( curGap >= triggerFilterTime || (currentStatus.startRevolutions == 0 )
@@ -3604,7 +3796,7 @@ void triggerSetup_Harley(void)
 void triggerPri_Harley(void)
 {
   lastGap = curGap;
-  curTime = micros();
+  curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);
   curGap = curTime - toothLastToothTime;
   setFilter(curGap); // Filtering adjusted according to setting
   if (curGap > triggerFilterTime)
@@ -3751,7 +3943,7 @@ void triggerSetup_ThirtySixMinus222(void)
 
 void triggerPri_ThirtySixMinus222(void)
 {
-   curTime = micros();
+   curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);
    curGap = curTime - toothLastToothTime;
    if ( curGap >= triggerFilterTime ) //Pulses should never be less than triggerFilterTime, so if they are it means a false trigger. (A 36-1 wheel at 8000pm will have triggers approx. every 200uS)
    {
@@ -3931,7 +4123,7 @@ void triggerSetup_ThirtySixMinus21(void)
 
 void triggerPri_ThirtySixMinus21(void)
 {
-   curTime = micros();
+   curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);
    curGap = curTime - toothLastToothTime;
    if ( curGap >= triggerFilterTime ) //Pulses should never be less than triggerFilterTime, so if they are it means a false trigger. (A 36-1 wheel at 8000pm will have triggers approx. every 200uS)
    {
@@ -4078,7 +4270,7 @@ void triggerSetup_420a(void)
 
 void triggerPri_420a(void)
 {
-  curTime = micros();
+  curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);
   curGap = curTime - toothLastToothTime;
   if ( curGap >= triggerFilterTime ) //Pulses should never be less than triggerFilterTime, so if they are it means a false trigger. (A 36-1 wheel at 8000pm will have triggers approx. every 200uS)
   {
@@ -4226,7 +4418,7 @@ Uses DualWheel decoders, There can be no missing teeth on the primary wheel.
 */
 void triggerPri_Webber(void)
 {
-  curTime = micros();
+  curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);
   curGap = curTime - toothLastToothTime;
   if ( curGap >= triggerFilterTime )
   {
@@ -4277,7 +4469,7 @@ void triggerPri_Webber(void)
 
 void triggerSec_Webber(void)
 {
-  curTime2 = micros();
+  curTime2 = getTriggerEdgeTime(TRIGGER_INPUT_SECONDARY);
   curGap2 = curTime2 - toothLastSecToothTime;
 
   if ( curGap2 >= triggerSecFilterTime )
@@ -4362,7 +4554,7 @@ void triggerSetup_FordST170(void)
 
 void triggerSec_FordST170(void)
 {
-  curTime2 = micros();
+  curTime2 = getTriggerEdgeTime(TRIGGER_INPUT_SECONDARY);
   curGap2 = curTime2 - toothLastSecToothTime;
 
   //Safety check for initial startup
@@ -4495,7 +4687,7 @@ void triggerSetup_DRZ400(void)
 
 void triggerSec_DRZ400(void)
 {
-  curTime2 = micros();
+  curTime2 = getTriggerEdgeTime(TRIGGER_INPUT_SECONDARY);
   curGap2 = curTime2 - toothLastSecToothTime;
   if ( curGap2 >= triggerSecFilterTime )
   {
@@ -4589,7 +4781,7 @@ void triggerSetup_NGC(void)
 
 void triggerPri_NGC(void) 
 {
-  curTime = micros();
+  curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);
   // We need to know the polarity of the missing tooth to determine position
   if (READ_PRI_TRIGGER() == HIGH) {
     toothLastToothRisingTime = curTime;
@@ -4708,7 +4900,7 @@ void triggerSec_NGC4(void)
     return;
   }
 
-  curTime2 = micros();
+  curTime2 = getTriggerEdgeTime(TRIGGER_INPUT_SECONDARY);
 
   // We need to know the polarity of the missing tooth to determine position
   if (READ_SEC_TRIGGER() == HIGH) {
@@ -4760,7 +4952,7 @@ void triggerSec_NGC68(void)
     return;
   }
 
-  curTime2 = micros();
+  curTime2 = getTriggerEdgeTime(TRIGGER_INPUT_SECONDARY);
 
   curGap2 = curTime2 - toothLastSecToothTime;
 
@@ -4894,7 +5086,7 @@ void triggerSetup_Vmax(void)
 
 void triggerPri_Vmax(void)
 {
-  curTime = micros();
+  curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);
   if(READ_PRI_TRIGGER() == primaryTriggerEdge){// Forwarded from the config page to setup the primary trigger edge (rising or falling). Inverting VR-conditioners require FALLING, non-inverting VR-conditioners require RISING in the Trigger edge setup.
     curGap2 = curTime;
     curGap = curTime - toothLastToothTime;
@@ -5108,7 +5300,7 @@ void triggerSetup_Renix(void)
 
 void triggerPri_Renix(void)
 {
-  curTime = micros();
+  curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);
   curGap = curTime - renixSystemLastToothTime;
 
   if ( curGap >= triggerFilterTime )   
@@ -5262,7 +5454,7 @@ void triggerSetup_RoverMEMS()
 
 void triggerPri_RoverMEMS()
 {
-  curTime = micros();
+  curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);
   curGap = curTime - toothLastToothTime;      
 
   if ( curGap >= triggerFilterTime ) //Pulses should never be less than triggerFilterTime, so if they are it means a false trigger. (A 36-1 wheel at 8000pm will have triggers approx. every 200uS)
@@ -5303,6 +5495,8 @@ void triggerPri_RoverMEMS()
             toothAngles[SKIP_TOOTH4] = 30;
             toothAngles[ID_TOOTH_PATTERN] = 5;
             configPage4.triggerMissingTeeth = 4; // this could be read in from the config file, but people could adjust it.
+            invalidatePageCRC32(ignSetPage);
+            markPageDirty(ignSetPage, offsetof(config4, triggerMissingTeeth), 1U); //configPage4 starts at offset 0 of its page
             triggerActualTeeth = 36; // should be 32 if not hacking toothcounter 
           }  
           triggerRoverMEMSCommon();                         
@@ -5318,6 +5512,8 @@ void triggerPri_RoverMEMS()
             toothAngles[SKIP_TOOTH4] = 27;
             toothAngles[ID_TOOTH_PATTERN] = 4;
             configPage4.triggerMissingTeeth = 4; // this could be read in from the config file, but people could adjust it.
+            invalidatePageCRC32(ignSetPage);
+            markPageDirty(ignSetPage, offsetof(config4, triggerMissingTeeth), 1U); //configPage4 starts at offset 0 of its page
             triggerActualTeeth = 36; // should be 32 if not hacking toothcounter 
           }  
           triggerRoverMEMSCommon();                         
@@ -5333,6 +5529,8 @@ void triggerPri_RoverMEMS()
             toothAngles[SKIP_TOOTH4] = 27;
             toothAngles[ID_TOOTH_PATTERN] = 3;
             configPage4.triggerMissingTeeth = 4; // this could be read in from the config file, but people could adjust it.
+            invalidatePageCRC32(ignSetPage);
+            markPageDirty(ignSetPage, offsetof(config4, triggerMissingTeeth), 1U); //configPage4 starts at offset 0 of its page
             triggerActualTeeth = 36; // should be 32 if not hacking toothcounter 
           } 
           triggerRoverMEMSCommon();                           
@@ -5348,6 +5546,8 @@ void triggerPri_RoverMEMS()
             toothAngles[SKIP_TOOTH4] = 29;
             toothAngles[ID_TOOTH_PATTERN] = 2;
             configPage4.triggerMissingTeeth = 4; // this could be read in from the config file, but people could adjust it.
+            invalidatePageCRC32(ignSetPage);
+            markPageDirty(ignSetPage, offsetof(config4, triggerMissingTeeth), 1U); //configPage4 starts at offset 0 of its page
             triggerActualTeeth = 36; // should be 32 if not hacking toothcounter 
           }  
           triggerRoverMEMSCommon();  
@@ -5361,6 +5561,8 @@ void triggerPri_RoverMEMS()
             toothAngles[SKIP_TOOTH2] = 18;
             toothAngles[ID_TOOTH_PATTERN] = 1;
             configPage4.triggerMissingTeeth = 2; // this should be read in from the config file, but people could adjust it.            
+            invalidatePageCRC32(ignSetPage);
+            markPageDirty(ignSetPage, offsetof(config4, triggerMissingTeeth), 1U); //configPage4 starts at offset 0 of its page
             triggerActualTeeth = 36; // should be 34 if not hacking toothcounter 
           }
           triggerRoverMEMSCommon(); 
@@ -5461,7 +5663,7 @@ int getCrankAngle_RoverMEMS()
 
 void triggerSec_RoverMEMS() 
 {
-  curTime2 = micros();
+  curTime2 = getTriggerEdgeTime(TRIGGER_INPUT_SECONDARY);
   curGap2 = curTime2 - toothLastSecToothTime;
 
   //Safety check for initial startup
@@ -5677,7 +5879,7 @@ void triggerSetup_SuzukiK6A(void)
 
 void triggerPri_SuzukiK6A(void)
 {
-  curTime = micros();  
+  curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);  
   curGap = curTime - toothLastToothTime;
   if ( (curGap >= triggerFilterTime) || (currentStatus.startRevolutions == 0) )
   {    
@@ -6021,3 +6223,345 @@ void triggerSetEndTeeth_SuzukiK6A(void)
 }
 /** @} */
 
+
+/** Generic gap pattern decoder - Decodes any wheel that is described by its tooth angles in trigger_patterns.h.
+* Each tooth gap is compared to the gap before it and quantised to a symbol (Short, equal, long or very long).
+* Sync is gained by a single table lookup of the last 3 symbols, after which each tooth only needs to match the symbol
+* that is expected for it, so every pattern shares the same constant time ISR.
+* Cam teeth in the description are used to find the engine phase for sequential operation on crank speed wheels.
+* The pattern is selected with configPage9.trigGapPattern
+* @defgroup dec_gap_pattern Generic gap pattern
+* @{
+*/
+static gapPattern gapActivePattern;
+static gapPatternLookup gapLookup;
+static uint8_t gapToothIndex; //Index of the last tooth seen (0 = tooth #1)
+static uint8_t gapHistory; //The symbols of the most recent teeth, latest in the lowest 2 bits
+static uint8_t gapHistoryLength;
+static bool gapPhaseKnown; //The cam has identified which revolution of the cycle the crank is on
+static unsigned long gapMinFilterTime;
+
+static inline bool gapPatternNeedsPhase(void)
+{
+  return (gapActivePattern.cycleAngle == 360U) && ( (configPage4.sparkMode == IGN_MODE_SEQUENTIAL) || (configPage2.injLayout == INJ_SEQUENTIAL) );
+}
+
+static void setGapPatternSync(void)
+{
+  if( (gapPatternNeedsPhase() == false) || (gapPhaseKnown == true) )
+  {
+    currentStatus.hasSync = true;
+    BIT_CLEAR(currentStatus.status3, BIT_STATUS3_HALFSYNC);
+  }
+  else
+  {
+    currentStatus.hasSync = false;
+    BIT_SET(currentStatus.status3, BIT_STATUS3_HALFSYNC); //Crank position is known, but not the phase
+  }
+}
+
+void triggerSetup_GapPattern(void)
+{
+  uint8_t patternIndex = configPage9.trigGapPattern;
+  if(patternIndex >= gapPatternCount) { patternIndex = GAP_PATTERN_36_2_2_2; }
+  memcpy_P(&gapActivePattern, &gapPatterns[patternIndex], sizeof(gapActivePattern));
+  if(compileGapPattern(gapActivePattern, gapLookup) == false)
+  {
+    //Invalid description. The lookup will never sync, but the gap limits are still needed below
+    gapLookup.minGap = 1U;
+    gapLookup.maxGap = 360U;
+  }
+
+  if(gapActivePattern.cycleAngle == 720U) { BIT_SET(decoderState, BIT_DECODER_IS_SEQUENTIAL); }
+  else if(gapActivePattern.camToothCount > 0U) { BIT_SET(decoderState, BIT_DECODER_IS_SEQUENTIAL); }
+  else { BIT_CLEAR(decoderState, BIT_DECODER_IS_SEQUENTIAL); }
+  if( (gapActivePattern.cycleAngle == 360U) && (gapActivePattern.camToothCount > 0U) ) { BIT_SET(decoderState, BIT_DECODER_HAS_SECONDARY); }
+  else { BIT_CLEAR(decoderState, BIT_DECODER_HAS_SECONDARY); }
+  BIT_SET(decoderState, BIT_DECODER_2ND_DERIV);
+  BIT_SET(decoderState, BIT_DECODER_MAP_ANGLE);
+  BIT_CLEAR(decoderState, BIT_DECODER_TOOTH_ANG_CORRECT);
+
+  triggerActualTeeth = gapActivePattern.toothCount;
+  triggerToothAngle = gapLookup.minGap;
+  triggerFilterTime = (gapLookup.minGap * MICROS_PER_DEG_1_RPM) / MAX_RPM; //The time between the closest teeth at max RPM. Anything shorter is noise
+  gapMinFilterTime = triggerFilterTime;
+  triggerSecFilterTime = (MICROS_PER_SEC / (MAX_RPM / 60U));
+  MAX_STALL_TIME = ((MICROS_PER_DEG_1_RPM/50U) * gapLookup.maxGap); //Minimum 50rpm across the largest gap
+
+  toothCurrentCount = 0;
+  toothLastToothTime = 0;
+  toothLastMinusOneToothTime = 0;
+  toothLastSecToothTime = 0;
+  toothOneTime = 0;
+  toothOneMinusOneTime = 0;
+  secondaryToothCount = 0;
+  gapToothIndex = 0;
+  gapHistory = 0;
+  gapHistoryLength = 0;
+  gapPhaseKnown = false;
+}
+
+void triggerPri_GapPattern(void)
+{
+  curTime = getTriggerEdgeTime(TRIGGER_INPUT_PRIMARY);
+  curGap = curTime - toothLastToothTime;
+  if ( curGap >= triggerFilterTime )
+  {
+    BIT_SET(decoderState, BIT_DECODER_VALID_TRIGGER); //Flag this pulse as being a valid trigger (ie that it passed filters)
+
+    if( (toothLastToothTime > 0) && (toothLastMinusOneToothTime > 0) )
+    {
+      uint8_t symbol = classifyGap(curGap, toothLastToothTime - toothLastMinusOneToothTime);
+      gapHistory = ((gapHistory << 2U) | symbol) & GAP_SIGNATURE_MASK;
+      if(gapHistoryLength < GAP_SIGNATURE_LENGTH) { gapHistoryLength++; }
+
+      bool isSynced = HasAnySync(currentStatus);
+      if(isSynced == true)
+      {
+        //The next tooth is already known, it only needs to be confirmed by its gap
+        uint8_t nextTooth = gapToothIndex + 1U;
+        if(nextTooth >= gapActivePattern.toothCount) { nextTooth = 0U; }
+
+        if(symbol == getGapToothSymbol(gapLookup, nextTooth)) { gapToothIndex = nextTooth; }
+        else
+        {
+          currentStatus.hasSync = false;
+          BIT_CLEAR(currentStatus.status3, BIT_STATUS3_HALFSYNC);
+          currentStatus.syncLossCounter++;
+          gapPhaseKnown = false;
+          isSynced = false;
+        }
+      }
+
+      if( (isSynced == false) && (gapHistoryLength >= GAP_SIGNATURE_LENGTH) )
+      {
+        uint8_t tooth = gapLookup.signatureTooth[gapHistory];
+        if(tooth != GAP_NO_TOOTH)
+        {
+          gapToothIndex = tooth;
+          currentStatus.startRevolutions = 0;
+          setGapPatternSync();
+          isSynced = true;
+        }
+      }
+
+      if(isSynced == true)
+      {
+        toothCurrentCount = gapToothIndex + 1U;
+        triggerToothAngle = gapBeforeTooth(gapActivePattern, gapToothIndex);
+        toothAngleTotal += triggerToothAngle;
+        BIT_SET(decoderState, BIT_DECODER_TOOTH_ANG_CORRECT);
+
+        if(gapToothIndex == 0U)
+        {
+          currentStatus.startRevolutions++;
+          if(gapActivePattern.cycleAngle == 720U) { currentStatus.startRevolutions++; } //Tooth #1 is only seen once every 2 revolutions
+          revolutionOne = !revolutionOne;
+          toothOneMinusOneTime = toothOneTime;
+          toothOneTime = curTime;
+          setGapPatternSync();
+        }
+
+        //A tooth that is expected to come early cannot be filtered from the current gap
+        uint8_t nextTooth = gapToothIndex + 1U;
+        if(nextTooth >= gapActivePattern.toothCount) { nextTooth = 0U; }
+        if(getGapToothSymbol(gapLookup, nextTooth) == GAP_SHORT) { triggerFilterTime = gapMinFilterTime; }
+        else { setFilter(curGap); }
+      }
+      else
+      {
+        BIT_CLEAR(decoderState, BIT_DECODER_TOOTH_ANG_CORRECT);
+        triggerFilterTime = gapMinFilterTime;
+      }
+    }
+
+    toothLastMinusOneToothTime = toothLastToothTime;
+    toothLastToothTime = curTime;
+
+    //Crank angle triggered MAP sampling
+    if( (isMAPAngleSamplingActive() == true) && ((currentStatus.hasSync == true) || BIT_CHECK(currentStatus.status3, BIT_STATUS3_HALFSYNC)) )
+    {
+      int16_t crankAngle = getGapToothAngle(gapActivePattern, gapToothIndex) + configPage4.triggerAngle;
+      if( (revolutionOne == true) && (gapActivePattern.cycleAngle == 360U) ) { crankAngle += 360; }
+      sampleMAPAtTooth(crankAngle);
+    }
+
+    //NEW IGNITION MODE
+    if( (configPage2.perToothIgn == true) && (currentStatus.hasSync == true) && (!BIT_CHECK(currentStatus.engine, BIT_ENGINE_CRANK)) )
+    {
+      int16_t crankAngle = getGapToothAngle(gapActivePattern, gapToothIndex) + configPage4.triggerAngle;
+      uint16_t currentTooth = toothCurrentCount;
+      if( (revolutionOne == true) && (gapActivePattern.cycleAngle == 360U) && (configPage4.sparkMode == IGN_MODE_SEQUENTIAL) )
+      {
+        crankAngle += 360;
+        currentTooth += gapActivePattern.toothCount;
+      }
+      crankAngle = ignitionLimits(crankAngle);
+      checkPerToothTiming(crankAngle, currentTooth);
+    }
+  }
+}
+
+void triggerSec_GapPattern(void)
+{
+  curTime2 = getTriggerEdgeTime(TRIGGER_INPUT_SECONDARY);
+  curGap2 = curTime2 - toothLastSecToothTime;
+  if ( curGap2 >= triggerSecFilterTime )
+  {
+    toothLastSecToothTime = curTime2;
+    triggerSecFilterTime = curGap2 >> 2; //Next secondary filter is 25% the current gap
+    secondaryToothCount++;
+
+    if( (gapActivePattern.camToothCount > 0U) && (gapActivePattern.cycleAngle == 360U) && (HasAnySync(currentStatus) == true) )
+    {
+      //Find the cam tooth that is closest to the current crank position. Its angle gives the revolution that the crank is on
+      int16_t crankAngle = getGapToothAngle(gapActivePattern, gapToothIndex);
+      int16_t closestDistance = INT16_MAX;
+      int8_t closestRevolution = -1;
+      for(uint8_t camTooth = 0U; camTooth < gapActivePattern.camToothCount; camTooth++)
+      {
+        int16_t camAngle = pgm_read_word(&gapActivePattern.pCamToothAngles[camTooth]);
+        int8_t revolution = (camAngle >= 360) ? 1 : 0;
+        int16_t distance = crankAngle - (camAngle - (revolution * 360));
+        //A cam tooth close to tooth #1 can be seen just after the crank has moved onto the next revolution (Or just before)
+        if(distance > 180) { distance -= 360; revolution = 1 - revolution; }
+        else if(distance < -180) { distance += 360; revolution = 1 - revolution; }
+        if(distance < 0) { distance = -distance; }
+
+        if(distance < closestDistance) { closestDistance = distance; closestRevolution = revolution; }
+        else if( (distance == closestDistance) && (revolution != closestRevolution) ) { closestRevolution = -1; } //Cannot tell which revolution this is
+      }
+
+      if(closestRevolution >= 0)
+      {
+        revolutionOne = (closestRevolution == 1);
+        gapPhaseKnown = true;
+        setGapPatternSync();
+      }
+    }
+    triggerRecordVVT1Angle();
+  }
+}
+
+uint16_t getRPM_GapPattern(void)
+{
+  uint16_t tempRPM = currentStatus.RPM;
+  if( currentStatus.RPM < currentStatus.crankRPM )
+  {
+    //The teeth are not evenly spaced, so the last tooth time is scaled by the angle of that tooth
+    noInterrupts();
+    bool isAngleCorrect = BIT_CHECK(decoderState, BIT_DECODER_TOOTH_ANG_CORRECT) && HasAnySync(currentStatus);
+    unsigned long toothTime = toothLastToothTime - toothLastMinusOneToothTime;
+    uint16_t toothAngle = triggerToothAngle;
+    interrupts();
+
+    if( (isAngleCorrect == true) && (currentStatus.startRevolutions >= configPage4.StgCycles) && (toothLastMinusOneToothTime > 0) && (toothTime > 0) && (toothAngle > 0) )
+    {
+      if( SetRevolutionTime((toothTime * 360UL) / toothAngle) ) { tempRPM = RpmFromRevolutionTimeUs(revolutionTime); }
+    }
+  }
+  else
+  {
+    tempRPM = stdGetRPM(gapActivePattern.cycleAngle == 720U);
+  }
+  return tempRPM;
+}
+
+int getCrankAngle_GapPattern(void)
+{
+  unsigned long tempToothLastToothTime;
+  uint8_t tempToothIndex;
+  bool tempRevolutionOne;
+  //Grab some variables that are used in the trigger code and assign them to temp variables.
+  noInterrupts();
+  tempToothIndex = gapToothIndex;
+  tempRevolutionOne = revolutionOne;
+  tempToothLastToothTime = toothLastToothTime;
+  lastCrankAngleCalc = micros();
+  interrupts();
+
+  int crankAngle = getGapToothAngle(gapActivePattern, tempToothIndex) + configPage4.triggerAngle; //Angle of the last tooth seen. This gives accuracy only to the nearest tooth.
+  if( (tempRevolutionOne == true) && (gapActivePattern.cycleAngle == 360U) ) { crankAngle += 360; }
+
+  elapsedTime = (lastCrankAngleCalc - tempToothLastToothTime);
+  crankAngle += timeToAngleDegPerMicroSec(elapsedTime);
+
+  if (crankAngle >= 720) { crankAngle -= 720; }
+  if (crankAngle < 0) { crankAngle += CRANK_ANGLE_MAX; }
+
+  return crankAngle;
+}
+
+static uint16_t __attribute__((noinline)) calcEndTeeth_GapPattern(int endAngle, uint8_t toothAdder)
+{
+  int16_t angle = ignitionLimits(endAngle - configPage4.triggerAngle);
+  uint8_t revolutionTeeth = 0U;
+  if( (toothAdder > 0U) && (angle >= (int16_t)gapActivePattern.cycleAngle) )
+  {
+    angle -= gapActivePattern.cycleAngle;
+    revolutionTeeth = toothAdder;
+  }
+
+  //The last tooth at or before the end angle
+  uint8_t tooth = 0U;
+  while( ((tooth + 1U) < gapActivePattern.toothCount) && ((int16_t)getGapToothAngle(gapActivePattern, tooth + 1U) <= angle) ) { tooth++; }
+
+  //For higher tooth count triggers, add a 1 tooth margin to allow for calculation time.
+  if(gapActivePattern.toothCount > 12U)
+  {
+    if(tooth > 0U) { tooth--; }
+    else
+    {
+      tooth = gapActivePattern.toothCount - 1U;
+      revolutionTeeth = (revolutionTeeth > 0U) ? 0U : toothAdder;
+    }
+  }
+
+  return revolutionTeeth + tooth + 1U;
+}
+
+void triggerSetEndTeeth_GapPattern(void)
+{
+  uint8_t toothAdder = 0;
+  if( (configPage4.sparkMode == IGN_MODE_SEQUENTIAL) && (gapActivePattern.cycleAngle == 360U) ) { toothAdder = gapActivePattern.toothCount; }
+
+  ignition1EndTooth = calcEndTeeth_GapPattern(ignition1EndAngle, toothAdder);
+  ignition2EndTooth = calcEndTeeth_GapPattern(ignition2EndAngle, toothAdder);
+  ignition3EndTooth = calcEndTeeth_GapPattern(ignition3EndAngle, toothAdder);
+  ignition4EndTooth = calcEndTeeth_GapPattern(ignition4EndAngle, toothAdder);
+#if IGN_CHANNELS >= 5
+  ignition5EndTooth = calcEndTeeth_GapPattern(ignition5EndAngle, toothAdder);
+#endif
+#if IGN_CHANNELS >= 6
+  ignition6EndTooth = calcEndTeeth_GapPattern(ignition6EndAngle, toothAdder);
+#endif
+#if IGN_CHANNELS >= 7
+  ignition7EndTooth = calcEndTeeth_GapPattern(ignition7EndAngle, toothAdder);
+#endif
+#if IGN_CHANNELS >= 8
+  ignition8EndTooth = calcEndTeeth_GapPattern(ignition8EndAngle, toothAdder);
+#endif
+
+  //The injection start teeth use the same tooth numbering as ignition, so they can only be used when both cover the same crank angle range
+  if(CRANK_ANGLE_MAX_INJ == CRANK_ANGLE_MAX_IGN)
+  {
+    injector1StartTooth = calcEndTeeth_GapPattern(injector1StartAngle, toothAdder);
+    injector2StartTooth = calcEndTeeth_GapPattern(injector2StartAngle, toothAdder);
+    injector3StartTooth = calcEndTeeth_GapPattern(injector3StartAngle, toothAdder);
+    injector4StartTooth = calcEndTeeth_GapPattern(injector4StartAngle, toothAdder);
+#if INJ_CHANNELS >= 5
+    injector5StartTooth = calcEndTeeth_GapPattern(injector5StartAngle, toothAdder);
+#endif
+#if INJ_CHANNELS >= 6
+    injector6StartTooth = calcEndTeeth_GapPattern(injector6StartAngle, toothAdder);
+#endif
+#if INJ_CHANNELS >= 7
+    injector7StartTooth = calcEndTeeth_GapPattern(injector7StartAngle, toothAdder);
+#endif
+#if INJ_CHANNELS >= 8
+    injector8StartTooth = calcEndTeeth_GapPattern(injector8StartAngle, toothAdder);
+#endif
+  }
+  else { clearInjectorStartTeeth(); }
+}
+/** @} */
@@ -41,10 +41,11 @@
 #define DECODER_ROVERMEMS		      25
 #define DECODER_SUZUKI_K6A        26
 #define DECODER_HONDA_J32         27
+#define DECODER_GAP_PATTERN       28
 
-#define BIT_DECODER_2ND_DERIV           0 //The use of the 2nd derivative calculation is limited to certain decoders. This is set to either true or false in each decoders setup routine
+#define BIT_DECODER_2ND_DERIV           0 //The decoder maintains toothAngleTotal, so the acceleration aware crank speed prediction can be used (See doCrankSpeedCalcs()). This is set to either true or false in each decoders setup routine
 #define BIT_DECODER_IS_SEQUENTIAL       1 //Whether or not the decoder supports sequential operation
-#define BIT_DECODER_UNUSED1             2 
+#define BIT_DECODER_MAP_ANGLE           2 //The decoder calls sampleMAPAtTooth() on every tooth, so crank angle triggered MAP sampling can be used (See map_sampling.h)
 #define BIT_DECODER_HAS_SECONDARY       3 //Whether or not the decoder supports fixed cranking timing
 #define BIT_DECODER_HAS_FIXED_CRANKING  4
 #define BIT_DECODER_VALID_TRIGGER       5 //Is set true when the last trigger (Primary or secondary) was valid (ie passed filters)
@@ -71,8 +72,24 @@ extern bool decoderHasFixedCrankingTiming;
 #define ANGLE_FILTER(input, alpha, prior) (((long)(input) * (256 - (alpha)) + ((long)(prior) * (alpha)))) >> 8
 
 void loggerPrimaryISR(void);
+void cycleLogPrimaryISR(void);
 void loggerSecondaryISR(void);
 void loggerTertiaryISR(void);
+void clearInjectorStartTeeth(void);
+
+#if defined(ISR_TIMING)
+void timedPrimaryISR(void);
+void timedSecondaryISR(void);
+void timedTertiaryISR(void);
+//The function attached to each trigger interrupt. When ISR timing is enabled these wrap the decoder functions
+#define PRIMARY_TRIGGER_ISR   timedPrimaryISR
+#define SECONDARY_TRIGGER_ISR timedSecondaryISR
+#define TERTIARY_TRIGGER_ISR  timedTertiaryISR
+#else
+#define PRIMARY_TRIGGER_ISR   triggerHandler
+#define SECONDARY_TRIGGER_ISR triggerSecondaryHandler
+#define TERTIARY_TRIGGER_ISR  triggerTertiaryHandler
+#endif
 
 //All of the below are the 6 required functions for each decoder / pattern
 void triggerSetup_missingTooth(void);
@@ -262,6 +279,13 @@ uint16_t getRPM_SuzukiK6A(void);
 int getCrankAngle_SuzukiK6A(void);
 void triggerSetEndTeeth_SuzukiK6A(void);
 
+void triggerSetup_GapPattern(void);
+void triggerPri_GapPattern(void);
+void triggerSec_GapPattern(void);
+uint16_t getRPM_GapPattern(void);
+int getCrankAngle_GapPattern(void);
+void triggerSetEndTeeth_GapPattern(void);
+
 
 
 extern void (*triggerHandler)(void); //Pointer for the trigger function (Gets pointed to the relevant decoder)
@@ -303,6 +327,7 @@ extern volatile unsigned long triggerFilterTime; // The shortest time (in uS) th
 extern volatile unsigned long triggerSecFilterTime; // The shortest time (in uS) that pulses will be accepted (Used for debounce filtering) for the secondary input
 extern unsigned int triggerSecFilterTime_duration; // The shortest valid time (in uS) pulse DURATION
 extern volatile uint16_t triggerToothAngle; //The number of crank degrees that elapse per tooth
+extern volatile uint16_t toothAngleTotal; //Running total (Wrapping) of the crank angle of the teeth seen. Only needs to be correct while synced, and is only maintained by decoders that set BIT_DECODER_2ND_DERIV
 extern byte checkSyncToothCount; //How many teeth must've been seen on this revolution before we try to confirm sync (Useful for missing tooth type decoders)
 extern unsigned long elapsedTime;
 extern unsigned long lastCrankAngleCalc;
@@ -317,6 +342,15 @@ extern uint16_t ignition6EndTooth;
 extern uint16_t ignition7EndTooth;
 extern uint16_t ignition8EndTooth;
 
+extern uint16_t injector1StartTooth;
+extern uint16_t injector2StartTooth;
+extern uint16_t injector3StartTooth;
+extern uint16_t injector4StartTooth;
+extern uint16_t injector5StartTooth;
+extern uint16_t injector6StartTooth;
+extern uint16_t injector7StartTooth;
+extern uint16_t injector8StartTooth;
+
 extern int16_t toothAngles[24]; //An array for storing fixed tooth angles. Currently sized at 24 for the GM 24X decoder, but may grow later if there are other decoders that use this style
 
 #define CRANK_SPEED 0U
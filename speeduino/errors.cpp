@@ -71,3 +71,15 @@ byte getNextError(void)
 
   return *(byte*)&currentError; //Ugly, but this forces the cast of the currentError struct to a byte.
 }
+
+/*
+ * Returns the first error (Or 0 if there are none), packed as getNextError() does. Unlike getNextError() it does not follow the once per second rotation
+ */
+byte getFirstError(void)
+{
+  packedError currentError;
+  currentError.errorNum = 0;
+  currentError.errorID = (errorCount > 0) ? errorCodes[0] : ERR_NONE;
+
+  return *(byte*)&currentError;
+}
@@ -18,6 +18,12 @@
 #define ERR_BAT_LOW     11 //Battery voltage is too low
 #define ERR_MAP_HIGH    12 //MAP output is too high
 #define ERR_MAP_LOW     13 //MAP output is too low
+#define ERR_BARO_HIGH   14 //External baro sensor output is too high
+#define ERR_BARO_LOW    15 //External baro sensor output is too low
+#define ERR_FUELP_HIGH  16 //Fuel pressure sensor output is too high
+#define ERR_FUELP_LOW   17 //Fuel pressure sensor output is too low
+#define ERR_OILP_HIGH   18 //Oil pressure sensor output is too high
+#define ERR_OILP_LOW    19 //Oil pressure sensor output is too low
 
 #define ERR_DEFAULT_IAT_SHORT   80 //Note that the default is 40C. 80 is used due to the -40 offset
 #define ERR_DEFAULT_IAT_GND     80 //Note that the default is 40C. 80 is used due to the -40 offset
@@ -31,6 +37,9 @@
 #define ERR_DEFAULT_BAT_LOW     130 //13v
 #define ERR_DEFAULT_MAP_HIGH    240
 #define ERR_DEFAULT_MAP_LOW     80
+#define ERR_DEFAULT_BARO        100 //kPa, the same fallback as when there is no stored baro reading
+#define ERR_DEFAULT_FUELP       0 //As if the sensor were disabled
+#define ERR_DEFAULT_OILP        0 //Low, so that oil pressure protection (If enabled) acts on a failed sensor
 
 
 #define MAX_ERRORS  4 //The number of errors the system can hold simultaneously. Should be a power of 2
@@ -47,6 +56,7 @@ struct packedError
 };
 
 byte getNextError(void);
+byte getFirstError(void);
 byte setError(byte errorID);
 void clearError(byte errorID);
 
@@ -27,34 +27,36 @@ trimTable3d trim6Table; ///< 6x6 Fuel trim 6 map
 trimTable3d trim7Table; ///< 6x6 Fuel trim 7 map
 trimTable3d trim8Table; ///< 6x6 Fuel trim 8 map
 struct table3d4RpmLoad dwellTable; ///< 4x4 Dwell map
-struct table2D taeTable; ///< 4 bin TPS Acceleration Enrichment map (2D)
-struct table2D maeTable;
-struct table2D WUETable; ///< 10 bin Warm Up Enrichment map (2D)
-struct table2D ASETable; ///< 4 bin After Start Enrichment map (2D)
-struct table2D ASECountTable; ///< 4 bin After Start duration map (2D)
-struct table2D PrimingPulseTable; ///< 4 bin Priming pulsewidth map (2D)
-struct table2D crankingEnrichTable; ///< 4 bin cranking Enrichment map (2D)
-struct table2D dwellVCorrectionTable; ///< 6 bin dwell voltage correction (2D)
-struct table2D injectorVCorrectionTable; ///< 6 bin injector voltage correction (2D)
-struct table2D injectorAngleTable; ///< 4 bin injector angle curve (2D)
-struct table2D IATDensityCorrectionTable; ///< 9 bin inlet air temperature density correction (2D)
-struct table2D baroFuelTable; ///< 8 bin baro correction curve (2D)
-struct table2D IATRetardTable; ///< 6 bin ignition adjustment based on inlet air temperature  (2D)
-struct table2D idleTargetTable; ///< 10 bin idle target table for idle timing (2D)
-struct table2D idleAdvanceTable; ///< 6 bin idle advance adjustment table based on RPM difference  (2D)
-struct table2D CLTAdvanceTable; ///< 6 bin ignition adjustment based on coolant temperature  (2D)
-struct table2D rotarySplitTable; ///< 8 bin ignition split curve for rotary leading/trailing  (2D)
-struct table2D flexFuelTable;  ///< 6 bin flex fuel correction table for fuel adjustments (2D)
-struct table2D flexAdvTable;   ///< 6 bin flex fuel correction table for timing advance (2D)
-struct table2D flexBoostTable; ///< 6 bin flex fuel correction table for boost adjustments (2D)
-struct table2D fuelTempTable;  ///< 6 bin flex fuel correction table for fuel adjustments (2D)
-struct table2D knockWindowStartTable;
-struct table2D knockWindowDurationTable;
-struct table2D oilPressureProtectTable;
-struct table2D wmiAdvTable; //6 bin wmi correction table for timing advance (2D)
-struct table2D coolantProtectTable;
-struct table2D fanPWMTable;
-struct table2D rollingCutTable;
+table3DSharedAxisCache rpmLoadAxisCache; ///< Shared axis search for the 16x16 tables looked up by RPM vs load (fuel, ignition, AFR)
+table3DSharedAxisCache trimAxisCache; ///< Shared axis search for the fuel trim maps
+table2D_u8_u8 taeTable; ///< 4 bin TPS Acceleration Enrichment map (2D)
+table2D_u8_u8 maeTable;
+table2D_u8_u8 WUETable; ///< 10 bin Warm Up Enrichment map (2D)
+table2D_u8_u8 ASETable; ///< 4 bin After Start Enrichment map (2D)
+table2D_u8_u8 ASECountTable; ///< 4 bin After Start duration map (2D)
+table2D_u8_u8 PrimingPulseTable; ///< 4 bin Priming pulsewidth map (2D)
+table2D_u8_u8 crankingEnrichTable; ///< 4 bin cranking Enrichment map (2D)
+table2D_u8_u8 dwellVCorrectionTable; ///< 6 bin dwell voltage correction (2D)
+table2D_u8_u8 injectorVCorrectionTable; ///< 6 bin injector voltage correction (2D)
+table2D_u16_u8 injectorAngleTable; ///< 4 bin injector angle curve (2D)
+table2D_u8_u8 IATDensityCorrectionTable; ///< 9 bin inlet air temperature density correction (2D)
+table2D_u8_u8 baroFuelTable; ///< 8 bin baro correction curve (2D)
+table2D_u8_u8 IATRetardTable; ///< 6 bin ignition adjustment based on inlet air temperature  (2D)
+table2D_u8_u8 idleTargetTable; ///< 10 bin idle target table for idle timing (2D)
+table2D_u8_u8 idleAdvanceTable; ///< 6 bin idle advance adjustment table based on RPM difference  (2D)
+table2D_u8_u8 CLTAdvanceTable; ///< 6 bin ignition adjustment based on coolant temperature  (2D)
+table2D_u8_u8 rotarySplitTable; ///< 8 bin ignition split curve for rotary leading/trailing  (2D)
+table2D_u8_u8 flexFuelTable;  ///< 6 bin flex fuel correction table for fuel adjustments (2D)
+table2D_u8_u8 flexAdvTable;   ///< 6 bin flex fuel correction table for timing advance (2D)
+table2D_s16_u8 flexBoostTable; ///< 6 bin flex fuel correction table for boost adjustments (2D)
+table2D_u8_u8 fuelTempTable;  ///< 6 bin flex fuel correction table for fuel adjustments (2D)
+table2D_u8_u8 knockWindowStartTable;
+table2D_u8_u8 knockWindowDurationTable;
+table2D_u8_u8 oilPressureProtectTable;
+table2D_u8_u8 wmiAdvTable; //6 bin wmi correction table for timing advance (2D)
+table2D_u8_u8 coolantProtectTable;
+table2D_u8_u8 fanPWMTable;
+table2D_u8_s8 rollingCutTable;
 
 /// volatile inj*_pin_port and  inj*_pin_mask vars are for the direct port manipulation of the injectors, coils and aux outputs.
 volatile PORT_TYPE *inj1_pin_port;
@@ -117,11 +119,12 @@ volatile unsigned long ms_counter = 0; //A counter that increments once per ms
 uint16_t fixedCrankingOverride = 0;
 bool clutchTrigger;
 bool previousClutchTrigger;
-volatile uint32_t toothHistory[TOOTH_LOG_SIZE]; ///< Tooth trigger history - delta time (in uS) from last tooth (Indexed by @ref toothHistoryIndex)
-volatile uint8_t compositeLogHistory[TOOTH_LOG_SIZE]; 
+volatile uint32_t toothHistory[TOOTH_LOG_BUFFERS][TOOTH_LOG_SIZE]; ///< Tooth trigger history - delta time (in uS) from last tooth (Indexed by @ref toothHistoryBuffer and @ref toothHistoryIndex)
+volatile uint8_t compositeLogHistory[TOOTH_LOG_BUFFERS][TOOTH_LOG_SIZE]; 
 volatile bool fpPrimed = false; ///< Tracks whether or not the fuel pump priming has been completed yet
 volatile bool injPrimed = false; ///< Tracks whether or not the injectors priming has been completed yet
 volatile unsigned int toothHistoryIndex = 0; ///< Current index to @ref toothHistory array
+volatile uint8_t toothHistoryBuffer = 0; ///< The @ref toothHistory buffer that is currently being filled. The other one is sent once BIT_STATUS1_TOOTHLOG1READY is set
 unsigned long currentLoopTime; /**< The time (in uS) that the current mainloop started */
 volatile uint16_t ignitionCount; /**< The count of ignition events that have taken place since the engine started */
 #if defined(CORE_SAMD21)
@@ -251,13 +254,13 @@ struct config15 configPage15;
 
 uint16_t cltCalibration_bins[32];
 uint16_t cltCalibration_values[32];
-struct table2D cltCalibrationTable;
+table2D_u16_u16 cltCalibrationTable;
 uint16_t iatCalibration_bins[32];
 uint16_t iatCalibration_values[32];
-struct table2D iatCalibrationTable;
+table2D_u16_u16 iatCalibrationTable;
 uint16_t o2Calibration_bins[32];
 uint8_t o2Calibration_values[32];
-struct table2D o2CalibrationTable; 
+table2D_u8_u16 o2CalibrationTable; 
 
 //These function do checks on a pin to determine if it is already in use by another (higher importance) active function
 bool pinIsOutput(byte pin)
@@ -39,6 +39,10 @@
   #endif
   #define CORE_AVR
   #define BOARD_H "board_avr2560.h"
+  #if defined(USE_SCHEDULE_QUEUE) //Fuel 5-8 and ignition 4-8 are multiplexed onto 2 compare units, leaving enough for 8 of each
+    #define INJ_CHANNELS 8
+    #define IGN_CHANNELS 8
+  #endif
   #ifndef INJ_CHANNELS
     #define INJ_CHANNELS 4
   #endif
@@ -208,13 +212,16 @@
 #define VALID_MAP_MAX 1022 //The largest ADC value that is valid for the MAP sensor
 #define VALID_MAP_MIN 2 //The smallest ADC value that is valid for the MAP sensor
 
-#ifndef UNIT_TEST 
+#if defined(TOOTH_LOG_SIZE)
+  //Set by the build (e.g. the comms bench, which needs the full size log while unit testing)
+#elif !defined(UNIT_TEST)
 #define TOOTH_LOG_SIZE      127U
 #else
 #define TOOTH_LOG_SIZE      1U
 #endif
 // Some code relies on TOOTH_LOG_SIZE being uint8_t.
 static_assert(TOOTH_LOG_SIZE<UINT8_MAX, "Check all uses of TOOTH_LOG_SIZE");
+#define TOOTH_LOG_BUFFERS   2U //The tooth logger fills one buffer while the other is sent
 
 #define O2_CALIBRATION_PAGE   2U
 #define IAT_CALIBRATION_PAGE  1U
@@ -409,6 +416,13 @@ This is so we can use an unsigned byte (0-255) to represent temperature ranges f
 #define LOGGER_RATE_4HZ                 1
 #define LOGGER_RATE_10HZ                2
 #define LOGGER_RATE_30HZ                3
+#define LOGGER_RATE_50HZ                4 //Only with the binary format (See onboard_log_fast_rate)
+#define LOGGER_RATE_200HZ               5 //Only with the binary format (See onboard_log_fast_rate)
+#define LOGGER_RATE_CYCLE               6 //Only with the binary format. Crank angle synchronous (See onboard_log_cycle_mode)
+
+#define LOGGER_FAST_RATE_OFF            0
+#define LOGGER_FAST_RATE_50HZ           1
+#define LOGGER_FAST_RATE_200HZ          2
 
 #define LOGGER_FILENAMING_OVERWRITE     0
 #define LOGGER_FILENAMING_DATETIME      1
@@ -442,34 +456,36 @@ extern trimTable3d trim7Table; //6x6 Fuel trim 7 map
 extern trimTable3d trim8Table; //6x6 Fuel trim 8 map
 
 extern struct table3d4RpmLoad dwellTable; //4x4 Dwell map
-extern struct table2D taeTable; //4 bin TPS Acceleration Enrichment map (2D)
-extern struct table2D maeTable;
-extern struct table2D WUETable; //10 bin Warm Up Enrichment map (2D)
-extern struct table2D ASETable; //4 bin After Start Enrichment map (2D)
-extern struct table2D ASECountTable; //4 bin After Start duration map (2D)
-extern struct table2D PrimingPulseTable; //4 bin Priming pulsewidth map (2D)
-extern struct table2D crankingEnrichTable; //4 bin cranking Enrichment map (2D)
-extern struct table2D dwellVCorrectionTable; //6 bin dwell voltage correction (2D)
-extern struct table2D injectorVCorrectionTable; //6 bin injector voltage correction (2D)
-extern struct table2D injectorAngleTable; //4 bin injector timing curve (2D)
-extern struct table2D IATDensityCorrectionTable; //9 bin inlet air temperature density correction (2D)
-extern struct table2D baroFuelTable; //8 bin baro correction curve (2D)
-extern struct table2D IATRetardTable; //6 bin ignition adjustment based on inlet air temperature  (2D)
-extern struct table2D idleTargetTable; //10 bin idle target table for idle timing (2D)
-extern struct table2D idleAdvanceTable; //6 bin idle advance adjustment table based on RPM difference  (2D)
-extern struct table2D CLTAdvanceTable; //6 bin ignition adjustment based on coolant temperature  (2D)
-extern struct table2D rotarySplitTable; //8 bin ignition split curve for rotary leading/trailing  (2D)
-extern struct table2D flexFuelTable;  //6 bin flex fuel correction table for fuel adjustments (2D)
-extern struct table2D flexAdvTable;   //6 bin flex fuel correction table for timing advance (2D)
-extern struct table2D flexBoostTable; //6 bin flex fuel correction table for boost adjustments (2D)
-extern struct table2D fuelTempTable;  //6 bin fuel temperature correction table for fuel adjustments (2D)
-extern struct table2D knockWindowStartTable;
-extern struct table2D knockWindowDurationTable;
-extern struct table2D oilPressureProtectTable;
-extern struct table2D wmiAdvTable; //6 bin wmi correction table for timing advance (2D)
-extern struct table2D coolantProtectTable; //6 bin coolant temperature protection table for engine protection (2D)
-extern struct table2D fanPWMTable;
-extern struct table2D rollingCutTable;
+extern table3DSharedAxisCache rpmLoadAxisCache; //Shared axis search for the 16x16 tables looked up by RPM vs load (fuel, ignition, AFR)
+extern table3DSharedAxisCache trimAxisCache; //Shared axis search for the fuel trim maps
+extern table2D_u8_u8 taeTable; //4 bin TPS Acceleration Enrichment map (2D)
+extern table2D_u8_u8 maeTable;
+extern table2D_u8_u8 WUETable; //10 bin Warm Up Enrichment map (2D)
+extern table2D_u8_u8 ASETable; //4 bin After Start Enrichment map (2D)
+extern table2D_u8_u8 ASECountTable; //4 bin After Start duration map (2D)
+extern table2D_u8_u8 PrimingPulseTable; //4 bin Priming pulsewidth map (2D)
+extern table2D_u8_u8 crankingEnrichTable; //4 bin cranking Enrichment map (2D)
+extern table2D_u8_u8 dwellVCorrectionTable; //6 bin dwell voltage correction (2D)
+extern table2D_u8_u8 injectorVCorrectionTable; //6 bin injector voltage correction (2D)
+extern table2D_u16_u8 injectorAngleTable; //4 bin injector timing curve (2D)
+extern table2D_u8_u8 IATDensityCorrectionTable; //9 bin inlet air temperature density correction (2D)
+extern table2D_u8_u8 baroFuelTable; //8 bin baro correction curve (2D)
+extern table2D_u8_u8 IATRetardTable; //6 bin ignition adjustment based on inlet air temperature  (2D)
+extern table2D_u8_u8 idleTargetTable; //10 bin idle target table for idle timing (2D)
+extern table2D_u8_u8 idleAdvanceTable; //6 bin idle advance adjustment table based on RPM difference  (2D)
+extern table2D_u8_u8 CLTAdvanceTable; //6 bin ignition adjustment based on coolant temperature  (2D)
+extern table2D_u8_u8 rotarySplitTable; //8 bin ignition split curve for rotary leading/trailing  (2D)
+extern table2D_u8_u8 flexFuelTable;  //6 bin flex fuel correction table for fuel adjustments (2D)
+extern table2D_u8_u8 flexAdvTable;   //6 bin flex fuel correction table for timing advance (2D)
+extern table2D_s16_u8 flexBoostTable; //6 bin flex fuel correction table for boost adjustments (2D)
+extern table2D_u8_u8 fuelTempTable;  //6 bin fuel temperature correction table for fuel adjustments (2D)
+extern table2D_u8_u8 knockWindowStartTable;
+extern table2D_u8_u8 knockWindowDurationTable;
+extern table2D_u8_u8 oilPressureProtectTable;
+extern table2D_u8_u8 wmiAdvTable; //6 bin wmi correction table for timing advance (2D)
+extern table2D_u8_u8 coolantProtectTable; //6 bin coolant temperature protection table for engine protection (2D)
+extern table2D_u8_u8 fanPWMTable;
+extern table2D_u8_s8 rollingCutTable;
 
 //These are for the direct port manipulation of the injectors, coils and aux outputs
 extern volatile PORT_TYPE *inj1_pin_port;
@@ -533,9 +549,10 @@ extern uint32_t revolutionTime; //The time in uS that one revolution would take
 extern volatile unsigned long timer5_overflow_count; //Increments every time counter 5 overflows. Used for the fast version of micros()
 extern volatile unsigned long ms_counter; //A counter that increments once per ms
 extern uint16_t fixedCrankingOverride;
-extern volatile uint32_t toothHistory[TOOTH_LOG_SIZE];
-extern volatile uint8_t compositeLogHistory[TOOTH_LOG_SIZE];
+extern volatile uint32_t toothHistory[TOOTH_LOG_BUFFERS][TOOTH_LOG_SIZE];
+extern volatile uint8_t compositeLogHistory[TOOTH_LOG_BUFFERS][TOOTH_LOG_SIZE];
 extern volatile unsigned int toothHistoryIndex;
+extern volatile uint8_t toothHistoryBuffer;
 extern unsigned long currentLoopTime; /**< The time (in uS) that the current mainloop started */
 extern volatile uint16_t ignitionCount; /**< The count of ignition events that have taken place since the engine started */
 //The below shouldn't be needed and probably should be cleaned up, but the Atmel SAM (ARM) boards use a specific type for the trigger edge values rather than a simple byte/int
@@ -683,6 +700,7 @@ struct statuses {
   volatile byte knockCount;
   bool toothLogEnabled;
   byte compositeTriggerUsed; // 0 means composite logger disabled, 2 means use secondary input (1st cam), 3 means use tertiary input (2nd cam), 4 means log both cams together
+  volatile byte toothLogOverruns; ///< Number of tooth/composite log buffers that were discarded because the previous buffer had not been sent yet
   int16_t vvt1Angle; //Has to be a long for PID calcs (CL VVT control)
   byte vvt1TargetAngle;
   long vvt1Duty; //Has to be a long for PID calcs (CL VVT control)
@@ -1115,7 +1133,8 @@ struct config9 {
   uint8_t canoutput_param_start_byte[8];
   byte canoutput_param_num_bytes[8];
 
-  byte unused10_110;
+  byte trigGapPattern : 3;          //Built in pattern used by the gap pattern decoder (See trigger_patterns.h)
+  byte unused10_110 : 5;
   byte unused10_111;
   byte egoMAPMax; //needs to be multiplied by 2 to get the proper value
   byte egoMAPMin; //needs to be multiplied by 2 to get the proper value
@@ -1383,7 +1402,10 @@ struct config13 {
 
   uint16_t candID[8]; ///< Actual CAN ID need 16bits, this is a placeholder
 
-  byte unused12_106_116[10];
+  byte onboard_log_cycle_mode    :2;  // "Off", "Every cycle", "Every N teeth", "INVALID". See cycle_logger.h. Overrides the log rates for binary logs
+  byte unused13_106              :6;
+  byte onboard_log_cycle_teeth;       // Teeth between snapshots when onboard_log_cycle_mode is "Every N teeth"
+  byte unused12_108_116[8];
 
   byte onboard_log_csv_separator :2;  //";", ",", "tab", "space"  
   byte onboard_log_file_style    :2;  // "Disabled", "CSV", "Binary", "INVALID" 
@@ -1405,7 +1427,7 @@ struct config13 {
   byte onboard_log_tr4_thr_on;        // "V",        0.1,   0.0,  0.0,  15.90,      2 ; * (  1 byte)    
   byte onboard_log_tr4_thr_off;       // "V",        0.1,   0.0,  0.0,  15.90,      2 ; * (  1 byte)   
   byte onboard_log_tr5_Epin_pin  :6;        // "pin",      0,    0, 0,  1,    255,        0 ;  
-  byte unused13_125_2            :2;
+  byte onboard_log_fast_rate     :2;  // "Off", "50Hz", "200Hz", "INVALID". Overrides onboard_log_file_rate for binary logs
 
   byte hwTestIgnDuration;
   byte hwTestInjDuration;
@@ -1457,8 +1479,28 @@ struct config15 {
   int8_t rollingProtRPMDelta[4]; // Signed RPM value representing how much below the RPM limit. Divided by 10
   byte rollingProtCutPercent[4];
   
-  //Bytes 106-255
-  byte Unused15_106_255[150];
+  //Bytes 106-218 - User defined CAN broadcast frames (See can_broadcast.h). Signal n belongs to frame n / CAN_TX_USER_SIGNALS
+  uint16_t canTxId[4];          ///< 11 bit CAN ID of each user frame
+  uint16_t canTxPeriod[4];      ///< mS between transmissions of each user frame. 0 = Frame disabled
+  byte canTxBigEndian;          ///< 1 bit per user frame. Signals are sent most significant byte first when set
+  uint8_t canTxSigSource[16];   ///< Live data (TS output channel) offset that each signal is read from
+  uint8_t canTxSigType[16];     ///< CAN_TX_SIGNAL_*. Both the live data and frame format of the signal
+  uint8_t canTxSigByte[16];     ///< First byte of the frame that each signal is written to
+  uint8_t canTxSigMultiply[16];
+  uint8_t canTxSigDivide[16];
+  int8_t canTxSigOffset[16];    ///< Added after the multiply/divide
+
+  //Bytes 219-221 - Crank angle triggered MAP sampling (See map_sampling.h)
+  byte mapAngleSampling : 1;    ///< Take the MAP samples from the decoder at mapSampleAngle, rather than from the main loop. The mapSample method is applied to these samples
+  byte unused15_219 : 7;
+  uint16_t mapSampleAngle;      ///< Degrees after each cylinder's TDC that its MAP sample is taken at
+
+  //Bytes 222-255 - Analog sensor channels (See sensor_channel.h). Indexed by SENSOR_CHANNEL_*
+  byte sensorMode[9];           ///< Bits 0-1: Decimation (1, 2, 4 or 8 samples per reading). Bit 2: Median of 3. Bits 4-7: Consecutive out of range readings before the sensor is faulty (0 = Off)
+  byte sensorFaultLow[9];       ///< Lowest valid reading, ADC / 4. The range check is off when this is not below sensorFaultHigh
+  byte sensorFaultHigh[9];      ///< Highest valid reading, ADC / 4
+  byte ADCFILTER_PSI;           ///< Filter of the fuel and oil pressure sensors
+  byte Unused15_250_255[6];
 
 #if defined(CORE_AVR)
   };
@@ -1572,9 +1614,9 @@ extern uint16_t iatCalibration_bins[32];
 extern uint16_t iatCalibration_values[32];
 extern uint16_t o2Calibration_bins[32];
 extern uint8_t  o2Calibration_values[32]; // Note 8-bit values
-extern struct table2D cltCalibrationTable; /**< A 32 bin array containing the coolant temperature sensor calibration values */
-extern struct table2D iatCalibrationTable; /**< A 32 bin array containing the inlet air temperature sensor calibration values */
-extern struct table2D o2CalibrationTable; /**< A 32 bin array containing the O2 sensor calibration values */
+extern table2D_u16_u16 cltCalibrationTable; /**< A 32 bin array containing the coolant temperature sensor calibration values */
+extern table2D_u16_u16 iatCalibrationTable; /**< A 32 bin array containing the inlet air temperature sensor calibration values */
+extern table2D_u8_u16 o2CalibrationTable; /**< A 32 bin array containing the O2 sensor calibration values */
 
 bool pinIsOutput(byte pin);
 bool pinIsUsed(byte pin);
@@ -7,6 +7,9 @@ A full copy of the license may be found in the projects root directory
 #include "maths.h"
 #include "timers.h"
 #include "src/PID_v1/PID_v1.h"
+#include "pages.h"
+#include "page_crc.h"
+#include "storage.h"
 
 #define STEPPER_LESS_AIR_DIRECTION() ((configPage9.iacStepperInv == 0) ? STEPPER_BACKWARD : STEPPER_FORWARD)
 #define STEPPER_MORE_AIR_DIRECTION() ((configPage9.iacStepperInv == 0) ? STEPPER_FORWARD : STEPPER_BACKWARD)
@@ -39,11 +42,11 @@ volatile PINMASK_TYPE idle2_pin_mask;
 volatile PORT_TYPE *idleUpOutput_pin_port;
 volatile PINMASK_TYPE idleUpOutput_pin_mask;
 
-struct table2D iacPWMTable;
-struct table2D iacStepTable;
+table2D_u8_u8 iacPWMTable;
+table2D_u8_u8 iacStepTable;
 //Open loop tables specifically for cranking
-struct table2D iacCrankStepsTable;
-struct table2D iacCrankDutyTable;
+table2D_u8_u8 iacCrankStepsTable;
+table2D_u8_u8 iacCrankDutyTable;
 
 /*
 These functions cover the PWM and stepper idle control
@@ -71,6 +74,8 @@ static inline void enableIdle(void)
 
 void initialiseIdle(bool forcehoming)
 {
+  const bool iacPWMrunBefore = configPage6.iacPWMrun;
+
   //By default, turn off the PWM interrupt (It gets turned on below if needed)
   IDLE_TIMER_DISABLE();
 
@@ -98,18 +103,10 @@ void initialiseIdle(bool forcehoming)
 
     case IAC_ALGORITHM_PWM_OL:
       //Case 2 is PWM open loop
-      iacPWMTable.xSize = 10;
-      iacPWMTable.valueSize = SIZE_BYTE;
-      iacPWMTable.axisSize = SIZE_BYTE;
-      iacPWMTable.values = configPage6.iacOLPWMVal;
-      iacPWMTable.axisX = configPage6.iacBins;
+      construct2dTable(iacPWMTable, 10, configPage6.iacOLPWMVal, configPage6.iacBins);
 
 
-      iacCrankDutyTable.xSize = 4;
-      iacCrankDutyTable.valueSize = SIZE_BYTE;
-      iacCrankDutyTable.axisSize = SIZE_BYTE;
-      iacCrankDutyTable.values = configPage6.iacCrankDuty;
-      iacCrankDutyTable.axisX = configPage6.iacCrankBins;
+      construct2dTable(iacCrankDutyTable, 4, configPage6.iacCrankDuty, configPage6.iacCrankBins);
 
       #if defined(CORE_AVR)
         idle_pwm_max_count = (uint16_t)(MICROS_PER_SEC / (16U * configPage6.idleFreq * 2U)); //Converts the frequency in Hz to the number of ticks (at 16uS) it takes to complete 1 cycle. Note that the frequency is divided by 2 coming from TS to allow for up to 512hz
@@ -123,17 +120,9 @@ void initialiseIdle(bool forcehoming)
 
     case IAC_ALGORITHM_PWM_OLCL:
       //Case 6 is PWM closed loop with open loop table used as feed forward
-      iacPWMTable.xSize = 10;
-      iacPWMTable.valueSize = SIZE_BYTE;
-      iacPWMTable.axisSize = SIZE_BYTE;
-      iacPWMTable.values = configPage6.iacOLPWMVal;
-      iacPWMTable.axisX = configPage6.iacBins;
-
-      iacCrankDutyTable.xSize = 4;
-      iacCrankDutyTable.valueSize = SIZE_BYTE;
-      iacCrankDutyTable.axisSize = SIZE_BYTE;
-      iacCrankDutyTable.values = configPage6.iacCrankDuty;
-      iacCrankDutyTable.axisX = configPage6.iacCrankBins;
+      construct2dTable(iacPWMTable, 10, configPage6.iacOLPWMVal, configPage6.iacBins);
+
+      construct2dTable(iacCrankDutyTable, 4, configPage6.iacCrankDuty, configPage6.iacCrankBins);
 
       #if defined(CORE_AVR)
         idle_pwm_max_count = (uint16_t)(MICROS_PER_SEC / (16U * configPage6.idleFreq * 2U)); //Converts the frequency in Hz to the number of ticks (at 16uS) it takes to complete 1 cycle. Note that the frequency is divided by 2 coming from TS to allow for up to 512hz
@@ -153,11 +142,7 @@ void initialiseIdle(bool forcehoming)
 
     case IAC_ALGORITHM_PWM_CL:
       //Case 3 is PWM closed loop
-      iacCrankDutyTable.xSize = 4;
-      iacCrankDutyTable.valueSize = SIZE_BYTE;
-      iacCrankDutyTable.axisSize = SIZE_BYTE;
-      iacCrankDutyTable.values = configPage6.iacCrankDuty;
-      iacCrankDutyTable.axisX = configPage6.iacCrankBins;
+      construct2dTable(iacCrankDutyTable, 4, configPage6.iacCrankDuty, configPage6.iacCrankBins);
 
       #if defined(CORE_AVR)
         idle_pwm_max_count = (uint16_t)(MICROS_PER_SEC / (16U * configPage6.idleFreq * 2U)); //Converts the frequency in Hz to the number of ticks (at 16uS) it takes to complete 1 cycle. Note that the frequency is divided by 2 coming from TS to allow for up to 512hz
@@ -177,17 +162,9 @@ void initialiseIdle(bool forcehoming)
 
     case IAC_ALGORITHM_STEP_OL:
       //Case 2 is Stepper open loop
-      iacStepTable.xSize = 10;
-      iacStepTable.valueSize = SIZE_BYTE;
-      iacStepTable.axisSize = SIZE_BYTE;
-      iacStepTable.values = configPage6.iacOLStepVal;
-      iacStepTable.axisX = configPage6.iacBins;
-
-      iacCrankStepsTable.xSize = 4;
-      iacCrankStepsTable.valueSize = SIZE_BYTE;
-      iacCrankStepsTable.axisSize = SIZE_BYTE;
-      iacCrankStepsTable.values = configPage6.iacCrankSteps;
-      iacCrankStepsTable.axisX = configPage6.iacCrankBins;
+      construct2dTable(iacStepTable, 10, configPage6.iacOLStepVal, configPage6.iacBins);
+
+      construct2dTable(iacCrankStepsTable, 4, configPage6.iacCrankSteps, configPage6.iacCrankBins);
       iacStepTime_uS = configPage6.iacStepTime * 1000;
       iacCoolTime_uS = configPage9.iacCoolTime * 1000;
 
@@ -204,11 +181,7 @@ void initialiseIdle(bool forcehoming)
 
     case IAC_ALGORITHM_STEP_CL:
       //Case 5 is Stepper closed loop
-      iacCrankStepsTable.xSize = 4;
-      iacCrankStepsTable.valueSize = SIZE_BYTE;
-      iacCrankStepsTable.axisSize = SIZE_BYTE;
-      iacCrankStepsTable.values = configPage6.iacCrankSteps;
-      iacCrankStepsTable.axisX = configPage6.iacCrankBins;
+      construct2dTable(iacCrankStepsTable, 4, configPage6.iacCrankSteps, configPage6.iacCrankBins);
       iacStepTime_uS = configPage6.iacStepTime * 1000;
       iacCoolTime_uS = configPage9.iacCoolTime * 1000;
 
@@ -231,17 +204,9 @@ void initialiseIdle(bool forcehoming)
 
     case IAC_ALGORITHM_STEP_OLCL:
       //Case 7 is Stepper closed loop with open loop table used as feed forward
-      iacStepTable.xSize = 10;
-      iacStepTable.valueSize = SIZE_BYTE;
-      iacStepTable.axisSize = SIZE_BYTE;
-      iacStepTable.values = configPage6.iacOLStepVal;
-      iacStepTable.axisX = configPage6.iacBins;
-
-      iacCrankStepsTable.xSize = 4;
-      iacCrankStepsTable.valueSize = SIZE_BYTE;
-      iacCrankStepsTable.axisSize = SIZE_BYTE;
-      iacCrankStepsTable.values = configPage6.iacCrankSteps;
-      iacCrankStepsTable.axisX = configPage6.iacCrankBins;
+      construct2dTable(iacStepTable, 10, configPage6.iacOLStepVal, configPage6.iacBins);
+
+      construct2dTable(iacCrankStepsTable, 4, configPage6.iacCrankSteps, configPage6.iacCrankBins);
       iacStepTime_uS = configPage6.iacStepTime * 1000;
       iacCoolTime_uS = configPage9.iacCoolTime * 1000;
 
@@ -271,6 +236,12 @@ void initialiseIdle(bool forcehoming)
 
   idleInitComplete = configPage6.iacAlgorithm; //Sets which idle method was initialised
   currentStatus.idleLoad = 0;
+  if(configPage6.iacPWMrun != iacPWMrunBefore)
+  {
+    //The stepper modes clear configPage6.iacPWMrun
+    invalidatePageCRC32(afrSetPage);
+    markConfigDirty(afrSetPage, &configPage6.boostKD + 1U, 1U); //The byte holding the iacPWMrun bitfield
+  }
 }
 
 void initialiseIdleUpOutput(void)
@@ -21,6 +21,9 @@
 #include "idle.h"
 #include "table2d.h"
 #include "acc_mc33810.h"
+#include "pages.h"
+#include "page_crc.h"
+#include "cycle_logger.h"
 #include BOARD_H //Note that this is not a real file, it is defined in globals.h. 
 #if defined(EEPROM_RESET_PIN)
   #include EEPROM_LIB_H
@@ -1242,6 +1245,7 @@ void initialiseAll(void)
        tachoSweepIncr is also the number of tach pulses per second */
     tachoSweepIncr = configPage2.tachoSweepMaxRPM * maxIgnOutputs * 5 / 3;
     
+    invalidateAllPageCRC32(); //Some of the initialisation above corrects values in the config pages
     currentStatus.initialisationComplete = true;
     digitalWrite(LED_BUILTIN, HIGH);
 
@@ -3131,6 +3135,7 @@ void initialiseTriggers(void)
   primaryTriggerEdge = 0; //This should ALWAYS be changed below
   secondaryTriggerEdge = 0; //This is optional and may not be changed below, depending on the decoder in use
   tertiaryTriggerEdge = 0; //This is even more optional and may not be changed below, depending on the decoder in use
+  clearInjectorStartTeeth(); //Per tooth injection timing is only enabled by the decoders that support it
 
   //Set the trigger function based on the decoder in the config
   switch (configPage4.TrigPattern)
@@ -3153,10 +3158,10 @@ void initialiseTriggers(void)
       if(configPage10.TrigEdgeThrd == 0) { tertiaryTriggerEdge = RISING; }
       else { tertiaryTriggerEdge = FALLING; }
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
 
-      if(BIT_CHECK(decoderState, BIT_DECODER_HAS_SECONDARY)) { attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge); }
-      if(configPage10.vvt2Enabled > 0) { attachInterrupt(triggerInterrupt3, triggerTertiaryHandler, tertiaryTriggerEdge); } // we only need this for vvt2, so not really needed if it's not used
+      if(BIT_CHECK(decoderState, BIT_DECODER_HAS_SECONDARY)) { attachInterrupt(triggerInterrupt2, SECONDARY_TRIGGER_ISR, secondaryTriggerEdge); }
+      if(configPage10.vvt2Enabled > 0) { attachInterrupt(triggerInterrupt3, TERTIARY_TRIGGER_ISR, tertiaryTriggerEdge); } // we only need this for vvt2, so not really needed if it's not used
 
       break;
 
@@ -3171,7 +3176,7 @@ void initialiseTriggers(void)
       if(configPage4.TrigEdge == 0) { primaryTriggerEdge = RISING; } // Attach the crank trigger wheel interrupt (Hall sensor drags to ground when triggering)
       else { primaryTriggerEdge = FALLING; }
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       break;
 
     case 2:
@@ -3187,8 +3192,8 @@ void initialiseTriggers(void)
       if(configPage4.TrigEdgeSec == 0) { secondaryTriggerEdge = RISING; }
       else { secondaryTriggerEdge = FALLING; }
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
-      attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt2, SECONDARY_TRIGGER_ISR, secondaryTriggerEdge);
       break;
 
     case DECODER_GM7X:
@@ -3198,13 +3203,13 @@ void initialiseTriggers(void)
       getCrankAngle = getCrankAngle_GM7X;
       triggerSetEndTeeth = triggerSetEndTeeth_GM7X;
 
-      if(configPage4.TrigEdge == 0) { attachInterrupt(triggerInterrupt, triggerHandler, RISING); } // Attach the crank trigger wheel interrupt (Hall sensor drags to ground when triggering)
-      else { attachInterrupt(triggerInterrupt, triggerHandler, FALLING); }
+      if(configPage4.TrigEdge == 0) { attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, RISING); } // Attach the crank trigger wheel interrupt (Hall sensor drags to ground when triggering)
+      else { attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, FALLING); }
 
       if(configPage4.TrigEdge == 0) { primaryTriggerEdge = RISING; } // Attach the crank trigger wheel interrupt (Hall sensor drags to ground when triggering)
       else { primaryTriggerEdge = FALLING; }
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       break;
 
     case DECODER_4G63:
@@ -3218,8 +3223,8 @@ void initialiseTriggers(void)
       primaryTriggerEdge = CHANGE;
       secondaryTriggerEdge = FALLING;
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
-      attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt2, SECONDARY_TRIGGER_ISR, secondaryTriggerEdge);
       break;
 
     case DECODER_24X:
@@ -3234,8 +3239,8 @@ void initialiseTriggers(void)
       else { primaryTriggerEdge = FALLING; }
       secondaryTriggerEdge = CHANGE; //Secondary is always on every change
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
-      attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt2, SECONDARY_TRIGGER_ISR, secondaryTriggerEdge);
       break;
 
     case DECODER_JEEP2000:
@@ -3250,8 +3255,8 @@ void initialiseTriggers(void)
       else { primaryTriggerEdge = FALLING; }
       secondaryTriggerEdge = CHANGE;
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
-      attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt2, SECONDARY_TRIGGER_ISR, secondaryTriggerEdge);
       break;
 
     case DECODER_AUDI135:
@@ -3266,8 +3271,8 @@ void initialiseTriggers(void)
       else { primaryTriggerEdge = FALLING; }
       secondaryTriggerEdge = RISING; //always rising for this trigger
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
-      attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt2, SECONDARY_TRIGGER_ISR, secondaryTriggerEdge);
       break;
 
     case DECODER_HONDA_D17:
@@ -3282,8 +3287,8 @@ void initialiseTriggers(void)
       else { primaryTriggerEdge = FALLING; }
       secondaryTriggerEdge = CHANGE;
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
-      attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt2, SECONDARY_TRIGGER_ISR, secondaryTriggerEdge);
       break;
 
     case DECODER_HONDA_J32:
@@ -3297,8 +3302,8 @@ void initialiseTriggers(void)
       primaryTriggerEdge = RISING; // Don't honor the config, always use rising edge 
       secondaryTriggerEdge = RISING; // Unused
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
-      attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);  // Suspect this line is not needed
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt2, SECONDARY_TRIGGER_ISR, secondaryTriggerEdge);  // Suspect this line is not needed
       break;
 
     case DECODER_MIATA_9905:
@@ -3315,8 +3320,8 @@ void initialiseTriggers(void)
       if(configPage4.TrigEdgeSec == 0) { secondaryTriggerEdge = RISING; }
       else { secondaryTriggerEdge = FALLING; }
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
-      attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt2, SECONDARY_TRIGGER_ISR, secondaryTriggerEdge);
       break;
 
     case DECODER_MAZDA_AU:
@@ -3331,8 +3336,8 @@ void initialiseTriggers(void)
       else { primaryTriggerEdge = FALLING; }
       secondaryTriggerEdge = FALLING;
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
-      attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt2, SECONDARY_TRIGGER_ISR, secondaryTriggerEdge);
       break;
 
     case DECODER_NON360:
@@ -3347,8 +3352,8 @@ void initialiseTriggers(void)
       else { primaryTriggerEdge = FALLING; }
       secondaryTriggerEdge = FALLING;
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
-      attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt2, SECONDARY_TRIGGER_ISR, secondaryTriggerEdge);
       break;
 
     case DECODER_NISSAN_360:
@@ -3363,8 +3368,8 @@ void initialiseTriggers(void)
       else { primaryTriggerEdge = FALLING; }
       secondaryTriggerEdge = CHANGE;
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
-      attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt2, SECONDARY_TRIGGER_ISR, secondaryTriggerEdge);
       break;
 
     case DECODER_SUBARU_67:
@@ -3379,8 +3384,8 @@ void initialiseTriggers(void)
       else { primaryTriggerEdge = FALLING; }
       secondaryTriggerEdge = FALLING;
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
-      attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt2, SECONDARY_TRIGGER_ISR, secondaryTriggerEdge);
       break;
 
     case DECODER_DAIHATSU_PLUS1:
@@ -3394,7 +3399,7 @@ void initialiseTriggers(void)
       if(configPage4.TrigEdge == 0) { primaryTriggerEdge = RISING; } // Attach the crank trigger wheel interrupt (Hall sensor drags to ground when triggering)
       else { primaryTriggerEdge = FALLING; }
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       break;
 
     case DECODER_HARLEY:
@@ -3406,7 +3411,7 @@ void initialiseTriggers(void)
       triggerSetEndTeeth = triggerSetEndTeeth_Harley;
 
       primaryTriggerEdge = RISING; //Always rising
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       break;
 
     case DECODER_36_2_2_2:
@@ -3423,8 +3428,8 @@ void initialiseTriggers(void)
       if(configPage4.TrigEdgeSec == 0) { secondaryTriggerEdge = RISING; }
       else { secondaryTriggerEdge = FALLING; }
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
-      attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt2, SECONDARY_TRIGGER_ISR, secondaryTriggerEdge);
       break;
 
     case DECODER_36_2_1:
@@ -3441,8 +3446,8 @@ void initialiseTriggers(void)
       if(configPage4.TrigEdgeSec == 0) { secondaryTriggerEdge = RISING; }
       else { secondaryTriggerEdge = FALLING; }
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
-      attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt2, SECONDARY_TRIGGER_ISR, secondaryTriggerEdge);
       break;
 
     case DECODER_420A:
@@ -3458,8 +3463,8 @@ void initialiseTriggers(void)
       else { primaryTriggerEdge = FALLING; }
       secondaryTriggerEdge = FALLING; //Always falling edge
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
-      attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt2, SECONDARY_TRIGGER_ISR, secondaryTriggerEdge);
       break;
 
     case DECODER_WEBER:
@@ -3476,8 +3481,8 @@ void initialiseTriggers(void)
       if(configPage4.TrigEdgeSec == 0) { secondaryTriggerEdge = RISING; }
       else { secondaryTriggerEdge = FALLING; }
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
-      attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt2, SECONDARY_TRIGGER_ISR, secondaryTriggerEdge);
       break;
 
     case DECODER_ST170:
@@ -3494,8 +3499,8 @@ void initialiseTriggers(void)
       if(configPage4.TrigEdgeSec == 0) { secondaryTriggerEdge = RISING; }
       else { secondaryTriggerEdge = FALLING; }
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
-      attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt2, SECONDARY_TRIGGER_ISR, secondaryTriggerEdge);
 
       break;
 	  
@@ -3512,8 +3517,8 @@ void initialiseTriggers(void)
       if(configPage4.TrigEdgeSec == 0) { secondaryTriggerEdge = RISING; }
       else { secondaryTriggerEdge = FALLING; }
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
-      attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt2, SECONDARY_TRIGGER_ISR, secondaryTriggerEdge);
       break;
 
     case DECODER_NGC:
@@ -3534,8 +3539,8 @@ void initialiseTriggers(void)
         secondaryTriggerEdge = FALLING;
       }
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
-      attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt2, SECONDARY_TRIGGER_ISR, secondaryTriggerEdge);
       break;
 
     case DECODER_VMAX:
@@ -3548,7 +3553,7 @@ void initialiseTriggers(void)
       if(configPage4.TrigEdge == 0) { primaryTriggerEdge = true; } // set as boolean so we can directly use it in decoder.
       else { primaryTriggerEdge = false; }
       
-      attachInterrupt(triggerInterrupt, triggerHandler, CHANGE); //Hardcoded change, the primaryTriggerEdge will be used in the decoder to select if it`s an inverted or non-inverted signal.
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, CHANGE); //Hardcoded change, the primaryTriggerEdge will be used in the decoder to select if it`s an inverted or non-inverted signal.
       break;
 
     case DECODER_RENIX:
@@ -3564,7 +3569,7 @@ void initialiseTriggers(void)
       if(configPage4.TrigEdgeSec == 0) { secondaryTriggerEdge = RISING; }
       else { secondaryTriggerEdge = FALLING; }
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       break;
 
     case DECODER_ROVERMEMS:
@@ -3582,8 +3587,8 @@ void initialiseTriggers(void)
       if(configPage4.TrigEdgeSec == 0) { secondaryTriggerEdge = RISING; }
       else { secondaryTriggerEdge = FALLING; }
       
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
-      attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt2, SECONDARY_TRIGGER_ISR, secondaryTriggerEdge);
       break;   
 
     case DECODER_SUZUKI_K6A:
@@ -3597,7 +3602,24 @@ void initialiseTriggers(void)
       if(configPage4.TrigEdge == 0) { primaryTriggerEdge = RISING; } // Attach the crank trigger wheel interrupt (Hall sensor drags to ground when triggering)
       else { primaryTriggerEdge = FALLING; }
       
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
+      break;
+
+    case DECODER_GAP_PATTERN:
+      triggerSetup_GapPattern();
+      triggerHandler = triggerPri_GapPattern;
+      triggerSecondaryHandler = triggerSec_GapPattern;
+      getRPM = getRPM_GapPattern;
+      getCrankAngle = getCrankAngle_GapPattern;
+      triggerSetEndTeeth = triggerSetEndTeeth_GapPattern;
+
+      if(configPage4.TrigEdge == 0) { primaryTriggerEdge = RISING; } // Attach the crank trigger wheel interrupt (Hall sensor drags to ground when triggering)
+      else { primaryTriggerEdge = FALLING; }
+      if(configPage4.TrigEdgeSec == 0) { secondaryTriggerEdge = RISING; }
+      else { secondaryTriggerEdge = FALLING; }
+
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt2, SECONDARY_TRIGGER_ISR, secondaryTriggerEdge);
       break;
 
 
@@ -3606,15 +3628,32 @@ void initialiseTriggers(void)
       getRPM = getRPM_missingTooth;
       getCrankAngle = getCrankAngle_missingTooth;
 
-      if(configPage4.TrigEdge == 0) { attachInterrupt(triggerInterrupt, triggerHandler, RISING); } // Attach the crank trigger wheel interrupt (Hall sensor drags to ground when triggering)
-      else { attachInterrupt(triggerInterrupt, triggerHandler, FALLING); }
+      if(configPage4.TrigEdge == 0) { primaryTriggerEdge = RISING; } // Attach the crank trigger wheel interrupt (Hall sensor drags to ground when triggering)
+      else { primaryTriggerEdge = FALLING; }
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       break;
   }
 
+  //This also runs on every loop while the engine is stalled. A cycle log started at key on, or running through the stall, must keep its interrupt
+  if(isCycleLogActive() == true)
+  {
+    detachInterrupt(triggerInterrupt);
+    attachInterrupt(triggerInterrupt, cycleLogPrimaryISR, primaryTriggerEdge);
+  }
+
   #if defined(CORE_TEENSY41)
     //Teensy 4 requires a HYSTERESIS flag to be set on the trigger pins to prevent false interrupts
     setTriggerHysteresis();
   #endif
+
+  #if defined(TRIGGER_CAPTURE_AVAILABLE)
+    //Latch the time of each trigger edge in hardware, where the pin supports it
+    initTriggerCapture(TRIGGER_INPUT_PRIMARY, pinTrigger, primaryTriggerEdge);
+    initTriggerCapture(TRIGGER_INPUT_SECONDARY, pinTrigger2, secondaryTriggerEdge);
+    initTriggerCapture(TRIGGER_INPUT_TERTIARY, pinTrigger3, tertiaryTriggerEdge);
+  #endif
+
+  invalidatePageCRC32(ignSetPage); //Some decoders force their own settings in configPage4
 }
 
 static inline bool isAnyFuelScheduleRunning(void) {
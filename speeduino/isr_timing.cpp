@@ -0,0 +1,77 @@
+/** @file
+ * ISR execution time statistics. See isr_timing.h
+ */
+#include "isr_timing.h"
+
+#if defined(ISR_TIMING)
+
+static volatile isrTimingStats isrStats[ISR_TIMING_COUNT];
+
+/** Add the duration of a single ISR call to the statistics for that ISR.
+ * Called at the end of the ISR itself. Each ISR only ever writes to its own entry, so no locking is needed here.
+ * Note that the duration of the 1ms ISR includes any interrupts that ran while it was executing as it does not block.
+ */
+void recordIsrTiming(uint8_t id, uint32_t duration)
+{
+  volatile isrTimingStats &stats = isrStats[id];
+  uint16_t clampedDuration = (duration > UINT16_MAX) ? UINT16_MAX : (uint16_t)duration;
+
+  if( (stats.count == 0U) || (clampedDuration < stats.min) ) { stats.min = clampedDuration; }
+  if(clampedDuration > stats.max) { stats.max = clampedDuration; }
+  stats.count++;
+  stats.total += clampedDuration;
+
+  uint8_t bucket = 0U;
+  while( (clampedDuration > 0U) && (bucket < (ISR_TIMING_BUCKETS - 1U)) )
+  {
+    clampedDuration = clampedDuration >> 1U;
+    bucket++;
+  }
+  if(stats.buckets[bucket] < UINT16_MAX) { stats.buckets[bucket]++; }
+}
+
+void resetIsrTiming(void)
+{
+  noInterrupts();
+  memset((void*)isrStats, 0, sizeof(isrStats));
+  interrupts();
+}
+
+static inline byte* writeLE(byte *buffer, uint16_t value)
+{
+  buffer[0] = lowByte(value);
+  buffer[1] = highByte(value);
+  return buffer + 2U;
+}
+
+/** Copy the statistics for one ISR into a buffer for sending over serial.
+ * The record is (All values little endian): <ISR index> <number of ISRs> <count:4> <min:2> <max:2> <mean:2> <bucket:2 x ISR_TIMING_BUCKETS>
+ * @return The number of bytes written (ISR_TIMING_RECORD_SIZE)
+ */
+uint16_t loadIsrTimingStats(uint8_t id, byte *buffer)
+{
+  isrTimingStats stats;
+  noInterrupts();
+  memcpy(&stats, (const void*)&isrStats[id], sizeof(stats));
+  interrupts();
+
+  uint16_t mean = 0U;
+  if(stats.count > 0U) { mean = (uint16_t)(stats.total / stats.count); }
+
+  byte *pWrite = buffer;
+  *pWrite++ = id;
+  *pWrite++ = (byte)ISR_TIMING_COUNT;
+  pWrite = writeLE(pWrite, (uint16_t)(stats.count & 0xFFFFU));
+  pWrite = writeLE(pWrite, (uint16_t)(stats.count >> 16U));
+  pWrite = writeLE(pWrite, stats.min);
+  pWrite = writeLE(pWrite, stats.max);
+  pWrite = writeLE(pWrite, mean);
+  for(uint8_t bucket = 0U; bucket < ISR_TIMING_BUCKETS; bucket++)
+  {
+    pWrite = writeLE(pWrite, stats.buckets[bucket]);
+  }
+
+  return (uint16_t)(pWrite - buffer);
+}
+
+#endif
@@ -0,0 +1,55 @@
+/** @file
+ * Execution time statistics for the time critical interrupts (Trigger, fuel/ignition schedules and the 1ms timer).
+ *
+ * Each instrumented ISR records the time between its entry and exit. Per ISR the minimum, maximum and mean
+ * are kept along with a histogram of the durations in log2 sized buckets. The statistics are sent to the tuning
+ * software via the 'i' serial command and are used to find which ISR is starving the others at high RPM.
+ *
+ * The instrumentation is only compiled in when ISR_TIMING is defined (Eg -DISR_TIMING in the build flags).
+ * Otherwise the macros below are empty and there is no RAM or time cost.
+ */
+#ifndef ISR_TIMING_H
+#define ISR_TIMING_H
+
+#include "globals.h"
+
+#define ISR_TIMING_BUCKETS  10U //Bucket 0 is 0uS, bucket n is [2^(n-1), 2^n) uS. The last bucket holds everything >= 256uS
+
+/** Index of each instrumented ISR. The number of schedule entries follows the channel count of the build */
+#define ISR_TIMING_TRIGGER_PRI  0U
+#define ISR_TIMING_TRIGGER_SEC  1U
+#define ISR_TIMING_TRIGGER_TER  2U
+#define ISR_TIMING_FUEL1        3U
+#define ISR_TIMING_IGN1         (ISR_TIMING_FUEL1 + INJ_CHANNELS)
+#define ISR_TIMING_1MS          (ISR_TIMING_IGN1 + IGN_CHANNELS)
+#define ISR_TIMING_COUNT        (ISR_TIMING_1MS + 1U)
+
+struct isrTimingStats
+{
+  uint32_t count;     ///< Number of times the ISR has run
+  uint32_t total;     ///< Sum of all durations (uS). Used for the mean
+  uint16_t min;       ///< Shortest duration (uS)
+  uint16_t max;       ///< Longest duration (uS)
+  uint16_t buckets[ISR_TIMING_BUCKETS]; ///< Log2 histogram of the durations. Saturates at 65535
+};
+
+#if defined(ISR_TIMING)
+
+  #define ISR_TIMING_START()    uint32_t isrTimingStartTime = micros()
+  #define ISR_TIMING_END(id)    recordIsrTiming((id), micros() - isrTimingStartTime)
+
+  /** Size of the isrTimingStats record sent by ::loadIsrTimingStats() */
+  #define ISR_TIMING_RECORD_SIZE  (2U + 4U + 2U + 2U + 2U + (2U * ISR_TIMING_BUCKETS))
+
+  void recordIsrTiming(uint8_t id, uint32_t duration);
+  void resetIsrTiming(void);
+  uint16_t loadIsrTimingStats(uint8_t id, byte *buffer);
+
+#else
+
+  #define ISR_TIMING_START()
+  #define ISR_TIMING_END(id)
+
+#endif
+
+#endif // ISR_TIMING_H
@@ -5,181 +5,264 @@
 #include "init.h"
 #include "maths.h"
 #include "utilities.h"
+#include "cycle_logger.h"
+#include <stddef.h>
 #include BOARD_H 
 
-/** 
- * Returns a numbered byte-field (partial field in case of multi-byte fields) from "current status" structure in the format expected by TunerStudio
- * Notes on fields:
- * - Numbered field will be fields from @ref currentStatus, but not at all in the internal order of strct (e.g. field RPM value, number 14 will be
- *   2nd field in struct)
- * - The fields stored in multi-byte types will be accessed lowbyte and highbyte separately (e.g. PW1 will be broken into numbered byte-fields 75,76)
- * - Values have the value offsets and shifts expected by TunerStudio. They will not all be a 'human readable value'
- * @param byteNum - byte-Field number. This is not the entry number (As some entries have multiple byets), but the byte number that is needed
- * @return Field value in 1 byte size struct fields or 1 byte partial value (chunk) on multibyte fields.
+/** @name Live data channel formats
+ * How each channel of the TunerStudio live data packet is produced from @ref currentStatus
+ * @{
  */
-byte getTSLogEntry(uint16_t byteNum)
+#define LOG_FORMAT_U8             0U  ///< 1 byte copied from the field (The low byte if the field is larger)
+#define LOG_FORMAT_U16            1U  ///< 2 bytes copied from the field, low byte first (The low 2 bytes if the field is larger)
+#define LOG_FORMAT_TEMP16         2U  ///< 1 byte. 16 bit (Or larger) temperature plus CALIBRATION_TEMPERATURE_OFFSET
+#define LOG_FORMAT_TEMP8          3U  ///< 1 byte. 8 bit temperature plus CALIBRATION_TEMPERATURE_OFFSET
+#define LOG_FORMAT_HALF16         4U  ///< 1 byte. 16 bit field divided by 2
+#define LOG_FORMAT_DIV100_16      5U  ///< 1 byte. 16 bit field divided by 100
+#define LOG_FORMAT_LOOPS          6U  ///< 2 bytes. loopsPerSecond, limited to 60000
+#define LOG_FORMAT_FREE_RAM       7U  ///< 2 bytes. The current free RAM (Also updates currentStatus.freeRAM)
+#define LOG_FORMAT_ERROR          8U  ///< 1 byte. The next error code (See getNextError())
+/** @} */
+
+/** @brief One channel of the live data packet */
+struct logChannel {
+  uint8_t logByte;        ///< Position of the first byte of the channel in the packet
+  uint8_t format;         ///< One of the LOG_FORMAT_* values
+  uint16_t statusOffset;  ///< Offset of the field in currentStatus. Unused by the calculated formats
+};
+
+#define LOG_FIELD(logByte, format, field) { (logByte), (format), (uint16_t)offsetof(statuses, field) }
+#define LOG_CALCULATED(logByte, format)   { (logByte), (format), 0U }
+
+/** The TunerStudio live data packet, in packet order. This MUST match the [OutputChannels] section of the ini file */
+static constexpr logChannel PROGMEM logChannels[] = {
+  LOG_FIELD(0, LOG_FORMAT_U8, secl), //secl is simply a counter that increments each second. Used to track unexpected resets (Which will reset this count to 0)
+  LOG_FIELD(1, LOG_FORMAT_U8, status1), //status1 Bitfield
+  LOG_FIELD(2, LOG_FORMAT_U8, engine), //Engine Status Bitfield
+  LOG_FIELD(3, LOG_FORMAT_U8, syncLossCounter),
+  LOG_FIELD(4, LOG_FORMAT_U16, MAP), //2 bytes for MAP
+  LOG_FIELD(6, LOG_FORMAT_TEMP16, IAT), //mat
+  LOG_FIELD(7, LOG_FORMAT_TEMP16, coolant), //Coolant ADC
+  LOG_FIELD(8, LOG_FORMAT_U8, batCorrection), //Battery voltage correction (%)
+  LOG_FIELD(9, LOG_FORMAT_U8, battery10), //battery voltage
+  LOG_FIELD(10, LOG_FORMAT_U8, O2), //O2
+  LOG_FIELD(11, LOG_FORMAT_U8, egoCorrection), //Exhaust gas correction (%)
+  LOG_FIELD(12, LOG_FORMAT_U8, iatCorrection), //Air temperature Correction (%)
+  LOG_FIELD(13, LOG_FORMAT_U8, wueCorrection), //Warmup enrichment (%)
+  LOG_FIELD(14, LOG_FORMAT_U16, RPM), //rpm
+  LOG_FIELD(16, LOG_FORMAT_HALF16, AEamount), //TPS acceleration enrichment (%) divided by 2 (Can exceed 255)
+  LOG_FIELD(17, LOG_FORMAT_U16, corrections), //Total GammaE (%)
+  LOG_FIELD(19, LOG_FORMAT_U8, VE1), //VE 1 (%)
+  LOG_FIELD(20, LOG_FORMAT_U8, VE2), //VE 2 (%)
+  LOG_FIELD(21, LOG_FORMAT_U8, afrTarget),
+  LOG_FIELD(22, LOG_FORMAT_U16, tpsDOT), //TPS DOT
+  LOG_FIELD(24, LOG_FORMAT_U8, advance),
+  LOG_FIELD(25, LOG_FORMAT_U8, TPS), // TPS (0% to 100%)
+  LOG_CALCULATED(26, LOG_FORMAT_LOOPS),
+  LOG_CALCULATED(28, LOG_FORMAT_FREE_RAM),
+  LOG_FIELD(30, LOG_FORMAT_HALF16, boostTarget), //Divide boost target by 2 to fit in a byte
+  LOG_FIELD(31, LOG_FORMAT_DIV100_16, boostDuty),
+  LOG_FIELD(32, LOG_FORMAT_U8, status2), //Spark related bitfield
+  LOG_FIELD(33, LOG_FORMAT_U16, rpmDOT), //rpmDOT must be sent as a signed integer
+  LOG_FIELD(35, LOG_FORMAT_U8, ethanolPct), //Flex sensor value (or 0 if not used)
+  LOG_FIELD(36, LOG_FORMAT_U8, flexCorrection), //Flex fuel correction (% above or below 100)
+  LOG_FIELD(37, LOG_FORMAT_U8, flexIgnCorrection), //Ignition correction (Increased degrees of advance) for flex fuel
+  LOG_FIELD(38, LOG_FORMAT_U8, idleLoad),
+  LOG_FIELD(39, LOG_FORMAT_U8, testOutputs),
+  LOG_FIELD(40, LOG_FORMAT_U8, O2_2), //O2
+  LOG_FIELD(41, LOG_FORMAT_U8, baro), //Barometer value
+  LOG_FIELD(42, LOG_FORMAT_U16, canin[0]),
+  LOG_FIELD(44, LOG_FORMAT_U16, canin[1]),
+  LOG_FIELD(46, LOG_FORMAT_U16, canin[2]),
+  LOG_FIELD(48, LOG_FORMAT_U16, canin[3]),
+  LOG_FIELD(50, LOG_FORMAT_U16, canin[4]),
+  LOG_FIELD(52, LOG_FORMAT_U16, canin[5]),
+  LOG_FIELD(54, LOG_FORMAT_U16, canin[6]),
+  LOG_FIELD(56, LOG_FORMAT_U16, canin[7]),
+  LOG_FIELD(58, LOG_FORMAT_U16, canin[8]),
+  LOG_FIELD(60, LOG_FORMAT_U16, canin[9]),
+  LOG_FIELD(62, LOG_FORMAT_U16, canin[10]),
+  LOG_FIELD(64, LOG_FORMAT_U16, canin[11]),
+  LOG_FIELD(66, LOG_FORMAT_U16, canin[12]),
+  LOG_FIELD(68, LOG_FORMAT_U16, canin[13]),
+  LOG_FIELD(70, LOG_FORMAT_U16, canin[14]),
+  LOG_FIELD(72, LOG_FORMAT_U16, canin[15]),
+  LOG_FIELD(74, LOG_FORMAT_U8, tpsADC),
+  LOG_CALCULATED(75, LOG_FORMAT_ERROR),
+  LOG_FIELD(76, LOG_FORMAT_U16, PW1), //Pulsewidth 1 in uS
+  LOG_FIELD(78, LOG_FORMAT_U16, PW2), //Pulsewidth 2 in uS
+  LOG_FIELD(80, LOG_FORMAT_U16, PW3), //Pulsewidth 3 in uS
+  LOG_FIELD(82, LOG_FORMAT_U16, PW4), //Pulsewidth 4 in uS
+  LOG_FIELD(84, LOG_FORMAT_U8, status3),
+  LOG_FIELD(85, LOG_FORMAT_U8, engineProtectStatus),
+  LOG_FIELD(86, LOG_FORMAT_U16, fuelLoad),
+  LOG_FIELD(88, LOG_FORMAT_U16, ignLoad),
+  LOG_FIELD(90, LOG_FORMAT_U16, dwell),
+  LOG_FIELD(92, LOG_FORMAT_U8, CLIdleTarget),
+  LOG_FIELD(93, LOG_FORMAT_U16, mapDOT),
+  LOG_FIELD(95, LOG_FORMAT_U16, vvt1Angle), //2 bytes for vvt1Angle
+  LOG_FIELD(97, LOG_FORMAT_U8, vvt1TargetAngle),
+  LOG_FIELD(98, LOG_FORMAT_U8, vvt1Duty),
+  LOG_FIELD(99, LOG_FORMAT_U16, flexBoostCorrection),
+  LOG_FIELD(101, LOG_FORMAT_U8, baroCorrection),
+  LOG_FIELD(102, LOG_FORMAT_U8, VE), //Current VE (%). Can be equal to VE1 or VE2 or a calculated value from both of them
+  LOG_FIELD(103, LOG_FORMAT_U8, ASEValue), //Current ASE (%)
+  LOG_FIELD(104, LOG_FORMAT_U16, vss),
+  LOG_FIELD(106, LOG_FORMAT_U8, gear),
+  LOG_FIELD(107, LOG_FORMAT_U8, fuelPressure),
+  LOG_FIELD(108, LOG_FORMAT_U8, oilPressure),
+  LOG_FIELD(109, LOG_FORMAT_U8, wmiPW),
+  LOG_FIELD(110, LOG_FORMAT_U8, status4),
+  LOG_FIELD(111, LOG_FORMAT_U16, vvt2Angle), //2 bytes for vvt2Angle
+  LOG_FIELD(113, LOG_FORMAT_U8, vvt2TargetAngle),
+  LOG_FIELD(114, LOG_FORMAT_U8, vvt2Duty),
+  LOG_FIELD(115, LOG_FORMAT_U8, outputsStatus),
+  LOG_FIELD(116, LOG_FORMAT_TEMP8, fuelTemp), //Fuel temperature from flex sensor
+  LOG_FIELD(117, LOG_FORMAT_U8, fuelTempCorrection), //Fuel temperature Correction (%)
+  LOG_FIELD(118, LOG_FORMAT_U8, advance1), //advance 1 (%)
+  LOG_FIELD(119, LOG_FORMAT_U8, advance2), //advance 2 (%)
+  LOG_FIELD(120, LOG_FORMAT_U8, TS_SD_Status), //SD card status
+  LOG_FIELD(121, LOG_FORMAT_U16, EMAP), //2 bytes for EMAP
+  LOG_FIELD(123, LOG_FORMAT_U8, fanDuty),
+  LOG_FIELD(124, LOG_FORMAT_U8, airConStatus),
+  LOG_FIELD(125, LOG_FORMAT_U16, actualDwell),
+  LOG_FIELD(127, LOG_FORMAT_U8, status5),
+  LOG_FIELD(128, LOG_FORMAT_U8, knockCount),
+  LOG_FIELD(129, LOG_FORMAT_U8, knockRetard),
+  LOG_FIELD(130, LOG_FORMAT_U8, toothLogOverruns),
+};
+static constexpr uint8_t logChannelCount = _countof(logChannels);
+
+static constexpr uint8_t logChannelWidth(uint8_t format)
 {
-  byte statusValue = 0;
+  return ( (format == LOG_FORMAT_U16) || (format == LOG_FORMAT_LOOPS) || (format == LOG_FORMAT_FREE_RAM) ) ? 2U : 1U;
+}
 
-  switch(byteNum)
+/** Checks at compile time that every channel starts where the previous one ends */
+static constexpr bool isLogChannelTableValid(uint8_t index)
+{
+  return (index >= (logChannelCount - 1U))
+    || ( (logChannels[index + 1U].logByte == (logChannels[index].logByte + logChannelWidth(logChannels[index].format))) && isLogChannelTableValid(index + 1U) );
+}
+static_assert(logChannels[0].logByte == 0U, "The live data packet must start at byte 0");
+static_assert(isLogChannelTableValid(0U), "Live data channels must be in packet order, with no gaps or overlaps");
+#ifndef UNIT_TEST
+static_assert( (logChannels[logChannelCount - 1U].logByte + logChannelWidth(logChannels[logChannelCount - 1U].format)) == LOG_ENTRY_SIZE, "The live data channels must fill LOG_ENTRY_SIZE");
+#endif
+
+/** Binary search for the channel that contains the given packet byte. Returns logChannelCount if it is beyond the last channel */
+static uint8_t findLogChannel(uint16_t byteNum)
+{
+  uint8_t last = logChannelCount - 1U;
+  if(byteNum >= (uint16_t)(pgm_read_byte(&logChannels[last].logByte) + logChannelWidth(pgm_read_byte(&logChannels[last].format)))) { return logChannelCount; }
+
+  uint8_t bottom = 0U;
+  uint8_t top = last;
+  while(bottom < top)
   {
-    case 0: statusValue = currentStatus.secl; break; //secl is simply a counter that increments each second. Used to track unexpected resets (Which will reset this count to 0)
-    case 1: statusValue = currentStatus.status1; break; //status1 Bitfield
-    case 2: statusValue = currentStatus.engine; break; //Engine Status Bitfield
-    case 3: statusValue = currentStatus.syncLossCounter; break;
-    case 4: statusValue = lowByte(currentStatus.MAP); break; //2 bytes for MAP
-    case 5: statusValue = highByte(currentStatus.MAP); break;
-    case 6: statusValue = lowByte(currentStatus.IAT + CALIBRATION_TEMPERATURE_OFFSET); break; //mat
-    case 7: statusValue = lowByte(currentStatus.coolant + CALIBRATION_TEMPERATURE_OFFSET); break; //Coolant ADC
-    case 8: statusValue = currentStatus.batCorrection; break; //Battery voltage correction (%)
-    case 9: statusValue = currentStatus.battery10; break; //battery voltage
-    case 10: statusValue = currentStatus.O2; break; //O2
-    case 11: statusValue = currentStatus.egoCorrection; break; //Exhaust gas correction (%)
-    case 12: statusValue = currentStatus.iatCorrection; break; //Air temperature Correction (%)
-    case 13: statusValue = currentStatus.wueCorrection; break; //Warmup enrichment (%)
-    case 14: statusValue = lowByte(currentStatus.RPM); break; //rpm HB
-    case 15: statusValue = highByte(currentStatus.RPM); break; //rpm LB
-    case 16: statusValue = lowByte(currentStatus.AEamount >> 1U); break; //TPS acceleration enrichment (%) divided by 2 (Can exceed 255)
-    case 17: statusValue = lowByte(currentStatus.corrections); break; //Total GammaE (%)
-    case 18: statusValue = highByte(currentStatus.corrections); break; //Total GammaE (%)
-    case 19: statusValue = currentStatus.VE1; break; //VE 1 (%)
-    case 20: statusValue = currentStatus.VE2; break; //VE 2 (%)
-    case 21: statusValue = currentStatus.afrTarget; break;
-    case 22: statusValue = lowByte(currentStatus.tpsDOT); break; //TPS DOT
-    case 23: statusValue = highByte(currentStatus.tpsDOT); break; //TPS DOT
-    case 24: statusValue = currentStatus.advance; break;
-    case 25: statusValue = currentStatus.TPS; break; // TPS (0% to 100%)
-    
-    case 26: 
-      if(currentStatus.loopsPerSecond > 60000U) { currentStatus.loopsPerSecond = 60000U;}
-      statusValue = lowByte(currentStatus.loopsPerSecond); 
-      break;
-    case 27: 
+    uint8_t middle = (bottom + top + 1U) >> 1U;
+    if(byteNum >= pgm_read_byte(&logChannels[middle].logByte)) { bottom = middle; }
+    else { top = middle - 1U; }
+  }
+  return bottom;
+}
+
+/** The value of a channel, with the offsets and shifts expected by TunerStudio applied
+ * @param isPassive - Read the channel without any side effects (See getPassiveTSLogEntry())
+ */
+static uint16_t getLogChannelValue(const logChannel &channel, bool isPassive)
+{
+  const byte *pField = (const byte *)&currentStatus + channel.statusOffset;
+  uint16_t value;
+
+  switch(channel.format)
+  {
+    case LOG_FORMAT_U16: value = word(pField[1], pField[0]); break;
+    case LOG_FORMAT_TEMP16: value = lowByte(word(pField[1], pField[0]) + CALIBRATION_TEMPERATURE_OFFSET); break;
+    case LOG_FORMAT_TEMP8: value = lowByte(pField[0] + CALIBRATION_TEMPERATURE_OFFSET); break;
+    case LOG_FORMAT_HALF16: value = lowByte(word(pField[1], pField[0]) >> 1U); break;
+    case LOG_FORMAT_DIV100_16: value = lowByte(div100(word(pField[1], pField[0]))); break;
+    case LOG_FORMAT_LOOPS:
       if(currentStatus.loopsPerSecond > 60000U) { currentStatus.loopsPerSecond = 60000U;}
-      statusValue = highByte(currentStatus.loopsPerSecond); 
+      value = (uint16_t)currentStatus.loopsPerSecond;
       break;
-    
-    case 28: 
-      currentStatus.freeRAM = freeRam();
-      statusValue = lowByte(currentStatus.freeRAM); //(byte)((currentStatus.loopsPerSecond >> 8) & 0xFF);
-      break; 
-    case 29: 
-      currentStatus.freeRAM = freeRam();
-      statusValue = highByte(currentStatus.freeRAM); 
+    case LOG_FORMAT_FREE_RAM:
+      if(isPassive == false) { currentStatus.freeRAM = freeRam(); }
+      value = currentStatus.freeRAM;
       break;
+    case LOG_FORMAT_ERROR: value = isPassive ? getFirstError() : getNextError(); break;
+    case LOG_FORMAT_U8: //Fall through
+    default: value = pField[0]; break;
+  }
 
-    case 30: statusValue = lowByte(currentStatus.boostTarget >> 1U); break; //Divide boost target by 2 to fit in a byte
-    case 31: statusValue = lowByte(div100(currentStatus.boostDuty)); break;
-    case 32: statusValue = currentStatus.status2; break; //Spark related bitfield
-
-    //rpmDOT must be sent as a signed integer
-    case 33: statusValue = lowByte(currentStatus.rpmDOT); break;
-    case 34: statusValue = highByte(currentStatus.rpmDOT); break;
-
-    case 35: statusValue = currentStatus.ethanolPct; break; //Flex sensor value (or 0 if not used)
-    case 36: statusValue = currentStatus.flexCorrection; break; //Flex fuel correction (% above or below 100)
-    case 37: statusValue = currentStatus.flexIgnCorrection; break; //Ignition correction (Increased degrees of advance) for flex fuel
-
-    case 38: statusValue = currentStatus.idleLoad; break;
-    case 39: statusValue = currentStatus.testOutputs; break;
-
-    case 40: statusValue = currentStatus.O2_2; break; //O2
-    case 41: statusValue = currentStatus.baro; break; //Barometer value
-
-    case 42: statusValue = lowByte(currentStatus.canin[0]); break;
-    case 43: statusValue = highByte(currentStatus.canin[0]); break;
-    case 44: statusValue = lowByte(currentStatus.canin[1]); break;
-    case 45: statusValue = highByte(currentStatus.canin[1]); break;
-    case 46: statusValue = lowByte(currentStatus.canin[2]); break;
-    case 47: statusValue = highByte(currentStatus.canin[2]); break;
-    case 48: statusValue = lowByte(currentStatus.canin[3]); break;
-    case 49: statusValue = highByte(currentStatus.canin[3]); break;
-    case 50: statusValue = lowByte(currentStatus.canin[4]); break;
-    case 51: statusValue = highByte(currentStatus.canin[4]); break;
-    case 52: statusValue = lowByte(currentStatus.canin[5]); break;
-    case 53: statusValue = highByte(currentStatus.canin[5]); break;
-    case 54: statusValue = lowByte(currentStatus.canin[6]); break;
-    case 55: statusValue = highByte(currentStatus.canin[6]); break;
-    case 56: statusValue = lowByte(currentStatus.canin[7]); break;
-    case 57: statusValue = highByte(currentStatus.canin[7]); break;
-    case 58: statusValue = lowByte(currentStatus.canin[8]); break;
-    case 59: statusValue = highByte(currentStatus.canin[8]); break;
-    case 60: statusValue = lowByte(currentStatus.canin[9]); break;
-    case 61: statusValue = highByte(currentStatus.canin[9]); break;
-    case 62: statusValue = lowByte(currentStatus.canin[10]); break;
-    case 63: statusValue = highByte(currentStatus.canin[10]); break;
-    case 64: statusValue = lowByte(currentStatus.canin[11]); break;
-    case 65: statusValue = highByte(currentStatus.canin[11]); break;
-    case 66: statusValue = lowByte(currentStatus.canin[12]); break;
-    case 67: statusValue = highByte(currentStatus.canin[12]); break;
-    case 68: statusValue = lowByte(currentStatus.canin[13]); break;
-    case 69: statusValue = highByte(currentStatus.canin[13]); break;
-    case 70: statusValue = lowByte(currentStatus.canin[14]); break;
-    case 71: statusValue = highByte(currentStatus.canin[14]); break;
-    case 72: statusValue = lowByte(currentStatus.canin[15]); break;
-    case 73: statusValue = highByte(currentStatus.canin[15]); break;
-
-    case 74: statusValue = currentStatus.tpsADC; break;
-    case 75: statusValue = getNextError(); break;
-
-    case 76: statusValue = lowByte(currentStatus.PW1); break; //Pulsewidth 1 multiplied by 10 in ms. Have to convert from uS to mS.
-    case 77: statusValue = highByte(currentStatus.PW1); break; //Pulsewidth 1 multiplied by 10 in ms. Have to convert from uS to mS.
-    case 78: statusValue = lowByte(currentStatus.PW2); break; //Pulsewidth 2 multiplied by 10 in ms. Have to convert from uS to mS.
-    case 79: statusValue = highByte(currentStatus.PW2); break; //Pulsewidth 2 multiplied by 10 in ms. Have to convert from uS to mS.
-    case 80: statusValue = lowByte(currentStatus.PW3); break; //Pulsewidth 3 multiplied by 10 in ms. Have to convert from uS to mS.
-    case 81: statusValue = highByte(currentStatus.PW3); break; //Pulsewidth 3 multiplied by 10 in ms. Have to convert from uS to mS.
-    case 82: statusValue = lowByte(currentStatus.PW4); break; //Pulsewidth 4 multiplied by 10 in ms. Have to convert from uS to mS.
-    case 83: statusValue = highByte(currentStatus.PW4); break; //Pulsewidth 4 multiplied by 10 in ms. Have to convert from uS to mS.
-
-    case 84: statusValue = currentStatus.status3; break;
-    case 85: statusValue = currentStatus.engineProtectStatus; break;
-    case 86: statusValue = lowByte(currentStatus.fuelLoad); break;
-    case 87: statusValue = highByte(currentStatus.fuelLoad); break;
-    case 88: statusValue = lowByte(currentStatus.ignLoad); break;
-    case 89: statusValue = highByte(currentStatus.ignLoad); break;
-    case 90: statusValue = lowByte(currentStatus.dwell); break;
-    case 91: statusValue = highByte(currentStatus.dwell); break;
-    case 92: statusValue = currentStatus.CLIdleTarget; break;
-    case 93: statusValue = lowByte(currentStatus.mapDOT); break;
-    case 94: statusValue = highByte(currentStatus.mapDOT); break;
-    case 95: statusValue = lowByte(currentStatus.vvt1Angle); break; //2 bytes for vvt1Angle
-    case 96: statusValue = highByte(currentStatus.vvt1Angle); break;
-    case 97: statusValue = currentStatus.vvt1TargetAngle; break;
-    case 98: statusValue = lowByte(currentStatus.vvt1Duty); break;
-    case 99: statusValue = lowByte(currentStatus.flexBoostCorrection); break;
-    case 100: statusValue = highByte(currentStatus.flexBoostCorrection); break;
-    case 101: statusValue = currentStatus.baroCorrection; break;
-    case 102: statusValue = currentStatus.VE; break; //Current VE (%). Can be equal to VE1 or VE2 or a calculated value from both of them
-    case 103: statusValue = currentStatus.ASEValue; break; //Current ASE (%)
-    case 104: statusValue = lowByte(currentStatus.vss); break;
-    case 105: statusValue = highByte(currentStatus.vss); break;
-    case 106: statusValue = currentStatus.gear; break;
-    case 107: statusValue = currentStatus.fuelPressure; break;
-    case 108: statusValue = currentStatus.oilPressure; break;
-    case 109: statusValue = currentStatus.wmiPW; break;
-    case 110: statusValue = currentStatus.status4; break;
-    case 111: statusValue = lowByte(currentStatus.vvt2Angle); break; //2 bytes for vvt2Angle
-    case 112: statusValue = highByte(currentStatus.vvt2Angle); break;
-    case 113: statusValue = currentStatus.vvt2TargetAngle; break;
-    case 114: statusValue = lowByte(currentStatus.vvt2Duty); break;
-    case 115: statusValue = currentStatus.outputsStatus; break;
-    case 116: statusValue = lowByte(currentStatus.fuelTemp + CALIBRATION_TEMPERATURE_OFFSET); break; //Fuel temperature from flex sensor
-    case 117: statusValue = currentStatus.fuelTempCorrection; break; //Fuel temperature Correction (%)
-    case 118: statusValue = currentStatus.advance1; break; //advance 1 (%)
-    case 119: statusValue = currentStatus.advance2; break; //advance 2 (%)
-    case 120: statusValue = currentStatus.TS_SD_Status; break; //SD card status
-    case 121: statusValue = lowByte(currentStatus.EMAP); break; //2 bytes for EMAP
-    case 122: statusValue = highByte(currentStatus.EMAP); break;
-    case 123: statusValue = currentStatus.fanDuty; break;
-    case 124: statusValue = currentStatus.airConStatus; break;
-    case 125: statusValue = lowByte(currentStatus.actualDwell); break;
-    case 126: statusValue = highByte(currentStatus.actualDwell); break;
-    case 127: statusValue = currentStatus.status5; break;
-    case 128: statusValue = currentStatus.knockCount; break;
-    case 129: statusValue = currentStatus.knockRetard; break;
-    default: statusValue = 0; // MISRA check
+  return value;
+}
+
+/** getTSLogEntries(), optionally without side effects (See getPassiveTSLogEntry()) */
+static void copyTSLogEntries(uint16_t byteNum, uint16_t length, byte *pBuffer, bool isPassive)
+{
+  uint8_t channelIndex = findLogChannel(byteNum);
+  byte *pBufferEnd = pBuffer + length;
+
+  while(pBuffer < pBufferEnd)
+  {
+    if(channelIndex >= logChannelCount)
+    {
+      *pBuffer = 0U;
+      pBuffer++;
+      continue;
+    }
+
+    logChannel channel;
+    memcpy_P(&channel, &logChannels[channelIndex], sizeof(channel));
+    uint16_t value = getLogChannelValue(channel, isPassive);
+    uint8_t width = logChannelWidth(channel.format);
+    for(uint8_t part = (uint8_t)(byteNum - channel.logByte); (part < width) && (pBuffer < pBufferEnd); part++)
+    {
+      *pBuffer = (part == 0U) ? lowByte(value) : highByte(value);
+      pBuffer++;
+      byteNum++;
+    }
+    channelIndex++;
   }
+}
+
+/** 
+ * Copies a range of the live data packet, in the format expected by TunerStudio, to a buffer.
+ * Notes on fields:
+ * - The packet is built from @ref currentStatus, but not at all in the internal order of the struct (See logChannels[])
+ * - Multi-byte fields are sent low byte first. The range can start or end part way through a field
+ * - Values have the value offsets and shifts expected by TunerStudio. They will not all be a 'human readable value'
+ * Each channel is only read once per call, so a full packet costs a single pass over the channel table.
+ * @param byteNum - First byte of the packet to copy. This is not the entry number (As some entries have multiple bytes)
+ * @param length - Number of bytes to copy. Bytes beyond the end of the packet are 0
+ * @param pBuffer - Destination buffer, at least length bytes
+ */
+void getTSLogEntries(uint16_t byteNum, uint16_t length, byte *pBuffer)
+{
+  copyTSLogEntries(byteNum, length, pBuffer, false);
+}
 
+/** 
+ * Returns a numbered byte-field (partial field in case of multi-byte fields) of the live data packet. See getTSLogEntries()
+ * @param byteNum - byte-Field number. This is not the entry number (As some entries have multiple byets), but the byte number that is needed
+ * @return Field value in 1 byte size struct fields or 1 byte partial value (chunk) on multibyte fields.
+ */
+byte getTSLogEntry(uint16_t byteNum)
+{
+  byte statusValue;
+  getTSLogEntries(byteNum, 1U, &statusValue);
+  return statusValue;
+}
+
+/** 
+ * As getTSLogEntry(), but with no side effects, for readers other than TunerStudio (Eg the user defined CAN frames).
+ * Free RAM is the value last measured for TunerStudio and the error channel is always the first error, so neither is updated here
+ */
+byte getPassiveTSLogEntry(uint16_t byteNum)
+{
+  byte statusValue;
+  copyTSLogEntries(byteNum, 1U, &statusValue, true);
   return statusValue;
 }
 
@@ -341,6 +424,46 @@ float getReadableFloatLogEntry(uint16_t logIndex)
 }
 #endif
 
+/**
+ * The scale of a @ref getReadableLogEntry value, for log formats that store the integer rather than the float (Eg the binary SD log).
+ * These are the same divisors that @ref getReadableFloatLogEntry uses
+ * @param logIndex - The log index required. Note that this is NOT the byte number, but the index in the log
+ * @return The value that the integer must be divided by to give the readable value. 1 for values that are already readable
+ */
+uint16_t getReadableLogEntryDivisor(uint16_t logIndex)
+{
+  uint16_t divisor = 1U;
+
+  switch(logIndex)
+  {
+    case 8: //battery voltage
+    case 9: //O2
+    case 18: //AFR target
+    case 33: //O2_2
+      divisor = 10U;
+      break;
+    case 21: divisor = 2U; break; // TPS (0% to 100% = 0 to 200)
+    case 53: //Pulsewidths are in uS, read as mS
+    case 54:
+    case 55:
+    case 56:
+      divisor = 1000U;
+      break;
+    default: break;
+  }
+
+  return divisor;
+}
+
+/**
+ * Whether a @ref getReadableLogEntry value is really a uint16_t. These can be above INT16_MAX, so they wrap in the int16_t
+ * @param logIndex - The log index required. Note that this is NOT the byte number, but the index in the log
+ */
+bool isReadableLogEntryUnsigned(uint16_t logIndex)
+{
+  return (logIndex >= 53U) && (logIndex <= 56U); //Pulsewidths
+}
+
 uint8_t getLegacySecondarySerialLogEntry(uint16_t byteNum)
 {
   uint8_t statusValue = 0;
@@ -482,40 +605,65 @@ uint8_t getLegacySecondarySerialLogEntry(uint16_t byteNum)
 }
 
 /** 
- * Searches the log 2 byte array to determine whether a given index is a regular single byte or a 2 byte field
- * Uses a boundless binary search for improved performance, but requires the fsIntIndex to remain in order
+ * Determines whether a given index of the live data packet is the start of a 2 byte field
  * 
  * @param key - Index in the log array to check
- * @return True if the index is a 2 byte log field. False if it is a single byte
+ * @return True if the index is the first byte of a 2 byte log field. False if it is a single byte (Or the 2nd byte of a 2 byte field)
  */
 bool is2ByteEntry(uint8_t key)
 {
-  // This array indicates which index values from the log are 2 byte values
-  // This array MUST remain in ascending order
-  // !!!! WARNING: If any value above 255 is required in this array, changes MUST be made to is2ByteEntry() function !!!!
-  static constexpr byte PROGMEM fsIntIndex[] = {4, 14, 17, 22, 26, 28, 33, 42, 44, 46, 48, 50, 52, 54, 56, 58, 60, 62, 64, 66, 68, 70, 72, 76, 78, 80, 82, 86, 88, 90, 93, 95, 99, 104, 111, 121, 125 };
+  uint8_t channelIndex = findLogChannel(key);
+  if(channelIndex >= logChannelCount) { return false; }
 
-  unsigned int bot = 0U;
-  unsigned int mid = _countof(fsIntIndex);
-  
-  while (mid > 1U)
-  {  
-    if (key >= pgm_read_byte( &fsIntIndex[bot + mid / 2U]) )
-    {
-      bot += mid++ / 2U;
-    }
-    mid /= 2U;
+  return (pgm_read_byte(&logChannels[channelIndex].logByte) == key) && (logChannelWidth(pgm_read_byte(&logChannels[channelIndex].format)) == 2U);
+}
+
+/** Empty both tooth log buffers ready for a logger to start */
+static void resetToothLog(void)
+{
+  noInterrupts();
+  BIT_CLEAR(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY);
+  toothHistoryIndex = 0U;
+  toothHistoryBuffer = 0U;
+  currentStatus.toothLogOverruns = 0U;
+  interrupts();
+}
+
+/** 
+ * Makes the partially filled tooth log buffer ready to send, swapping the logger over to the other buffer.
+ * Used when the tuner times out waiting for a full log. Does nothing if a full buffer is already ready.
+ * @return The number of entries in the ready buffer. The rest of it needs padding by the caller
+ */
+uint8_t readyPartialToothLog(void)
+{
+  uint8_t entries = TOOTH_LOG_SIZE;
+
+  noInterrupts();
+  if(BIT_CHECK(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY) == false)
+  {
+    entries = (uint8_t)toothHistoryIndex;
+    toothHistoryBuffer ^= 1U;
+    toothHistoryIndex = 0U;
+    BIT_SET(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY);
   }
+  interrupts();
+
+  return entries;
+}
 
-  return key == pgm_read_byte(&fsIntIndex[bot]);
+/** Reattach the primary trigger interrupt used when the tooth and composite loggers are not running */
+static void attachStandardPrimaryISR(void)
+{
+  detachInterrupt( digitalPinToInterrupt(pinTrigger) );
+  if(isCycleLogActive() == true) { attachInterrupt( digitalPinToInterrupt(pinTrigger), cycleLogPrimaryISR, primaryTriggerEdge ); }
+  else { attachInterrupt( digitalPinToInterrupt(pinTrigger), PRIMARY_TRIGGER_ISR, primaryTriggerEdge ); }
 }
 
 void startToothLogger(void)
 {
   currentStatus.toothLogEnabled = true;
   currentStatus.compositeTriggerUsed = 0U; //Safety first (Should never be required)
-  BIT_CLEAR(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY);
-  toothHistoryIndex = 0U;
+  resetToothLog();
 
   //Disconnect the standard interrupt and add the logger version
   detachInterrupt( digitalPinToInterrupt(pinTrigger) );
@@ -534,13 +682,12 @@ void stopToothLogger(void)
   currentStatus.toothLogEnabled = false;
 
   //Disconnect the logger interrupts and attach the normal ones
-  detachInterrupt( digitalPinToInterrupt(pinTrigger) );
-  attachInterrupt( digitalPinToInterrupt(pinTrigger), triggerHandler, primaryTriggerEdge );
+  attachStandardPrimaryISR();
 
   if(VSS_USES_RPM2() != true)
   {
     detachInterrupt( digitalPinToInterrupt(pinTrigger2) );
-    attachInterrupt( digitalPinToInterrupt(pinTrigger2), triggerSecondaryHandler, secondaryTriggerEdge );  
+    attachInterrupt( digitalPinToInterrupt(pinTrigger2), SECONDARY_TRIGGER_ISR, secondaryTriggerEdge );  
   }
 }
 
@@ -548,8 +695,7 @@ void startCompositeLogger(void)
 {
   currentStatus.compositeTriggerUsed = 2U;
   currentStatus.toothLogEnabled = false; //Safety first (Should never be required)
-  BIT_CLEAR(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY);
-  toothHistoryIndex = 0U;
+  resetToothLog();
 
   //Disconnect the standard interrupt and add the logger version
   detachInterrupt( digitalPinToInterrupt(pinTrigger) );
@@ -567,13 +713,12 @@ void stopCompositeLogger(void)
   currentStatus.compositeTriggerUsed = 0U;
 
   //Disconnect the logger interrupts and attach the normal ones
-  detachInterrupt( digitalPinToInterrupt(pinTrigger) );
-  attachInterrupt( digitalPinToInterrupt(pinTrigger), triggerHandler, primaryTriggerEdge );
+  attachStandardPrimaryISR();
 
   if( (VSS_USES_RPM2() != true) && (FLEX_USES_RPM2() != true) )
   {
     detachInterrupt( digitalPinToInterrupt(pinTrigger2) );
-    attachInterrupt( digitalPinToInterrupt(pinTrigger2), triggerSecondaryHandler, secondaryTriggerEdge );
+    attachInterrupt( digitalPinToInterrupt(pinTrigger2), SECONDARY_TRIGGER_ISR, secondaryTriggerEdge );
   }
 }
 
@@ -581,8 +726,7 @@ void startCompositeLoggerTertiary(void)
 {
   currentStatus.compositeTriggerUsed = 3U;
   currentStatus.toothLogEnabled = false; //Safety first (Should never be required)
-  BIT_CLEAR(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY);
-  toothHistoryIndex = 0U;
+  resetToothLog();
 
   //Disconnect the standard interrupt and add the logger version
   detachInterrupt( digitalPinToInterrupt(pinTrigger) );
@@ -597,11 +741,10 @@ void stopCompositeLoggerTertiary(void)
   currentStatus.compositeTriggerUsed = 0;
 
   //Disconnect the logger interrupts and attach the normal ones
-  detachInterrupt( digitalPinToInterrupt(pinTrigger) );
-  attachInterrupt( digitalPinToInterrupt(pinTrigger), triggerHandler, primaryTriggerEdge );
+  attachStandardPrimaryISR();
 
   detachInterrupt( digitalPinToInterrupt(pinTrigger3) );
-  attachInterrupt( digitalPinToInterrupt(pinTrigger3), triggerTertiaryHandler, tertiaryTriggerEdge );
+  attachInterrupt( digitalPinToInterrupt(pinTrigger3), TERTIARY_TRIGGER_ISR, tertiaryTriggerEdge );
 }
 
 
@@ -609,8 +752,7 @@ void startCompositeLoggerCams(void)
 {
   currentStatus.compositeTriggerUsed = 4;
   currentStatus.toothLogEnabled = false; //Safety first (Should never be required)
-  BIT_CLEAR(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY);
-  toothHistoryIndex = 0;
+  resetToothLog();
 
   //Disconnect the standard interrupt and add the logger version
   if( (VSS_USES_RPM2() != true) && (FLEX_USES_RPM2() != true) )
@@ -631,9 +773,30 @@ void stopCompositeLoggerCams(void)
   if( (VSS_USES_RPM2() != true) && (FLEX_USES_RPM2() != true) )
   {
     detachInterrupt( digitalPinToInterrupt(pinTrigger2) );
-    attachInterrupt( digitalPinToInterrupt(pinTrigger2), triggerSecondaryHandler, secondaryTriggerEdge );
+    attachInterrupt( digitalPinToInterrupt(pinTrigger2), SECONDARY_TRIGGER_ISR, secondaryTriggerEdge );
   }
 
   detachInterrupt( digitalPinToInterrupt(pinTrigger3) );
-  attachInterrupt( digitalPinToInterrupt(pinTrigger3), triggerTertiaryHandler, tertiaryTriggerEdge );
+  attachInterrupt( digitalPinToInterrupt(pinTrigger3), TERTIARY_TRIGGER_ISR, tertiaryTriggerEdge );
+}
+
+/** Start taking crank angle synchronous snapshots (See cycle_logger.h)
+ * @param mode CYCLE_LOG_PER_CYCLE or CYCLE_LOG_PER_TEETH
+ * @param teeth Number of teeth between snapshots for CYCLE_LOG_PER_TEETH
+ */
+void startCycleLogger(uint8_t mode, uint8_t teeth)
+{
+  resetCycleLog(mode, teeth);
+  setCycleLogActive(true);
+
+  //The tooth and composite logger interrupts take the snapshots themselves, so only the standard interrupt needs to be swapped
+  if( (currentStatus.toothLogEnabled == false) && (currentStatus.compositeTriggerUsed == 0U) ) { attachStandardPrimaryISR(); }
+}
+
+void stopCycleLogger(void)
+{
+  if(isCycleLogActive() == false) { return; }
+  setCycleLogActive(false);
+
+  if( (currentStatus.toothLogEnabled == false) && (currentStatus.compositeTriggerUsed == 0U) ) { attachStandardPrimaryISR(); }
 }
@@ -12,19 +12,27 @@
 #include "globals.h" // Needed for FPU_MAX_SIZE
 
 #ifndef UNIT_TEST // Scope guard for unit testing
-  #define LOG_ENTRY_SIZE      130 /**< The size of the live data packet. This MUST match ochBlockSize setting in the ini file */
+  #define LOG_ENTRY_SIZE      131 /**< The size of the live data packet. This MUST match ochBlockSize setting in the ini file */
 #else
   #define LOG_ENTRY_SIZE      1 /**< The size of the live data packet. This MUST match ochBlockSize setting in the ini file */
 #endif
 
 byte getTSLogEntry(uint16_t byteNum);
+byte getPassiveTSLogEntry(uint16_t byteNum);
+void getTSLogEntries(uint16_t byteNum, uint16_t length, byte *pBuffer);
 int16_t getReadableLogEntry(uint16_t logIndex);
 #if defined(FPU_MAX_SIZE) && FPU_MAX_SIZE >= 32 //cppcheck-suppress misra-c2012-20.9
   float getReadableFloatLogEntry(uint16_t logIndex);
 #endif
+uint16_t getReadableLogEntryDivisor(uint16_t logIndex);
+bool isReadableLogEntryUnsigned(uint16_t logIndex);
 uint8_t getLegacySecondarySerialLogEntry(uint16_t byteNum);
 bool is2ByteEntry(uint8_t key);
 
+uint8_t readyPartialToothLog(void);
+/** The tooth log buffer that is ready to send. Only valid while BIT_STATUS1_TOOTHLOG1READY is set */
+static inline uint8_t getToothLogReadyBuffer(void) { return toothHistoryBuffer ^ 1U; }
+
 void startToothLogger(void);
 void stopToothLogger(void);
 
@@ -37,4 +45,7 @@ void stopCompositeLoggerTertiary(void);
 void startCompositeLoggerCams(void);
 void stopCompositeLoggerCams(void);
 
+void startCycleLogger(uint8_t mode, uint8_t teeth);
+void stopCycleLogger(void);
+
 #endif
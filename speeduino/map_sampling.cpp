@@ -0,0 +1,186 @@
+/** @file
+ * Crank angle triggered MAP sampling. See map_sampling.h
+ */
+#include "map_sampling.h"
+
+volatile bool mapAngleSamplingActive = false;
+
+static bool angleEnabled = false;
+static uint8_t angleCylinders = 0U;
+static uint16_t angleCycle = 720U;    //Degrees in an engine cycle (720 for 4 stroke, 360 for 2 stroke)
+static uint16_t angleSpacing = 720U;  //Degrees between each cylinder's TDC
+static uint16_t angleSample = 0U;     //Sample angle of the first cylinder
+
+//Only used by the trigger interrupt
+static uint8_t nextCylinder = 0U;
+static uint16_t nextAngle = 0U;
+static uint16_t lastToothAngle = 0U;
+static bool firstTooth = true;
+
+//Written by the trigger interrupt, read by the conversion complete interrupt (Which may be the same one)
+static volatile uint8_t convertingCylinder = 0U;
+
+//Only used by the conversion complete interrupt
+static uint8_t fillCount = 0U; //Number of cylinders of the current cycle that have a sample
+
+static volatile uint16_t cycleMAP[2][MAP_ANGLE_MAX_CYLINDERS];
+static volatile uint16_t cycleEMAP[2][MAP_ANGLE_MAX_CYLINDERS];
+static volatile uint8_t fillBuffer = 0U;      //The half of the buffer being filled. The other half holds the last complete cycle
+static volatile uint8_t completedCycles = 0U; //8 bit so that it can be read atomically on AVR
+static uint8_t lastReadCycle = 0U;
+
+static volatile uint16_t latestMAP = 0U;
+static volatile uint16_t latestEMAP = 0U;
+static volatile uint8_t sampleCount = 0U;
+static uint8_t lastReadSample = 0U;
+
+/** Set up the sampling angles. This can be called repeatedly (Eg every time MAP is read) and only restarts the
+ * sampling when something has changed.
+ * @param enabled Whether the sampling should run
+ * @param cylinders Number of samples per cycle
+ * @param cycleAngle 720 for 4 stroke, 360 for 2 stroke
+ * @param sampleAngle Degrees after each cylinder's TDC that its sample is taken at
+ */
+void configureMAPAngleSampling(bool enabled, uint8_t cylinders, uint16_t cycleAngle, uint16_t sampleAngle)
+{
+  if( (cylinders == 0U) || (cylinders > MAP_ANGLE_MAX_CYLINDERS) || (cycleAngle == 0U) ) { enabled = false; }
+  if(enabled == false)
+  {
+    mapAngleSamplingActive = false;
+    angleEnabled = false;
+    return;
+  }
+
+  sampleAngle = sampleAngle % cycleAngle;
+  if( (angleEnabled == true) && (cylinders == angleCylinders) && (cycleAngle == angleCycle) && (sampleAngle == angleSample) ) { return; }
+
+  //Stop the trigger interrupt using the angles while they are changed
+  mapAngleSamplingActive = false;
+  angleEnabled = true;
+  angleCylinders = cylinders;
+  angleCycle = cycleAngle;
+  angleSpacing = cycleAngle / cylinders;
+  angleSample = sampleAngle;
+  nextCylinder = 0U;
+  nextAngle = sampleAngle;
+  firstTooth = true;
+  convertingCylinder = 0U;
+  fillCount = 0U;
+  lastReadCycle = completedCycles;
+  lastReadSample = sampleCount;
+  mapAngleSamplingActive = true;
+}
+
+/** Called by the decoders on each tooth while sampling is active. Starts a conversion on the first tooth at or after
+ * the next cylinder's sample angle.
+ * @param crankAngle Crank angle (ATDC of cylinder 1) of the tooth. Does not need to be within the cycle
+ */
+void sampleMAPAtTooth(int16_t crankAngle)
+{
+  if(mapAngleSamplingActive == false) { return; }
+
+  while(crankAngle < 0) { crankAngle += (int16_t)angleCycle; }
+  while(crankAngle >= (int16_t)angleCycle) { crankAngle -= (int16_t)angleCycle; }
+
+  uint16_t toothAngle = (uint16_t)crankAngle;
+  uint16_t previousAngle = lastToothAngle;
+  lastToothAngle = toothAngle;
+  if(firstTooth == true)
+  {
+    firstTooth = false;
+    return;
+  }
+
+  //The sample is due when its angle falls between the previous tooth and this one. If a sample angle is missed (Eg sync
+  //was gained part way through a cycle), the following ones wait until it comes around again so they stay in order
+  uint16_t toothStep = toothAngle - previousAngle;
+  if(toothAngle < previousAngle) { toothStep += angleCycle; }
+  uint16_t untilSample = nextAngle - previousAngle;
+  if(nextAngle < previousAngle) { untilSample += angleCycle; }
+  if( (untilSample == 0U) || (untilSample > toothStep) ) { return; }
+
+  convertingCylinder = nextCylinder;
+  nextCylinder++;
+  nextAngle += angleSpacing;
+  if(nextCylinder >= angleCylinders)
+  {
+    nextCylinder = 0U;
+    nextAngle = angleSample;
+  }
+  else if(nextAngle >= angleCycle) { nextAngle -= angleCycle; }
+  else { /* Angle is within the cycle */ }
+
+  startMAPAngleConversion();
+}
+
+/** Called by the board layer when a conversion started by startMAPAngleConversion() has completed
+ * @param mapADC Raw MAP reading
+ * @param emapADC Raw EMAP reading (0 when EMAP is not used)
+ */
+void storeMAPAngleSample(uint16_t mapADC, uint16_t emapADC)
+{
+  uint8_t cylinder = convertingCylinder;
+
+  //A cycle is only published when every cylinder was sampled in order. If one was missed, the rest of that cycle is dropped
+  if(cylinder == 0U) { fillCount = 0U; }
+  if( (cylinder == fillCount) && (cylinder < angleCylinders) )
+  {
+    cycleMAP[fillBuffer][cylinder] = mapADC;
+    cycleEMAP[fillBuffer][cylinder] = emapADC;
+    fillCount++;
+    if(fillCount >= angleCylinders)
+    {
+      fillBuffer ^= 1U;
+      completedCycles++;
+      fillCount = 0U;
+    }
+  }
+
+  latestMAP = mapADC;
+  latestEMAP = emapADC;
+  sampleCount++;
+}
+
+/** Read the samples of the last complete cycle
+ * @return false if there has not been a new complete cycle since the last call
+ */
+bool readMAPAngleCycle(mapAngleCycle &cycle)
+{
+  uint8_t completed = completedCycles;
+  if(completed == lastReadCycle) { return false; }
+
+  //The interrupt only writes to the other half of the buffer, unless another cycle completes during the copy
+  do
+  {
+    completed = completedCycles;
+    uint8_t buffer = fillBuffer ^ 1U;
+    cycle.cylinders = angleCylinders;
+    for(uint8_t x = 0U; x < angleCylinders; x++)
+    {
+      cycle.mapADC[x] = cycleMAP[buffer][x];
+      cycle.emapADC[x] = cycleEMAP[buffer][x];
+    }
+  } while(completed != completedCycles);
+
+  lastReadCycle = completed;
+  return true;
+}
+
+/** Read the most recent sample, whichever cylinder it was for
+ * @return false if there has not been a new sample since the last call
+ */
+bool readLatestMAPAngleSample(uint16_t &mapADC, uint16_t &emapADC)
+{
+  uint8_t count = sampleCount;
+  if(count == lastReadSample) { return false; }
+
+  do
+  {
+    count = sampleCount;
+    mapADC = latestMAP;
+    emapADC = latestEMAP;
+  } while(count != sampleCount);
+
+  lastReadSample = count;
+  return true;
+}
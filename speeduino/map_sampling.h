@@ -0,0 +1,53 @@
+/** @file
+ * Crank angle triggered MAP sampling.
+ *
+ * The time based MAP sampling methods (Cycle average/minimum, event average) take their samples from the 1kHz loop, so
+ * the crank angle of each sample and the number of samples per cycle vary with RPM and loop load. With this enabled,
+ * the decoder starts a MAP (And EMAP) conversion instead on the first tooth at or after a set angle after each
+ * cylinder's TDC. This gives 1 sample per cylinder per cycle, always taken at the same point of each intake stroke.
+ *
+ * Cylinders are numbered in firing order and are assumed to be evenly spaced across the cycle.
+ *
+ * The samples of a cycle are collected into one half of a double buffer as each conversion completes (See
+ * storeMAPAngleSample()). Once every cylinder has a sample the buffers are swapped, so the main loop can read the
+ * previous complete cycle (readMAPAngleCycle()) while the next one is being filled.
+ *
+ * Only decoders that set BIT_DECODER_MAP_ANGLE call sampleMAPAtTooth(). The conversions themselves are board
+ * specific, see startMAPAngleConversion() in sensors.cpp. The trigger interrupt only starts them, the result is
+ * collected by an end of conversion interrupt. The AVR does this itself, other boards define ADC_CONVERSION_ISR_AVAILABLE
+ * in their board_*.h and provide:
+ *   void initADCConversion(void); //Setup an ADC that analogRead() does not use, with its end of conversion interrupt
+ *   void startADCConversion(uint8_t pin); //Start a single conversion. The interrupt passes the result to adcConversionComplete()
+ * Boards without it keep this off, as a blocking read in the trigger interrupt costs too much
+ */
+#ifndef MAP_SAMPLING_H
+#define MAP_SAMPLING_H
+
+#include <stdint.h>
+
+#define MAP_ANGLE_MAX_CYLINDERS 8U
+
+struct mapAngleCycle
+{
+  uint8_t cylinders;
+  uint16_t mapADC[MAP_ANGLE_MAX_CYLINDERS];
+  uint16_t emapADC[MAP_ANGLE_MAX_CYLINDERS];
+};
+
+extern volatile bool mapAngleSamplingActive;
+
+void configureMAPAngleSampling(bool enabled, uint8_t cylinders, uint16_t cycleAngle, uint16_t sampleAngle);
+void sampleMAPAtTooth(int16_t crankAngle);
+void storeMAPAngleSample(uint16_t mapADC, uint16_t emapADC);
+bool readMAPAngleCycle(mapAngleCycle &cycle);
+bool readLatestMAPAngleSample(uint16_t &mapADC, uint16_t &emapADC);
+
+/** Start a conversion of the MAP (And EMAP if used) sensor. Called from the trigger interrupt.
+ * The board layer must call storeMAPAngleSample() once the conversion has completed.
+ */
+void startMAPAngleConversion(void);
+
+/** Whether the trigger interrupt should call sampleMAPAtTooth(). Kept inline as it is checked on every tooth */
+static inline bool isMAPAngleSamplingActive(void) { return mapAngleSamplingActive; }
+
+#endif // MAP_SAMPLING_H
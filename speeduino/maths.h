@@ -221,6 +221,15 @@ static inline int16_t nudge(int16_t min, int16_t max, int16_t value, int16_t nud
 //This is a new version that allows for out_min
 #define fastMap10Bit(x, out_min, out_max) ( rshift<10>( (uint32_t)(x) * ((out_max)-(out_min)) ) + (out_min))
 
+// Flag if we should use the AVR assembler division
+#if !defined(USE_OPTIMIZED_DIVISION)
+#if defined(CORE_AVR) || defined(ARDUINO_ARCH_AVR)
+#define USE_OPTIMIZED_DIVISION 1
+#else
+#define USE_OPTIMIZED_DIVISION 0
+#endif
+#endif
+
 #if defined(CORE_AVR) || defined(ARDUINO_ARCH_AVR)
 
 static inline bool udiv_is16bit_result(uint32_t dividend, uint16_t divisor) {
@@ -245,7 +254,7 @@ static inline bool udiv_is16bit_result(uint32_t dividend, uint16_t divisor) {
  */
 static inline uint16_t udiv_32_16 (uint32_t dividend, uint16_t divisor)
 {
-#if defined(CORE_AVR) || defined(ARDUINO_ARCH_AVR)
+#if USE_OPTIMIZED_DIVISION
 
     if (divisor==0U || !udiv_is16bit_result(dividend, divisor)) { return UINT16_MAX; }
 
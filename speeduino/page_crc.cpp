@@ -84,7 +84,14 @@ static inline uint32_t compute_crc(const page_iterator_t &entity, pCrcCalc calcF
     }
 }
 
-uint32_t calculatePageCRC32(byte pageNum)
+#define PAGE_CRC_CACHE_PAGES 16U //Pages beyond this are always calculated in full
+
+static uint32_t pageCrcCache[PAGE_CRC_CACHE_PAGES];
+//Set when pageCrcCache holds the current CRC of the page. A byte per page (Rather than a bit) so that an invalidation from
+//an ISR can never be lost to a read-modify-write in the main loop
+static volatile bool pageCrcValid[PAGE_CRC_CACHE_PAGES];
+
+static uint32_t computePageCRC32(byte pageNum)
 {
   FastCRC32 crcCalc;
   page_iterator_t entity = page_begin(pageNum);
@@ -98,4 +105,27 @@ uint32_t calculatePageCRC32(byte pageNum)
     entity = advance(entity);
   }
   return ~pad_crc(getPageSize(pageNum) - entity.size, crc, crcCalc);
-}
\ No newline at end of file
+}
+
+uint32_t calculatePageCRC32(byte pageNum)
+{
+  if(pageNum >= PAGE_CRC_CACHE_PAGES) { return computePageCRC32(pageNum); }
+
+  if(pageCrcValid[pageNum] == false)
+  {
+    //Marked valid before the calculation, so that if the page is changed (And invalidated) by an ISR part way through, it is calculated again next time
+    pageCrcValid[pageNum] = true;
+    pageCrcCache[pageNum] = computePageCRC32(pageNum);
+  }
+  return pageCrcCache[pageNum];
+}
+
+void invalidatePageCRC32(byte pageNum)
+{
+  if(pageNum < PAGE_CRC_CACHE_PAGES) { pageCrcValid[pageNum] = false; }
+}
+
+void invalidateAllPageCRC32(void)
+{
+  for(byte page = 0; page < PAGE_CRC_CACHE_PAGES; page++) { pageCrcValid[page] = false; }
+}
@@ -3,5 +3,18 @@
 
 /*
  * Calculates and returns the CRC32 value of a given page of memory
+ * The CRC of each page is cached, so this is only calculated in full after the page has changed
  */
-uint32_t calculatePageCRC32(byte pageNum /**< [in] The page number to compute CRC for. */);
\ No newline at end of file
+uint32_t calculatePageCRC32(byte pageNum /**< [in] The page number to compute CRC for. */);
+
+/*
+ * Marks the cached CRC of a page as out of date.
+ * setPageValue() does this itself. Anything else that changes the values of a page (Eg writing to a configPage struct directly) must call this
+ * Safe to call from an ISR
+ */
+void invalidatePageCRC32(byte pageNum /**< [in] The page number that has changed. */);
+
+/*
+ * Marks the cached CRCs of all pages as out of date. Used after the whole config has been loaded or changed
+ */
+void invalidateAllPageCRC32(void);
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include "globals.h"
 #include "utilities.h"
 #include "table3d_axis_io.h"
+#include "page_crc.h"
+#include "storage.h"
 
 // Maps from virtual page "addresses" to addresses/bytes of real in memory entities
 //
@@ -430,6 +432,13 @@ void setPageValue(byte pageNum, uint16_t offset, byte value)
 {
   page_iterator_t entity = map_page_offset_to_entity(pageNum, offset);
 
+  //The page CRC is of the values as TS sees them, so it only needs recalculating if that has changed. Tuners often write back whole pages that are mostly unchanged
+  //Likewise only changed values need burning
+  if(get_value(entity, offset) != value)
+  {
+    invalidatePageCRC32(pageNum);
+    markPageDirty(pageNum, offset, 1U);
+  }
   set_value(entity, value, offset);
 }
 
@@ -37,6 +37,23 @@ int ignition8EndAngle;
 int channel8IgnDegrees; /**< The number of crank degrees until cylinder 2 (and 5/6/7/8) is at TDC */
 #endif
 
+int injector1StartAngle; /**< The crank angle at which injector 1 opens. Set by the main loop and also used by the decoders for per tooth injection timing */
+int injector2StartAngle;
+int injector3StartAngle;
+int injector4StartAngle;
+#if (INJ_CHANNELS >= 5)
+int injector5StartAngle;
+#endif
+#if (INJ_CHANNELS >= 6)
+int injector6StartAngle;
+#endif
+#if (INJ_CHANNELS >= 7)
+int injector7StartAngle;
+#endif
+#if (INJ_CHANNELS >= 8)
+int injector8StartAngle;
+#endif
+
 int channel1InjDegrees; /**< The number of crank degrees until cylinder 1 is at TDC (This is obviously 0 for virtually ALL engines, but there's some weird ones) */
 int channel2InjDegrees; /**< The number of crank degrees until cylinder 2 (and 5/6/7/8) is at TDC */
 int channel3InjDegrees; /**< The number of crank degrees until cylinder 3 (and 5/6/7/8) is at TDC */
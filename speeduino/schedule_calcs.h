@@ -40,6 +40,23 @@ extern int ignition8EndAngle;
 extern int channel8IgnDegrees; /**< The number of crank degrees until cylinder 2 (and 5/6/7/8) is at TDC */
 #endif
 
+extern int injector1StartAngle;
+extern int injector2StartAngle;
+extern int injector3StartAngle;
+extern int injector4StartAngle;
+#if (INJ_CHANNELS >= 5)
+extern int injector5StartAngle;
+#endif
+#if (INJ_CHANNELS >= 6)
+extern int injector6StartAngle;
+#endif
+#if (INJ_CHANNELS >= 7)
+extern int injector7StartAngle;
+#endif
+#if (INJ_CHANNELS >= 8)
+extern int injector8StartAngle;
+#endif
+
 extern int channel1InjDegrees; /**< The number of crank degrees until cylinder 1 is at TDC (This is obviously 0 for virtually ALL engines, but there's some weird ones) */
 extern int channel2InjDegrees; /**< The number of crank degrees until cylinder 2 (and 5/6/7/8) is at TDC */
 extern int channel3InjDegrees; /**< The number of crank degrees until cylinder 3 (and 5/6/7/8) is at TDC */
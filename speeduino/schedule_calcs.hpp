@@ -114,4 +114,22 @@ inline void adjustCrankAngle(IgnitionSchedule &schedule, int endAngle, int crank
     schedule.endCompare = schedule.counter + uS_TO_TIMER_COMPARE( angleToTimeMicroSecPerDegree( ignitionLimits( (endAngle - crankAngle) ) ) ); 
     schedule.endScheduleSetByDecoder = true; 
   }
+}
+
+/** Re-anchor a pending injection to the crank angle of the tooth that has just been seen.
+ * The schedule was set up by the main loop using the last known crank angle, so the time until the open angle includes
+ * the error of predicting that angle from the average RPM. Resetting it here shortens the prediction to (at most) a
+ * couple of teeth.
+ * Only a PENDING schedule is changed. Once the injector is open the pulse width must not change and a schedule that
+ * has not been set yet will be set correctly by the main loop.
+ */
+inline void adjustFuelStartAngle(FuelSchedule &schedule, int channelInjDegrees, int startAngle, int crankAngle) {
+  if( (schedule.Status == PENDING) && (currentStatus.startRevolutions > MIN_CYCLES_FOR_ENDCOMPARE) ) {
+    uint32_t timeout = calculateInjectorTimeout(schedule, channelInjDegrees, startAngle, crankAngle);
+    if( (timeout > 0U) && (timeout < MAX_TIMER_PERIOD) ) {
+      schedule.startCompare = schedule.counter + uS_TO_TIMER_COMPARE(timeout);
+      schedule.endCompare = schedule.startCompare + uS_TO_TIMER_COMPARE(schedule.duration);
+      SET_COMPARE(schedule.compare, schedule.startCompare);
+    }
+  }
 }
\ No newline at end of file
@@ -0,0 +1,166 @@
+/** \file
+ * @brief Multiplexed timer compare unit
+ *
+ * The standard scheduler (See scheduler.h) binds every fuel and ignition schedule to its own timer compare unit, so
+ * the number of channels is limited by the number of compare units. On the Mega 2560 there are 9 of them, so 8 fuel
+ * and 8 ignition channels cannot be used together.
+ *
+ * A ScheduleQueue shares one hardware compare unit between several channels. Each channel gets a virtual compare
+ * register and enable/disable functions in place of the hardware ones, so a FuelSchedule or IgnitionSchedule is
+ * constructed on top of it exactly as on a real compare unit and the schedule ISR code is unchanged. The hardware
+ * compare is always set to the earliest enabled channel and the shared ISR (ScheduleQueue::service()) runs the
+ * handler of every channel whose compare value has been reached, then sets up the next one.
+ *
+ * As with the hardware, a channel matches when the counter reaches its compare value, so a compare value equal to the
+ * counter at the time the channel is enabled is one full timer period away (It runs a tick late, as a full period cannot
+ * be told apart from no time at all).
+ *
+ * All times are in timer ticks. The queue itself is not interrupt safe, enable() and disable() must be called with
+ * interrupts disabled, or from within a handler. See scheduler.cpp (USE_SCHEDULE_QUEUE) for how it is wired up.
+ */
+#pragma once
+
+#include <stdint.h>
+
+/** @brief The state of a single channel in a ScheduleQueue */
+struct QueuedCompare
+{
+  volatile uint16_t compare;  ///< The virtual compare register of the channel
+  uint16_t armed;             ///< Counter value that the compare value is measured from (When the channel was last checked)
+  volatile bool isEnabled;    ///< The virtual compare interrupt is enabled
+  void (*pHandler)(void);     ///< The channel ISR, called when the counter reaches the compare value
+};
+
+/** @brief channelCount virtual compare units, sharing one hardware compare unit
+ *
+ * @tparam channelCount Number of channels multiplexed onto the compare unit
+ * @tparam counter_t Type of the timer counter register (Eg decltype(TCNT4))
+ * @tparam compare_t Type of the timer compare register (Eg decltype(OCR4C))
+ */
+template <uint8_t channelCount, typename counter_t, typename compare_t>
+class ScheduleQueue
+{
+public:
+
+  /** @brief The hardware compare is never set closer than this to the counter, so that it cannot be passed while it is being set */
+  static constexpr uint16_t minTicks = 2U;
+
+  ScheduleQueue(counter_t &counter, compare_t &compare, void (&timerDisable)(), void (&timerEnable)())
+  : _counter(counter)
+  , _compare(compare)
+  , _timerDisable(timerDisable)
+  , _timerEnable(timerEnable)
+  {
+  }
+
+  /** @brief Disable every channel and the hardware compare unit */
+  void reset(void)
+  {
+    for (uint8_t channel = 0U; channel < channelCount; ++channel)
+    {
+      _channels[channel].isEnabled = false;
+      _channels[channel].pHandler = nullQueueHandler;
+    }
+    _timerDisable();
+  }
+
+  void setHandler(uint8_t channel, void (*pHandler)(void)) { _channels[channel].pHandler = pHandler; }
+
+  /** @brief The virtual compare register of a channel. Used in place of the hardware register (Eg OCR4C) */
+  volatile uint16_t& compare(uint8_t channel) { return _channels[channel].compare; }
+
+  bool isEnabled(uint8_t channel) const { return _channels[channel].isEnabled; }
+
+  /** @brief Enable the compare interrupt of a channel, as the hardware XXX_TIMER_ENABLE() functions */
+  void enable(uint8_t channel)
+  {
+    _channels[channel].armed = _counter;
+    _channels[channel].isEnabled = true;
+    //Any channel that is already due is pushed back to minTicks, it is run by the next service()
+    while (setHardwareCompare(false) == false) { }
+  }
+
+  /** @brief Disable the compare interrupt of a channel. The hardware compare is left as it is, a match with nothing to run is harmless */
+  void disable(uint8_t channel) { _channels[channel].isEnabled = false; }
+
+  /** @brief Run the handler of every channel that is due and set the compare unit for the next one. Must be called from the compare ISR */
+  void service(void)
+  {
+    do
+    {
+      uint16_t now = _counter;
+      for (uint8_t index = 0U; index < channelCount; ++index)
+      {
+        QueuedCompare &channel = _channels[index];
+        if (channel.isEnabled)
+        {
+          bool isDue = isReached(channel, now);
+          //All enabled channels are measured from now on, so that they are never more than a timer period behind
+          channel.armed = now;
+          //The handler sets the next compare value from the counter, which is at or after now
+          if (isDue) { channel.pHandler(); }
+        }
+      }
+    } while (setHardwareCompare(true) == false);
+  }
+
+private:
+
+  static void nullQueueHandler(void) { }
+
+  /** The counter has reached the compare value since the channel was armed */
+  static bool isReached(const QueuedCompare &channel, uint16_t now)
+  {
+    //Both are measured from the armed point. An interval of 0 is a full timer period
+    uint16_t interval = (uint16_t)(channel.compare - channel.armed - 1U);
+    uint16_t elapsed = (uint16_t)(now - channel.armed);
+    return elapsed > interval;
+  }
+
+  /** Set the hardware compare to the earliest enabled channel
+   *
+   * @param isServicing Called from service(), which runs any channel that is already due rather than waiting for it
+   * @return false if a channel is due (isServicing only), or the counter passed the compare while it was being set
+   */
+  bool setHardwareCompare(bool isServicing)
+  {
+    uint16_t now = _counter;
+    bool isAnyEnabled = false;
+    uint16_t earliestWait = UINT16_MAX; //Ticks to the earliest match, less 1
+    for (uint8_t index = 0U; index < channelCount; ++index)
+    {
+      const QueuedCompare &channel = _channels[index];
+      if (channel.isEnabled)
+      {
+        isAnyEnabled = true;
+        uint16_t interval = (uint16_t)(channel.compare - channel.armed - 1U);
+        uint16_t elapsed = (uint16_t)(now - channel.armed);
+        uint16_t wait = 0U;
+        if (elapsed <= interval) { wait = interval - elapsed; }
+        else if (isServicing) { return false; }
+        else { } //Due, set for minTicks
+        if (wait < earliestWait) { earliestWait = wait; }
+      }
+    }
+
+    if (isAnyEnabled == false)
+    {
+      _timerDisable();
+      return true;
+    }
+
+    if (earliestWait < (minTicks - 1U)) { earliestWait = minTicks - 1U; }
+    //A full period would look like no time at all to isReached(), so check again a tick short of it
+    if (earliestWait == UINT16_MAX) { earliestWait = UINT16_MAX - 1U; }
+    _compare = (uint16_t)(now + earliestWait + 1U);
+    _timerEnable();
+    return (uint16_t)(_counter - now) <= earliestWait;
+  }
+
+  counter_t &_counter;
+  compare_t &_compare;
+  void (&_timerDisable)();
+  void (&_timerEnable)();
+
+  QueuedCompare _channels[channelCount];
+};
@@ -29,12 +29,48 @@ A full copy of the license may be found in the projects root directory
 #include "scheduledIO.h"
 #include "timers.h"
 #include "schedule_calcs.h"
+#include "isr_timing.h"
+
+#if defined(USE_SCHEDULE_QUEUE)
+#if !defined(FUEL_QUEUE_COMPARE) || !defined(IGN_QUEUE_COMPARE)
+  #error USE_SCHEDULE_QUEUE is not supported on this board
+#endif
+#include <util/atomic.h>
+#include "schedule_queue.h"
+
+//Fuel 5-8 and ignition 4-8 each share a single compare unit. Their schedules are given a virtual compare register and
+//enable/disable functions by the queue, the schedules and their ISR code are otherwise the same as the per channel ones
+static ScheduleQueue<4U, decltype(FUEL_QUEUE_COUNTER), decltype(FUEL_QUEUE_COMPARE)> fuelQueue(FUEL_QUEUE_COUNTER, FUEL_QUEUE_COMPARE, FUEL_QUEUE_TIMER_DISABLE, FUEL_QUEUE_TIMER_ENABLE);
+static ScheduleQueue<5U, decltype(IGN_QUEUE_COUNTER), decltype(IGN_QUEUE_COMPARE)> ignitionQueue(IGN_QUEUE_COUNTER, IGN_QUEUE_COMPARE, IGN_QUEUE_TIMER_DISABLE, IGN_QUEUE_TIMER_ENABLE);
+
+template <uint8_t channel> static void fuelQueueEnable(void) { ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { fuelQueue.enable(channel); } }
+template <uint8_t channel> static void fuelQueueDisable(void) { fuelQueue.disable(channel); }
+template <uint8_t channel> static void ignitionQueueEnable(void) { ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { ignitionQueue.enable(channel); } }
+template <uint8_t channel> static void ignitionQueueDisable(void) { ignitionQueue.disable(channel); }
+
+//The queued channel ISRs, called by the queues
+static void fuelSchedule5Interrupt(void);
+static void fuelSchedule6Interrupt(void);
+static void fuelSchedule7Interrupt(void);
+static void fuelSchedule8Interrupt(void);
+static void ignitionSchedule4Interrupt(void);
+static void ignitionSchedule5Interrupt(void);
+static void ignitionSchedule6Interrupt(void);
+static void ignitionSchedule7Interrupt(void);
+static void ignitionSchedule8Interrupt(void);
+#endif
 
 FuelSchedule fuelSchedule1(FUEL1_COUNTER, FUEL1_COMPARE, FUEL1_TIMER_DISABLE, FUEL1_TIMER_ENABLE);
 FuelSchedule fuelSchedule2(FUEL2_COUNTER, FUEL2_COMPARE, FUEL2_TIMER_DISABLE, FUEL2_TIMER_ENABLE);
 FuelSchedule fuelSchedule3(FUEL3_COUNTER, FUEL3_COMPARE, FUEL3_TIMER_DISABLE, FUEL3_TIMER_ENABLE);
 FuelSchedule fuelSchedule4(FUEL4_COUNTER, FUEL4_COMPARE, FUEL4_TIMER_DISABLE, FUEL4_TIMER_ENABLE);
 
+#if defined(USE_SCHEDULE_QUEUE)
+FuelSchedule fuelSchedule5(FUEL_QUEUE_COUNTER, fuelQueue.compare(0U), fuelQueueDisable<0U>, fuelQueueEnable<0U>);
+FuelSchedule fuelSchedule6(FUEL_QUEUE_COUNTER, fuelQueue.compare(1U), fuelQueueDisable<1U>, fuelQueueEnable<1U>);
+FuelSchedule fuelSchedule7(FUEL_QUEUE_COUNTER, fuelQueue.compare(2U), fuelQueueDisable<2U>, fuelQueueEnable<2U>);
+FuelSchedule fuelSchedule8(FUEL_QUEUE_COUNTER, fuelQueue.compare(3U), fuelQueueDisable<3U>, fuelQueueEnable<3U>);
+#else
 #if (INJ_CHANNELS >= 5)
 FuelSchedule fuelSchedule5(FUEL5_COUNTER, FUEL5_COMPARE, FUEL5_TIMER_DISABLE, FUEL5_TIMER_ENABLE);
 #endif
@@ -47,10 +83,18 @@ FuelSchedule fuelSchedule7(FUEL7_COUNTER, FUEL7_COMPARE, FUEL7_TIMER_DISABLE, FU
 #if (INJ_CHANNELS >= 8)
 FuelSchedule fuelSchedule8(FUEL8_COUNTER, FUEL8_COMPARE, FUEL8_TIMER_DISABLE, FUEL8_TIMER_ENABLE);
 #endif
+#endif
 
 IgnitionSchedule ignitionSchedule1(IGN1_COUNTER, IGN1_COMPARE, IGN1_TIMER_DISABLE, IGN1_TIMER_ENABLE);
 IgnitionSchedule ignitionSchedule2(IGN2_COUNTER, IGN2_COMPARE, IGN2_TIMER_DISABLE, IGN2_TIMER_ENABLE);
 IgnitionSchedule ignitionSchedule3(IGN3_COUNTER, IGN3_COMPARE, IGN3_TIMER_DISABLE, IGN3_TIMER_ENABLE);
+#if defined(USE_SCHEDULE_QUEUE)
+IgnitionSchedule ignitionSchedule4(IGN_QUEUE_COUNTER, ignitionQueue.compare(0U), ignitionQueueDisable<0U>, ignitionQueueEnable<0U>);
+IgnitionSchedule ignitionSchedule5(IGN_QUEUE_COUNTER, ignitionQueue.compare(1U), ignitionQueueDisable<1U>, ignitionQueueEnable<1U>);
+IgnitionSchedule ignitionSchedule6(IGN_QUEUE_COUNTER, ignitionQueue.compare(2U), ignitionQueueDisable<2U>, ignitionQueueEnable<2U>);
+IgnitionSchedule ignitionSchedule7(IGN_QUEUE_COUNTER, ignitionQueue.compare(3U), ignitionQueueDisable<3U>, ignitionQueueEnable<3U>);
+IgnitionSchedule ignitionSchedule8(IGN_QUEUE_COUNTER, ignitionQueue.compare(4U), ignitionQueueDisable<4U>, ignitionQueueEnable<4U>);
+#else
 IgnitionSchedule ignitionSchedule4(IGN4_COUNTER, IGN4_COMPARE, IGN4_TIMER_DISABLE, IGN4_TIMER_ENABLE);
 IgnitionSchedule ignitionSchedule5(IGN5_COUNTER, IGN5_COMPARE, IGN5_TIMER_DISABLE, IGN5_TIMER_ENABLE);
 
@@ -63,6 +107,7 @@ IgnitionSchedule ignitionSchedule7(IGN7_COUNTER, IGN7_COMPARE, IGN7_TIMER_DISABL
 #if IGN_CHANNELS >= 8
 IgnitionSchedule ignitionSchedule8(IGN8_COUNTER, IGN8_COMPARE, IGN8_TIMER_DISABLE, IGN8_TIMER_ENABLE);
 #endif
+#endif
 
 static void reset(FuelSchedule &schedule) 
 {
@@ -78,6 +123,20 @@ static void reset(IgnitionSchedule &schedule)
 
 void initialiseSchedulers()
 {
+#if defined(USE_SCHEDULE_QUEUE)
+    fuelQueue.reset();
+    fuelQueue.setHandler(0U, fuelSchedule5Interrupt);
+    fuelQueue.setHandler(1U, fuelSchedule6Interrupt);
+    fuelQueue.setHandler(2U, fuelSchedule7Interrupt);
+    fuelQueue.setHandler(3U, fuelSchedule8Interrupt);
+    ignitionQueue.reset();
+    ignitionQueue.setHandler(0U, ignitionSchedule4Interrupt);
+    ignitionQueue.setHandler(1U, ignitionSchedule5Interrupt);
+    ignitionQueue.setHandler(2U, ignitionSchedule6Interrupt);
+    ignitionQueue.setHandler(3U, ignitionSchedule7Interrupt);
+    ignitionQueue.setHandler(4U, ignitionSchedule8Interrupt);
+#endif
+
     reset(fuelSchedule1);
     reset(fuelSchedule2);
     reset(fuelSchedule3);
@@ -225,8 +284,8 @@ void _setFuelScheduleRunning(FuelSchedule &schedule, unsigned long timeout, unsi
   schedule.endCompare = schedule.startCompare + uS_TO_TIMER_COMPARE(duration);
   SET_COMPARE(schedule.compare, schedule.startCompare); //Use the B compare unit of timer 3
   schedule.Status = PENDING; //Turn this schedule on
+  schedule.pTimerEnable(); //Before interrupts are back on, a queued channel (USE_SCHEDULE_QUEUE) must be re-armed before its new compare is checked
   interrupts();
-  schedule.pTimerEnable();
 }
 
 void _setFuelScheduleNext(FuelSchedule &schedule, unsigned long timeout, unsigned long duration)
@@ -252,8 +311,8 @@ void _setIgnitionScheduleRunning(IgnitionSchedule &schedule, unsigned long timeo
   if(schedule.endScheduleSetByDecoder == false) { schedule.endCompare = schedule.startCompare + uS_TO_TIMER_COMPARE(duration); } //The .endCompare value is also set by the per tooth timing in decoders.ino. The check here is so that it's not getting overridden. 
   SET_COMPARE(schedule.compare, schedule.startCompare);
   schedule.Status = PENDING; //Turn this schedule on
+  schedule.pTimerEnable(); //Before interrupts are back on, a queued channel (USE_SCHEDULE_QUEUE) must be re-armed before its new compare is checked
   interrupts();
-  schedule.pTimerEnable();
 }
 
 void _setIgnitionScheduleNext(IgnitionSchedule &schedule, unsigned long timeout, unsigned long duration)
@@ -364,7 +423,9 @@ ISR(TIMER3_COMPA_vect) //cppcheck-suppress misra-c2012-8.2
 void fuelSchedule1Interrupt() //Most ARM chips can simply call a function
 #endif
   {
+    ISR_TIMING_START();
     fuelScheduleISR(fuelSchedule1);
+    ISR_TIMING_END(ISR_TIMING_FUEL1);
   }
 
 
@@ -374,7 +435,9 @@ ISR(TIMER3_COMPB_vect) //cppcheck-suppress misra-c2012-8.2
 void fuelSchedule2Interrupt() //Most ARM chips can simply call a function
 #endif
   {
+    ISR_TIMING_START();
     fuelScheduleISR(fuelSchedule2);
+    ISR_TIMING_END(ISR_TIMING_FUEL1 + 1U);
   }
 
 
@@ -384,7 +447,9 @@ ISR(TIMER3_COMPC_vect) //cppcheck-suppress misra-c2012-8.2
 void fuelSchedule3Interrupt() //Most ARM chips can simply call a function
 #endif
   {
+    ISR_TIMING_START();
     fuelScheduleISR(fuelSchedule3);
+    ISR_TIMING_END(ISR_TIMING_FUEL1 + 2U);
   }
 
 
@@ -394,50 +459,68 @@ ISR(TIMER4_COMPB_vect) //cppcheck-suppress misra-c2012-8.2
 void fuelSchedule4Interrupt() //Most ARM chips can simply call a function
 #endif
   {
+    ISR_TIMING_START();
     fuelScheduleISR(fuelSchedule4);
+    ISR_TIMING_END(ISR_TIMING_FUEL1 + 3U);
   }
 
 #if INJ_CHANNELS >= 5
-#if defined(CORE_AVR) //AVR chips use the ISR for this
+#if defined(USE_SCHEDULE_QUEUE)
+static void fuelSchedule5Interrupt(void) //Called by the queue ISR below
+#elif defined(CORE_AVR) //AVR chips use the ISR for this
 ISR(TIMER4_COMPC_vect) //cppcheck-suppress misra-c2012-8.2
 #else
 void fuelSchedule5Interrupt() //Most ARM chips can simply call a function
 #endif
   {
+    ISR_TIMING_START();
     fuelScheduleISR(fuelSchedule5);
+    ISR_TIMING_END(ISR_TIMING_FUEL1 + 4U);
   }
 #endif
 
 #if INJ_CHANNELS >= 6
-#if defined(CORE_AVR) //AVR chips use the ISR for this
+#if defined(USE_SCHEDULE_QUEUE)
+static void fuelSchedule6Interrupt(void) //Called by the queue ISR below
+#elif defined(CORE_AVR) //AVR chips use the ISR for this
 ISR(TIMER4_COMPA_vect) //cppcheck-suppress misra-c2012-8.2
 #else
 void fuelSchedule6Interrupt() //Most ARM chips can simply call a function
 #endif
   {
+    ISR_TIMING_START();
     fuelScheduleISR(fuelSchedule6);
+    ISR_TIMING_END(ISR_TIMING_FUEL1 + 5U);
   }
 #endif
 
 #if INJ_CHANNELS >= 7
-#if defined(CORE_AVR) //AVR chips use the ISR for this
+#if defined(USE_SCHEDULE_QUEUE)
+static void fuelSchedule7Interrupt(void) //Called by the queue ISR below
+#elif defined(CORE_AVR) //AVR chips use the ISR for this
 ISR(TIMER5_COMPC_vect) //cppcheck-suppress misra-c2012-8.2
 #else
 void fuelSchedule7Interrupt() //Most ARM chips can simply call a function
 #endif
   {
+    ISR_TIMING_START();
     fuelScheduleISR(fuelSchedule7);
+    ISR_TIMING_END(ISR_TIMING_FUEL1 + 6U);
   }
 #endif
 
 #if INJ_CHANNELS >= 8
-#if defined(CORE_AVR) //AVR chips use the ISR for this
+#if defined(USE_SCHEDULE_QUEUE)
+static void fuelSchedule8Interrupt(void) //Called by the queue ISR below
+#elif defined(CORE_AVR) //AVR chips use the ISR for this
 ISR(TIMER5_COMPB_vect) //cppcheck-suppress misra-c2012-8.2
 #else
 void fuelSchedule8Interrupt() //Most ARM chips can simply call a function
 #endif
   {
+    ISR_TIMING_START();
     fuelScheduleISR(fuelSchedule8);
+    ISR_TIMING_END(ISR_TIMING_FUEL1 + 7U);
   }
 #endif
 
@@ -487,7 +570,9 @@ ISR(TIMER5_COMPA_vect) //cppcheck-suppress misra-c2012-8.2
 void ignitionSchedule1Interrupt(void) //Most ARM chips can simply call a function
 #endif
   {
+    ISR_TIMING_START();
     ignitionScheduleISR(ignitionSchedule1);
+    ISR_TIMING_END(ISR_TIMING_IGN1);
   }
 
 #if IGN_CHANNELS >= 2
@@ -497,7 +582,9 @@ ISR(TIMER5_COMPB_vect) //cppcheck-suppress misra-c2012-8.2
 void ignitionSchedule2Interrupt(void) //Most ARM chips can simply call a function
 #endif
   {
+    ISR_TIMING_START();
     ignitionScheduleISR(ignitionSchedule2);
+    ISR_TIMING_END(ISR_TIMING_IGN1 + 1U);
   }
 #endif
 
@@ -508,62 +595,96 @@ ISR(TIMER5_COMPC_vect) //cppcheck-suppress misra-c2012-8.2
 void ignitionSchedule3Interrupt(void) //Most ARM chips can simply call a function
 #endif
   {
+    ISR_TIMING_START();
     ignitionScheduleISR(ignitionSchedule3);
+    ISR_TIMING_END(ISR_TIMING_IGN1 + 2U);
   }
 #endif
 
 #if IGN_CHANNELS >= 4
-#if defined(CORE_AVR) //AVR chips use the ISR for this
+#if defined(USE_SCHEDULE_QUEUE)
+static void ignitionSchedule4Interrupt(void) //Called by the queue ISR below
+#elif defined(CORE_AVR) //AVR chips use the ISR for this
 ISR(TIMER4_COMPA_vect) //cppcheck-suppress misra-c2012-8.2
 #else
 void ignitionSchedule4Interrupt(void) //Most ARM chips can simply call a function
 #endif
   {
+    ISR_TIMING_START();
     ignitionScheduleISR(ignitionSchedule4);
+    ISR_TIMING_END(ISR_TIMING_IGN1 + 3U);
   }
 #endif
 
 #if IGN_CHANNELS >= 5
-#if defined(CORE_AVR) //AVR chips use the ISR for this
+#if defined(USE_SCHEDULE_QUEUE)
+static void ignitionSchedule5Interrupt(void) //Called by the queue ISR below
+#elif defined(CORE_AVR) //AVR chips use the ISR for this
 ISR(TIMER4_COMPC_vect) //cppcheck-suppress misra-c2012-8.2
 #else
 void ignitionSchedule5Interrupt(void) //Most ARM chips can simply call a function
 #endif
   {
+    ISR_TIMING_START();
     ignitionScheduleISR(ignitionSchedule5);
+    ISR_TIMING_END(ISR_TIMING_IGN1 + 4U);
   }
 #endif
 
 #if IGN_CHANNELS >= 6
-#if defined(CORE_AVR) //AVR chips use the ISR for this
+#if defined(USE_SCHEDULE_QUEUE)
+static void ignitionSchedule6Interrupt(void) //Called by the queue ISR below
+#elif defined(CORE_AVR) //AVR chips use the ISR for this
 ISR(TIMER4_COMPB_vect) //cppcheck-suppress misra-c2012-8.2
 #else
 void ignitionSchedule6Interrupt(void) //Most ARM chips can simply call a function
 #endif
   {
+    ISR_TIMING_START();
     ignitionScheduleISR(ignitionSchedule6);
+    ISR_TIMING_END(ISR_TIMING_IGN1 + 5U);
   }
 #endif
 
 #if IGN_CHANNELS >= 7
-#if defined(CORE_AVR) //AVR chips use the ISR for this
+#if defined(USE_SCHEDULE_QUEUE)
+static void ignitionSchedule7Interrupt(void) //Called by the queue ISR below
+#elif defined(CORE_AVR) //AVR chips use the ISR for this
 ISR(TIMER3_COMPC_vect) //cppcheck-suppress misra-c2012-8.2
 #else
 void ignitionSchedule7Interrupt(void) //Most ARM chips can simply call a function
 #endif
   {
+    ISR_TIMING_START();
     ignitionScheduleISR(ignitionSchedule7);
+    ISR_TIMING_END(ISR_TIMING_IGN1 + 6U);
   }
 #endif
 
 #if IGN_CHANNELS >= 8
-#if defined(CORE_AVR) //AVR chips use the ISR for this
+#if defined(USE_SCHEDULE_QUEUE)
+static void ignitionSchedule8Interrupt(void) //Called by the queue ISR below
+#elif defined(CORE_AVR) //AVR chips use the ISR for this
 ISR(TIMER3_COMPB_vect) //cppcheck-suppress misra-c2012-8.2
 #else
 void ignitionSchedule8Interrupt(void) //Most ARM chips can simply call a function
 #endif
   {
+    ISR_TIMING_START();
     ignitionScheduleISR(ignitionSchedule8);
+    ISR_TIMING_END(ISR_TIMING_IGN1 + 7U);
+  }
+#endif
+
+#if defined(USE_SCHEDULE_QUEUE)
+ISR(FUEL_QUEUE_VECTOR) //cppcheck-suppress misra-c2012-8.2
+  {
+    fuelQueue.service(); //Fuel 5-8
+  }
+
+ISR(IGN_QUEUE_VECTOR) //cppcheck-suppress misra-c2012-8.2
+  {
+    ignitionQueue.service(); //Ignition 4-8
   }
 #endif
 
@@ -24,6 +24,9 @@ it will not reoccur unless you explicitly ask/re-register for it).
 Each timer can have only 1 callback associated with it at any given time. If you call the setCallback function a 2nd time,
 the original schedule will be overwritten and not occur.
 
+With USE_SCHEDULE_QUEUE (Mega 2560 only), fuel 5-8 and ignition 4-8 share a compare unit each, so that 8 channels of both are
+available. See schedule_queue.h
+
 ## Timer identification
 
 Arduino timers usage for injection and ignition schedules:
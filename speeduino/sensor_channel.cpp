@@ -0,0 +1,75 @@
+/** @file
+ * Filtering and fault detection of a single analog sensor. See sensor_channel.h
+ */
+#include "sensor_channel.h"
+
+/** Start the channel again from its next sample. The value is kept until then */
+void sensorChannelReset(sensorChannel &channel)
+{
+  channel.accumulator = 0U;
+  channel.accumulated = 0U;
+  channel.errorCount = 0U;
+  channel.primed = false;
+  channel.faulty = false;
+}
+
+static inline uint16_t median3(uint16_t a, uint16_t b, uint16_t c)
+{
+  if(a > b) { uint16_t swap = a; a = b; b = swap; }
+  if(b > c) { b = c; }
+  return (a > b) ? a : b;
+}
+
+static inline bool isInRange(const sensorChannelConfig &config, uint16_t reading)
+{
+  if(config.faultLow >= config.faultHigh) { return true; }
+  return (reading >= config.faultLow) && (reading <= config.faultHigh);
+}
+
+/** Add a raw ADC sample to the channel
+ * @return SENSOR_SAMPLE_*. The value only changes when SENSOR_SAMPLE_VALID is returned
+ */
+uint8_t sensorChannelUpdate(sensorChannel &channel, const sensorChannelConfig &config, uint16_t raw)
+{
+  uint16_t reading = raw;
+  if(channel.primed == true)
+  {
+    uint8_t decimation = (config.decimation > SENSOR_DECIMATION_MAX) ? SENSOR_DECIMATION_MAX : config.decimation;
+    channel.accumulator += raw;
+    channel.accumulated++;
+    if(channel.accumulated < (1U << decimation)) { return SENSOR_SAMPLE_PENDING; }
+    reading = channel.accumulator >> decimation;
+    channel.accumulator = 0U;
+    channel.accumulated = 0U;
+  }
+
+  if(isInRange(config, reading) == false)
+  {
+    if(channel.errorCount < UINT8_MAX) { channel.errorCount++; }
+    if( (config.faultSamples == 0U) || (channel.errorCount < config.faultSamples) || (channel.faulty == true) ) { return SENSOR_SAMPLE_REJECTED; }
+    channel.faulty = true;
+    return (reading < config.faultLow) ? SENSOR_SAMPLE_FAULT_LOW : SENSOR_SAMPLE_FAULT_HIGH;
+  }
+  channel.errorCount = 0U;
+  channel.faulty = false;
+
+  if(channel.primed == false)
+  {
+    channel.primed = true;
+    channel.value = reading;
+    channel.reading = reading;
+    channel.history[0] = reading;
+    channel.history[1] = reading;
+    return SENSOR_SAMPLE_VALID;
+  }
+
+  uint16_t filterInput = reading;
+  if(config.median == true) { filterInput = median3(channel.history[0], channel.history[1], reading); }
+  channel.history[0] = channel.history[1];
+  channel.history[1] = reading;
+  channel.reading = reading;
+
+  //Same as ADC_FILTER()
+  channel.value = (uint16_t)((((uint32_t)filterInput * (256U - config.filterAlpha)) + ((uint32_t)channel.value * config.filterAlpha)) >> 8);
+  return SENSOR_SAMPLE_VALID;
+}
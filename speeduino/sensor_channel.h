@@ -0,0 +1,57 @@
+/** @file
+ * Filtering and fault detection of a single analog sensor.
+ *
+ * Each call to sensorChannelUpdate() takes one raw ADC sample and passes it through the same stages:
+ * 1. Decimation: 1, 2, 4 or 8 samples are averaged into each reading. The reading (And everything after it) is only
+ *    updated once enough samples have been collected, so a sensor read at 30Hz with a decimation of 2 is filtered at 15Hz.
+ * 2. Range check: readings outside faultLow - faultHigh are discarded. Once faultSamples readings in a row have been
+ *    discarded, the channel is faulty until the next good reading. Only the reading that makes the channel faulty returns
+ *    SENSOR_SAMPLE_FAULT_*, so errors are only raised once.
+ * 3. Median of the last 3 readings (Optional). Removes single reading spikes without the lag of a heavier filter.
+ * 4. Low pass IIR filter with the same alpha (0 - 240) as ADC_FILTER().
+ *
+ * The first sample after sensorChannelReset() skips the decimation, median and filter so that the value is usable
+ * straight away (Eg for priming at startup).
+ *
+ * The channel works with raw ADC values. Readers convert the filtered value into their own units afterwards.
+ */
+#ifndef SENSOR_CHANNEL_H
+#define SENSOR_CHANNEL_H
+
+#include <stdint.h>
+
+#define SENSOR_DECIMATION_MAX   3U //8 samples per reading
+
+//Return values of sensorChannelUpdate()
+#define SENSOR_SAMPLE_PENDING     0U //Still collecting samples for the next reading
+#define SENSOR_SAMPLE_VALID       1U //A new reading has been filtered into the value
+#define SENSOR_SAMPLE_REJECTED    2U //The reading was out of range and was discarded
+#define SENSOR_SAMPLE_FAULT_LOW   3U //The reading was below faultLow and has made the channel faulty
+#define SENSOR_SAMPLE_FAULT_HIGH  4U //The reading was above faultHigh and has made the channel faulty
+
+struct sensorChannelConfig
+{
+  uint8_t decimation;   ///< 1 << decimation samples are averaged into each reading (0 - SENSOR_DECIMATION_MAX)
+  bool median;          ///< Median of the last 3 readings before filtering
+  uint8_t filterAlpha;  ///< 0 (No filtering) to 240
+  uint16_t faultLow;    ///< Lowest valid reading. The range check is off when faultLow >= faultHigh
+  uint16_t faultHigh;   ///< Highest valid reading
+  uint8_t faultSamples; ///< Consecutive discarded readings before the channel is faulty. 0 = Never faulty
+};
+
+struct sensorChannel
+{
+  uint16_t value;       ///< Filtered output
+  uint16_t reading;     ///< Last reading that passed the range check, before the median and filter
+  uint16_t history[2];  ///< The 2 readings before that, for the median
+  uint16_t accumulator;
+  uint8_t accumulated;
+  uint8_t errorCount;   ///< Consecutive discarded readings
+  bool primed;          ///< False until the first sample after a reset
+  bool faulty;
+};
+
+void sensorChannelReset(sensorChannel &channel);
+uint8_t sensorChannelUpdate(sensorChannel &channel, const sensorChannelConfig &config, uint16_t raw);
+
+#endif // SENSOR_CHANNEL_H
@@ -19,6 +19,9 @@ A full copy of the license may be found in the projects root directory
 #include "decoders.h"
 #include "auxiliaries.h"
 #include "utilities.h"
+#include "map_sampling.h"
+#include "adc_scan.h"
+#include "sensor_channel.h"
 #include BOARD_H
 
 uint32_t MAPcurRev; //Tracks which revolution we're sampling on
@@ -43,6 +46,17 @@ byte mapErrorCount = 0;
 
 static inline void validateMAP(void);
 
+static sensorChannel sensorChannels[SENSOR_CHANNEL_COUNT];
+static sensorChannel mapChannel;
+static sensorChannel emapChannel;
+
+//The trigger interrupt can only start a MAP conversion, not wait for one. See startMAPAngleConversion()
+#if defined(CORE_AVR) || defined(ADC_CONVERSION_ISR_AVAILABLE)
+  #define MAP_ANGLE_SAMPLING_AVAILABLE true
+#else
+  #define MAP_ANGLE_SAMPLING_AVAILABLE false
+#endif
+
 #if defined(ANALOG_ISR)
 static volatile uint16_t AnChannel[16];
 
@@ -76,6 +90,217 @@ ISR(ADC_vect)
   if(nChannel == 0) { nChannel = 16;} 
   AnChannel[nChannel-1] = (result_high << 8) | result_low;
 }
+
+/** Crank angle triggered MAP samples (See map_sampling.h) are taken from the latest free running result */
+void startMAPAngleConversion(void)
+{
+  uint16_t emapADC = 0;
+  if(configPage6.useEMAP == true) { emapADC = AnChannel[pinEMAP-A0]; }
+  storeMAPAngleSample(AnChannel[pinMAP-A0], emapADC);
+}
+
+/** Blocking read of an analog pin, for the sensors that are not read by the free running conversions */
+static inline uint16_t readAnalogPin(uint8_t pin)
+{
+  analogRead(pin);
+  return analogRead(pin);
+}
+
+#else
+/*
+Crank angle triggered MAP samples (See map_sampling.h) are started by the trigger interrupt and collected by an end of
+conversion interrupt. On the AVR they share the ADC with the blocking reads from the main loop. While a blocking read is
+part way through, a conversion requested by the trigger interrupt is held as pending and started when the read finishes.
+*/
+#if MAP_ANGLE_SAMPLING_AVAILABLE
+#define ADC_ANGLE_IDLE  0U
+#define ADC_ANGLE_MAP   1U
+#define ADC_ANGLE_EMAP  2U
+static volatile uint8_t adcAngleState = ADC_ANGLE_IDLE;
+static volatile uint16_t adcAngleMAP;
+static volatile bool mapAngleConversionPending = false;
+#endif
+
+#if defined(CORE_AVR)
+static volatile bool adcBlockingReadBusy = false; //A blocking read is part way through
+
+/** Start a single conversion that completes in the ADC interrupt. This is the same channel selection as analogRead() */
+static inline void startADCConversion(uint8_t pin)
+{
+  uint8_t channel = pin - A0;
+  #if defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__)
+    if(channel >= 8U) { BIT_SET(ADCSRB, MUX5); }
+    else { BIT_CLEAR(ADCSRB, MUX5); }
+  #endif
+  ADMUX = ADMUX_DEFAULT_CONFIG | (channel & 0x07U);
+  //Writing ADIF clears any flag left by an analogRead(), so the interrupt only fires for this conversion
+  ADCSRA |= (1U << ADIF) | (1U << ADIE) | (1U << ADSC);
+}
+
+static inline void beginMAPAngleConversion(void)
+{
+  adcAngleState = ADC_ANGLE_MAP;
+  startADCConversion(pinMAP);
+}
+
+ISR(ADC_vect)
+{
+  uint8_t result_low = ADCL;
+  uint8_t result_high = ADCH;
+  uint16_t result = (result_high << 8) | result_low;
+
+  if( (adcAngleState == ADC_ANGLE_MAP) && (configPage6.useEMAP == true) )
+  {
+    adcAngleMAP = result;
+    adcAngleState = ADC_ANGLE_EMAP;
+    startADCConversion(pinEMAP);
+  }
+  else
+  {
+    BIT_CLEAR(ADCSRA, ADIE);
+    if(adcAngleState == ADC_ANGLE_EMAP) { storeMAPAngleSample(adcAngleMAP, result); }
+    else if(adcAngleState == ADC_ANGLE_MAP) { storeMAPAngleSample(result, 0); }
+    else { /* Not a crank angle triggered conversion */ }
+    adcAngleState = ADC_ANGLE_IDLE;
+  }
+}
+
+/** Called from the trigger interrupt, see map_sampling.h */
+void startMAPAngleConversion(void)
+{
+  if( (adcBlockingReadBusy == true) || (adcAngleState != ADC_ANGLE_IDLE) ) { mapAngleConversionPending = true; }
+  else { beginMAPAngleConversion(); }
+}
+
+/** Blocking read of an analog pin for the main loop. The pin is read twice and the first result discarded, which gives
+ * the ADC time to settle after changing channel.
+ */
+static inline uint16_t readAnalogPin(uint8_t pin)
+{
+  adcBlockingReadBusy = true;
+  while(adcAngleState != ADC_ANGLE_IDLE) { } //Let a crank angle triggered conversion finish. This is at most 2 conversions
+  analogRead(pin);
+  uint16_t reading = analogRead(pin);
+
+  noInterrupts();
+  adcBlockingReadBusy = false;
+  if(mapAngleConversionPending == true)
+  {
+    mapAngleConversionPending = false;
+    beginMAPAngleConversion();
+  }
+  interrupts();
+
+  return reading;
+}
+
+#else
+#if defined(ADC_CONVERSION_ISR_AVAILABLE)
+/*
+As on the AVR, the trigger interrupt only starts the conversion and the result is collected when it completes. The board
+converts these on an ADC that analogRead() does not use, so they never wait on the blocking reads below. The board
+completion interrupt has the same priority as the trigger interrupts, so neither preempts the other.
+With ANALOG_SCAN the same ADC also runs the background scan (See adc_scan.h), one conversion at a time. A MAP sample
+requested during a scan conversion starts as soon as that conversion completes, ahead of the rest of the scan.
+*/
+static volatile bool adcScanConverting = false; //A background scan conversion is running
+#if defined(ANALOG_SCAN)
+static volatile uint8_t adcScanWaitingPin = ADC_SCAN_NO_CHANNEL; //A background scan conversion waiting for the MAP sample to finish
+
+/** Called by the background scan, from the 1ms timer or the end of conversion interrupt */
+void adcScanStartConversion(uint8_t pin)
+{
+  noInterrupts();
+  if(adcAngleState != ADC_ANGLE_IDLE) { adcScanWaitingPin = pin; }
+  else
+  {
+    adcScanConverting = true;
+    startADCConversion(pin);
+  }
+  interrupts();
+}
+#endif
+
+static inline void beginMAPAngleConversion(void)
+{
+  adcAngleState = ADC_ANGLE_MAP;
+  startADCConversion(pinMAP);
+}
+
+/** Called by the board layer from its end of conversion interrupt */
+void adcConversionComplete(uint16_t result)
+{
+#if defined(ANALOG_SCAN)
+  if(adcScanConverting == true)
+  {
+    adcScanConverting = false;
+    if(mapAngleConversionPending == true)
+    {
+      mapAngleConversionPending = false;
+      beginMAPAngleConversion();
+    }
+    adcScanConversionComplete(result); //Starts the next scan conversion, which waits if the MAP sample was started
+    return;
+  }
+#endif
+
+  if( (adcAngleState == ADC_ANGLE_MAP) && (configPage6.useEMAP == true) )
+  {
+    adcAngleMAP = result;
+    adcAngleState = ADC_ANGLE_EMAP;
+    startADCConversion(pinEMAP);
+  }
+  else
+  {
+    if(adcAngleState == ADC_ANGLE_EMAP) { storeMAPAngleSample(adcAngleMAP, result); }
+    else if(adcAngleState == ADC_ANGLE_MAP) { storeMAPAngleSample(result, 0); }
+    else { /* Not a crank angle triggered conversion */ }
+    adcAngleState = ADC_ANGLE_IDLE;
+
+    if(mapAngleConversionPending == true)
+    {
+      mapAngleConversionPending = false;
+      beginMAPAngleConversion();
+    }
+#if defined(ANALOG_SCAN)
+    else if(adcScanWaitingPin != ADC_SCAN_NO_CHANNEL)
+    {
+      adcScanConverting = true;
+      startADCConversion(adcScanWaitingPin);
+      adcScanWaitingPin = ADC_SCAN_NO_CHANNEL;
+    }
+#endif
+    else { /* The ADC is idle */ }
+  }
+}
+
+/** Called from the trigger interrupt, see map_sampling.h */
+void startMAPAngleConversion(void)
+{
+  if( (adcAngleState != ADC_ANGLE_IDLE) || (adcScanConverting == true) ) { mapAngleConversionPending = true; }
+  else { beginMAPAngleConversion(); }
+}
+#else
+/** Not called. A blocking read is too slow for the trigger interrupt, so crank angle triggered MAP sampling is kept off
+ * on boards without ADC_CONVERSION_ISR_AVAILABLE (See readMAP())
+ */
+void startMAPAngleConversion(void) { }
+#endif
+
+/** Read an analog pin for the main loop. With ANALOG_SCAN this is the latest background scan result.
+ * Otherwise it is a blocking read: the pin is read twice and the first result discarded, which gives the ADC time to
+ * settle after changing channel.
+ */
+static inline uint16_t readAnalogPin(uint8_t pin)
+{
+  #if defined(ANALOG_SCAN)
+    uint16_t reading;
+    if(adcScanRead(pin, reading) == true) { return reading; }
+  #endif
+  analogRead(pin);
+  return analogRead(pin);
+}
+#endif
 #endif
 
 /** Init all ADC conversions by setting resolutions, etc.
@@ -119,11 +344,36 @@ void initialiseADC(void)
   #endif
 #elif defined(ARDUINO_ARCH_STM32) //STM32GENERIC core and ST STM32duino core, change analog read to 12 bit
   analogReadResolution(10); //use 10bits for analog reading on STM32 boards
+#endif
+#if defined(ADC_CONVERSION_ISR_AVAILABLE)
+  initADCConversion(); //Crank angle triggered MAP samples
 #endif
   MAPcurRev = 0;
   MAPcount = 0;
   MAPrunningValue = 0;
 
+#if defined(ANALOG_SCAN)
+  //Background conversion of all the analog sensors (See adc_scan.h). MAP and knock need to be current whenever they are read
+  adcScanReset();
+  adcScanAddChannel(pinMAP, true);
+  if(configPage6.useEMAP == true) { adcScanAddChannel(pinEMAP, true); }
+  if(configPage10.knock_mode == KNOCK_MODE_ANALOG)
+  {
+    uint8_t pinKnock = A15;
+    if(configPage10.knock_pin >= 47U) { pinKnock = pinTranslateAnalog(configPage10.knock_pin - 47U); }
+    adcScanAddChannel(pinKnock, true);
+  }
+  adcScanAddChannel(pinTPS, false);
+  adcScanAddChannel(pinCLT, false);
+  adcScanAddChannel(pinIAT, false);
+  adcScanAddChannel(pinO2, false);
+  adcScanAddChannel(pinO2_2, false);
+  adcScanAddChannel(pinBat, false);
+  if(configPage6.useExtBaro != 0) { adcScanAddChannel(pinBaro, false); }
+  if(configPage10.fuelPressureEnable > 0) { adcScanAddChannel(pinFuelPressure, false); }
+  if(configPage10.oilPressureEnable > 0) { adcScanAddChannel(pinOilPressure, false); }
+#endif
+
   //The following checks the aux inputs and initialises pins if required
   auxIsEnabled = false;
   for (byte AuxinChan = 0; AuxinChan <16 ; AuxinChan++)
@@ -149,6 +399,9 @@ void initialiseADC(void)
       {
         //Channel is active and analog
         pinMode( pinNumber, INPUT);
+        #if defined(ANALOG_SCAN)
+          adcScanAddChannel(pinNumber, false);
+        #endif
         //currentStatus.canin[14] = 33;  Dev test use only!
         auxIsEnabled = true;
       }  
@@ -173,19 +426,31 @@ void initialiseADC(void)
 
     }
   } //For loop iterating through aux in lines
+
+#if defined(ANALOG_SCAN)
+  adcScanStart(); //Until every channel has been converted once, the sensors are read by blocking reads
+#endif
   
 
   //Sanity checks to ensure none of the filter values are set above 240 (Which would include the 255 value which is the default on a new arduino)
   //If an invalid value is detected, it's reset to the default the value and burned to EEPROM. 
   //Each sensor has it's own default value
-  if(configPage4.ADCFILTER_TPS  > 240) { configPage4.ADCFILTER_TPS   = ADCFILTER_TPS_DEFAULT;   writeConfig(ignSetPage); }
-  if(configPage4.ADCFILTER_CLT  > 240) { configPage4.ADCFILTER_CLT   = ADCFILTER_CLT_DEFAULT;   writeConfig(ignSetPage); }
-  if(configPage4.ADCFILTER_IAT  > 240) { configPage4.ADCFILTER_IAT   = ADCFILTER_IAT_DEFAULT;   writeConfig(ignSetPage); }
-  if(configPage4.ADCFILTER_O2   > 240) { configPage4.ADCFILTER_O2    = ADCFILTER_O2_DEFAULT;    writeConfig(ignSetPage); }
-  if(configPage4.ADCFILTER_BAT  > 240) { configPage4.ADCFILTER_BAT   = ADCFILTER_BAT_DEFAULT;   writeConfig(ignSetPage); }
-  if(configPage4.ADCFILTER_MAP  > 240) { configPage4.ADCFILTER_MAP   = ADCFILTER_MAP_DEFAULT;   writeConfig(ignSetPage); }
-  if(configPage4.ADCFILTER_BARO > 240) { configPage4.ADCFILTER_BARO  = ADCFILTER_BARO_DEFAULT;  writeConfig(ignSetPage); }
-  if(configPage4.FILTER_FLEX    > 240) { configPage4.FILTER_FLEX     = FILTER_FLEX_DEFAULT;     writeConfig(ignSetPage); }
+  if(configPage4.ADCFILTER_TPS  > 240) { configPage4.ADCFILTER_TPS   = ADCFILTER_TPS_DEFAULT;   markConfigDirty(ignSetPage, &configPage4.ADCFILTER_TPS, 1U); }
+  if(configPage4.ADCFILTER_CLT  > 240) { configPage4.ADCFILTER_CLT   = ADCFILTER_CLT_DEFAULT;   markConfigDirty(ignSetPage, &configPage4.ADCFILTER_CLT, 1U); }
+  if(configPage4.ADCFILTER_IAT  > 240) { configPage4.ADCFILTER_IAT   = ADCFILTER_IAT_DEFAULT;   markConfigDirty(ignSetPage, &configPage4.ADCFILTER_IAT, 1U); }
+  if(configPage4.ADCFILTER_O2   > 240) { configPage4.ADCFILTER_O2    = ADCFILTER_O2_DEFAULT;    markConfigDirty(ignSetPage, &configPage4.ADCFILTER_O2, 1U); }
+  if(configPage4.ADCFILTER_BAT  > 240) { configPage4.ADCFILTER_BAT   = ADCFILTER_BAT_DEFAULT;   markConfigDirty(ignSetPage, &configPage4.ADCFILTER_BAT, 1U); }
+  if(configPage4.ADCFILTER_MAP  > 240) { configPage4.ADCFILTER_MAP   = ADCFILTER_MAP_DEFAULT;   markConfigDirty(ignSetPage, &configPage4.ADCFILTER_MAP, 1U); }
+  if(configPage4.ADCFILTER_BARO > 240) { configPage4.ADCFILTER_BARO  = ADCFILTER_BARO_DEFAULT;  markConfigDirty(ignSetPage, &configPage4.ADCFILTER_BARO, 1U); }
+  if(configPage4.FILTER_FLEX    > 240) { configPage4.FILTER_FLEX     = FILTER_FLEX_DEFAULT;     markConfigDirty(ignSetPage, &configPage4.FILTER_FLEX, 1U); }
+  if(configPage15.ADCFILTER_PSI > 240) { configPage15.ADCFILTER_PSI  = ADCFILTER_PSI_DEFAULT;   markConfigDirty(boostvvtPage2, &configPage15.ADCFILTER_PSI, 1U); }
+  //Burn the corrected values straight away. Only the corrected bytes are written
+  if(isPageDirty(ignSetPage)) { writeDirtyConfig(ignSetPage); }
+  if(isPageDirty(boostvvtPage2)) { writeDirtyConfig(boostvvtPage2); }
+
+  for(uint8_t channel = 0; channel < SENSOR_CHANNEL_COUNT; channel++) { sensorChannelReset(sensorChannels[channel]); }
+  sensorChannelReset(mapChannel);
+  sensorChannelReset(emapChannel);
 
   flexStartTime = micros();
 
@@ -218,6 +483,43 @@ static inline void validateMAP(void)
   }
 }
 
+/** Filter a raw reading with the sensor's settings from configPage15
+ * @param channel SENSOR_CHANNEL_*
+ * @param filterAlpha Strength of the sensor's IIR filter
+ * @return SENSOR_SAMPLE_*
+ */
+static uint8_t updateSensorChannel(uint8_t channel, uint8_t filterAlpha, uint16_t raw)
+{
+  sensorChannelConfig config;
+  uint8_t mode = configPage15.sensorMode[channel];
+  config.decimation = mode & SENSOR_MODE_DECIMATION;
+  config.median = ((mode & SENSOR_MODE_MEDIAN) != 0U);
+  config.filterAlpha = filterAlpha;
+  config.faultLow = (uint16_t)configPage15.sensorFaultLow[channel] << 2;
+  config.faultHigh = ((uint16_t)configPage15.sensorFaultHigh[channel] << 2) | 0x03U;
+  if(configPage15.sensorFaultLow[channel] >= configPage15.sensorFaultHigh[channel]) { config.faultHigh = 0; } //Range check is off
+  config.faultSamples = mode >> SENSOR_MODE_FAULT_SHIFT;
+
+  return sensorChannelUpdate(sensorChannels[channel], config, raw);
+}
+
+/** Raise or clear the errors of a sensor after its channel has been updated
+ * @return true if the sensor is faulty and its reading should be replaced with the default value
+ */
+static bool checkSensorFault(uint8_t channel, uint8_t result, bool wasFaulty, byte errorLow, byte errorHigh)
+{
+  if(result == SENSOR_SAMPLE_FAULT_LOW) { setError(errorLow); }
+  else if(result == SENSOR_SAMPLE_FAULT_HIGH) { setError(errorHigh); }
+  else if( (wasFaulty == true) && (sensorChannels[channel].faulty == false) )
+  {
+    clearError(errorLow);
+    clearError(errorHigh);
+  }
+  else { /* No change */ }
+
+  return sensorChannels[channel].faulty;
+}
+
 void instanteneousMAPReading(void)
 {
   //Update the calculation times and last value. These are used by the MAP based Accel enrich
@@ -230,16 +532,16 @@ void instanteneousMAPReading(void)
   #if defined(ANALOG_ISR_MAP)
     tempReading = AnChannel[pinMAP-A0];
   #else
-    tempReading = analogRead(pinMAP);
-    tempReading = analogRead(pinMAP);
+    tempReading = readAnalogPin(pinMAP);
   #endif
-  //Error checking
-  if( (tempReading >= VALID_MAP_MAX) || (tempReading <= VALID_MAP_MIN) ) { mapErrorCount += 1; }
-  else { mapErrorCount = 0; }
-
+  //Readings at the limits of the ADC are discarded. The other sampling methods also set mapADC, so the filter continues from that
+  sensorChannelConfig mapConfig = { 0U, false, configPage4.ADCFILTER_MAP, VALID_MAP_MIN + 1U, VALID_MAP_MAX - 1U, 0U }; //Very weak filter
+  mapChannel.value = currentStatus.mapADC;
   //During startup a call is made here to get the baro reading. In this case, we can't apply the ADC filter
-  if(currentStatus.initialisationComplete == true) { currentStatus.mapADC = ADC_FILTER(tempReading, configPage4.ADCFILTER_MAP, currentStatus.mapADC); } //Very weak filter
-  else { currentStatus.mapADC = tempReading; } //Baro reading (No filter)
+  if(currentStatus.initialisationComplete == false) { sensorChannelReset(mapChannel); }
+  sensorChannelUpdate(mapChannel, mapConfig, tempReading);
+  mapErrorCount = mapChannel.errorCount;
+  currentStatus.mapADC = mapChannel.value;
 
   currentStatus.MAP = fastMap10Bit(currentStatus.mapADC, configPage2.mapMin, configPage2.mapMax); //Get the current MAP value
   if(currentStatus.MAP < 0) { currentStatus.MAP = 0; } //Sanity check
@@ -250,25 +552,89 @@ void instanteneousMAPReading(void)
     #if defined(ANALOG_ISR_MAP)
       tempReading = AnChannel[pinEMAP-A0];
     #else
-      tempReading = analogRead(pinEMAP);
-      tempReading = analogRead(pinEMAP);
+      tempReading = readAnalogPin(pinEMAP);
     #endif
 
-    //Error check
-    if( (tempReading < VALID_MAP_MAX) && (tempReading > VALID_MAP_MIN) )
+    emapChannel.value = currentStatus.EMAPADC;
+    if(sensorChannelUpdate(emapChannel, mapConfig, tempReading) == SENSOR_SAMPLE_REJECTED) { mapErrorCount += 1; }
+    currentStatus.EMAPADC = emapChannel.value;
+    currentStatus.EMAP = fastMap10Bit(currentStatus.EMAPADC, configPage2.EMAPMin, configPage2.EMAPMax);
+    if(currentStatus.EMAP < 0) { currentStatus.EMAP = 0; } //Sanity check
+  }
+
+}
+
+/** Update MAP (And EMAP) from the crank angle triggered samples, combined according to the MAP sampling method.
+ * Samples outside of the valid range are left out.
+ */
+static void readAngleSampledMAP(void)
+{
+  uint16_t mapADC = 0;
+  uint16_t emapADC = 0;
+
+  if(configPage2.mapSample == 3U)
+  {
+    //Event average. Each cylinder's sample is used as soon as it arrives
+    if(readLatestMAPAngleSample(mapADC, emapADC) == false) { return; }
+    if( (mapADC >= VALID_MAP_MAX) || (mapADC <= VALID_MAP_MIN) ) { mapErrorCount += 1; return; }
+  }
+  else
+  {
+    mapAngleCycle cycle;
+    if(readMAPAngleCycle(cycle) == false) { return; }
+
+    uint32_t mapTotal = 0;
+    uint32_t emapTotal = 0;
+    uint16_t mapMinimum = 1023;
+    uint8_t validCount = 0;
+    for(uint8_t cylinder = 0; cylinder < cycle.cylinders; cylinder++)
+    {
+      if( (cycle.mapADC[cylinder] < VALID_MAP_MAX) && (cycle.mapADC[cylinder] > VALID_MAP_MIN) )
       {
-        currentStatus.EMAPADC = ADC_FILTER(tempReading, configPage4.ADCFILTER_MAP, currentStatus.EMAPADC);
+        mapTotal += cycle.mapADC[cylinder];
+        emapTotal += cycle.emapADC[cylinder];
+        if(cycle.mapADC[cylinder] < mapMinimum) { mapMinimum = cycle.mapADC[cylinder]; }
+        validCount++;
       }
-    else { mapErrorCount += 1; }
+      else { mapErrorCount += 1; }
+    }
+    if(validCount == 0U) { return; }
+
+    if(configPage2.mapSample == 2U) { mapADC = mapMinimum; } //Cycle minimum
+    else { mapADC = udiv_32_16(mapTotal, validCount); } //Cycle average
+    emapADC = udiv_32_16(emapTotal, validCount);
+  }
+
+  //Update the calculation times and last value. These are used by the MAP based Accel enrich
+  MAPlast = currentStatus.MAP;
+  MAPlast_time = MAP_time;
+  MAP_time = micros();
+
+  currentStatus.mapADC = mapADC;
+  currentStatus.MAP = fastMap10Bit(currentStatus.mapADC, configPage2.mapMin, configPage2.mapMax); //Get the current MAP value
+  validateMAP();
+
+  if(configPage6.useEMAP == true)
+  {
+    currentStatus.EMAPADC = emapADC;
     currentStatus.EMAP = fastMap10Bit(currentStatus.EMAPADC, configPage2.EMAPMin, configPage2.EMAPMax);
     if(currentStatus.EMAP < 0) { currentStatus.EMAP = 0; } //Sanity check
   }
-
 }
 
 void readMAP(void)
 {
   unsigned int tempReading;
+
+  //Crank angle triggered sampling replaces the samples taken here, but only once the engine is running and synced
+  configureMAPAngleSampling( MAP_ANGLE_SAMPLING_AVAILABLE && (configPage15.mapAngleSampling == true) && (configPage2.mapSample != 0U) && BIT_CHECK(decoderState, BIT_DECODER_MAP_ANGLE),
+                             configPage2.nCylinders, (configPage2.strokes == FOUR_STROKE) ? 720U : 360U, configPage15.mapSampleAngle );
+  if( (isMAPAngleSamplingActive() == true) && (currentStatus.RPMdiv100 > configPage2.mapSwitchPoint) && ((currentStatus.hasSync == true) || BIT_CHECK(currentStatus.status3, BIT_STATUS3_HALFSYNC)) && (currentStatus.startRevolutions > 1) )
+  {
+    readAngleSampledMAP();
+    return;
+  }
+
   //MAP Sampling system
   switch(configPage2.mapSample)
   {
@@ -287,8 +653,7 @@ void readMAP(void)
           #if defined(ANALOG_ISR_MAP)
             tempReading = AnChannel[pinMAP-A0];
           #else
-            tempReading = analogRead(pinMAP);
-            tempReading = analogRead(pinMAP);
+            tempReading = readAnalogPin(pinMAP);
           #endif
 
           //Error check
@@ -306,8 +671,7 @@ void readMAP(void)
             #if defined(ANALOG_ISR_MAP)
               tempReading = AnChannel[pinEMAP-A0];
             #else
-              tempReading = analogRead(pinEMAP);
-              tempReading = analogRead(pinEMAP);
+              tempReading = readAnalogPin(pinEMAP);
             #endif
 
             //Error check
@@ -371,8 +735,7 @@ void readMAP(void)
           #if defined(ANALOG_ISR_MAP)
             tempReading = AnChannel[pinMAP-A0];
           #else
-            tempReading = analogRead(pinMAP);
-            tempReading = analogRead(pinMAP);
+            tempReading = readAnalogPin(pinMAP);
           #endif
           //Error check
           if( (tempReading < VALID_MAP_MAX) && (tempReading > VALID_MAP_MIN) )
@@ -414,8 +777,7 @@ void readMAP(void)
           #if defined(ANALOG_ISR_MAP)
             tempReading = AnChannel[pinMAP-A0];
           #else
-            tempReading = analogRead(pinMAP);
-            tempReading = analogRead(pinMAP);
+            tempReading = readAnalogPin(pinMAP);
           #endif
 
           //Error check
@@ -468,17 +830,22 @@ void readTPS(bool useFilter)
 {
   currentStatus.TPSlast = currentStatus.TPS;
   #if defined(ANALOG_ISR)
-    byte tempTPS = fastMap1023toX(AnChannel[pinTPS-A0], 255); //Get the current raw TPS ADC value and map it into a byte
+    uint16_t tempReading = AnChannel[pinTPS-A0]; //Get the current raw TPS ADC value
   #else
-    analogRead(pinTPS);
-    byte tempTPS = fastMap1023toX(analogRead(pinTPS), 255); //Get the current raw TPS ADC value and map it into a byte
+    uint16_t tempReading = readAnalogPin(pinTPS); //Get the current raw TPS ADC value
   #endif
   //The use of the filter can be overridden if required. This is used on startup to disable priming pulse if flood clear is wanted
-  if(useFilter == true) { currentStatus.tpsADC = ADC_FILTER(tempTPS, configPage4.ADCFILTER_TPS, currentStatus.tpsADC); }
-  else { currentStatus.tpsADC = tempTPS; }
+  if(useFilter == false) { sensorChannelReset(sensorChannels[SENSOR_CHANNEL_TPS]); }
+  bool wasFaulty = sensorChannels[SENSOR_CHANNEL_TPS].faulty;
+  uint8_t result = updateSensorChannel(SENSOR_CHANNEL_TPS, configPage4.ADCFILTER_TPS, tempReading);
+  currentStatus.tpsADC = fastMap1023toX(sensorChannels[SENSOR_CHANNEL_TPS].value, 255); //Map the filtered value into a byte
   byte tempADC = currentStatus.tpsADC; //The tempADC value is used in order to allow TunerStudio to recover and redo the TPS calibration if this somehow gets corrupted
 
-  if(configPage2.tpsMax > configPage2.tpsMin)
+  if(checkSensorFault(SENSOR_CHANNEL_TPS, result, wasFaulty, ERR_TPS_GND, ERR_TPS_SHORT) == true)
+  {
+    currentStatus.TPS = ERR_DEFAULT_TPS_SHORT * 2U; //TPS is in 0.5% steps
+  }
+  else if(configPage2.tpsMax > configPage2.tpsMin)
   {
     //Check that the ADC values fall within the min and max ranges (Should always be the case, but noise can cause these to fluctuate outside the defined range).
     if (currentStatus.tpsADC < configPage2.tpsMin) { tempADC = configPage2.tpsMin; }
@@ -515,15 +882,17 @@ void readCLT(bool useFilter)
   #if defined(ANALOG_ISR)
     tempReading = AnChannel[pinCLT-A0]; //Get the current raw CLT value
   #else
-    tempReading = analogRead(pinCLT);
-    tempReading = analogRead(pinCLT);
+    tempReading = readAnalogPin(pinCLT);
     //tempReading = fastMap1023toX(analogRead(pinCLT), 511); //Get the current raw CLT value
   #endif
   //The use of the filter can be overridden if required. This is used on startup so there can be an immediately accurate coolant value for priming
-  if(useFilter == true) { currentStatus.cltADC = ADC_FILTER(tempReading, configPage4.ADCFILTER_CLT, currentStatus.cltADC); }
-  else { currentStatus.cltADC = tempReading; }
-  
-  currentStatus.coolant = table2D_getValue(&cltCalibrationTable, currentStatus.cltADC) - CALIBRATION_TEMPERATURE_OFFSET; //Temperature calibration values are stored as positive bytes. We subtract 40 from them to allow for negative temperatures
+  if(useFilter == false) { sensorChannelReset(sensorChannels[SENSOR_CHANNEL_CLT]); }
+  bool wasFaulty = sensorChannels[SENSOR_CHANNEL_CLT].faulty;
+  uint8_t result = updateSensorChannel(SENSOR_CHANNEL_CLT, configPage4.ADCFILTER_CLT, tempReading);
+  currentStatus.cltADC = sensorChannels[SENSOR_CHANNEL_CLT].value;
+
+  if(checkSensorFault(SENSOR_CHANNEL_CLT, result, wasFaulty, ERR_CLT_GND, ERR_CLT_SHORT) == true) { currentStatus.coolant = ERR_DEFAULT_CLT_GND - CALIBRATION_TEMPERATURE_OFFSET; }
+  else { currentStatus.coolant = table2D_getValue(&cltCalibrationTable, currentStatus.cltADC) - CALIBRATION_TEMPERATURE_OFFSET; } //Temperature calibration values are stored as positive bytes. We subtract 40 from them to allow for negative temperatures
 }
 
 void readIAT(void)
@@ -532,11 +901,14 @@ void readIAT(void)
   #if defined(ANALOG_ISR)
     tempReading = AnChannel[pinIAT-A0]; //Get the current raw IAT value
   #else
-    tempReading = analogRead(pinIAT);
-    tempReading = analogRead(pinIAT);
+    tempReading = readAnalogPin(pinIAT);
   #endif
-  currentStatus.iatADC = ADC_FILTER(tempReading, configPage4.ADCFILTER_IAT, currentStatus.iatADC);
-  currentStatus.IAT = table2D_getValue(&iatCalibrationTable, currentStatus.iatADC) - CALIBRATION_TEMPERATURE_OFFSET;
+  bool wasFaulty = sensorChannels[SENSOR_CHANNEL_IAT].faulty;
+  uint8_t result = updateSensorChannel(SENSOR_CHANNEL_IAT, configPage4.ADCFILTER_IAT, tempReading);
+  currentStatus.iatADC = sensorChannels[SENSOR_CHANNEL_IAT].value;
+
+  if(checkSensorFault(SENSOR_CHANNEL_IAT, result, wasFaulty, ERR_IAT_GND, ERR_IAT_SHORT) == true) { currentStatus.IAT = ERR_DEFAULT_IAT_GND - CALIBRATION_TEMPERATURE_OFFSET; }
+  else { currentStatus.IAT = table2D_getValue(&iatCalibrationTable, currentStatus.iatADC) - CALIBRATION_TEMPERATURE_OFFSET; }
 }
 
 void readBaro(void)
@@ -548,14 +920,16 @@ void readBaro(void)
     #if defined(ANALOG_ISR_MAP)
       tempReading = AnChannel[pinBaro-A0];
     #else
-      tempReading = analogRead(pinBaro);
-      tempReading = analogRead(pinBaro);
+      tempReading = readAnalogPin(pinBaro);
     #endif
 
-    if(currentStatus.initialisationComplete == true) { currentStatus.baroADC = ADC_FILTER(tempReading, configPage4.ADCFILTER_BARO, currentStatus.baroADC); }//Very weak filter
-    else { currentStatus.baroADC = tempReading; } //Baro reading (No filter)
+    if(currentStatus.initialisationComplete == false) { sensorChannelReset(sensorChannels[SENSOR_CHANNEL_BARO]); } //Startup reading (No filter)
+    bool wasFaulty = sensorChannels[SENSOR_CHANNEL_BARO].faulty;
+    uint8_t result = updateSensorChannel(SENSOR_CHANNEL_BARO, configPage4.ADCFILTER_BARO, tempReading); //Very weak filter
+    currentStatus.baroADC = sensorChannels[SENSOR_CHANNEL_BARO].value;
 
-    currentStatus.baro = fastMap10Bit(currentStatus.baroADC, configPage2.baroMin, configPage2.baroMax); //Get the current MAP value
+    if(checkSensorFault(SENSOR_CHANNEL_BARO, result, wasFaulty, ERR_BARO_LOW, ERR_BARO_HIGH) == true) { currentStatus.baro = ERR_DEFAULT_BARO; }
+    else { currentStatus.baro = fastMap10Bit(currentStatus.baroADC, configPage2.baroMin, configPage2.baroMax); } //Get the current MAP value
   }
   else
   {
@@ -599,13 +973,15 @@ void readO2(void)
     #if defined(ANALOG_ISR)
       tempReading = AnChannel[pinO2-A0]; //Get the current O2 value.
     #else
-      tempReading = analogRead(pinO2);
-      tempReading = analogRead(pinO2);
+      tempReading = readAnalogPin(pinO2);
       //tempReading = fastMap1023toX(analogRead(pinO2), 511); //Get the current O2 value.
     #endif
-    currentStatus.O2ADC = ADC_FILTER(tempReading, configPage4.ADCFILTER_O2, currentStatus.O2ADC);
+    bool wasFaulty = sensorChannels[SENSOR_CHANNEL_O2].faulty;
+    uint8_t result = updateSensorChannel(SENSOR_CHANNEL_O2, configPage4.ADCFILTER_O2, tempReading);
+    currentStatus.O2ADC = sensorChannels[SENSOR_CHANNEL_O2].value;
     //currentStatus.O2 = o2CalibrationTable[currentStatus.O2ADC];
-    currentStatus.O2 = table2D_getValue(&o2CalibrationTable, currentStatus.O2ADC);
+    if(checkSensorFault(SENSOR_CHANNEL_O2, result, wasFaulty, ERR_O2_GND, ERR_O2_SHORT) == true) { currentStatus.O2 = ERR_DEFAULT_O2_GND; }
+    else { currentStatus.O2 = table2D_getValue(&o2CalibrationTable, currentStatus.O2ADC); }
   }
   else
   {
@@ -623,29 +999,39 @@ void readO2_2(void)
   #if defined(ANALOG_ISR)
     tempReading = AnChannel[pinO2_2-A0]; //Get the current O2 value.
   #else
-    tempReading = analogRead(pinO2_2);
-    tempReading = analogRead(pinO2_2);
+    tempReading = readAnalogPin(pinO2_2);
     //tempReading = fastMap1023toX(analogRead(pinO2_2), 511); //Get the current O2 value.
   #endif
-  currentStatus.O2_2ADC = ADC_FILTER(tempReading, configPage4.ADCFILTER_O2, currentStatus.O2_2ADC);
-  currentStatus.O2_2 = table2D_getValue(&o2CalibrationTable, currentStatus.O2_2ADC);
+  bool wasFaulty = sensorChannels[SENSOR_CHANNEL_O2_2].faulty;
+  uint8_t result = updateSensorChannel(SENSOR_CHANNEL_O2_2, configPage4.ADCFILTER_O2, tempReading);
+  currentStatus.O2_2ADC = sensorChannels[SENSOR_CHANNEL_O2_2].value;
+  if(checkSensorFault(SENSOR_CHANNEL_O2_2, result, wasFaulty, ERR_O2_GND, ERR_O2_SHORT) == true) { currentStatus.O2_2 = ERR_DEFAULT_O2_GND; }
+  else { currentStatus.O2_2 = table2D_getValue(&o2CalibrationTable, currentStatus.O2_2ADC); }
 }
 
 void readBat(void)
 {
-  int tempReading;
+  uint16_t rawReading;
   #if defined(ANALOG_ISR)
-    tempReading = fastMap1023toX(AnChannel[pinBat-A0], 245); //Get the current raw Battery value. Permissible values are from 0v to 24.5v (245)
+    rawReading = AnChannel[pinBat-A0]; //Get the current raw Battery value
   #else
-    tempReading = analogRead(pinBat);
-    tempReading = fastMap1023toX(analogRead(pinBat), 245); //Get the current raw Battery value. Permissible values are from 0v to 24.5v (245)
+    rawReading = readAnalogPin(pinBat); //Get the current raw Battery value
   #endif
+  bool wasFaulty = sensorChannels[SENSOR_CHANNEL_BAT].faulty;
+  uint8_t result = updateSensorChannel(SENSOR_CHANNEL_BAT, configPage4.ADCFILTER_BAT, rawReading);
+  if(checkSensorFault(SENSOR_CHANNEL_BAT, result, wasFaulty, ERR_BAT_LOW, ERR_BAT_HIGH) == true)
+  {
+    currentStatus.battery10 = ERR_DEFAULT_BAT_LOW;
+    return;
+  }
 
-  //Apply the offset calibration value to the reading
-  tempReading += configPage4.batVoltCorrect;
+  //Permissible values are from 0v to 24.5v (245). The offset calibration value is applied to the reading
+  int tempReading = (int)fastMap1023toX(sensorChannels[SENSOR_CHANNEL_BAT].reading, 245) + configPage4.batVoltCorrect; //Latest unfiltered reading
   if(tempReading < 0){
     tempReading=0;
   }  //with negative overflow prevention
+  int tempBattery = (int)fastMap1023toX(sensorChannels[SENSOR_CHANNEL_BAT].value, 245) + configPage4.batVoltCorrect;
+  if(tempBattery < 0) { tempBattery = 0; }
 
 
   //The following is a check for if the voltage has jumped up from under 5.5v to over 7v.
@@ -665,7 +1051,7 @@ void readBat(void)
     }
   }
 
-  currentStatus.battery10 = ADC_FILTER(tempReading, configPage4.ADCFILTER_BAT, currentStatus.battery10);
+  currentStatus.battery10 = tempBattery;
 }
 
 /**
@@ -765,12 +1151,13 @@ byte getFuelPressure(void)
     #if defined(ANALOG_ISR)
       tempReading = AnChannel[pinFuelPressure-A0];
     #else
-      tempReading = analogRead(pinFuelPressure);
-      tempReading = analogRead(pinFuelPressure);
+      tempReading = readAnalogPin(pinFuelPressure);
     #endif
 
-    tempFuelPressure = fastMap10Bit(tempReading, configPage10.fuelPressureMin, configPage10.fuelPressureMax);
-    tempFuelPressure = ADC_FILTER(tempFuelPressure, ADCFILTER_PSI_DEFAULT, currentStatus.fuelPressure); //Apply smoothing factor
+    bool wasFaulty = sensorChannels[SENSOR_CHANNEL_FUEL_PRESSURE].faulty;
+    uint8_t result = updateSensorChannel(SENSOR_CHANNEL_FUEL_PRESSURE, configPage15.ADCFILTER_PSI, tempReading); //Apply smoothing factor
+    if(checkSensorFault(SENSOR_CHANNEL_FUEL_PRESSURE, result, wasFaulty, ERR_FUELP_LOW, ERR_FUELP_HIGH) == true) { return ERR_DEFAULT_FUELP; }
+    tempFuelPressure = fastMap10Bit(sensorChannels[SENSOR_CHANNEL_FUEL_PRESSURE].value, configPage10.fuelPressureMin, configPage10.fuelPressureMax);
     //Sanity checks
     if(tempFuelPressure > configPage10.fuelPressureMax) { tempFuelPressure = configPage10.fuelPressureMax; }
     if(tempFuelPressure < 0 ) { tempFuelPressure = 0; } //prevent negative values, which will cause problems later when the values aren't signed.
@@ -790,13 +1177,14 @@ byte getOilPressure(void)
     #if defined(ANALOG_ISR)
       tempReading = AnChannel[pinOilPressure-A0];
     #else
-      tempReading = analogRead(pinOilPressure);
-      tempReading = analogRead(pinOilPressure);
+      tempReading = readAnalogPin(pinOilPressure);
     #endif
 
 
-    tempOilPressure = fastMap10Bit(tempReading, configPage10.oilPressureMin, configPage10.oilPressureMax);
-    tempOilPressure = ADC_FILTER(tempOilPressure, ADCFILTER_PSI_DEFAULT, currentStatus.oilPressure); //Apply smoothing factor
+    bool wasFaulty = sensorChannels[SENSOR_CHANNEL_OIL_PRESSURE].faulty;
+    uint8_t result = updateSensorChannel(SENSOR_CHANNEL_OIL_PRESSURE, configPage15.ADCFILTER_PSI, tempReading); //Apply smoothing factor
+    if(checkSensorFault(SENSOR_CHANNEL_OIL_PRESSURE, result, wasFaulty, ERR_OILP_LOW, ERR_OILP_HIGH) == true) { return ERR_DEFAULT_OILP; }
+    tempOilPressure = fastMap10Bit(sensorChannels[SENSOR_CHANNEL_OIL_PRESSURE].value, configPage10.oilPressureMin, configPage10.oilPressureMax);
     //Sanity check
     if(tempOilPressure > configPage10.oilPressureMax) { tempOilPressure = configPage10.oilPressureMax; }
     if(tempOilPressure < 0 ) { tempOilPressure = 0; } //prevent negative values, which will cause problems later when the values aren't signed.
@@ -819,8 +1207,7 @@ uint8_t getAnalogKnock(void)
   #if defined(ANALOG_ISR)
     tempReading = AnChannel[pinKnock-A0];
   #else
-    tempReading = analogRead(pinKnock);
-    tempReading = analogRead(pinKnock);
+    tempReading = readAnalogPin(pinKnock);
   #endif
 
   tempReading = fastMap1023toX(tempReading, 255);
@@ -879,8 +1266,7 @@ uint16_t readAuxanalog(uint8_t analogPin)
   #if defined(ANALOG_ISR)
     tempReading = AnChannel[analogPin-A0]; //Get the current raw Auxanalog value
   #else
-    tempReading = analogRead(analogPin);
-    tempReading = analogRead(analogPin);
+    tempReading = readAnalogPin(analogPin);
   #endif
   return tempReading;
 } 
@@ -13,7 +13,24 @@
 #define ADCFILTER_MAP_DEFAULT   20 //This is only used on Instantaneous MAP readings and is intentionally very weak to allow for faster response
 #define ADCFILTER_BARO_DEFAULT  64
 
-#define ADCFILTER_PSI_DEFAULT  150 //not currently configurable at runtime, used for misc pressure sensors, oil, fuel, etc.
+#define ADCFILTER_PSI_DEFAULT  150 //Used for misc pressure sensors, oil, fuel, etc.
+
+//Index of each sensor's settings in configPage15.sensorMode, sensorFaultLow and sensorFaultHigh
+#define SENSOR_CHANNEL_TPS            0
+#define SENSOR_CHANNEL_CLT            1
+#define SENSOR_CHANNEL_IAT            2
+#define SENSOR_CHANNEL_O2             3
+#define SENSOR_CHANNEL_O2_2           4
+#define SENSOR_CHANNEL_BAT            5
+#define SENSOR_CHANNEL_BARO           6
+#define SENSOR_CHANNEL_FUEL_PRESSURE  7
+#define SENSOR_CHANNEL_OIL_PRESSURE   8
+#define SENSOR_CHANNEL_COUNT          9
+
+//configPage15.sensorMode bits
+#define SENSOR_MODE_DECIMATION    0x03U
+#define SENSOR_MODE_MEDIAN        0x04U
+#define SENSOR_MODE_FAULT_SHIFT   4U
 
 #define FILTER_FLEX_DEFAULT     75
 
@@ -52,6 +69,7 @@ extern unsigned long MAPlast_time; //The time the previous MAP sample was taken
 #define ADC_FILTER(input, alpha, prior) (((long)input * (256 - alpha) + ((long)prior * alpha))) >> 8
 
 void initialiseADC(void);
+void adcConversionComplete(uint16_t result); //Called by the board end of conversion interrupt, see map_sampling.h
 void readTPS(bool useFilter=true); //Allows the option to override the use of the filter
 void readO2_2(void);
 void flexPulse(void);
@@ -68,7 +68,7 @@ void setup(void)
 
 inline uint16_t applyFuelTrimToPW(trimTable3d *pTrimTable, int16_t fuelLoad, int16_t RPM, uint16_t currentPW)
 {
-    uint8_t pw1percent = 100U + get3DTableValue(pTrimTable, fuelLoad, RPM) - OFFSET_FUELTRIM;
+    uint8_t pw1percent = 100U + get3DTableValue(pTrimTable, fuelLoad, RPM, &trimAxisCache) - OFFSET_FUELTRIM;
     return percentage(pw1percent, currentPW);
 }
 
@@ -94,8 +94,8 @@ void loop(void)
       LOOP_TIMER = TIMER_mask;
 
       //SERIAL Comms
-      //Initially check that the last serial send values request is not still outstanding
-      if (serialTransmitInProgress())
+      //Initially check that the last serial send values request is not still outstanding, or if a subscribed live data frame is due
+      if (serialTransmitInProgress() || ( (serialStatusFlag == SERIAL_INACTIVE) && isLiveDataStreamActive() ))
       {
         serialTransmit();
       }
@@ -129,6 +129,7 @@ void loop(void)
             if (configPage2.canWBO > 0) { receiveCANwbo(); }
           }
         }   
+        sendCANBroadcast(); //Each broadcast frame has its own period, this only sends the ones that are due
       #endif
           
     if(currentLoopTime > micros_safe())
@@ -199,6 +200,11 @@ void loop(void)
     {
       BIT_CLEAR(TIMER_mask, BIT_TIMER_1KHZ);
       readMAP();
+
+      #ifdef SD_LOGGING
+        //Cycle log snapshots are taken by the trigger interrupt, this only moves them from its buffer to the SD card
+        if(getSDLogRate() == LOGGER_RATE_CYCLE) { writeSDLogEntry(); }
+      #endif
     }
     if(BIT_CHECK(LOOP_TIMER, BIT_TIMER_200HZ))
     {
@@ -207,15 +213,18 @@ void loop(void)
         //ADC in free running mode does 1 complete conversion of all 16 channels and then the interrupt is disabled. Every 200Hz we re-enable the interrupt to get another conversion cycle
         BIT_SET(ADCSRA,ADIE); //Enable ADC interrupt
       #endif
+
+      #ifdef SD_LOGGING
+        if(getSDLogRate() == LOGGER_RATE_200HZ) { writeSDLogEntry(); }
+      #endif
     }
     if(BIT_CHECK(LOOP_TIMER, BIT_TIMER_50HZ)) //50 hertz
     {
       BIT_CLEAR(TIMER_mask, BIT_TIMER_50HZ);
 
-      #if defined(NATIVE_CAN_AVAILABLE)
-      sendCANBroadcast(50);
+      #ifdef SD_LOGGING
+        if(getSDLogRate() == LOGGER_RATE_50HZ) { writeSDLogEntry(); }
       #endif
-
     }
     if(BIT_CHECK(LOOP_TIMER, BIT_TIMER_30HZ)) //30 hertz
     {
@@ -235,16 +244,12 @@ void loop(void)
         readO2_2();
       }
       
-      #if defined(NATIVE_CAN_AVAILABLE)
-      sendCANBroadcast(30);
-      #endif
-
       #ifdef SD_LOGGING
-        if(configPage13.onboard_log_file_rate == LOGGER_RATE_30HZ) { writeSDLogEntry(); }
+        if(getSDLogRate() == LOGGER_RATE_30HZ) { writeSDLogEntry(); }
       #endif
 
       //Check for any outstanding EEPROM writes.
-      if( (isEepromWritePending() == true) && (serialStatusFlag == SERIAL_INACTIVE) && (micros() > deferEEPROMWritesUntil)) { writeAllConfig(); } 
+      if( (isEepromWritePending() == true) && (serialStatusFlag == SERIAL_INACTIVE) && (micros() > deferEEPROMWritesUntil)) { writeAllDirtyConfig(); } 
     }
     if (BIT_CHECK(LOOP_TIMER, BIT_TIMER_15HZ)) //Every 32 loops
     {
@@ -261,13 +266,6 @@ void loop(void)
       #endif     
 
       checkLaunchAndFlatShift(); //Check for launch control and flat shift being active
-
-      #if defined(NATIVE_CAN_AVAILABLE)
-      sendCANBroadcast(15);
-      #endif
-
-      //And check whether the tooth log buffer is ready
-      if(toothHistoryIndex > TOOTH_LOG_SIZE) { BIT_SET(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY); }
     }
     if(BIT_CHECK(LOOP_TIMER, BIT_TIMER_10HZ)) //10 hertz
     {
@@ -282,12 +280,8 @@ void loop(void)
       currentStatus.vss = getSpeed();
       currentStatus.gear = getGear();
 
-      #if defined(NATIVE_CAN_AVAILABLE)
-      sendCANBroadcast(10);
-      #endif
-
       #ifdef SD_LOGGING
-        if(configPage13.onboard_log_file_rate == LOGGER_RATE_10HZ) { writeSDLogEntry(); }
+        if(getSDLogRate() == LOGGER_RATE_10HZ) { writeSDLogEntry(); }
       #endif
     }
     if (BIT_CHECK(LOOP_TIMER, BIT_TIMER_4HZ))
@@ -307,7 +301,7 @@ void loop(void)
       }
 
       #ifdef SD_LOGGING
-        if(configPage13.onboard_log_file_rate == LOGGER_RATE_4HZ) { writeSDLogEntry(); }
+        if(getSDLogRate() == LOGGER_RATE_4HZ) { writeSDLogEntry(); }
         syncSDLog(); //Sync the SD log file to the card 4 times per second. 
       #endif  
       
@@ -391,7 +385,7 @@ void loop(void)
       }
 
       #ifdef SD_LOGGING
-        if(configPage13.onboard_log_file_rate == LOGGER_RATE_1HZ) { writeSDLogEntry(); }
+        if(getSDLogRate() == LOGGER_RATE_1HZ) { writeSDLogEntry(); }
       #endif
 
     } //1Hz timer
@@ -446,6 +440,9 @@ void loop(void)
       //END SETTING ENGINE STATUSES
       //-----------------------------------------------------------------------------------------------------
 
+      //Update the crank speed prediction before any of the angle<->time conversions are used
+      doCrankSpeedCalcs();
+
       //Begin the fuel calculation
       //Calculate an injector pulsewidth from the VE
       currentStatus.afrTarget = calculateAfrTarget(afrTable, currentStatus, configPage2, configPage6);
@@ -469,24 +466,6 @@ void loop(void)
         currentStatus.PW1 = currentStatus.PW1 + (configPage10.n2o_stage2_adderMax + percentage(adderPercent, (configPage10.n2o_stage2_adderMin - configPage10.n2o_stage2_adderMax))) * 100; //Calculate the above percentage of the calculated ms value.
       }
 
-      int injector1StartAngle = 0;
-      uint16_t injector2StartAngle = 0;
-      uint16_t injector3StartAngle = 0;
-      uint16_t injector4StartAngle = 0;
-
-      #if INJ_CHANNELS >= 5
-      uint16_t injector5StartAngle = 0;
-      #endif
-      #if INJ_CHANNELS >= 6
-      uint16_t injector6StartAngle = 0;
-      #endif
-      #if INJ_CHANNELS >= 7
-      uint16_t injector7StartAngle = 0;
-      #endif
-      #if INJ_CHANNELS >= 8
-      uint16_t injector8StartAngle = 0;
-      #endif
-      
       //Check that the duty cycle of the chosen pulsewidth isn't too high.
       uint16_t pwLimit = calculatePWLimit();
       //Apply the pwLimit if staging is disabled and engine is not cranking
@@ -1301,7 +1280,7 @@ byte getVE1(void)
     currentStatus.fuelLoad = ((int16_t)currentStatus.MAP * 100U) / currentStatus.EMAP;
   }
   else { currentStatus.fuelLoad = currentStatus.MAP; } //Fallback position
-  tempVE = get3DTableValue(&fuelTable, currentStatus.fuelLoad, currentStatus.RPM); //Perform lookup into fuel map for RPM vs MAP value
+  tempVE = get3DTableValue(&fuelTable, currentStatus.fuelLoad, currentStatus.RPM, &rpmLoadAxisCache); //Perform lookup into fuel map for RPM vs MAP value
 
   return tempVE;
 }
@@ -1330,7 +1309,9 @@ byte getAdvance1(void)
     //IMAP / EMAP
     currentStatus.ignLoad = ((int16_t)currentStatus.MAP * 100U) / currentStatus.EMAP;
   }
-  tempAdvance = get3DTableValue(&ignitionTable, currentStatus.ignLoad, currentStatus.RPM) - OFFSET_IGNITION; //As above, but for ignition advance
+  //The axis search can only be shared with the fuel table when both use the same load source
+  if (configPage2.ignAlgorithm == configPage2.fuelAlgorithm) { tempAdvance = get3DTableValue(&ignitionTable, currentStatus.ignLoad, currentStatus.RPM, &rpmLoadAxisCache) - OFFSET_IGNITION; }
+  else { tempAdvance = get3DTableValue(&ignitionTable, currentStatus.ignLoad, currentStatus.RPM) - OFFSET_IGNITION; } //As above, but for ignition advance
   tempAdvance = correctionsIgn(tempAdvance);
 
   return tempAdvance;
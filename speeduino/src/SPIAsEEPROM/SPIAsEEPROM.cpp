@@ -52,6 +52,8 @@ FLASH_EEPROM_BaseClass::FLASH_EEPROM_BaseClass(EEPROM_Emulation_Config config)
     _Flash_Size_Per_EEPROM_Byte = _config.Flash_Sector_Size/(_config.EEPROM_Bytes_Per_Sector +1);
     _Addres_Translation_Size = _Flash_Size_Per_EEPROM_Byte/8;
     _EEPROM_Emulation_Size = _config.Flash_Sectors_Used*_config.EEPROM_Bytes_Per_Sector;
+
+    clearMirror();
 }
 
 int8_t FLASH_EEPROM_BaseClass::initialize(bool flashavailable)
@@ -77,6 +79,11 @@ int8_t FLASH_EEPROM_BaseClass::initialize(bool flashavailable)
 }
 
 byte FLASH_EEPROM_BaseClass::read(uint16_t addressEEPROM){
+    if (isMirrored(addressEEPROM)) { return _mirror[addressEEPROM]; }
+    return readFlash(addressEEPROM);
+}
+
+byte FLASH_EEPROM_BaseClass::readFlash(uint16_t addressEEPROM){
     //version 0.1 does not check magic number
 
     byte EEPROMbyte;
@@ -124,8 +131,11 @@ int8_t FLASH_EEPROM_BaseClass::write(uint16_t addressEEPROM, byte val){
     //Check if address is outside of the maximum. limit to get inside maximum and return an error.
     if (addressEEPROM > _EEPROM_Emulation_Size){addressEEPROM = _EEPROM_Emulation_Size - 1; return -1;}  
     
+    //Nothing to write if the mirror already holds this value
+    if (isMirrored(addressEEPROM) && (_mirror[addressEEPROM] == val)) { return 0; }
+
     //read the current value
-    uint8_t readValue = read(addressEEPROM);
+    uint8_t readValue = readFlash(addressEEPROM);
 
     //After reading the current byte all global variables containing information about the address are set correctly. 
 
@@ -138,9 +148,12 @@ int8_t FLASH_EEPROM_BaseClass::write(uint16_t addressEEPROM, byte val){
         byte tempBuf[_config.EEPROM_Bytes_Per_Sector];
         for(uint16_t i = 0; i<_config.EEPROM_Bytes_Per_Sector; i++){
             uint16_t TempEEPROMaddress = (_sectorFlash*_config.EEPROM_Bytes_Per_Sector) + i;
-            tempBuf[i] = read(TempEEPROMaddress);
+            tempBuf[i] = readFlash(TempEEPROMaddress);
         }
 
+        //The erase changes the flash under the mirror. The writes below load the sector again, from the erased flash
+        if (_sectorFlash < FLASH_EEPROM_MIRROR_SECTORS) { _mirrorLoaded[_sectorFlash / BITS_PER_BYTE] &= ~(1U << (_sectorFlash % BITS_PER_BYTE)); }
+
         //Now erase the sector
         eraseFlashSector(_sectorFlash*_config.Flash_Sector_Size, _config.Flash_Sector_Size);
 
@@ -183,6 +196,9 @@ int8_t FLASH_EEPROM_BaseClass::write(uint16_t addressEEPROM, byte val){
       AdressInAddressTranslation &= ~(0x1); //align address with 2 byte for write to flash for 32bit STM32 MCU
       memcpy(&tempBuffer, &_ReadWriteBuffer[AdressInAddressTranslation], sizeof(uint16_t));
       writeFlashBytes(_addressFLASH+AdressInAddressTranslation, tempBuffer, sizeof(uint16_t));
+
+      //Keep the mirror in step, if this sector is loaded
+      if ( (_sectorFlash < FLASH_EEPROM_MIRROR_SECTORS) && ((_mirrorLoaded[_sectorFlash / BITS_PER_BYTE] & (1U << (_sectorFlash % BITS_PER_BYTE))) != 0U) ) { _mirror[addressEEPROM] = val; }
       return 1;
     }  
   return 0;
@@ -194,6 +210,7 @@ int8_t FLASH_EEPROM_BaseClass::update(uint16_t addressEEPROM, uint8_t val){
 
 int16_t FLASH_EEPROM_BaseClass::clear(){
       uint32_t i;
+      clearMirror();
       for(i=0; i< _config.Flash_Sectors_Used; i++ ){
           eraseFlashSector(i*_config.Flash_Sector_Size, _config.Flash_Sector_Size);
           writeMagicNumbers(i);
@@ -203,6 +220,50 @@ int16_t FLASH_EEPROM_BaseClass::clear(){
 
 uint16_t FLASH_EEPROM_BaseClass::length(){ return _EEPROM_Emulation_Size; }
 
+void FLASH_EEPROM_BaseClass::clearMirror(){
+  memset(_mirrorLoaded, 0, sizeof(_mirrorLoaded));
+}
+
+bool FLASH_EEPROM_BaseClass::isMirrored(uint16_t addressEEPROM){
+  if (addressEEPROM >= _EEPROM_Emulation_Size) { return false; }
+
+  uint32_t sector = addressEEPROM/_config.EEPROM_Bytes_Per_Sector;
+  //Only whole sectors are mirrored
+  if ( (sector >= FLASH_EEPROM_MIRROR_SECTORS) || (((sector + 1) * _config.EEPROM_Bytes_Per_Sector) > _mirrorSize) ) { return false; }
+
+  if ((_mirrorLoaded[sector / BITS_PER_BYTE] & (1U << (sector % BITS_PER_BYTE))) == 0U) { loadMirrorSector(sector); }
+  return ((_mirrorLoaded[sector / BITS_PER_BYTE] & (1U << (sector % BITS_PER_BYTE))) != 0U);
+}
+
+void FLASH_EEPROM_BaseClass::loadMirrorSector(uint32_t sector){
+  //Each read covers as many whole sections (Address translation + values of 1 eeprom byte) as fit in the buffer
+  uint32_t sectionsPerRead = FLASH_EEPROM_BULK_READ_SIZE / _Flash_Size_Per_EEPROM_Byte;
+  if ( (sectionsPerRead == 0) || (_FlashAvailable == false) ) { return; } //Sections too large to bulk read. Bytes are read from flash one at a time
+
+  byte bulkBuffer[FLASH_EEPROM_BULK_READ_SIZE];
+  uint32_t firstAddressEEPROM = sector*_config.EEPROM_Bytes_Per_Sector;
+  //The first section of each sector holds the magic numbers
+  uint32_t addressFLASH = (sector*_config.Flash_Sector_Size) + _Flash_Size_Per_EEPROM_Byte;
+
+  for (uint32_t i = 0; i < _config.EEPROM_Bytes_Per_Sector; i += sectionsPerRead)
+  {
+    uint32_t sections = _config.EEPROM_Bytes_Per_Sector - i;
+    if (sections > sectionsPerRead) { sections = sectionsPerRead; }
+    readFlashBytes(addressFLASH + (i * _Flash_Size_Per_EEPROM_Byte), bulkBuffer, sections * _Flash_Size_Per_EEPROM_Byte);
+
+    //Same decoding as readFlash()
+    for (uint32_t j = 0; j < sections; j++)
+    {
+      byte *section = &bulkBuffer[j * _Flash_Size_Per_EEPROM_Byte];
+      uint32_t nrOfOnes = count(section, _Addres_Translation_Size);
+      if (nrOfOnes >= _Flash_Size_Per_EEPROM_Byte) { _mirror[firstAddressEEPROM + i + j] = 0xFF; }
+      else { _mirror[firstAddressEEPROM + i + j] = section[nrOfOnes]; }
+    }
+  }
+
+  _mirrorLoaded[sector / BITS_PER_BYTE] |= (1U << (sector % BITS_PER_BYTE));
+}
+
 
 bool FLASH_EEPROM_BaseClass::checkForMagicNumbers(){
       bool magicnumbers = true;
@@ -252,6 +313,8 @@ int8_t FLASH_EEPROM_BaseClass::eraseFlashSector(uint32_t address __attribute__((
 SPI_EEPROM_Class::SPI_EEPROM_Class(EEPROM_Emulation_Config EmulationConfig, Flash_SPI_Config SPIConfig):FLASH_EEPROM_BaseClass(EmulationConfig)
 {
   _configSPI = SPIConfig;
+  _mirror = _mirrorBuffer;
+  _mirrorSize = sizeof(_mirrorBuffer);
 }
 
 byte SPI_EEPROM_Class::read(uint16_t addressEEPROM){
@@ -128,6 +128,17 @@
 
 #define BITS_PER_BYTE 8 
 
+//The SPI flash emulated EEPROM is mirrored in RAM, one flash sector at a time. The first read from a sector loads all of its
+//bytes with a few large flash reads, rather than 2 small SPI transfers (Address translation, then value) per byte. Reads are
+//then served from RAM and writes of an unchanged value are skipped without touching the flash.
+//Bytes above FLASH_EEPROM_MIRROR_SIZE are read from flash as before. The internal flash backends are memory mapped, so they
+//have no mirror and read the flash directly. A backend opts in by pointing _mirror at its own buffer.
+#ifndef FLASH_EEPROM_MIRROR_SIZE
+  #define FLASH_EEPROM_MIRROR_SIZE      8192UL
+#endif
+#define FLASH_EEPROM_MIRROR_SECTORS     256UL  //Most flash sectors that can be mirrored
+#define FLASH_EEPROM_BULK_READ_SIZE     1024UL //Largest single flash read when loading a sector into the mirror
+
 typedef struct {
   uint32_t Flash_Sectors_Used;        //This the number of flash sectors used for EEPROM emulation can be any number from 1 to many. 
   uint32_t Flash_Sector_Size;         //Flash sector size: This is determined by the physical device. This is the smallest block that can be erased at one time 
@@ -213,6 +224,11 @@ class FLASH_EEPROM_BaseClass
      */
     uint16_t length();
 
+    /**
+     * Discard the RAM mirror so that every sector is loaded from flash again on its next read
+     */
+    void clearMirror();
+
     //Class variable indicating if the emulated EEPROM flash is initialized  
     bool _EmulatedEEPROMAvailable=false;
 
@@ -237,8 +253,34 @@ class FLASH_EEPROM_BaseClass
     uint32_t _Addres_Translation_Size;
     uint32_t _EEPROM_Emulation_Size;
 
+    //RAM mirror of the emulated EEPROM and which of its flash sectors have been loaded (1 bit per sector)
+    //Set by the backends that use a mirror. A size of 0 disables it
+    byte *_mirror = nullptr;
+    uint32_t _mirrorSize = 0;
+    uint8_t _mirrorLoaded[FLASH_EEPROM_MIRROR_SECTORS / BITS_PER_BYTE];
+
   private:
 
+    /**
+     * Read an eeprom cell from flash, bypassing the mirror. Sets up the class variables used by write()
+     * @param address
+     * @return value
+     */
+    byte readFlash(uint16_t);
+
+    /**
+     * Whether an eeprom address is held in the RAM mirror, loading its flash sector first if needed
+     * @param address
+     * @return true if _mirror[address] is valid
+     */
+    bool isMirrored(uint16_t);
+
+    /**
+     * Load all the eeprom bytes of a flash sector into the RAM mirror
+     * @param Sector
+     */
+    void loadMirrorSector(uint32_t);
+
     /**
      * Checking for magic numbers on flash if numbers are there no erase is needed else do erase. True if magic numbers are there.
      * @return Success. 
@@ -348,6 +390,9 @@ class SPI_EEPROM_Class : public FLASH_EEPROM_BaseClass
 
     //SPI configuration struct. Now only the CS pins is used, future extension can be the use SPI object or MOSI/MISO/SCK pins
     Flash_SPI_Config _configSPI;
+
+    //RAM mirror storage. Each read of the SPI flash is a bus transfer, so this backend mirrors the emulated EEPROM
+    byte _mirrorBuffer[FLASH_EEPROM_MIRROR_SIZE];
 };
 
 //Internal flash class for flash EEPROM emulation. Inherit most from the base class. 
@@ -12,6 +12,8 @@ A full copy of the license may be found in the projects root directory
 #include "storage.h"
 #include "pages.h"
 #include "table3d_axis_io.h"
+#include "page_crc.h"
+#include <util/atomic.h>
 
 
 #define EEPROM_DATA_VERSION   0
@@ -41,22 +43,94 @@ bool isEepromWritePending(void)
   return BIT_CHECK(currentStatus.status4, BIT_STATUS4_BURNPENDING);
 }
 
+//  ================================= Dirty range tracking ===============================
+// The range of each page (As per the ini offsets) that has changed since it was last written to EEPROM. 
+// Burns only visit the entities that overlap this range, and only the changed bytes of raw config blocks, rather than
+// reading back every byte of the page to compare it. The range is empty when start>=end
+#define DIRTY_PAGE_COUNT 16U
+static volatile uint16_t dirtyStart[DIRTY_PAGE_COUNT];
+static volatile uint16_t dirtyEnd[DIRTY_PAGE_COUNT];
+
+/** Record that part of a page has changed and needs writing by the next burn of the page.
+ * Safe to call from an ISR, e.g. a decoder that sets its own config values.
+ * @param pageNum The page that was changed
+ * @param offset First changed byte, as per the ini page layout
+ * @param length Number of bytes changed
+ */
+void markPageDirty(uint8_t pageNum, uint16_t offset, uint16_t length)
+{
+  if( (pageNum >= DIRTY_PAGE_COUNT) || (pageNum >= getPageCount()) || (length == 0U) ) { return; }
+
+  uint16_t end = offset + length;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    if(dirtyStart[pageNum] >= dirtyEnd[pageNum])
+    {
+      dirtyStart[pageNum] = offset;
+      dirtyEnd[pageNum] = end;
+    }
+    else
+    {
+      if(offset < dirtyStart[pageNum]) { dirtyStart[pageNum] = offset; }
+      if(end > dirtyEnd[pageNum]) { dirtyEnd[pageNum] = end; }
+    }
+  }
+}
+
+/** Record that a config struct was changed directly, rather than through setPageValue(). Only the changed bytes are written by the next burn.
+ * @param pageNum The page holding the config struct
+ * @param pFirst First changed byte of the struct
+ * @param length Number of bytes changed
+ */
+void markConfigDirty(uint8_t pageNum, const void *pFirst, uint16_t length)
+{
+  page_iterator_t entity = page_begin(pageNum);
+  while (entity.type!=End)
+  {
+    if ( (entity.type==Raw) && ((const byte *)pFirst >= (const byte *)entity.pData) && ((const byte *)pFirst < ((const byte *)entity.pData + entity.size)) )
+    {
+      markPageDirty(pageNum, entity.start + (uint16_t)((const byte *)pFirst - (const byte *)entity.pData), length);
+      return;
+    }
+    entity = advance(entity);
+  }
+}
+
+/** Does the page have any changes that have not been written to EEPROM? */
+bool isPageDirty(uint8_t pageNum)
+{
+  if(pageNum >= DIRTY_PAGE_COUNT) { return false; }
+  bool dirty;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { dirty = (dirtyStart[pageNum] < dirtyEnd[pageNum]); }
+  return dirty;
+}
+
 /** Write all config pages to EEPROM.
  */
 void writeAllConfig(void)
 {
+  for (uint8_t page=1; page<getPageCount(); ++page)
+  {
+    markPageDirty(page, 0U, getPageSize(page));
+  }
+  writeAllDirtyConfig();
+}
+
+/** Write the changed parts of all config pages to EEPROM.
+ * Stops at the first page that cannot be completed in one go, leaving the burn pending.
+ */
+void writeAllDirtyConfig(void)
+{
+  BIT_CLEAR(currentStatus.status4, BIT_STATUS4_BURNPENDING);
   uint8_t pageCount = getPageCount();
   uint8_t page = 1U;
-  writeConfig(page);
-  page = page + 1;
   while (page<pageCount && !isEepromWritePending())
   {
-    writeConfig(page);
+    if(isPageDirty(page)) { writeDirtyConfig(page); }
     page = page + 1;
   }
 }
 
-
 //  ================================= Internal write support ===============================
 struct write_location {
   eeprom_address_t address; // EEPROM address to write next
@@ -151,15 +225,12 @@ uint8_t EEPROMReadRaw(uint16_t address) { return EEPROM.read(address); }
 
 //  ================================= End write support ===============================
 
-/** Write a table or map to EEPROM storage.
-Takes the current configuration (config pages and maps)
-and writes them to EEPROM as per the layout defined in storage.h.
+/** The maximum number of write operations that will be performed in one go.
+If we try to write to the EEPROM too fast (Eg Each write takes ~3ms on the AVR) then 
+the rest of the system can hang)
 */
-void writeConfig(uint8_t pageNum)
+static uint8_t getMaxWriteBlockSize(void)
 {
-//The maximum number of write operations that will be performed in one go.
-//If we try to write to the EEPROM too fast (Eg Each write takes ~3ms on the AVR) then 
-//the rest of the system can hang)
 #if defined(USE_SPI_EEPROM)
   //For use with common Winbond SPI EEPROMs Eg W25Q16JV
   uint8_t EEPROM_MAX_WRITE_BLOCK = 20; //This needs tuning
@@ -183,150 +254,125 @@ void writeConfig(uint8_t pageNum)
   #endif
 
 #endif
+  return EEPROM_MAX_WRITE_BLOCK;
+}
 
-  write_location result = { 0, 0, EEPROM_MAX_WRITE_BLOCK };
-
+/** EEPROM address of a table or config block (See storage.h for data layout).
+ * @param pageNum The page the entity is on
+ * @param entityNum Index of the entity on the page, in the same order as pages.cpp
+ */
+static eeprom_address_t getEntityAddress(uint8_t pageNum, uint8_t entityNum)
+{
   switch(pageNum)
   {
-    case veMapPage:
-      /*---------------------------------------------------
-      | Fuel table (See storage.h for data layout) - Page 1
-      | 16x16 table itself + the 16 values along each of the axis
-      -----------------------------------------------------*/
-      result = writeTable(&fuelTable, decltype(fuelTable)::type_key, result.changeWriteAddress(EEPROM_CONFIG1_MAP));
-      break;
-
-    case veSetPage:
-      /*---------------------------------------------------
-      | Config page 2 (See storage.h for data layout)
-      | 64 byte long config table
-      -----------------------------------------------------*/
-      result = write_range((byte *)&configPage2, (byte *)&configPage2+sizeof(configPage2), result.changeWriteAddress(EEPROM_CONFIG2_START));
-      break;
-
-    case ignMapPage:
-      /*---------------------------------------------------
-      | Ignition table (See storage.h for data layout) - Page 1
-      | 16x16 table itself + the 16 values along each of the axis
-      -----------------------------------------------------*/
-      result = writeTable(&ignitionTable, decltype(ignitionTable)::type_key, result.changeWriteAddress(EEPROM_CONFIG3_MAP));
-      break;
-
-    case ignSetPage:
-      /*---------------------------------------------------
-      | Config page 2 (See storage.h for data layout)
-      | 64 byte long config table
-      -----------------------------------------------------*/
-      result = write_range((byte *)&configPage4, (byte *)&configPage4+sizeof(configPage4), result.changeWriteAddress(EEPROM_CONFIG4_START));
-      break;
+    case veMapPage: return EEPROM_CONFIG1_MAP; //Fuel table
+    case veSetPage: return EEPROM_CONFIG2_START;
+    case ignMapPage: return EEPROM_CONFIG3_MAP; //Ignition table
+    case ignSetPage: return EEPROM_CONFIG4_START;
+    case afrMapPage: return EEPROM_CONFIG5_MAP; //AFR target table
+    case afrSetPage: return EEPROM_CONFIG6_START;
+
+    case boostvvtPage: //Boost, VVT and staging tables
+      if(entityNum == 0U) { return EEPROM_CONFIG7_MAP1; }
+      if(entityNum == 1U) { return EEPROM_CONFIG7_MAP2; }
+      return EEPROM_CONFIG7_MAP3;
+
+    case seqFuelPage: //Fuel trim tables. Trims 5-8 are not contiguous with 1-4
+      switch(entityNum)
+      {
+        case 0: return EEPROM_CONFIG8_MAP1;
+        case 1: return EEPROM_CONFIG8_MAP2;
+        case 2: return EEPROM_CONFIG8_MAP3;
+        case 3: return EEPROM_CONFIG8_MAP4;
+        case 4: return EEPROM_CONFIG8_MAP5;
+        case 5: return EEPROM_CONFIG8_MAP6;
+        case 6: return EEPROM_CONFIG8_MAP7;
+        default: return EEPROM_CONFIG8_MAP8;
+      }
 
-    case afrMapPage:
-      /*---------------------------------------------------
-      | AFR table (See storage.h for data layout) - Page 5
-      | 16x16 table itself + the 16 values along each of the axis
-      -----------------------------------------------------*/
-      result = writeTable(&afrTable, decltype(afrTable)::type_key, result.changeWriteAddress(EEPROM_CONFIG5_MAP));
-      break;
+    case canbusPage: return EEPROM_CONFIG9_START;
+    case warmupPage: return EEPROM_CONFIG10_START;
+    case fuelMap2Page: return EEPROM_CONFIG11_MAP; //Fuel table 2
 
-    case afrSetPage:
-      /*---------------------------------------------------
-      | Config page 3 (See storage.h for data layout)
-      | 64 byte long config table
-      -----------------------------------------------------*/
-      result = write_range((byte *)&configPage6, (byte *)&configPage6+sizeof(configPage6), result.changeWriteAddress(EEPROM_CONFIG6_START));
-      break;
+    case wmiMapPage: //WMI, VVT2 and dwell tables
+      if(entityNum == 0U) { return EEPROM_CONFIG12_MAP; }
+      if(entityNum == 1U) { return EEPROM_CONFIG12_MAP2; }
+      return EEPROM_CONFIG12_MAP3;
 
-    case boostvvtPage:
-      /*---------------------------------------------------
-      | Boost and vvt tables (See storage.h for data layout) - Page 8
-      | 8x8 table itself + the 8 values along each of the axis
-      -----------------------------------------------------*/
-      result = writeTable(&boostTable, decltype(boostTable)::type_key, result.changeWriteAddress(EEPROM_CONFIG7_MAP1));
-      result = writeTable(&vvtTable, decltype(vvtTable)::type_key, result.changeWriteAddress(EEPROM_CONFIG7_MAP2));
-      result = writeTable(&stagingTable, decltype(stagingTable)::type_key, result.changeWriteAddress(EEPROM_CONFIG7_MAP3));
-      break;
+    case progOutsPage: return EEPROM_CONFIG13_START;
+    case ignMap2Page: return EEPROM_CONFIG14_MAP; //Ignition table 2
 
-    case seqFuelPage:
-      /*---------------------------------------------------
-      | Fuel trim tables (See storage.h for data layout) - Page 9
-      | 6x6 tables itself + the 6 values along each of the axis
-      -----------------------------------------------------*/
-      result = writeTable(&trim1Table, decltype(trim1Table)::type_key, result.changeWriteAddress(EEPROM_CONFIG8_MAP1));
-      result = writeTable(&trim2Table, decltype(trim2Table)::type_key, result.changeWriteAddress(EEPROM_CONFIG8_MAP2));
-      result = writeTable(&trim3Table, decltype(trim3Table)::type_key, result.changeWriteAddress(EEPROM_CONFIG8_MAP3));
-      result = writeTable(&trim4Table, decltype(trim4Table)::type_key, result.changeWriteAddress(EEPROM_CONFIG8_MAP4));
-      result = writeTable(&trim5Table, decltype(trim5Table)::type_key, result.changeWriteAddress(EEPROM_CONFIG8_MAP5));
-      result = writeTable(&trim6Table, decltype(trim6Table)::type_key, result.changeWriteAddress(EEPROM_CONFIG8_MAP6));
-      result = writeTable(&trim7Table, decltype(trim7Table)::type_key, result.changeWriteAddress(EEPROM_CONFIG8_MAP7));
-      result = writeTable(&trim8Table, decltype(trim8Table)::type_key, result.changeWriteAddress(EEPROM_CONFIG8_MAP8));
-      break;
+    case boostvvtPage2: //Boost duty lookup table, then config page 15
+      if(entityNum == 0U) { return EEPROM_CONFIG15_MAP; }
+      return EEPROM_CONFIG15_START;
 
-    case canbusPage:
-      /*---------------------------------------------------
-      | Config page 10 (See storage.h for data layout)
-      | 192 byte long config table
-      -----------------------------------------------------*/
-      result = write_range((byte *)&configPage9, (byte *)&configPage9+sizeof(configPage9), result.changeWriteAddress(EEPROM_CONFIG9_START));
-      break;
+    default:
+      return 0;
+  }
+}
 
-    case warmupPage:
-      /*---------------------------------------------------
-      | Config page 11 (See storage.h for data layout)
-      | 192 byte long config table
-      -----------------------------------------------------*/
-      result = write_range((byte *)&configPage10, (byte *)&configPage10+sizeof(configPage10), result.changeWriteAddress(EEPROM_CONFIG10_START));
-      break;
+/** Write a table or map to EEPROM storage.
+Takes the current configuration (config pages and maps)
+and writes them to EEPROM as per the layout defined in storage.h.
+The whole page is written, so this is for changes that were made directly to the config structs (Rather than through setPageValue())
+*/
+void writeConfig(uint8_t pageNum)
+{
+  markPageDirty(pageNum, 0U, getPageSize(pageNum));
+  writeDirtyConfig(pageNum);
+}
 
-    case fuelMap2Page:
-      /*---------------------------------------------------
-      | Fuel table 2 (See storage.h for data layout)
-      | 16x16 table itself + the 16 values along each of the axis
-      -----------------------------------------------------*/
-      result = writeTable(&fuelTable2, decltype(fuelTable2)::type_key, result.changeWriteAddress(EEPROM_CONFIG11_MAP));
-      break;
+/** Write the parts of a page that have changed since it was last written (See markPageDirty()) to EEPROM.
+Tables that overlap the changed range are written whole, config blocks only over the changed range.
+If the write block size runs out first, the burn is left pending and the next call carries on from where this one stopped.
+*/
+void writeDirtyConfig(uint8_t pageNum)
+{
+  write_location result = { 0, 0, getMaxWriteBlockSize() };
 
-    case wmiMapPage:
-      /*---------------------------------------------------
-      | WMI and Dwell tables (See storage.h for data layout) - Page 12
-      | 8x8 WMI table itself + the 8 values along each of the axis
-      | 8x8 VVT2 table + the 8 values along each of the axis
-      | 4x4 Dwell table itself + the 4 values along each of the axis
-      -----------------------------------------------------*/
-      result = writeTable(&wmiTable, decltype(wmiTable)::type_key, result.changeWriteAddress(EEPROM_CONFIG12_MAP));
-      result = writeTable(&vvt2Table, decltype(vvt2Table)::type_key, result.changeWriteAddress(EEPROM_CONFIG12_MAP2));
-      result = writeTable(&dwellTable, decltype(dwellTable)::type_key, result.changeWriteAddress(EEPROM_CONFIG12_MAP3));
-      break;
-      
-    case progOutsPage:
-      /*---------------------------------------------------
-      | Config page 13 (See storage.h for data layout)
-      -----------------------------------------------------*/
-      result = write_range((byte *)&configPage13, (byte *)&configPage13+sizeof(configPage13), result.changeWriteAddress(EEPROM_CONFIG13_START));
-      break;
-    
-    case ignMap2Page:
-      /*---------------------------------------------------
-      | Ignition table (See storage.h for data layout) - Page 1
-      | 16x16 table itself + the 16 values along each of the axis
-      -----------------------------------------------------*/
-      result = writeTable(&ignitionTable2, decltype(ignitionTable2)::type_key, result.changeWriteAddress(EEPROM_CONFIG14_MAP));
-      break;
+  if(isPageDirty(pageNum))
+  {
+    //Take the range, so that a change made by an ISR while burning is kept for the next burn
+    uint16_t start;
+    uint16_t end;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+      start = dirtyStart[pageNum];
+      end = dirtyEnd[pageNum];
+      dirtyStart[pageNum] = 0U;
+      dirtyEnd[pageNum] = 0U;
+    }
 
-    case boostvvtPage2:
-      /*---------------------------------------------------
-      | Boost duty cycle lookuptable (See storage.h for data layout) - Page 15
-      | 8x8 table itself + the 8 values along each of the axis
-      -----------------------------------------------------*/
-      result = writeTable(&boostTableLookupDuty, decltype(boostTableLookupDuty)::type_key, result.changeWriteAddress(EEPROM_CONFIG15_MAP));
-
-      /*---------------------------------------------------
-      | Config page 15 (See storage.h for data layout)
-      -----------------------------------------------------*/
-      result = write_range((byte *)&configPage15, (byte *)&configPage15+sizeof(configPage15), result.changeWriteAddress(EEPROM_CONFIG15_START));
-      break;
+    uint16_t resumeFrom = end;
+    uint8_t entityNum = 0U;
+    page_iterator_t entity = page_begin(pageNum);
+    while ( (entity.type!=End) && result.can_write() && (entity.start < end) )
+    {
+      if ( (entity.type==Raw) || (entity.type==Table) )
+      {
+        if ( (entity.start + entity.size) > start )
+        {
+          eeprom_address_t address = getEntityAddress(pageNum, entityNum);
+          if (entity.type==Table)
+          {
+            result = writeTable(entity.pData, entity.table_key, result.changeWriteAddress(address));
+            resumeFrom = entity.start; //Tables are always written whole
+          }
+          else
+          {
+            uint16_t first = max(start, entity.start) - entity.start;
+            uint16_t last = min(end, (uint16_t)(entity.start + entity.size)) - entity.start;
+            result = write_range((byte *)entity.pData + first, (byte *)entity.pData + last, result.changeWriteAddress(address + first));
+            resumeFrom = entity.start + (uint16_t)(result.address - address);
+          }
+        }
+        ++entityNum;
+      }
+      entity = advance(entity);
+    }
 
-    default:
-      break;
+    //Hand back whatever was not written
+    if (!result.can_write()) { markPageDirty(pageNum, resumeFrom, end - resumeFrom); }
   }
 
   BIT_WRITE(currentStatus.status4, BIT_STATUS4_BURNPENDING, !result.can_write());
@@ -347,7 +393,9 @@ void resetConfigPages(void)
       }
       entity = advance(entity);
     }
+    markPageDirty(page, 0U, getPageSize(page));
   }
+  invalidateAllPageCRC32();
 }
 
 //  ================================= Internal read support ===============================
@@ -481,6 +529,8 @@ void loadConfig(void)
   load_range(EEPROM_CONFIG15_START, (byte *)&configPage15, (byte *)&configPage15+sizeof(configPage15));  
 
   //*********************************************************************************************************************************************************************************
+
+  invalidateAllPageCRC32();
 }
 
 /** Read the calibration information from EEPROM.
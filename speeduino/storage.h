@@ -122,6 +122,11 @@
 
 void writeAllConfig(void);
 void writeConfig(uint8_t pageNum);
+void writeAllDirtyConfig(void);
+void writeDirtyConfig(uint8_t pageNum);
+void markPageDirty(uint8_t pageNum, uint16_t offset, uint16_t length);
+void markConfigDirty(uint8_t pageNum, const void *pFirst, uint16_t length);
+bool isPageDirty(uint8_t pageNum);
 void EEPROMWriteRaw(uint16_t address, uint8_t data);
 uint8_t EEPROMReadRaw(uint16_t address);
 void loadConfig(void);
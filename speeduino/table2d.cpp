@@ -13,9 +13,8 @@ Note that this may clear some of the existing values of the table
 #include "globals.h"
 #endif
 
-static void construct2dTable(table2D &table, uint8_t valueSize, uint8_t axisSize, uint8_t length, void *values, void *bins) {
-  table.valueSize = valueSize;
-  table.axisSize = axisSize;
+template <typename TValue, typename TAxis>
+void construct2dTable(table2D_t<TValue, TAxis> &table, uint8_t length, TValue *values, TAxis *bins) {
   table.xSize = length;
   table.values = values;
   table.axisX = bins;
@@ -24,25 +23,6 @@ static void construct2dTable(table2D &table, uint8_t valueSize, uint8_t axisSize
   table.lastXMin = INT16_MAX;
 }
 
-void construct2dTable(table2D &table, uint8_t length, uint8_t *values, uint8_t *bins) {
-  construct2dTable(table, SIZE_BYTE, SIZE_BYTE, length, values, bins);
-}
-void construct2dTable(table2D &table, uint8_t length, uint8_t *values, int8_t *bins) {
-  construct2dTable(table, SIZE_BYTE, SIZE_SIGNED_BYTE, length, values, bins);
-}
-void construct2dTable(table2D &table, uint8_t length, uint16_t *values, uint16_t *bins) {
-  construct2dTable(table, SIZE_INT, SIZE_INT, length, values, bins);
-}
-void construct2dTable(table2D &table, uint8_t length, uint8_t *values, uint16_t *bins) {
-  construct2dTable(table, SIZE_BYTE, SIZE_INT, length, values, bins);
-}
-void construct2dTable(table2D &table, uint8_t length, uint16_t *values, uint8_t *bins) {
-  construct2dTable(table, SIZE_INT, SIZE_BYTE, length, values, bins);
-}
-void construct2dTable(table2D &table, uint8_t length, int16_t *values, uint8_t *bins) {
-  construct2dTable(table, SIZE_INT, SIZE_BYTE, length, values, bins);
-}
-
 static inline uint8_t getCacheTime(void) {
 #if !defined(UNIT_TEST)
   return currentStatus.secl;
@@ -55,10 +35,11 @@ static inline uint8_t getCacheTime(void) {
 This function pulls a 1D linear interpolated (ie averaged) value from a 2D table
 ie: Given a value on the X axis, it returns a Y value that corresponds to the point on the curve between the nearest two defined X values
 
-This function must take into account whether a table contains 8-bit or 16-bit values.
-Unfortunately this means many of the lines are duplicated depending on this
+The value & axis types are known at compile time, so there is a separate copy of this function for each type
+combination (See the explicit instantiations at the end of this file)
 */
-int table2D_getValue(struct table2D *fromTable, int X_in)
+template <typename TValue, typename TAxis>
+int table2D_getValue(table2D_t<TValue, TAxis> *fromTable, int X_in)
 {
   //Orig memory usage = 5414
   int returnValue = 0;
@@ -153,22 +134,16 @@ int table2D_getValue(struct table2D *fromTable, int X_in)
 }
 
 /**
- * @brief Returns an axis (bin) value from the 2D table. This works regardless of whether that axis is bytes or int16_ts
+ * @brief Returns an axis (bin) value from the 2D table
  * 
  * @param fromTable 
  * @param X_in 
  * @return int16_t 
  */
-int16_t table2D_getAxisValue(struct table2D *fromTable, byte X_in)
+template <typename TValue, typename TAxis>
+int16_t table2D_getAxisValue(const table2D_t<TValue, TAxis> *fromTable, byte X_in)
 {
-  int returnValue = 0;
-
-  if(fromTable->axisSize == SIZE_INT) { returnValue = ((int16_t*)fromTable->axisX)[X_in]; }
-  else if(fromTable->axisSize == SIZE_BYTE) { returnValue = ((uint8_t*)fromTable->axisX)[X_in]; }
-  else if(fromTable->axisSize == SIZE_SIGNED_BYTE) { returnValue = ((int8_t*)fromTable->axisX)[X_in]; }
-  
-
-  return returnValue;
+  return (int16_t)fromTable->axisX[X_in];
 }
 
 /**
@@ -178,13 +153,24 @@ int16_t table2D_getAxisValue(struct table2D *fromTable, byte X_in)
  * @param X_index 
  * @return int16_t 
  */
-int16_t table2D_getRawValue(struct table2D *fromTable, byte X_index)
+template <typename TValue, typename TAxis>
+int16_t table2D_getRawValue(const table2D_t<TValue, TAxis> *fromTable, byte X_index)
 {
-  int returnValue = 0;
-
-  if(fromTable->valueSize == SIZE_INT) { returnValue = ((int16_t*)fromTable->values)[X_index]; }
-  else if(fromTable->valueSize == SIZE_BYTE) { returnValue = ((uint8_t*)fromTable->values)[X_index]; }
-  else if(fromTable->valueSize == SIZE_SIGNED_BYTE) { returnValue = ((int8_t*)fromTable->values)[X_index]; }
-
-  return returnValue;
+  return (int16_t)fromTable->values[X_index];
 }
+
+//Instantiate the functions for each of the supported table types
+#define TABLE2D_INSTANTIATE(TValue, TAxis) \
+  template void construct2dTable(table2D_t<TValue, TAxis> &table, uint8_t length, TValue *values, TAxis *bins); \
+  template int16_t table2D_getAxisValue(const table2D_t<TValue, TAxis> *fromTable, byte X_in); \
+  template int16_t table2D_getRawValue(const table2D_t<TValue, TAxis> *fromTable, byte X_index); \
+  template int table2D_getValue(table2D_t<TValue, TAxis> *fromTable, int X_in);
+
+TABLE2D_INSTANTIATE(uint8_t, uint8_t)
+TABLE2D_INSTANTIATE(uint8_t, int8_t)
+TABLE2D_INSTANTIATE(uint8_t, uint16_t)
+TABLE2D_INSTANTIATE(uint8_t, int16_t)
+TABLE2D_INSTANTIATE(uint16_t, uint8_t)
+TABLE2D_INSTANTIATE(uint16_t, uint16_t)
+TABLE2D_INSTANTIATE(int16_t, uint8_t)
+TABLE2D_INSTANTIATE(int16_t, int16_t)
@@ -4,27 +4,25 @@ This file is used for everything related to maps/tables including their definiti
 #ifndef TABLE_H
 #define TABLE_H
 
-#include "globals.h"
-
-#define SIZE_SIGNED_BYTE    4
-#define SIZE_BYTE           8
-#define SIZE_INT            16
+#include <stdint.h>
+#include <Arduino.h>
 
 /*
-The 2D table can contain either 8-bit (byte) or 16-bit (int) values
-The valueSize variable should be set to either 8 or 16 to indicate this BEFORE the table is used
+A 2D table (curve). The value and axis (bin) element types are template parameters, so every lookup
+is compiled for the exact types of the table it is used on. There is no runtime checking of the element sizes.
+
+The values & bins are not owned by the table, they point at the config page arrays (Or calibration arrays).
+Use construct2dTable() to setup the table BEFORE it is used.
 */
-struct table2D {
-  //Used 5414 RAM with original version
-  byte valueSize;
-  byte axisSize;
-  byte xSize;
+template <typename TValue, typename TAxis>
+struct table2D_t {
+  typedef TValue value_t;
+  typedef TAxis axis_t;
 
-  void *values;
-  void *axisX;
+  byte xSize;
 
-  //int16_t *values16;
-  //int16_t *axisX16;
+  TValue *values;
+  TAxis *axisX;
 
   //Store the last X and Y coordinates in the table. This is used to make the next check faster
   int16_t lastXMax;
@@ -33,19 +31,29 @@ struct table2D {
   //Store the last input and output for caching
   int16_t lastInput;
   int16_t lastOutput;
-  byte cacheTime; //Tracks when the last cache value was set so it can expire after x seconds. A timeout is required to pickup when a tuning value is changed, otherwise the old cached value will continue to be returned as the X value isn't changing. 
+  byte cacheTime; //Tracks when the last cache value was set so it can expire after x seconds. A timeout is required to pickup when a tuning value is changed, otherwise the old cached value will continue to be returned as the X value isn't changing.
 };
 
-void construct2dTable(table2D &table, uint8_t length, uint8_t *values, uint8_t *bins);
-void construct2dTable(table2D &table, uint8_t length, uint8_t *values, int8_t *bins);
-void construct2dTable(table2D &table, uint8_t length, uint16_t *values, uint16_t *bins);
-void construct2dTable(table2D &table, uint8_t length, uint8_t *values, uint16_t *bins);
-void construct2dTable(table2D &table, uint8_t length, uint16_t *values, uint8_t *bins);
-void construct2dTable(table2D &table, uint8_t length, int16_t *values, uint8_t *bins);
+//The supported combinations of value & axis types. Naming is table2D_<value type>_<axis type>
+typedef table2D_t<uint8_t, uint8_t> table2D_u8_u8;
+typedef table2D_t<uint8_t, int8_t> table2D_u8_s8;
+typedef table2D_t<uint8_t, uint16_t> table2D_u8_u16;
+typedef table2D_t<uint8_t, int16_t> table2D_u8_s16;
+typedef table2D_t<uint16_t, uint8_t> table2D_u16_u8;
+typedef table2D_t<uint16_t, uint16_t> table2D_u16_u16;
+typedef table2D_t<int16_t, uint8_t> table2D_s16_u8;
+typedef table2D_t<int16_t, int16_t> table2D_s16_s16;
+
+template <typename TValue, typename TAxis>
+void construct2dTable(table2D_t<TValue, TAxis> &table, uint8_t length, TValue *values, TAxis *bins);
+
+template <typename TValue, typename TAxis>
+int16_t table2D_getAxisValue(const table2D_t<TValue, TAxis> *fromTable, byte X_in);
 
-int16_t table2D_getAxisValue(struct table2D *fromTable, byte X_in);
-int16_t table2D_getRawValue(struct table2D *fromTable, byte X_index);
+template <typename TValue, typename TAxis>
+int16_t table2D_getRawValue(const table2D_t<TValue, TAxis> *fromTable, byte X_index);
 
-int table2D_getValue(struct table2D *fromTable, int X_in);
+template <typename TValue, typename TAxis>
+int table2D_getValue(table2D_t<TValue, TAxis> *fromTable, int X_in);
 
 #endif // TABLE_H
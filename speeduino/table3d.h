@@ -100,6 +100,16 @@ TABLE3D_GENERATOR(TABLE3D_GEN_TYPE)
                               pTable->axisX.axis, \
                               pTable->axisY.axis, \
                               y, x); \
+    } \
+    static inline table3d_value_t get3DTableValue(TABLE3D_TYPENAME_BASE(size, xDom, yDom) *pTable, table3d_axis_t y, table3d_axis_t x, table3DSharedAxisCache *pSharedCache) \
+    { \
+      return get3DTableValue( &pTable->get_value_cache, \
+                              pSharedCache, \
+                              TABLE3D_TYPENAME_BASE(size, xDom, yDom)::value_t::row_size, \
+                              pTable->values.values, \
+                              pTable->axisX.axis, \
+                              pTable->axisY.axis, \
+                              y, x); \
     } 
 TABLE3D_GENERATOR(TABLE3D_GEN_GET_TABLE_VALUE)
 
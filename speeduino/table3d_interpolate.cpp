@@ -1,5 +1,6 @@
 #include "table3d_interpolate.h"
 #include "maths.h"
+#include <string.h>
 
 
 // ============================= Axis Bin Searching =========================
@@ -126,27 +127,90 @@ static inline QU1X8_t mulQU1X8(QU1X8_t a, QU1X8_t b)
 
 // ============================= Axis value to bin % =========================
 
-static inline QU1X8_t compute_bin_position(table3d_axis_t value, const table3d_dim_t &bin, const table3d_axis_t *pAxis)
+// Bins up to this wide use a 16-bit reciprocal of 2^16/width. Wider bins use 2^24/width.
+// Either way, the reciprocal fits in 16 bits & the multiply below can't overflow.
+static constexpr uint16_t NARROW_BIN_MAX_WIDTH = 256U;
+
+static inline uint16_t compute_bin_reciprocal(uint16_t binWidth)
+{
+  // Zero & one width bins never get here (the value would have to match one end)
+  if (binWidth<2U) { return UINT16_MAX; }
+  // Round up, so that the multiply never results in a lower value than the division
+  // would. Most importantly, exact fractions (E.g. 50%) give exactly the same result.
+  if (binWidth<=NARROW_BIN_MAX_WIDTH) { return (uint16_t)(UINT16_MAX / binWidth) + 1U; }
+  return udiv_32_16(0xFFFFFFUL, binWidth) + 1U;
+}
+
+static inline QU1X8_t compute_bin_position(table3d_axis_t value, const table3d_dim_t &bin, const table3d_axis_t *pAxis, uint16_t &binReciprocal)
 {
   table3d_axis_t binMinValue = pAxis[bin+1U];
   if (value==binMinValue) { return 0; }
   table3d_axis_t binMaxValue = pAxis[bin];
   if (value==binMaxValue) { return QU1X8_ONE; }
-  table3d_axis_t binWidth = binMaxValue-binMinValue;
-
-  // Since we can have bins of any width, we need to use 
-  // 24.8 fixed point to avoid overflow
-  table3d_axis_t binPosition = value - binMinValue;
-  uint32_t p = (uint32_t)binPosition << QU1X8_INTEGER_SHIFT;
-  // But since we are computing the ratio (0 to 1), p is guaranteed to be
-  // less than binWidth and thus the division below will result in a value
-  // <=1. So we can reduce the data type from 24.8 (uint32_t) to 1.8 (uint16_t)
-  return udiv_32_16(p, (uint16_t)binWidth);  
+  uint16_t binWidth = (uint16_t)(binMaxValue-binMinValue);
+
+  // The reciprocal is cached, so this is only calculated once per bin
+  if (binReciprocal==0U) { binReciprocal = compute_bin_reciprocal(binWidth); }
+
+  // The ratio (0 to 1) of the position within the bin, as a 1.8 fixed point number.
+  // I.e. (binPosition << 8) / binWidth, without the division.
+  uint16_t binPosition = (uint16_t)(value - binMinValue);
+  if (binWidth<=NARROW_BIN_MAX_WIDTH)
+  {
+    // binPosition < binWidth, so this fits in 16 bits
+    return (QU1X8_t)((uint16_t)(binPosition * binReciprocal) >> QU1X8_INTEGER_SHIFT);
+  }
+  return (QU1X8_t)(((uint32_t)binPosition * binReciprocal) >> 16U);
+}
+
+
+// ============================= Interpolation =========================
+
+/*
+The 4 corners of the map where the interpolated value will fall in
+Eg: (yMax,xMin)  (yMax,xMax)
+
+    (yMin,xMin)  (yMin,xMax)
+
+In the following calculation the table values are referred to by the following variables:
+          A          B
+
+          C          D
+*/
+struct table3d_corners
+{
+  table3d_value_t A, B, C, D;
+};
+
+static inline table3d_corners get_corners(table3d_dim_t axisSize, const table3d_value_t *pValues, table3d_dim_t xBinMax, table3d_dim_t yBinMax)
+{
+  table3d_dim_t rowMax = yBinMax * axisSize;
+  table3d_dim_t rowMin = rowMax + axisSize;
+  table3d_dim_t colMax = axisSize - xBinMax - 1U;
+  table3d_dim_t colMin = colMax - 1U;
+  return { pValues[rowMax + colMin], pValues[rowMax + colMax], pValues[rowMin + colMin], pValues[rowMin + colMax] };
 }
 
+//Check that all values aren't just the same (This regularly happens with things like the fuel trim maps)
+static inline bool is_flat(const table3d_corners &corners)
+{
+  return (corners.A == corners.B) && (corners.A == corners.C) && (corners.A == corners.D);
+}
+
+// p & q are essentially percentages (between 0 and 1) of where the desired value falls between the nearest bins on each axis
+static inline table3d_value_t interpolate_corners(const table3d_corners &corners, QU1X8_t p, QU1X8_t q)
+{
+  const QU1X8_t m = mulQU1X8(QU1X8_ONE-p, q);
+  const QU1X8_t n = mulQU1X8(p, q);
+  const QU1X8_t o = mulQU1X8(QU1X8_ONE-p, QU1X8_ONE-q);
+  const QU1X8_t r = mulQU1X8(p, QU1X8_ONE-q);
+  return ( (corners.A * m) + (corners.B * n) + (corners.C * o) + (corners.D * r) ) >> QU1X8_INTEGER_SHIFT;
+}
 
 // ============================= End internal support functions =========================
 
+uint16_t table3d_axis_generation = 1U;
+
 //This function pulls a value from a 3D table given a target for X and Y coordinates.
 //It performs a 2D linear interpolation as described in: www.megamanual.com/v22manual/ve_tuner.pdf
 table3d_value_t __attribute__((noclone)) get3DTableValue(struct table3DGetValueCache *pValueCache, 
@@ -170,44 +234,127 @@ table3d_value_t __attribute__((noclone)) get3DTableValue(struct table3DGetValueC
     pValueCache->last_lookup.y = Y_in;
 
     // Figure out where on the axes the incoming coord are
-    pValueCache->lastXBinMax = find_xbin(X_in, pXAxis, axisSize, pValueCache->lastXBinMax);
-    pValueCache->lastYBinMax = find_ybin(Y_in, pYAxis, axisSize, pValueCache->lastYBinMax);
-
-    /*
-    At this point we have the 4 corners of the map where the interpolated value will fall in
-    Eg: (yMax,xMin)  (yMax,xMax)
-
-        (yMin,xMin)  (yMin,xMax)
-
-    In the following calculation the table values are referred to by the following variables:
-              A          B
-
-              C          D
-    */
-    table3d_dim_t rowMax = pValueCache->lastYBinMax * axisSize;
-    table3d_dim_t rowMin = rowMax + axisSize;
-    table3d_dim_t colMax = axisSize - pValueCache->lastXBinMax - 1U;
-    table3d_dim_t colMin = colMax - 1U;
-    table3d_value_t A = pValues[rowMax + colMin];
-    table3d_value_t B = pValues[rowMax + colMax];
-    table3d_value_t C = pValues[rowMin + colMin];
-    table3d_value_t D = pValues[rowMin + colMax];
-
-    //Check that all values aren't just the same (This regularly happens with things like the fuel trim maps)
-    if( (A == B) && (A == C) && (A == D) ) { pValueCache->lastOutput = A; }
+    table3d_dim_t xBinMax = find_xbin(X_in, pXAxis, axisSize, pValueCache->lastXBinMax);
+    if (xBinMax!=pValueCache->lastXBinMax)
+    {
+      pValueCache->lastXBinMax = xBinMax;
+      pValueCache->lastXBinReciprocal = 0;
+    }
+    table3d_dim_t yBinMax = find_ybin(Y_in, pYAxis, axisSize, pValueCache->lastYBinMax);
+    if (yBinMax!=pValueCache->lastYBinMax)
+    {
+      pValueCache->lastYBinMax = yBinMax;
+      pValueCache->lastYBinReciprocal = 0;
+    }
+
+    table3d_corners corners = get_corners(axisSize, pValues, pValueCache->lastXBinMax, pValueCache->lastYBinMax);
+    if( is_flat(corners) ) { pValueCache->lastOutput = corners.A; }
     else
     {
       //Create some normalised position values
-      //These are essentially percentages (between 0 and 1) of where the desired value falls between the nearest bins on each axis
-      const QU1X8_t p = compute_bin_position(X_in, pValueCache->lastXBinMax, pXAxis);
-      const QU1X8_t q = compute_bin_position(Y_in, pValueCache->lastYBinMax, pYAxis);
-
-      const QU1X8_t m = mulQU1X8(QU1X8_ONE-p, q);
-      const QU1X8_t n = mulQU1X8(p, q);
-      const QU1X8_t o = mulQU1X8(QU1X8_ONE-p, QU1X8_ONE-q);
-      const QU1X8_t r = mulQU1X8(p, QU1X8_ONE-q);
-      pValueCache->lastOutput = ( (A * m) + (B * n) + (C * o) + (D * r) ) >> QU1X8_INTEGER_SHIFT;
+      const QU1X8_t p = compute_bin_position(X_in, pValueCache->lastXBinMax, pXAxis, pValueCache->lastXBinReciprocal);
+      const QU1X8_t q = compute_bin_position(Y_in, pValueCache->lastYBinMax, pYAxis, pValueCache->lastYBinReciprocal);
+      pValueCache->lastOutput = interpolate_corners(corners, p, q);
+    }
+
+    return pValueCache->lastOutput;
+}
+
+// Check whether a table's axes are the same as the reference axes of a shared cache.
+// The result is stored in the table's cache, so the (relatively slow) comparison
+// is only done once per table edit
+static inline bool is_axis_shared(struct table3DGetValueCache *pValueCache, 
+                    const struct table3DSharedAxisCache *pSharedCache,
+                    table3d_dim_t axisSize,
+                    const table3d_axis_t *pXAxis,
+                    const table3d_axis_t *pYAxis)
+{
+  if (pXAxis==pSharedCache->pXAxis && pYAxis==pSharedCache->pYAxis) { return true; }
+
+  if (pValueCache->sharedGeneration!=table3d_axis_generation)
+  {
+    pValueCache->sharedGeneration = table3d_axis_generation;
+    pValueCache->isAxisShared = (axisSize==pSharedCache->axisSize)
+                              && (memcmp(pXAxis, pSharedCache->pXAxis, axisSize*sizeof(table3d_axis_t))==0)
+                              && (memcmp(pYAxis, pSharedCache->pYAxis, axisSize*sizeof(table3d_axis_t))==0);
+  }
+  return pValueCache->isAxisShared;
+}
+
+table3d_value_t get3DTableValue(struct table3DGetValueCache *pValueCache, 
+                    struct table3DSharedAxisCache *pSharedCache,
+                    table3d_dim_t axisSize,
+                    const table3d_value_t *pValues,
+                    const table3d_axis_t *pXAxis,
+                    const table3d_axis_t *pYAxis,
+                    table3d_axis_t Y_in, table3d_axis_t X_in)
+{
+    // A table has been edited since the shared cache was set up, so start again
+    if (pSharedCache->generation!=table3d_axis_generation)
+    {
+      pSharedCache->generation = table3d_axis_generation;
+      pSharedCache->pXAxis = nullptr;
+      pSharedCache->last_lookup.x = INT16_MAX;
+    }
+    // The first table to be looked up supplies the axes for the other tables to match
+    if (pSharedCache->pXAxis==nullptr)
+    {
+      pSharedCache->pXAxis = pXAxis;
+      pSharedCache->pYAxis = pYAxis;
+      pSharedCache->axisSize = axisSize;
+    }
+
+    if (!is_axis_shared(pValueCache, pSharedCache, axisSize, pXAxis, pYAxis))
+    {
+      return get3DTableValue(pValueCache, axisSize, pValues, pXAxis, pYAxis, Y_in, X_in);
     }
 
+    if( X_in == pValueCache->last_lookup.x && 
+        Y_in == pValueCache->last_lookup.y)
+    {
+      return pValueCache->lastOutput;
+    }
+    pValueCache->last_lookup.x = X_in;
+    pValueCache->last_lookup.y = Y_in;
+
+    // The axis search is only done by the first table looked up with these inputs
+    if( X_in != pSharedCache->last_lookup.x || 
+        Y_in != pSharedCache->last_lookup.y)
+    {
+      pSharedCache->last_lookup.x = X_in;
+      pSharedCache->last_lookup.y = Y_in;
+
+      table3d_dim_t xBinMax = find_xbin(X_in, pXAxis, axisSize, pSharedCache->xBinMax);
+      if (xBinMax!=pSharedCache->xBinMax)
+      {
+        pSharedCache->xBinMax = xBinMax;
+        pSharedCache->xBinReciprocal = 0;
+      }
+      table3d_dim_t yBinMax = find_ybin(Y_in, pYAxis, axisSize, pSharedCache->yBinMax);
+      if (yBinMax!=pSharedCache->yBinMax)
+      {
+        pSharedCache->yBinMax = yBinMax;
+        pSharedCache->yBinReciprocal = 0;
+      }
+      pSharedCache->xBinPosition = compute_bin_position(X_in, xBinMax, pXAxis, pSharedCache->xBinReciprocal);
+      pSharedCache->yBinPosition = compute_bin_position(Y_in, yBinMax, pYAxis, pSharedCache->yBinReciprocal);
+    }
+
+    // Keep the table's own cache in step, in case it is also looked up without the shared cache
+    if (pValueCache->lastXBinMax!=pSharedCache->xBinMax)
+    {
+      pValueCache->lastXBinMax = pSharedCache->xBinMax;
+      pValueCache->lastXBinReciprocal = 0;
+    }
+    if (pValueCache->lastYBinMax!=pSharedCache->yBinMax)
+    {
+      pValueCache->lastYBinMax = pSharedCache->yBinMax;
+      pValueCache->lastYBinReciprocal = 0;
+    }
+
+    table3d_corners corners = get_corners(axisSize, pValues, pSharedCache->xBinMax, pSharedCache->yBinMax);
+    if( is_flat(corners) ) { pValueCache->lastOutput = corners.A; }
+    else { pValueCache->lastOutput = interpolate_corners(corners, pSharedCache->xBinPosition, pSharedCache->yBinPosition); }
+
     return pValueCache->lastOutput;
 }
@@ -30,14 +30,63 @@ struct table3DGetValueCache {
   //Store the last input and output values, again for caching purposes
   coord2d last_lookup = { INT16_MAX, INT16_MAX };
   table3d_value_t lastOutput;
+
+  // Scaled reciprocals of the widths of the last X & Y bins. These turn the
+  // division needed to find the position within a bin into a multiply, so the
+  // division only happens when the lookup moves to a new bin.
+  // 0 means not calculated yet.
+  uint16_t lastXBinReciprocal = 0;
+  uint16_t lastYBinReciprocal = 0;
+
+  // Whether this table's axes are identical to those of the shared axis cache
+  // it is looked up with (See table3DSharedAxisCache). Only valid while
+  // sharedGeneration matches table3d_axis_generation
+  uint16_t sharedGeneration = 0;
+  bool isAxisShared = false;
 };
 
+// Incremented whenever a table cache is invalidated (I.e. a table has been
+// edited). Shared axis caches & the axis comparisons are only valid for the
+// generation they were made in. Never 0.
+extern uint16_t table3d_axis_generation;
 
 static inline void invalidate_cache(table3DGetValueCache *pCache)
 {
     pCache->last_lookup.x = INT16_MAX;
+    // The axis may have changed, so the bin widths may have too
+    pCache->lastXBinReciprocal = 0;
+    pCache->lastYBinReciprocal = 0;
+    // ...and it may no longer match (or now match) the axes of other tables
+    ++table3d_axis_generation;
+    if (table3d_axis_generation==0U) { table3d_axis_generation = 1U; }
 }
 
+// Several tables are often looked up with the same inputs (E.g. RPM & fuel load)
+// on identical axes. A shared axis cache holds the result of the axis search
+// (the bins and the position within them) for the last lookup, so that it is
+// only done once per loop for all of those tables. Only the value interpolation
+// is done per table.
+//
+// The first table looked up with the cache supplies the reference axes. Any other
+// table is compared to them (once per table edit) & if the axes differ the table
+// is looked up as normal, so it is always safe to use a shared cache. A table
+// should only be looked up with a single shared cache.
+struct table3DSharedAxisCache {
+  const table3d_axis_t *pXAxis = nullptr; // Axes of the reference table. nullptr if not set yet
+  const table3d_axis_t *pYAxis = nullptr;
+  table3d_dim_t axisSize = 0;
+  uint16_t generation = 0;
+
+  coord2d last_lookup = { INT16_MAX, INT16_MAX };
+  table3d_dim_t xBinMax = 1;
+  table3d_dim_t yBinMax = 1;
+  uint16_t xBinReciprocal = 0;
+  uint16_t yBinReciprocal = 0;
+  // Position within the bins (0 to 1) as 1.8 fixed point numbers
+  uint16_t xBinPosition = 0;
+  uint16_t yBinPosition = 0;
+};
+
 /*
 3D Tables have an origin (0,0) in the top left hand corner. Vertical axis is expressed first.
 Eg: 2x2 table
@@ -56,4 +105,14 @@ table3d_value_t get3DTableValue(struct table3DGetValueCache *pValueCache,
                     const table3d_value_t *pValues,
                     const table3d_axis_t *pXAxis,
                     const table3d_axis_t *pYAxis,
-                    table3d_axis_t y, table3d_axis_t x);
\ No newline at end of file
+                    table3d_axis_t y, table3d_axis_t x);
+
+// As above, but the axis search is shared with any other tables that are looked
+// up with the same shared cache and have identical axes.
+table3d_value_t get3DTableValue(struct table3DGetValueCache *pValueCache, 
+                    struct table3DSharedAxisCache *pSharedCache,
+                    table3d_dim_t axisSize,
+                    const table3d_value_t *pValues,
+                    const table3d_axis_t *pXAxis,
+                    const table3d_axis_t *pYAxis,
+                    table3d_axis_t y, table3d_axis_t x);
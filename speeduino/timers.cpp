@@ -18,8 +18,10 @@ Timers are typically low resolution (Compared to Schedulers), with maximum frequ
 #include "speeduino.h"
 #include "scheduler.h"
 #include "auxiliaries.h"
+#include "isr_timing.h"
 #include "comms.h"
 #include "maths.h"
+#include "adc_scan.h"
 
 #if defined(CORE_AVR)
   #include <avr/wdt.h>
@@ -76,9 +78,14 @@ ISR(TIMER2_OVF_vect, ISR_NOBLOCK) //cppcheck-suppress misra-c2012-8.2
 void oneMSInterval(void) //Most ARM chips can simply call a function
 #endif
 {
+  ISR_TIMING_START();
   BIT_SET(TIMER_mask, BIT_TIMER_1KHZ);
   ms_counter++;
 
+#if defined(ANALOG_SCAN)
+  adcScanTick(); //Background conversion of the analog inputs
+#endif
+
   //Increment Loop Counters
   loop5ms++;
   loop20ms++;
@@ -385,4 +392,5 @@ void oneMSInterval(void) //Most ARM chips can simply call a function
     //Reset Timer2 to trigger in another ~1ms
     TCNT2 = 131;            //Preload timer2 with 100 cycles, leaving 156 till overflow.
 #endif
+  ISR_TIMING_END(ISR_TIMING_1MS);
 }
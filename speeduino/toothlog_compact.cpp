@@ -0,0 +1,196 @@
+/** @file
+ * Compact tooth log transport format. See toothlog_compact.h
+ */
+#include "toothlog_compact.h"
+
+static inline uint8_t* writeVarint(uint8_t *pBuffer, uint32_t value)
+{
+  while(value >= 0x80U)
+  {
+    *pBuffer = (uint8_t)(value | 0x80U);
+    pBuffer++;
+    value >>= 7U;
+  }
+  *pBuffer = (uint8_t)value;
+  return pBuffer + 1U;
+}
+
+/** @return Pointer to the byte after the varint, or nullptr if it runs past pEnd or is longer than a 32 bit value */
+static inline const uint8_t* readVarint(const uint8_t *pBuffer, const uint8_t *pEnd, uint32_t &value)
+{
+  value = 0U;
+  for(uint8_t shift = 0U; (shift < (7U * TOOTH_LOG_COMPACT_VARINT_MAX)) && (pBuffer < pEnd); shift += 7U)
+  {
+    uint8_t data = *pBuffer;
+    pBuffer++;
+    value |= (uint32_t)(data & 0x7FU) << shift;
+    if((data & 0x80U) == 0U) { return pBuffer; }
+  }
+  return nullptr;
+}
+
+static inline uint32_t zigzagEncode(uint32_t difference) { return (difference << 1U) ^ (uint32_t)(-(int32_t)(difference >> 31U)); }
+static inline uint32_t zigzagDecode(uint32_t value) { return (value >> 1U) ^ (uint32_t)(-(int32_t)(value & 1U)); }
+
+/** Write the run length encoded composite status bits (See toothlog_compact.h)
+ * @return Pointer to the byte after the last one written
+ */
+static uint8_t* writeCompactFlags(const volatile uint8_t *pFlags, uint8_t entries, uint8_t *pOut)
+{
+  uint8_t lastFlags = 0U;
+  uint8_t lastChange = 0U;
+  uint8_t run = 0U;
+  for(uint8_t entry = 0U; entry < entries; entry++)
+  {
+    uint8_t flags = pFlags[entry] & TOOTH_LOG_COMPACT_FLAG_MASK;
+    uint8_t change = flags ^ lastFlags;
+    lastFlags = flags;
+
+    if( (change == lastChange) && (run < TOOTH_LOG_COMPACT_RUN_MAX) ) { run++; }
+    else
+    {
+      if(run > 0U)
+      {
+        *pOut = TOOTH_LOG_COMPACT_FLAG_RUN | (uint8_t)(run - 1U);
+        pOut++;
+      }
+      if(change == lastChange) { run = 1U; } //The previous run was full
+      else
+      {
+        *pOut = change;
+        pOut++;
+        lastChange = change;
+        run = 0U;
+      }
+    }
+  }
+  if(run > 0U)
+  {
+    *pOut = TOOTH_LOG_COMPACT_FLAG_RUN | (uint8_t)(run - 1U);
+    pOut++;
+  }
+  return pOut;
+}
+
+/** Encode a tooth or composite log.
+ * @param pTimes The log entries (toothHistory)
+ * @param pFlags The composite status bytes (compositeLogHistory), or nullptr for a tooth log
+ * @param entries Number of entries to encode. Set to the number that were encoded, which is less if they did not all fit
+ * @param pBuffer Destination
+ * @param bufferSize Size of the destination. All the entries are guaranteed to fit if this is at least TOOTH_LOG_COMPACT_MAX_SIZE(entries)
+ * @return Number of bytes written
+ */
+uint16_t encodeCompactToothLog(const volatile uint32_t *pTimes, const volatile uint8_t *pFlags, uint8_t &entries, uint8_t *pBuffer, uint16_t bufferSize)
+{
+  uint8_t *pOut = pBuffer + 2U;
+  const uint8_t *pEnd = pBuffer + bufferSize;
+  bool isComposite = (pFlags != nullptr);
+
+  uint32_t lastTime = 0U;
+  uint32_t lastGap = 0U;
+  //Size of the status bits so far. Each literal and each run is 1 byte, as per writeCompactFlags()
+  uint16_t flagBytes = 0U;
+  uint8_t lastFlags = 0U;
+  uint8_t lastChange = 0U;
+  uint8_t run = 0U;
+
+  uint8_t entry = 0U;
+  for(; entry < entries; entry++)
+  {
+    //Stop if the worst case size of this entry plus the status bytes will not fit. An entry adds at most 1 status byte
+    if((pEnd - pOut) < (int16_t)(TOOTH_LOG_COMPACT_VARINT_MAX + flagBytes + (isComposite ? 1U : 0U))) { break; }
+
+    uint32_t time = pTimes[entry];
+    uint32_t difference = time - lastTime;
+    if(isComposite)
+    {
+      uint32_t gap = difference;
+      difference = gap - lastGap;
+      lastGap = (entry == 0U) ? 0U : gap; //The first entry is a timestamp, not a gap
+
+      uint8_t flags = pFlags[entry] & TOOTH_LOG_COMPACT_FLAG_MASK;
+      uint8_t change = flags ^ lastFlags;
+      lastFlags = flags;
+      if(change == lastChange)
+      {
+        if( (run == 0U) || (run == TOOTH_LOG_COMPACT_RUN_MAX) ) { flagBytes++; run = 0U; }
+        run++;
+      }
+      else
+      {
+        flagBytes++;
+        lastChange = change;
+        run = 0U;
+      }
+    }
+    pOut = writeVarint(pOut, (entry == 0U) ? difference : zigzagEncode(difference));
+    lastTime = time;
+  }
+  entries = entry;
+  pBuffer[0] = TOOTH_LOG_COMPACT_VERSION | (isComposite ? TOOTH_LOG_COMPACT_COMPOSITE : 0U);
+  pBuffer[1] = entries;
+
+  if(isComposite) { pOut = writeCompactFlags(pFlags, entries, pOut); }
+
+  return (uint16_t)(pOut - pBuffer);
+}
+
+/** Decode a compact tooth or composite log. This is the reverse of encodeCompactToothLog(), for tools and testing
+ * @param pFlags Destination for the composite status bytes. Can be nullptr if they are not needed, and is not written for a tooth log
+ * @return Number of entries decoded, or -1 if the data is not a valid compact log or has more than maxEntries entries
+ */
+int16_t decodeCompactToothLog(const uint8_t *pBuffer, uint16_t length, uint32_t *pTimes, uint8_t *pFlags, uint8_t maxEntries)
+{
+  const uint8_t *pEnd = pBuffer + length;
+  if( (length < 2U) || ((pBuffer[0] & ~TOOTH_LOG_COMPACT_COMPOSITE) != TOOTH_LOG_COMPACT_VERSION) || (pBuffer[1] > maxEntries) ) { return -1; }
+  bool isComposite = (pBuffer[0] & TOOTH_LOG_COMPACT_COMPOSITE) != 0U;
+  uint8_t entries = pBuffer[1];
+  const uint8_t *pIn = pBuffer + 2U;
+
+  uint32_t lastTime = 0U;
+  uint32_t lastGap = 0U;
+  for(uint8_t entry = 0U; entry < entries; entry++)
+  {
+    uint32_t value;
+    pIn = readVarint(pIn, pEnd, value);
+    if(pIn == nullptr) { return -1; }
+    uint32_t difference = (entry == 0U) ? value : zigzagDecode(value);
+    if(isComposite)
+    {
+      uint32_t gap = lastGap + difference;
+      lastGap = (entry == 0U) ? 0U : gap;
+      difference = gap;
+    }
+    lastTime += difference;
+    pTimes[entry] = lastTime;
+  }
+
+  if(isComposite)
+  {
+    uint8_t lastFlags = 0U;
+    uint8_t lastChange = 0U;
+    uint8_t run = 0U;
+    for(uint8_t entry = 0U; entry < entries; entry++)
+    {
+      if(run == 0U)
+      {
+        if(pIn >= pEnd) { return -1; }
+        uint8_t data = *pIn;
+        pIn++;
+        if((data & TOOTH_LOG_COMPACT_FLAG_RUN) != 0U) { run = (uint8_t)((data & ~TOOTH_LOG_COMPACT_FLAG_RUN) + 1U); }
+        else if((data & ~TOOTH_LOG_COMPACT_FLAG_MASK) != 0U) { return -1; }
+        else
+        {
+          lastChange = data;
+          run = 1U;
+        }
+      }
+      lastFlags ^= lastChange;
+      run--;
+      if(pFlags != nullptr) { pFlags[entry] = lastFlags; }
+    }
+    if(run != 0U) { return -1; } //A run longer than the log
+  }
+
+  return (pIn == pEnd) ? (int16_t)entries : -1;
+}
@@ -0,0 +1,46 @@
+/** @file
+ * Compact transport format for the tooth and composite logs.
+ *
+ * The standard 'T' command sends every tooth log entry as a raw 32 bit value (Plus a status byte for the composite log),
+ * which limits how many teeth can be streamed over a slow serial link. Consecutive entries are closely related though:
+ * - Tooth log entries are the gaps between teeth, which change very little from one tooth to the next (Except at missing teeth)
+ * - Composite log entries are increasing timestamps, separated by roughly one tooth gap
+ * so this format sends each entry as a variable length difference from the previous one instead.
+ *
+ * Layout:
+ * - Header byte: TOOTH_LOG_COMPACT_VERSION, plus TOOTH_LOG_COMPACT_COMPOSITE for a composite log
+ * - Number of entries (1 byte)
+ * - The first entry as an unsigned varint
+ * - Each further entry as a zigzag encoded varint (0, -1, 1, -2, 2... become 0, 1, 2, 3, 4...). For a tooth log this is the
+ *   difference from the previous gap. Composite timestamps are turned into gaps first, so theirs is the difference between
+ *   this gap and the previous one
+ * - Composite logs only: the status bits of each entry (COMPOSITE_LOG_PRI to COMPOSITE_ENGINE_CYCLE), sent as the bits that
+ *   changed from the previous entry (Which starts at 0). Each byte is either:
+ *   - A literal (Top bit clear): the bits that changed on the next entry
+ *   - A run (TOOTH_LOG_COMPACT_FLAG_RUN set): the next 1 to 128 entries (The low 7 bits plus 1) change the same bits as the last
+ *     literal did. A primary input logged on both edges toggles the same bit on every tooth, so most of a log is a few runs
+ *
+ * A log that does not fit in the space available is split, with each part being a complete compact log of its own.
+ *
+ * Varints are 7 bits per byte, least significant group first, with the top bit set on all bytes but the last.
+ * At steady speed a tooth log entry is 1 byte rather than 4, and a composite entry is a little over 1 byte rather than 5.
+ */
+#ifndef TOOTHLOG_COMPACT_H
+#define TOOTHLOG_COMPACT_H
+
+#include <stdint.h>
+
+#define TOOTH_LOG_COMPACT_VERSION     1U
+#define TOOTH_LOG_COMPACT_COMPOSITE   0x80U
+#define TOOTH_LOG_COMPACT_FLAG_MASK   0x3FU //The bits of each composite status byte that are sent
+#define TOOTH_LOG_COMPACT_FLAG_RUN    0x80U
+#define TOOTH_LOG_COMPACT_RUN_MAX     128U
+#define TOOTH_LOG_COMPACT_VARINT_MAX  5U //Largest varint for a 32 bit value
+
+/** Largest possible encoded size of a log with the given number of entries */
+#define TOOTH_LOG_COMPACT_MAX_SIZE(entries) (2U + ((TOOTH_LOG_COMPACT_VARINT_MAX + 1U) * (entries)))
+
+uint16_t encodeCompactToothLog(const volatile uint32_t *pTimes, const volatile uint8_t *pFlags, uint8_t &entries, uint8_t *pBuffer, uint16_t bufferSize);
+int16_t decodeCompactToothLog(const uint8_t *pBuffer, uint16_t length, uint32_t *pTimes, uint8_t *pFlags, uint8_t maxEntries);
+
+#endif // TOOTHLOG_COMPACT_H
@@ -0,0 +1,47 @@
+/** @file
+ * Hardware input capture timestamps for the trigger inputs.
+ *
+ * The trigger ISRs need the time that the edge occurred, but micros() called on ISR entry also includes the interrupt
+ * latency, which varies with whatever other interrupt (Scheduler, ADC, serial etc) was running when the edge arrived.
+ * On boards where the trigger pin is also a timer input capture channel, the timer latches its count on the edge itself.
+ * The ISR then measures how long ago that was with the same timer and subtracts it from micros(), giving the time of
+ * the edge on the micros() timeline. As both counts come from the same timer the two clocks do not need to be synchronised.
+ *
+ * A board that supports this defines TRIGGER_CAPTURE_AVAILABLE in its board_*.h and provides:
+ *   void initTriggerCapture(uint8_t input, uint8_t pin, uint8_t edge); //Setup the capture for one trigger input (If the pin supports it)
+ *   unsigned long getTriggerCaptureTime(uint8_t input); //Time of the last edge on the input, on the micros() timeline
+ * getTriggerCaptureTime() is normally just captureEdgeTime() on the triggerCapture of the input.
+ * Boards without input capture fall back to micros(), see getTriggerEdgeTime() in decoders.cpp
+ */
+#ifndef TRIGGER_CAPTURE_H
+#define TRIGGER_CAPTURE_H
+
+#include <stdint.h>
+
+#define TRIGGER_INPUT_PRIMARY     0U
+#define TRIGGER_INPUT_SECONDARY   1U
+#define TRIGGER_INPUT_TERTIARY    2U
+#define TRIGGER_INPUT_COUNT       3U
+
+/** The timer registers used to capture one trigger input */
+struct triggerCapture {
+  volatile uint32_t *pCounter;  ///< Free running counter that the capture is taken from. nullptr if the input has no capture
+  volatile uint32_t *pCapture;  ///< Register that latches the counter on each trigger edge
+  uint32_t counterMask;         ///< Counter range, eg 0xFFFF for a 16 bit timer
+  uint8_t usPerTickShift;       ///< log2 of the number of uS per counter tick (0 for a 1MHz counter)
+};
+
+/** Convert the last capture of an input to the micros() timeline
+ * @param capture The capture registers of the input
+ * @param nowMicros micros() at the time of the call. Read immediately before this call
+ * @return The micros() time of the captured edge. If the input has no capture, nowMicros is returned unchanged
+ * @note The edge must be less than one counter period before the call (65mS on a 16 bit 1MHz counter)
+ */
+static inline unsigned long captureEdgeTime(const triggerCapture &capture, unsigned long nowMicros)
+{
+  if(capture.pCapture == nullptr) { return nowMicros; }
+  uint32_t ticksSinceEdge = (*capture.pCounter - *capture.pCapture) & capture.counterMask;
+  return nowMicros - (ticksSinceEdge << capture.usPerTickShift);
+}
+
+#endif // TRIGGER_CAPTURE_H
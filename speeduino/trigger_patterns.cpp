@@ -0,0 +1,92 @@
+/** @file
+ * Built in gap patterns and the setup time compilation of a pattern into its lookup tables. See trigger_patterns.h
+ */
+#include <string.h>
+#include "trigger_patterns.h"
+
+//36-2-2-2 (Subaru H4): 13 teeth, 2 missing, 16 teeth, 2 missing, 1 tooth, 2 missing
+static constexpr uint16_t PROGMEM angles36_2_2_2[] = {   0,  10,  20,  30,  40,  50,  60,  70,  80,  90, 100, 110, 120,
+                                                       150, 160, 170, 180, 190, 200, 210, 220, 230, 240, 250, 260, 270, 280, 290, 300,
+                                                       330 };
+//36-2-1 (Mitsubishi 4B11): 16 teeth, 1 missing, 17 teeth, 2 missing
+static constexpr uint16_t PROGMEM angles36_2_1[] = {   0,  10,  20,  30,  40,  50,  60,  70,  80,  90, 100, 110, 120, 130, 140, 150,
+                                                     170, 180, 190, 200, 210, 220, 230, 240, 250, 260, 270, 280, 290, 300, 310, 320, 330 };
+//60-2 with a single cam tooth in the first crank revolution
+static constexpr uint16_t PROGMEM angles60_2[] = {   0,   6,  12,  18,  24,  30,  36,  42,  48,  54,  60,  66,  72,  78,  84,  90,
+                                                    96, 102, 108, 114, 120, 126, 132, 138, 144, 150, 156, 162, 168, 174, 180, 186,
+                                                   192, 198, 204, 210, 216, 222, 228, 234, 240, 246, 252, 258, 264, 270, 276, 282,
+                                                   288, 294, 300, 306, 312, 318, 324, 330, 336, 342 };
+static constexpr uint16_t PROGMEM cam60_2[] = { 100 };
+//12+1 at cam speed (Eg Honda D17): 12 evenly spaced teeth with an extra tooth half way between #12 and #1
+static constexpr uint16_t PROGMEM angles12_1[] = { 0, 60, 120, 180, 240, 300, 360, 420, 480, 540, 600, 660, 690 };
+
+const gapPattern gapPatterns[] PROGMEM = {
+  { 360, sizeof(angles36_2_2_2) / sizeof(angles36_2_2_2[0]), 0, angles36_2_2_2, nullptr }, //GAP_PATTERN_36_2_2_2
+  { 360, sizeof(angles36_2_1) / sizeof(angles36_2_1[0]), 0, angles36_2_1, nullptr },       //GAP_PATTERN_36_2_1
+  { 360, sizeof(angles60_2) / sizeof(angles60_2[0]), 1, angles60_2, cam60_2 },             //GAP_PATTERN_60_2_CAM
+  { 720, sizeof(angles12_1) / sizeof(angles12_1[0]), 0, angles12_1, nullptr },             //GAP_PATTERN_12_1_CAM_SPEED
+};
+const uint8_t gapPatternCount = sizeof(gapPatterns) / sizeof(gapPatterns[0]);
+
+/** The angle from the previous tooth to the given tooth (Wrapping around the end of the cycle) */
+uint16_t gapBeforeTooth(const gapPattern &pattern, uint8_t tooth)
+{
+  uint16_t angle = getGapToothAngle(pattern, tooth);
+  if(tooth == 0U) { return (angle + pattern.cycleAngle) - getGapToothAngle(pattern, pattern.toothCount - 1U); }
+  return angle - getGapToothAngle(pattern, tooth - 1U);
+}
+
+static inline uint8_t previousTooth(const gapPattern &pattern, uint8_t tooth)
+{
+  return (tooth == 0U) ? (pattern.toothCount - 1U) : (tooth - 1U);
+}
+
+/** Build the expected tooth symbols and the sync lookup for a pattern.
+ * @return false if the pattern is invalid, or no tooth on it can be uniquely identified from its gaps (The decoder will never sync)
+ */
+bool compileGapPattern(const gapPattern &pattern, gapPatternLookup &lookup)
+{
+  memset(lookup.toothSymbols, 0, sizeof(lookup.toothSymbols));
+  memset(lookup.signatureTooth, GAP_NO_TOOTH, sizeof(lookup.signatureTooth));
+  lookup.syncTeeth = 0U;
+  lookup.minGap = UINT16_MAX;
+  lookup.maxGap = 0U;
+
+  if( (pattern.toothCount < 2U) || (pattern.toothCount > GAP_PATTERN_MAX_TEETH) || (pattern.camToothCount > GAP_PATTERN_MAX_CAM_TEETH) ) { return false; }
+
+  for(uint8_t tooth = 0U; tooth < pattern.toothCount; tooth++)
+  {
+    if( getGapToothAngle(pattern, tooth) >= pattern.cycleAngle ) { return false; }
+    uint16_t gap = gapBeforeTooth(pattern, tooth);
+    if( (gap == 0U) || (gap > pattern.cycleAngle) ) { return false; } //Teeth are not in ascending order
+    if(gap < lookup.minGap) { lookup.minGap = gap; }
+    if(gap > lookup.maxGap) { lookup.maxGap = gap; }
+
+    uint8_t symbol = classifyGap(gap, gapBeforeTooth(pattern, previousTooth(pattern, tooth)));
+    lookup.toothSymbols[tooth >> 2U] |= symbol << ((tooth & 3U) * 2U);
+  }
+
+  //Record the tooth that each signature ends on. Signatures that end on more than one tooth cannot be used for sync
+  static constexpr uint8_t GAP_AMBIGUOUS = GAP_NO_TOOTH - 1U;
+  for(uint8_t tooth = 0U; tooth < pattern.toothCount; tooth++)
+  {
+    uint8_t signature = 0U;
+    uint8_t signatureTooth = tooth;
+    for(uint8_t position = 0U; position < GAP_SIGNATURE_LENGTH; position++)
+    {
+      signature |= getGapToothSymbol(lookup, signatureTooth) << (position * 2U);
+      signatureTooth = previousTooth(pattern, signatureTooth);
+    }
+
+    if(lookup.signatureTooth[signature] == GAP_NO_TOOTH) { lookup.signatureTooth[signature] = tooth; }
+    else { lookup.signatureTooth[signature] = GAP_AMBIGUOUS; }
+  }
+
+  for(uint8_t signature = 0U; signature < GAP_SIGNATURE_COUNT; signature++)
+  {
+    if(lookup.signatureTooth[signature] == GAP_AMBIGUOUS) { lookup.signatureTooth[signature] = GAP_NO_TOOTH; }
+    else if(lookup.signatureTooth[signature] != GAP_NO_TOOTH) { lookup.syncTeeth++; }
+  }
+
+  return lookup.syncTeeth > 0U;
+}
@@ -0,0 +1,87 @@
+/** @file
+ * Trigger wheel descriptions for the generic gap pattern decoder (DECODER_GAP_PATTERN).
+ *
+ * A pattern is described only by the angles of its teeth (And optionally the angles of cam teeth used for phase),
+ * so a new wheel is added by adding its description to gapPatterns[] rather than by writing a new decoder.
+ *
+ * Decoding is based on the ratio of each tooth gap to the gap before it, quantised to a 2 bit symbol (See classifyGap()).
+ * At setup, the expected symbol of every tooth is calculated from the description, along with a lookup table from
+ * the last GAP_SIGNATURE_LENGTH symbols to the tooth that they end on. In the trigger ISR, sync is gained with a single
+ * lookup of the recent symbols, and once synced each tooth only needs to be checked against its expected symbol.
+ * This keeps the per-edge cost constant, regardless of the number of teeth on the wheel.
+ *
+ * The gap ratios that occur on a wheel should be kept clear of the classifyGap() thresholds (0.67, 1.5 and 2.5) so
+ * that acceleration and timing noise do not change the observed symbol. Ratios of 1/3, 1/2, 1, 2 and 3 all work well.
+ */
+#ifndef TRIGGER_PATTERNS_H
+#define TRIGGER_PATTERNS_H
+
+#include <stdint.h>
+#include <Arduino.h>
+
+#define GAP_PATTERN_MAX_TEETH       64U
+#define GAP_PATTERN_MAX_CAM_TEETH   4U
+#define GAP_SIGNATURE_LENGTH        3U  //Number of consecutive symbols used to identify a tooth
+#define GAP_SIGNATURE_MASK          ((1U << (GAP_SIGNATURE_LENGTH * 2U)) - 1U)
+#define GAP_SIGNATURE_COUNT         (GAP_SIGNATURE_MASK + 1U)
+#define GAP_NO_TOOTH                0xFFU
+
+//Indexes of the built in patterns. These must match the gapPattern list in the ini
+#define GAP_PATTERN_36_2_2_2        0
+#define GAP_PATTERN_36_2_1          1
+#define GAP_PATTERN_60_2_CAM        2
+#define GAP_PATTERN_12_1_CAM_SPEED  3
+
+/** The ratio of a tooth gap to the gap before it, quantised to 2 bits */
+#define GAP_SHORT       0U  //Less than 0.67x the previous gap
+#define GAP_EQUAL       1U  //0.67x - 1.5x
+#define GAP_LONG        2U  //1.5x - 2.5x
+#define GAP_VERY_LONG   3U  //2.5x or more
+
+/** Description of a trigger wheel.
+ * All angles are in crank degrees, measured from an arbitrary reference. The trigger angle setting is the angle ATDC
+ * of that reference point. Both angle arrays are stored in flash (PROGMEM).
+ */
+struct gapPattern {
+  uint16_t cycleAngle;              ///< Crank angle covered by one revolution of the wheel. 360 for a crank wheel, 720 for a cam speed wheel
+  uint8_t toothCount;               ///< Number of physical teeth on the wheel
+  uint8_t camToothCount;            ///< Number of cam teeth used for phase. 0 if there are none (Or the wheel is at cam speed)
+  const uint16_t *pToothAngles;     ///< Angle of each tooth, in ascending order and all less than cycleAngle. pToothAngles[0] is tooth #1
+  const uint16_t *pCamToothAngles;  ///< Angle (0-719) of each cam tooth, relative to tooth #1 of the first crank revolution of the cycle
+};
+
+/** The tables built from a gapPattern by compileGapPattern() */
+struct gapPatternLookup {
+  uint8_t toothSymbols[GAP_PATTERN_MAX_TEETH / 4U];   ///< The expected symbol of the gap before each tooth, packed 4 per byte
+  uint8_t signatureTooth[GAP_SIGNATURE_COUNT];        ///< Index of the tooth that each signature uniquely ends on. GAP_NO_TOOTH if none (Or ambiguous)
+  uint8_t syncTeeth;                                  ///< Number of teeth that sync can be gained on
+  uint16_t minGap;                                    ///< Smallest angle between 2 teeth
+  uint16_t maxGap;                                    ///< Largest angle between 2 teeth
+};
+
+extern const gapPattern gapPatterns[] PROGMEM;
+extern const uint8_t gapPatternCount;
+
+bool compileGapPattern(const gapPattern &pattern, gapPatternLookup &lookup);
+uint16_t gapBeforeTooth(const gapPattern &pattern, uint8_t tooth);
+
+/** Quantise the ratio of a tooth gap to the previous one. Integer compares only as this is called on every trigger edge */
+static inline uint8_t classifyGap(uint32_t gap, uint32_t lastGap)
+{
+  if( (gap * 3U) < (lastGap * 2U) ) { return GAP_SHORT; }
+  if( (gap * 2U) < (lastGap * 3U) ) { return GAP_EQUAL; }
+  if( (gap * 2U) < (lastGap * 5U) ) { return GAP_LONG; }
+  return GAP_VERY_LONG;
+}
+
+static inline uint8_t getGapToothSymbol(const gapPatternLookup &lookup, uint8_t tooth)
+{
+  return (lookup.toothSymbols[tooth >> 2U] >> ((tooth & 3U) * 2U)) & 3U;
+}
+
+static inline uint16_t getGapToothAngle(const gapPattern &pattern, uint8_t tooth)
+{
+  return pgm_read_word(&pattern.pToothAngles[tooth]);
+}
+
+#endif // TRIGGER_PATTERNS_H
@@ -14,11 +14,12 @@
 #include "updates.h"
 #include "pages.h"
 #include "comms_CAN.h"
+#include "can_broadcast.h"
 #include EEPROM_LIB_H //This is defined in the board .h files
 
 void doUpdates(void)
 {
-  #define CURRENT_DATA_VERSION    24
+  #define CURRENT_DATA_VERSION    25
   //Only the latest update for small flash devices must be retained
    #ifndef SMALL_FLASH_MODE
 
@@ -772,6 +773,55 @@ void doUpdates(void)
     writeAllConfig();
     storeEEPROMVersion(24);
   }
+
+  if(readEEPROMVersion() == 24)
+  {
+    //Analog sensor channels added. Decimation, median and fault detection off by default
+    for(byte x = 0; x < SENSOR_CHANNEL_COUNT; x++)
+    {
+      configPage15.sensorMode[x] = 0;
+      configPage15.sensorFaultLow[x] = 0;
+      configPage15.sensorFaultHigh[x] = 0;
+    }
+    //Fuel and oil pressure filters were fixed at the default
+    configPage15.ADCFILTER_PSI = ADCFILTER_PSI_DEFAULT;
+
+    //Gap pattern decoder added. Byte 110 of page 9 was unused, so may hold anything
+    configPage9.trigGapPattern = 0;
+    configPage9.unused10_110 = 0;
+
+    //User defined CAN broadcast frames added. Bytes 106-218 of page 15 were unused, so may hold anything. All frames off
+    for(byte x = 0; x < CAN_TX_USER_FRAMES; x++)
+    {
+      configPage15.canTxId[x] = 0;
+      configPage15.canTxPeriod[x] = 0;
+    }
+    configPage15.canTxBigEndian = 0;
+    for(byte x = 0; x < (CAN_TX_USER_FRAMES * CAN_TX_USER_SIGNALS); x++)
+    {
+      configPage15.canTxSigSource[x] = 0;
+      configPage15.canTxSigType[x] = CAN_TX_SIGNAL_OFF;
+      configPage15.canTxSigByte[x] = 0;
+      configPage15.canTxSigMultiply[x] = 1; //As the ini defaults, so an enabled signal is sent unscaled
+      configPage15.canTxSigDivide[x] = 1;
+      configPage15.canTxSigOffset[x] = 0;
+    }
+
+    //Crank angle triggered MAP sampling added in bytes 219-221 of page 15. Off, so MAP is sampled from the main loop as before
+    configPage15.mapAngleSampling = 0;
+    configPage15.unused15_219 = 0;
+    configPage15.mapSampleAngle = 0;
+
+    //Fast binary SD log rates added in the top 2 bits of byte 125 of page 13, which were unused
+    configPage13.onboard_log_fast_rate = 0;
+    //Crank angle synchronous logging added in bytes 106-107 of page 13. These were part of an unused (But user editable) array
+    configPage13.onboard_log_cycle_mode = 0;
+    configPage13.unused13_106 = 0;
+    configPage13.onboard_log_cycle_teeth = 1;
+
+    writeAllConfig();
+    storeEEPROMVersion(25);
+  }
   
   //Final check is always for 255 and 0 (Brand new arduino)
   if( (readEEPROMVersion() == 0) || (readEEPROMVersion() == 255) )
@@ -0,0 +1,204 @@
+/*
+Checks the background analog scan against a fake ADC: which channels are converted on each tick, that each conversion is
+started from the completion of the last one, and that results are only published once a pass has completed
+*/
+#include <unity.h>
+#include "adc_scan.h"
+#include "adc_scan.cpp"
+
+#define FAKE_PINS 64U
+
+static uint16_t fakeValue[FAKE_PINS];
+static uint8_t fakeConversions[FAKE_PINS];
+static uint8_t fakeConvertingPin; //The conversion that has been started and not completed
+
+//Stands in for the board layer
+void adcScanStartConversion(uint8_t pin)
+{
+  TEST_ASSERT_EQUAL_UINT8(ADC_SCAN_NO_CHANNEL, fakeConvertingPin); //Only one conversion at a time
+  fakeConvertingPin = pin;
+}
+
+/** As the end of conversion interrupt */
+static bool completeConversion(void)
+{
+  uint8_t pin = fakeConvertingPin;
+  if(pin == ADC_SCAN_NO_CHANNEL) { return false; }
+  fakeConvertingPin = ADC_SCAN_NO_CHANNEL;
+  fakeConversions[pin]++;
+  adcScanConversionComplete(fakeValue[pin]);
+  return true;
+}
+
+static void completeAllConversions(void)
+{
+  while(completeConversion() == true) { }
+}
+
+static void tickAndComplete(void)
+{
+  adcScanTick();
+  completeAllConversions();
+}
+
+static void resetFake(void)
+{
+  for(uint8_t pin = 0U; pin < FAKE_PINS; pin++)
+  {
+    fakeValue[pin] = (uint16_t)(pin * 10U);
+    fakeConversions[pin] = 0U;
+  }
+  fakeConvertingPin = ADC_SCAN_NO_CHANNEL;
+  adcScanReset();
+}
+
+static void test_adcScan_start(void)
+{
+  resetFake();
+  TEST_ASSERT_TRUE(adcScanAddChannel(1U, true));
+  TEST_ASSERT_TRUE(adcScanAddChannel(2U, false));
+  TEST_ASSERT_TRUE(adcScanAddChannel(3U, false));
+
+  //Nothing is read or converted until the scan is started
+  uint16_t value;
+  TEST_ASSERT_FALSE(adcScanRead(2U, value));
+  adcScanTick();
+  TEST_ASSERT_EQUAL_UINT8(ADC_SCAN_NO_CHANNEL, fakeConvertingPin);
+
+  //The first pass converts every channel, and nothing can be read until it is done
+  adcScanStart();
+  adcScanTick();
+  TEST_ASSERT_EQUAL_UINT8(1U, fakeConvertingPin);
+  TEST_ASSERT_TRUE(completeConversion());
+  TEST_ASSERT_TRUE(completeConversion());
+  TEST_ASSERT_FALSE(adcScanRead(3U, value));
+  TEST_ASSERT_TRUE(completeConversion());
+  TEST_ASSERT_FALSE(completeConversion());
+  TEST_ASSERT_EQUAL_UINT8(1U, fakeConversions[1]);
+  TEST_ASSERT_EQUAL_UINT8(1U, fakeConversions[2]);
+  TEST_ASSERT_EQUAL_UINT8(1U, fakeConversions[3]);
+  TEST_ASSERT_TRUE(adcScanRead(3U, value));
+  TEST_ASSERT_EQUAL_UINT16(30U, value);
+
+  //Pins that are not in the scan
+  TEST_ASSERT_FALSE(adcScanRead(4U, value));
+}
+
+static void test_adcScan_fast_and_slow(void)
+{
+  resetFake();
+  adcScanAddChannel(10U, true);
+  adcScanAddChannel(11U, false);
+  adcScanAddChannel(12U, false);
+  adcScanAddChannel(13U, false);
+  adcScanStart();
+  tickAndComplete();
+
+  for(uint8_t tick = 0U; tick < 6U; tick++) { tickAndComplete(); }
+
+  //The fast channel is converted every tick, the slow ones take turns
+  TEST_ASSERT_EQUAL_UINT8(7U, fakeConversions[10]);
+  TEST_ASSERT_EQUAL_UINT8(3U, fakeConversions[11]);
+  TEST_ASSERT_EQUAL_UINT8(3U, fakeConversions[12]);
+  TEST_ASSERT_EQUAL_UINT8(3U, fakeConversions[13]);
+
+  //Slow channels keep their last result on the ticks they are not converted
+  fakeValue[10] = 500U;
+  fakeValue[11] = 600U;
+  fakeValue[12] = 700U;
+  tickAndComplete(); //Converts 11
+  uint16_t value;
+  adcScanRead(10U, value);
+  TEST_ASSERT_EQUAL_UINT16(500U, value);
+  adcScanRead(11U, value);
+  TEST_ASSERT_EQUAL_UINT16(600U, value);
+  adcScanRead(12U, value);
+  TEST_ASSERT_EQUAL_UINT16(120U, value);
+}
+
+static void test_adcScan_pass_overrun(void)
+{
+  resetFake();
+  adcScanAddChannel(20U, true);
+  adcScanAddChannel(21U, true);
+  adcScanAddChannel(22U, false);
+  adcScanStart();
+  tickAndComplete();
+  uint8_t published = adcScanPublishCount();
+
+  //Part way through a pass, none of its results are published
+  fakeValue[20] = 900U;
+  adcScanTick();
+  TEST_ASSERT_TRUE(completeConversion()); //20
+  TEST_ASSERT_EQUAL_UINT8(21U, fakeConvertingPin);
+  TEST_ASSERT_EQUAL_UINT8(published, adcScanPublishCount());
+  uint16_t value;
+  adcScanRead(20U, value);
+  TEST_ASSERT_EQUAL_UINT16(200U, value);
+
+  //A tick while the pass is still converting is skipped
+  adcScanTick();
+  TEST_ASSERT_EQUAL_UINT8(21U, fakeConvertingPin);
+
+  //The pass then finishes as normal
+  completeAllConversions();
+  TEST_ASSERT_EQUAL_UINT8(published + 1U, adcScanPublishCount());
+  TEST_ASSERT_EQUAL_UINT8(2U, fakeConversions[20]);
+  TEST_ASSERT_EQUAL_UINT8(2U, fakeConversions[22]);
+  adcScanRead(20U, value);
+  TEST_ASSERT_EQUAL_UINT16(900U, value);
+}
+
+static void test_adcScan_reset_during_conversion(void)
+{
+  resetFake();
+  adcScanAddChannel(40U, true);
+  adcScanStart();
+  adcScanTick();
+
+  //The conversion completes after the scan has been reset. Its result is dropped
+  adcScanReset();
+  uint8_t published = adcScanPublishCount();
+  TEST_ASSERT_TRUE(completeConversion());
+  TEST_ASSERT_EQUAL_UINT8(published, adcScanPublishCount());
+  uint16_t value;
+  TEST_ASSERT_FALSE(adcScanRead(40U, value));
+}
+
+static void test_adcScan_snapshot(void)
+{
+  resetFake();
+  adcScanAddChannel(30U, false);
+  adcScanAddChannel(31U, true);
+  adcScanAddChannel(30U, true); //Re-adding a pin can make it fast, but does not add it twice
+  TEST_ASSERT_EQUAL_UINT8(2U, adcScanChannelCount());
+  adcScanStart();
+  tickAndComplete();
+
+  fakeValue[30] = 1U;
+  fakeValue[31] = 2U;
+  tickAndComplete();
+
+  uint16_t values[ADC_SCAN_MAX_CHANNELS];
+  TEST_ASSERT_EQUAL_UINT8(2U, adcScanSnapshot(values));
+  TEST_ASSERT_EQUAL_UINT16(1U, values[0]);
+  TEST_ASSERT_EQUAL_UINT16(2U, values[1]);
+}
+
+static void test_adcScan_capacity(void)
+{
+  resetFake();
+  for(uint8_t pin = 0U; pin < ADC_SCAN_MAX_CHANNELS; pin++) { TEST_ASSERT_TRUE(adcScanAddChannel(pin, false)); }
+  TEST_ASSERT_FALSE(adcScanAddChannel(ADC_SCAN_MAX_CHANNELS, false));
+  TEST_ASSERT_TRUE(adcScanAddChannel(0U, false)); //Already in the scan
+}
+
+void testADCScan(void)
+{
+  RUN_TEST(test_adcScan_start);
+  RUN_TEST(test_adcScan_fast_and_slow);
+  RUN_TEST(test_adcScan_pass_overrun);
+  RUN_TEST(test_adcScan_reset_during_conversion);
+  RUN_TEST(test_adcScan_snapshot);
+  RUN_TEST(test_adcScan_capacity);
+}
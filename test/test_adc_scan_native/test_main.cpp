@@ -0,0 +1,11 @@
+#include <unity.h>
+
+extern void testADCScan(void);
+
+int main(void) {
+  UNITY_BEGIN();
+
+  testADCScan();
+
+  return UNITY_END();
+}
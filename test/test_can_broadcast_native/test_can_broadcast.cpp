@@ -0,0 +1,138 @@
+/*
+Checks the CAN broadcast queue keeps each frame to its own period, and the packing of user defined signals
+*/
+#include <unity.h>
+#include "can_broadcast.h"
+#include "can_broadcast.cpp"
+
+/** Run the queue from start to end (mS) in 1mS steps, counting how many times each frame is sent */
+static void runQueue(uint32_t start, uint32_t end, uint16_t *pCounts, uint8_t frameCount)
+{
+  for(uint32_t now = start; now != end; now++)
+  {
+    uint8_t frame = canTxNextDueFrame(now);
+    while(frame != CAN_TX_FRAME_NONE)
+    {
+      if(frame < frameCount) { pCounts[frame]++; }
+      frame = canTxNextDueFrame(now);
+    }
+  }
+}
+
+static void test_canTx_periods(void)
+{
+  canTxReset();
+  TEST_ASSERT_TRUE(canTxAddFrame(0U, 10U, 0U));
+  TEST_ASSERT_TRUE(canTxAddFrame(1U, 20U, 0U));
+  TEST_ASSERT_TRUE(canTxAddFrame(2U, 50U, 0U));
+  TEST_ASSERT_TRUE(canTxAddFrame(3U, 100U, 0U));
+  TEST_ASSERT_EQUAL_UINT8(4U, canTxFrameCount());
+
+  uint16_t counts[4] = { 0U, 0U, 0U, 0U };
+  runQueue(0U, 1000U, counts, 4U);
+  TEST_ASSERT_EQUAL_UINT16(100U, counts[0]);
+  TEST_ASSERT_EQUAL_UINT16(50U, counts[1]);
+  TEST_ASSERT_EQUAL_UINT16(20U, counts[2]);
+  TEST_ASSERT_EQUAL_UINT16(10U, counts[3]);
+}
+
+static void test_canTx_deadline_order(void)
+{
+  canTxReset();
+  canTxAddFrame(7U, 30U, 0U);   //Due at 0
+  canTxAddFrame(8U, 10U, 0U);   //Staggered to 1
+  canTxAddFrame(9U, 100U, 0U);  //Staggered to 2
+
+  TEST_ASSERT_EQUAL_UINT8(7U, canTxNextDueFrame(0U));
+  TEST_ASSERT_EQUAL_UINT8(CAN_TX_FRAME_NONE, canTxNextDueFrame(0U));
+  TEST_ASSERT_EQUAL_UINT8(8U, canTxNextDueFrame(2U));
+  TEST_ASSERT_EQUAL_UINT8(9U, canTxNextDueFrame(2U));
+  TEST_ASSERT_EQUAL_UINT8(CAN_TX_FRAME_NONE, canTxNextDueFrame(2U));
+  TEST_ASSERT_EQUAL_UINT8(8U, canTxNextDueFrame(11U));
+}
+
+static void test_canTx_late_frames_are_not_repeated(void)
+{
+  canTxReset();
+  canTxAddFrame(0U, 10U, 0U);
+  TEST_ASSERT_EQUAL_UINT8(0U, canTxNextDueFrame(0U));
+
+  //The loop was held up for 5 periods. The frame goes out once and then 1 period later
+  TEST_ASSERT_EQUAL_UINT8(0U, canTxNextDueFrame(55U));
+  TEST_ASSERT_EQUAL_UINT8(CAN_TX_FRAME_NONE, canTxNextDueFrame(55U));
+  TEST_ASSERT_EQUAL_UINT8(CAN_TX_FRAME_NONE, canTxNextDueFrame(64U));
+  TEST_ASSERT_EQUAL_UINT8(0U, canTxNextDueFrame(65U));
+}
+
+static void test_canTx_millis_wrap(void)
+{
+  canTxReset();
+  uint32_t start = UINT32_MAX - 500U;
+  canTxAddFrame(0U, 10U, start);
+  canTxAddFrame(1U, 33U, start);
+
+  uint16_t counts[2] = { 0U, 0U };
+  runQueue(start, start + 1000U, counts, 2U);
+  TEST_ASSERT_EQUAL_UINT16(100U, counts[0]);
+  TEST_ASSERT_EQUAL_UINT16(31U, counts[1]);
+}
+
+static void test_canTx_limits(void)
+{
+  canTxReset();
+  TEST_ASSERT_FALSE(canTxAddFrame(0U, 0U, 0U));
+  for(uint8_t frame = 0U; frame < CAN_TX_MAX_FRAMES; frame++) { TEST_ASSERT_TRUE(canTxAddFrame(frame, 10U, 0U)); }
+  TEST_ASSERT_FALSE(canTxAddFrame(CAN_TX_MAX_FRAMES, 10U, 0U));
+}
+
+static void test_packCANSignal(void)
+{
+  uint8_t data[8] = { 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U };
+
+  TEST_ASSERT_TRUE(packCANSignal(data, CAN_TX_SIGNAL_U16, 0U, false, 0x1234));
+  TEST_ASSERT_EQUAL_UINT8(0x34U, data[0]);
+  TEST_ASSERT_EQUAL_UINT8(0x12U, data[1]);
+
+  TEST_ASSERT_TRUE(packCANSignal(data, CAN_TX_SIGNAL_U16, 2U, true, 0x1234));
+  TEST_ASSERT_EQUAL_UINT8(0x12U, data[2]);
+  TEST_ASSERT_EQUAL_UINT8(0x34U, data[3]);
+
+  TEST_ASSERT_TRUE(packCANSignal(data, CAN_TX_SIGNAL_S16, 4U, false, -2));
+  TEST_ASSERT_EQUAL_UINT8(0xFEU, data[4]);
+  TEST_ASSERT_EQUAL_UINT8(0xFFU, data[5]);
+
+  //Values are limited to the range of the type
+  TEST_ASSERT_TRUE(packCANSignal(data, CAN_TX_SIGNAL_U08, 6U, false, 300));
+  TEST_ASSERT_EQUAL_UINT8(0xFFU, data[6]);
+  TEST_ASSERT_TRUE(packCANSignal(data, CAN_TX_SIGNAL_S08, 7U, false, -300));
+  TEST_ASSERT_EQUAL_UINT8(0x80U, data[7]);
+  TEST_ASSERT_TRUE(packCANSignal(data, CAN_TX_SIGNAL_U16, 0U, false, -5));
+  TEST_ASSERT_EQUAL_UINT8(0x00U, data[0]);
+  TEST_ASSERT_EQUAL_UINT8(0x00U, data[1]);
+
+  //Signals that are off or do not fit are not written
+  TEST_ASSERT_FALSE(packCANSignal(data, CAN_TX_SIGNAL_U16, 7U, false, 0));
+  TEST_ASSERT_FALSE(packCANSignal(data, CAN_TX_SIGNAL_OFF, 0U, false, 0));
+  TEST_ASSERT_FALSE(packCANSignal(data, 9U, 0U, false, 0));
+  TEST_ASSERT_EQUAL_UINT8(0x80U, data[7]);
+}
+
+static void test_scaleCANSignal(void)
+{
+  TEST_ASSERT_EQUAL_INT32(64, scaleCANSignal(10, 64, 10, 0));   //BMW RPM scaling
+  TEST_ASSERT_EQUAL_INT32(-40, scaleCANSignal(0, 1, 1, -40));   //Temperature offset
+  TEST_ASSERT_EQUAL_INT32(25, scaleCANSignal(50, 1, 2, 0));
+  TEST_ASSERT_EQUAL_INT32(50, scaleCANSignal(50, 1, 0, 0));     //A divide of 0 is ignored
+  TEST_ASSERT_EQUAL_INT32(-650, scaleCANSignal(-65, 10, 1, 0));
+}
+
+void testCANBroadcast(void)
+{
+  RUN_TEST(test_canTx_periods);
+  RUN_TEST(test_canTx_deadline_order);
+  RUN_TEST(test_canTx_late_frames_are_not_repeated);
+  RUN_TEST(test_canTx_millis_wrap);
+  RUN_TEST(test_canTx_limits);
+  RUN_TEST(test_packCANSignal);
+  RUN_TEST(test_scaleCANSignal);
+}
@@ -0,0 +1,11 @@
+#include <unity.h>
+
+extern void testCANBroadcast(void);
+
+int main(void) {
+  UNITY_BEGIN();
+
+  testCANBroadcast();
+
+  return UNITY_END();
+}
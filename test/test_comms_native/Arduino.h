@@ -0,0 +1,164 @@
+/** @file
+ * A minimal host stand in for the Arduino core, just enough to build the serial comms stack natively.
+ * The board is the Mega 2560 (See bench_board.h), with the registers as plain variables (See avr/io.h).
+ */
+#ifndef BENCH_ARDUINO_H
+#define BENCH_ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <avr/pgmspace.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef unsigned int word;
+static inline uint16_t makeWord(uint16_t w) { return w; }
+static inline uint16_t makeWord(uint8_t h, uint8_t l) { return (uint16_t)((h << 8U) | l); }
+#define word(...) makeWord(__VA_ARGS__)
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+#define DEC 10
+#define HEX 16
+#define BIN 2
+#define LED_BUILTIN 13
+#define NOT_A_PIN 0
+#define NOT_AN_INTERRUPT -1
+#define A0 54
+#define A1 55
+#define A2 56
+#define A3 57
+#define A4 58
+#define A5 59
+#define A6 60
+#define A7 61
+#define A8 62
+#define A9 63
+#define A10 64
+#define A11 65
+#define A12 66
+#define A13 67
+#define A14 68
+#define A15 69
+
+#define F(x) (x)
+#define lowByte(w) ((uint8_t)((w) & 0xFFU))
+#define highByte(w) ((uint8_t)((w) >> 8U))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01U)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+#ifndef min
+  #define min(a,b) ((a)<(b)?(a):(b))
+  #define max(a,b) ((a)>(b)?(a):(b))
+#endif
+#define noInterrupts() cli()
+#define interrupts() sei()
+#define digitalPinToPort(p) (p)
+#define digitalPinToBitMask(p) (1U << ((p) & 7U))
+#define portInputRegister(p) (&PINA)
+#define portOutputRegister(p) (&PORTA)
+#define digitalPinToInterrupt(p) (p)
+
+//Time comes from the host clock (See bench_serial.cpp)
+unsigned long micros(void);
+unsigned long millis(void);
+void delay(unsigned long ms);
+static inline void delayMicroseconds(unsigned int) { }
+
+//No real IO on the host
+static inline void pinMode(uint8_t, uint8_t) { }
+static inline void digitalWrite(uint8_t, uint8_t) { }
+static inline int digitalRead(uint8_t) { return LOW; }
+static inline int analogRead(uint8_t) { return 0; }
+static inline void analogWrite(uint8_t, int) { }
+static inline void attachInterrupt(uint8_t, void (*)(void), int) { }
+static inline void detachInterrupt(uint8_t) { }
+static inline long map(long x, long inMin, long inMax, long outMin, long outMax) { return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin; }
+
+class Print {
+public:
+  virtual ~Print() { }
+  virtual size_t write(uint8_t value) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size)
+  {
+    size_t written = 0U;
+    while( (written < size) && (write(buffer[written]) == 1U) ) { written++; }
+    return written;
+  }
+  virtual int availableForWrite(void) { return 0; }
+  size_t write(const char *str) { return write((const uint8_t*)str, strlen(str)); }
+
+  //The legacy (Human readable) commands print numbers as text
+  size_t print(const char *str) { return write(str); }
+  size_t print(char value) { return write((uint8_t)value); }
+  size_t print(long value, int base = DEC) { return printNumber(value, base); }
+  size_t print(unsigned long value, int base = DEC) { return printNumber((long)value, base); }
+  size_t print(int value, int base = DEC) { return printNumber(value, base); }
+  size_t print(unsigned int value, int base = DEC) { return printNumber((long)value, base); }
+  size_t print(unsigned char value, int base = DEC) { return printNumber(value, base); }
+  size_t print(double value, int digits = 2) { char text[32]; (void)snprintf(text, sizeof(text), "%.*f", digits, value); return write(text); }
+  size_t println(void) { return write("\r\n"); }
+  template <typename T> size_t println(T value) { size_t length = print(value); return length + println(); }
+  template <typename T> size_t println(T value, int format) { size_t length = print(value, format); return length + println(); }
+
+private:
+  size_t printNumber(long value, int base)
+  {
+    char text[34];
+    (void)snprintf(text, sizeof(text), (base == HEX) ? "%lX" : "%ld", value);
+    return write(text);
+  }
+};
+
+class Stream : public Print {
+public:
+  virtual int available(void) = 0;
+  virtual int read(void) = 0;
+  virtual int peek(void) = 0;
+  virtual void flush(void) { }
+  size_t readBytes(uint8_t *buffer, size_t length)
+  {
+    size_t count = 0U;
+    while( (count < length) && (available() > 0) ) { buffer[count] = (uint8_t)read(); count++; }
+    return count;
+  }
+  size_t readBytes(char *buffer, size_t length) { return readBytes((uint8_t*)buffer, length); }
+  void setTimeout(unsigned long) { }
+};
+
+/** The serial port. On the host it is one end of a pseudo terminal (See bench_serial.cpp) */
+class HardwareSerial : public Stream {
+public:
+  HardwareSerial(void) : fd(-1), peeked(-1) { }
+  void begin(unsigned long) { }
+  void end(void) { }
+  operator bool() { return true; }
+
+  int available(void) override;
+  int read(void) override;
+  int peek(void) override;
+  int availableForWrite(void) override;
+  size_t write(uint8_t value) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+
+  int fd;
+private:
+  int peeked;
+};
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,24 @@
+//The EEPROM is kept in RAM, it starts erased on every run
+#ifndef BENCH_EEPROM_H
+#define BENCH_EEPROM_H
+#include <stdint.h>
+#include <string.h>
+#include <avr/eeprom.h>
+
+class EEPROMClass {
+public:
+  EEPROMClass(void) { memset(data, 0xFF, sizeof(data)); }
+  uint8_t read(int address) { reads++; return data[address]; }
+  void write(int address, uint8_t value) { writes++; data[address] = value; }
+  void update(int address, uint8_t value) { data[address] = value; }
+  uint16_t length(void) { return sizeof(data); }
+  template <typename T> T &get(int address, T &value) { memcpy(&value, &data[address], sizeof(T)); return value; }
+  template <typename T> const T &put(int address, const T &value) { memcpy(&data[address], &value, sizeof(T)); return value; }
+
+  uint8_t data[E2END + 1];
+  uint32_t reads = 0;  //Byte accesses, so a test can tell how much of the EEPROM a burn touched
+  uint32_t writes = 0;
+};
+extern EEPROMClass EEPROM;
+
+#endif
@@ -0,0 +1,8 @@
+//The avr-libc block read, from the RAM EEPROM (See EEPROM.h)
+#ifndef BENCH_AVR_EEPROM_H
+#define BENCH_AVR_EEPROM_H
+#include <stddef.h>
+
+void eeprom_read_block(void *pDestination, const void *source, size_t size);
+
+#endif
@@ -0,0 +1,10 @@
+//The bench is single threaded: there are no interrupts to mask
+#ifndef BENCH_INTERRUPT_H
+#define BENCH_INTERRUPT_H
+
+static inline void cli(void) { }
+static inline void sei(void) { }
+#define ISR(vector, ...) extern "C" void vector(void); void vector(void)
+#define ISR_NOBLOCK
+
+#endif
@@ -0,0 +1,242 @@
+/** @file
+ * The ATmega2560 registers that the board code touches, as plain variables. Nothing reads them back on the host.
+*/
+#ifndef BENCH_IO_H
+#define BENCH_IO_H
+#include <stdint.h>
+
+#define BENCH_REGISTERS(X) \
+  X(uint8_t, TCCR0A) \
+  X(uint8_t, TCCR0B) \
+  X(uint8_t, TCCR1A) \
+  X(uint8_t, TCCR1B) \
+  X(uint8_t, TCCR1C) \
+  X(uint8_t, TCCR2A) \
+  X(uint8_t, TCCR2B) \
+  X(uint8_t, TCCR3A) \
+  X(uint8_t, TCCR3B) \
+  X(uint8_t, TCCR3C) \
+  X(uint8_t, TCCR4A) \
+  X(uint8_t, TCCR4B) \
+  X(uint8_t, TCCR4C) \
+  X(uint8_t, TCCR5A) \
+  X(uint8_t, TCCR5B) \
+  X(uint8_t, TCCR5C) \
+  X(uint8_t, TIMSK0) \
+  X(uint8_t, TIMSK1) \
+  X(uint8_t, TIMSK2) \
+  X(uint8_t, TIMSK3) \
+  X(uint8_t, TIMSK4) \
+  X(uint8_t, TIMSK5) \
+  X(uint8_t, TIFR0) \
+  X(uint8_t, TIFR1) \
+  X(uint8_t, TIFR2) \
+  X(uint8_t, TIFR3) \
+  X(uint8_t, TIFR4) \
+  X(uint8_t, TIFR5) \
+  X(uint8_t, TCNT0) \
+  X(uint8_t, TCNT2) \
+  X(uint8_t, OCR0A) \
+  X(uint8_t, OCR0B) \
+  X(uint8_t, OCR2A) \
+  X(uint8_t, OCR2B) \
+  X(uint8_t, ASSR) \
+  X(uint8_t, ADCSRA) \
+  X(uint8_t, ADCSRB) \
+  X(uint8_t, ADMUX) \
+  X(uint8_t, DIDR0) \
+  X(uint8_t, DIDR2) \
+  X(uint8_t, PINA) \
+  X(uint8_t, PINB) \
+  X(uint8_t, PINC) \
+  X(uint8_t, PIND) \
+  X(uint8_t, PINE) \
+  X(uint8_t, PINF) \
+  X(uint8_t, PING) \
+  X(uint8_t, PINH) \
+  X(uint8_t, PINJ) \
+  X(uint8_t, PINK) \
+  X(uint8_t, PINL) \
+  X(uint8_t, PORTA) \
+  X(uint8_t, PORTB) \
+  X(uint8_t, PORTC) \
+  X(uint8_t, PORTD) \
+  X(uint8_t, PORTE) \
+  X(uint8_t, PORTF) \
+  X(uint8_t, PORTG) \
+  X(uint8_t, PORTH) \
+  X(uint8_t, PORTJ) \
+  X(uint8_t, PORTK) \
+  X(uint8_t, PORTL) \
+  X(uint8_t, DDRA) \
+  X(uint8_t, DDRB) \
+  X(uint8_t, SREG) \
+  X(uint8_t, MCUSR) \
+  X(uint8_t, EIMSK) \
+  X(uint8_t, EICRA) \
+  X(uint8_t, EICRB) \
+  X(uint8_t, EIFR) \
+  X(uint8_t, UCSR0A) \
+  X(uint8_t, UCSR0B) \
+  X(uint8_t, ADCL) \
+  X(uint8_t, ADCH) \
+  X(uint8_t, GTCCR) \
+  X(uint8_t, PRR0) \
+  X(uint8_t, PRR1) \
+  X(uint8_t, SPCR) \
+  X(uint8_t, SPSR) \
+  X(uint8_t, SPDR) \
+  X(uint16_t, TCNT1) \
+  X(uint16_t, TCNT3) \
+  X(uint16_t, TCNT4) \
+  X(uint16_t, TCNT5) \
+  X(uint16_t, OCR1A) \
+  X(uint16_t, OCR1B) \
+  X(uint16_t, OCR1C) \
+  X(uint16_t, OCR3A) \
+  X(uint16_t, OCR3B) \
+  X(uint16_t, OCR3C) \
+  X(uint16_t, OCR4A) \
+  X(uint16_t, OCR4B) \
+  X(uint16_t, OCR4C) \
+  X(uint16_t, OCR5A) \
+  X(uint16_t, OCR5B) \
+  X(uint16_t, OCR5C) \
+  X(uint16_t, ICR1) \
+  X(uint16_t, ICR3) \
+  X(uint16_t, ICR4) \
+  X(uint16_t, ICR5) \
+  X(uint16_t, ADC)
+
+#define BENCH_DECLARE_REGISTER(type, name) extern volatile type name;
+BENCH_REGISTERS(BENCH_DECLARE_REGISTER)
+
+#define CS00 0
+#define CS01 1
+#define CS02 2
+#define CS10 3
+#define CS11 4
+#define CS12 5
+#define CS20 6
+#define CS21 7
+#define CS22 0
+#define CS30 1
+#define CS31 2
+#define CS32 3
+#define CS40 4
+#define CS41 5
+#define CS42 6
+#define CS50 7
+#define CS51 0
+#define CS52 1
+#define WGM00 2
+#define WGM01 3
+#define WGM02 4
+#define WGM10 5
+#define WGM11 6
+#define WGM12 7
+#define WGM13 0
+#define WGM20 1
+#define WGM21 2
+#define WGM22 3
+#define WGM30 4
+#define WGM31 5
+#define WGM32 6
+#define WGM33 7
+#define WGM40 0
+#define WGM41 1
+#define WGM42 2
+#define WGM43 3
+#define WGM50 4
+#define WGM51 5
+#define WGM52 6
+#define WGM53 7
+#define TOIE0 0
+#define TOIE1 1
+#define TOIE2 2
+#define TOIE3 3
+#define TOIE4 4
+#define TOIE5 5
+#define OCIE0A 6
+#define OCIE0B 7
+#define OCIE1A 0
+#define OCIE1B 1
+#define OCIE1C 2
+#define OCIE2A 3
+#define OCIE2B 4
+#define OCIE3A 5
+#define OCIE3B 6
+#define OCIE3C 7
+#define OCIE4A 0
+#define OCIE4B 1
+#define OCIE4C 2
+#define OCIE5A 3
+#define OCIE5B 4
+#define OCIE5C 5
+#define TOV0 6
+#define TOV1 7
+#define TOV2 0
+#define TOV3 1
+#define TOV4 2
+#define TOV5 3
+#define OCF0A 4
+#define OCF0B 5
+#define OCF1A 6
+#define OCF1B 7
+#define OCF1C 0
+#define OCF2A 1
+#define OCF2B 2
+#define OCF3A 3
+#define OCF3B 4
+#define OCF3C 5
+#define OCF4A 6
+#define OCF4B 7
+#define OCF4C 0
+#define OCF5A 1
+#define OCF5B 2
+#define OCF5C 3
+#define ADEN 4
+#define ADSC 5
+#define ADATE 6
+#define ADIF 7
+#define ADIE 0
+#define ADPS0 1
+#define ADPS1 2
+#define ADPS2 3
+#define REFS0 4
+#define REFS1 5
+#define ADLAR 6
+#define MUX0 7
+#define MUX1 0
+#define MUX2 1
+#define MUX3 2
+#define MUX4 3
+#define MUX5 4
+#define ADTS0 5
+#define ADTS1 6
+#define ADTS2 7
+#define AS2 0
+#define ICES1 1
+#define ICES3 2
+#define ICES4 3
+#define ICES5 4
+#define ICIE1 5
+#define ICIE3 6
+#define ICIE4 7
+#define ICIE5 0
+#define ICF1 1
+#define ICF3 2
+#define ICF4 3
+#define ICF5 4
+#define ICNC1 5
+#define ICNC3 6
+#define ICNC4 7
+#define ICNC5 0
+#define COM1A0 1
+#define COM1A1 2
+#define WDRF 3
+#define _BV(b) (1<<(b))
+#define RAMEND 0x21FF
+#define E2END 4095
+
+#endif
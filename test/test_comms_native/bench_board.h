@@ -0,0 +1,24 @@
+/** @file
+ * Every translation unit of the bench includes this first. The firmware is built as the Mega 2560, on the host stand ins
+ * for the Arduino core (Arduino.h, avr/)
+ */
+#ifndef BENCH_BOARD_H
+#define BENCH_BOARD_H
+
+#define __AVR_ATmega2560__
+#define __AVR__
+#define USE_OPTIMIZED_SHIFTS 0 //The optimised shifts and division are AVR assembler
+#define USE_OPTIMIZED_DIVISION 0
+#define TOOTH_LOG_SIZE 127U //As the board, rather than the 1 entry of other unit tests, so 'T' sends (and times) the whole log
+
+#include <Arduino.h>
+//Only the system headers globals.h pulls in are included ahead of the pack, nothing outside the firmware is packed
+#include <assert.h>
+#include <inttypes.h>
+
+//The config pages are the raw bytes of the config structs. AVR has no alignment padding, so neither can the host
+#pragma pack(push, 1)
+#include "globals.h"
+#pragma pack(pop)
+
+#endif
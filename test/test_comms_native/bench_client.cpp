@@ -0,0 +1,125 @@
+/*
+The scripted client. The framing is the same as TunerStudio's: a big endian 16 bit length, the payload, then the big
+endian CRC32 of the payload.
+*/
+#include "bench_board.h"
+#include "globals.h"
+#include "comms.h"
+#include "comms_legacy.h"
+#include "bench_serial.h"
+#include "bench_client.h"
+
+static FastCRC32 clientCrc;
+static benchTraffic traffic;
+
+bool startBenchClient(void)
+{
+  pPrimarySerial = &Serial;
+  return openBenchSerial();
+}
+
+void pumpFirmwareSerial(void)
+{
+  drainBenchSerial();
+  if (serialTransmitInProgress() || ( (serialStatusFlag == SERIAL_INACTIVE) && isLiveDataStreamActive() ))
+  {
+    serialTransmit();
+  }
+  if (Serial.available()>0 || serialRecieveInProgress())
+  {
+    serialReceive();
+  }
+}
+
+static void writeAll(const uint8_t *pBuffer, uint16_t length)
+{
+  while(length > 0U)
+  {
+    int32_t count = writeBenchClient(pBuffer, length);
+    if(count > 0)
+    {
+      pBuffer = pBuffer + count;
+      length = length - (uint16_t)count;
+      traffic.bytesSent = traffic.bytesSent + (uint32_t)count;
+    }
+    else { pumpFirmwareSerial(); } //The terminal is full, let the firmware read some
+  }
+}
+
+static void sendFrame(const uint8_t *pPayload, uint16_t length, uint32_t crc)
+{
+  uint8_t header[2] = { (uint8_t)(length >> 8U), (uint8_t)length };
+  uint8_t trailer[4] = { (uint8_t)(crc >> 24U), (uint8_t)(crc >> 16U), (uint8_t)(crc >> 8U), (uint8_t)crc };
+  writeAll(header, sizeof(header));
+  writeAll(pPayload, length);
+  writeAll(trailer, sizeof(trailer));
+}
+
+void sendRequest(const uint8_t *pPayload, uint16_t length)
+{
+  sendFrame(pPayload, length, clientCrc.crc32(pPayload, length));
+}
+
+void sendCorruptRequest(const uint8_t *pPayload, uint16_t length)
+{
+  sendFrame(pPayload, length, ~clientCrc.crc32(pPayload, length));
+}
+
+/** Read exactly length bytes, pumping the firmware while waiting */
+static bool readExactly(uint8_t *pBuffer, uint16_t length, uint32_t deadline)
+{
+  while(length > 0U)
+  {
+    int32_t count = readBenchClient(pBuffer, length);
+    if(count > 0)
+    {
+      pBuffer = pBuffer + count;
+      length = length - (uint16_t)count;
+      traffic.bytesReceived = traffic.bytesReceived + (uint32_t)count;
+    }
+    else
+    {
+      if((int32_t)(millis() - deadline) > 0) { return false; }
+      pumpFirmwareSerial();
+    }
+  }
+  return true;
+}
+
+int32_t receiveResponse(uint8_t *pPayload, uint16_t bufferSize, uint32_t timeoutMs)
+{
+  uint32_t deadline = millis() + timeoutMs;
+  uint8_t header[2];
+  uint8_t trailer[4];
+
+  if(!readExactly(header, sizeof(header), deadline)) { return -1; }
+  uint16_t length = (uint16_t)((header[0] << 8U) | header[1]);
+  if(length > bufferSize) { return -1; }
+  if(!readExactly(pPayload, length, deadline) || !readExactly(trailer, sizeof(trailer), deadline)) { return -1; }
+
+  uint32_t crc = ((uint32_t)trailer[0] << 24U) | ((uint32_t)trailer[1] << 16U) | ((uint32_t)trailer[2] << 8U) | trailer[3];
+  return (crc == clientCrc.crc32(pPayload, length)) ? (int32_t)length : -1;
+}
+
+int32_t exchange(const uint8_t *pRequest, uint16_t requestLength, uint8_t *pResponse, uint16_t responseSize)
+{
+  uint32_t start = micros();
+  sendRequest(pRequest, requestLength);
+  int32_t length = receiveResponse(pResponse, responseSize, 1000U);
+  uint32_t latency = micros() - start;
+
+  traffic.requests++;
+  traffic.totalLatency = traffic.totalLatency + latency;
+  if(latency > traffic.maxLatency) { traffic.maxLatency = latency; }
+  return length;
+}
+
+void resetTraffic(void)
+{
+  memset(&traffic, 0, sizeof(traffic));
+}
+
+const benchTraffic &getTraffic(void)
+{
+  return traffic;
+}
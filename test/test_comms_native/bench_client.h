@@ -0,0 +1,40 @@
+/** @file
+ * A scripted tuning software client. It talks to the firmware over the pseudo terminal, pumping the firmware
+ * serial loop while it waits, just as a board would run it between requests.
+ */
+#ifndef BENCH_CLIENT_H
+#define BENCH_CLIENT_H
+#include <stdint.h>
+
+/** @brief Traffic totals, for throughput */
+struct benchTraffic {
+  uint32_t requests;
+  uint32_t bytesSent;     //!< Including the framing
+  uint32_t bytesReceived; //!< Including the framing
+  uint32_t totalLatency;  //!< uS, from the start of the request to the end of the response
+  uint32_t maxLatency;    //!< uS
+};
+
+/** @brief Connect to the firmware. Returns false if the host has no pseudo terminals */
+bool startBenchClient(void);
+
+/** @brief One pass of the serial part of the firmware main loop (See loop() in speeduino.ino) */
+void pumpFirmwareSerial(void);
+
+/** @brief Send a framed request: length, payload, CRC32 */
+void sendRequest(const uint8_t *pPayload, uint16_t length);
+
+/** @brief Send a request with a deliberately broken CRC */
+void sendCorruptRequest(const uint8_t *pPayload, uint16_t length);
+
+/** @brief Receive one framed response, pumping the firmware until it has arrived
+ * @return The payload length, or -1 on a timeout or a CRC mismatch */
+int32_t receiveResponse(uint8_t *pPayload, uint16_t bufferSize, uint32_t timeoutMs);
+
+/** @brief sendRequest() then receiveResponse(), adding the exchange to the traffic totals */
+int32_t exchange(const uint8_t *pRequest, uint16_t requestLength, uint8_t *pResponse, uint16_t responseSize);
+
+void resetTraffic(void);
+const benchTraffic &getTraffic(void);
+
+#endif
@@ -0,0 +1,144 @@
+/*
+The host side of the Arduino stand in (Arduino.h): the serial port is the slave end of a pseudo terminal, the
+clock is the host monotonic clock and the EEPROM is RAM.
+*/
+#include <chrono> //Before Arduino.h, which has min() and max() macros
+#include "bench_board.h"
+#include <EEPROM.h>
+#include "bench_serial.h"
+#if defined(BENCH_HAS_PTY)
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <termios.h>
+  #include <sys/ioctl.h>
+#endif
+
+#define BENCH_DEFINE_REGISTER(type, name) volatile type name;
+BENCH_REGISTERS(BENCH_DEFINE_REGISTER)
+
+HardwareSerial Serial;
+EEPROMClass EEPROM;
+
+static uint16_t txBudget = BENCH_SERIAL_TX_BUFFER;
+
+static uint64_t hostMicros(void)
+{
+  return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+unsigned long micros(void) { return (unsigned long)(uint32_t)hostMicros(); }
+unsigned long millis(void) { return (unsigned long)(uint32_t)(hostMicros() / 1000U); }
+void delay(unsigned long ms)
+{
+  uint64_t end = hostMicros() + (ms * 1000U);
+  while(hostMicros() < end) { }
+}
+
+void eeprom_read_block(void *pDestination, const void *source, size_t size)
+{
+  memcpy(pDestination, &EEPROM.data[(size_t)source], size);
+}
+
+void drainBenchSerial(void)
+{
+  txBudget = BENCH_SERIAL_TX_BUFFER;
+}
+
+int HardwareSerial::availableForWrite(void)
+{
+  int available = txBudget;
+  //A caller that keeps asking is waiting on the UART to drain (writeByteReliableBlocking()), so let it
+  if(txBudget == 0U) { txBudget = BENCH_SERIAL_TX_BUFFER; }
+  return available;
+}
+
+#if defined(BENCH_HAS_PTY)
+
+static int clientFd = -1;
+
+int HardwareSerial::available(void)
+{
+  int count = 0;
+  if(ioctl(fd, FIONREAD, &count) != 0) { count = 0; }
+  return count + ((peeked >= 0) ? 1 : 0);
+}
+
+int HardwareSerial::peek(void)
+{
+  if(peeked < 0) { peeked = read(); }
+  return peeked;
+}
+
+int HardwareSerial::read(void)
+{
+  if(peeked >= 0)
+  {
+    int value = peeked;
+    peeked = -1;
+    return value;
+  }
+  uint8_t value;
+  return (::read(fd, &value, 1U) == 1) ? value : -1;
+}
+
+size_t HardwareSerial::write(uint8_t value)
+{
+  return write(&value, 1U);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+  size_t written = 0U;
+  while(written < size)
+  {
+    ssize_t count = ::write(fd, buffer + written, size - written);
+    if(count <= 0) { break; }
+    written = written + (size_t)count;
+  }
+  txBudget = (written >= txBudget) ? 0U : (uint16_t)(txBudget - written);
+  return written;
+}
+
+static void makeRaw(int fd)
+{
+  struct termios settings;
+  (void)tcgetattr(fd, &settings);
+  cfmakeraw(&settings);
+  (void)tcsetattr(fd, TCSANOW, &settings);
+  (void)fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+bool openBenchSerial(void)
+{
+  clientFd = posix_openpt(O_RDWR | O_NOCTTY);
+  if( (clientFd < 0) || (grantpt(clientFd) != 0) || (unlockpt(clientFd) != 0) ) { return false; }
+
+  Serial.fd = open(ptsname(clientFd), O_RDWR | O_NOCTTY);
+  if(Serial.fd < 0) { return false; }
+  makeRaw(Serial.fd);
+  makeRaw(clientFd);
+  return true;
+}
+
+int32_t readBenchClient(uint8_t *pBuffer, uint16_t length)
+{
+  return (int32_t)::read(clientFd, pBuffer, length);
+}
+
+int32_t writeBenchClient(const uint8_t *pBuffer, uint16_t length)
+{
+  return (int32_t)::write(clientFd, pBuffer, length);
+}
+
+#else //No pseudo terminals: Serial is never connected
+
+int HardwareSerial::available(void) { return 0; }
+int HardwareSerial::peek(void) { return -1; }
+int HardwareSerial::read(void) { return -1; }
+size_t HardwareSerial::write(uint8_t) { return 0U; }
+size_t HardwareSerial::write(const uint8_t *, size_t) { return 0U; }
+bool openBenchSerial(void) { return false; }
+int32_t readBenchClient(uint8_t *, uint16_t) { return -1; }
+int32_t writeBenchClient(const uint8_t *, uint16_t) { return -1; }
+
+#endif
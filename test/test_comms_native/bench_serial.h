@@ -0,0 +1,30 @@
+/** @file
+ * The pseudo terminal behind Serial (See bench_serial.cpp)
+ */
+#ifndef BENCH_SERIAL_H
+#define BENCH_SERIAL_H
+
+#include <stdint.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+  #define BENCH_HAS_PTY
+#endif
+
+#define BENCH_SERIAL_TX_BUFFER 63U //!< The free space in the ATmega2560 serial transmit buffer when it is empty
+
+/** @brief Connect Serial to a new pseudo terminal
+ * @return false if the host has no pseudo terminals */
+bool openBenchSerial(void);
+
+/** @brief Read from the client end of the terminal, without blocking
+ * @return The number of bytes read, 0 or less if there were none */
+int32_t readBenchClient(uint8_t *pBuffer, uint16_t length);
+
+/** @brief Write to the client end of the terminal, without blocking
+ * @return The number of bytes written, 0 or less if the terminal is full */
+int32_t writeBenchClient(const uint8_t *pBuffer, uint16_t length);
+
+/** @brief Empty the modelled transmit buffer, as the UART would between loops */
+void drainBenchSerial(void);
+
+#endif
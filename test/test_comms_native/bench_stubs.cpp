@@ -0,0 +1,24 @@
+/*
+The parts of the firmware that the serial comms reference, but are not part of the bench
+*/
+#include "bench_board.h"
+#include "globals.h"
+#include "decoders.h"
+#include "comms_secondary.h"
+#include "TS_CommandButtonHandler.h"
+
+volatile uint8_t decoderState = 0U;
+void (*triggerHandler)(void) = nullptr;
+void (*triggerSecondaryHandler)(void) = nullptr;
+void (*triggerTertiaryHandler)(void) = nullptr;
+void loggerPrimaryISR(void) { }
+void loggerSecondaryISR(void) { }
+void loggerTertiaryISR(void) { }
+void cycleLogPrimaryISR(void) { }
+volatile unsigned long toothLastToothTime = 0UL;
+
+HardwareSerial *pSecondarySerial = &Serial;
+
+uint16_t freeRam(void) { return 0U; }
+
+bool TS_CommandButtonsHandler(uint16_t) { return true; }
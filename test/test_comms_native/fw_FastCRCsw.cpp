@@ -0,0 +1,2 @@
+#include "bench_board.h"
+#include "src/FastCRC/FastCRCsw.cpp"
@@ -0,0 +1,2 @@
+#include "bench_board.h"
+#include "comms_legacy.cpp"
@@ -0,0 +1,2 @@
+#include "bench_board.h"
+#include "table3d_axis_io.cpp"
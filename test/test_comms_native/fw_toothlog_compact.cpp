@@ -0,0 +1,2 @@
+#include "bench_board.h"
+#include "toothlog_compact.cpp"
@@ -0,0 +1,357 @@
+/*
+Runs the serial comms stack (comms.cpp and friends, built for the Mega 2560) against a scripted client over a pseudo
+terminal. The conformance tests check the framed protocol end to end. The throughput bench times the commands that
+make up most of the traffic when tuning and logging, so a protocol performance regression shows up on any Linux box.
+*/
+#include "bench_board.h"
+#include <unity.h>
+#include "globals.h"
+#include "pages.h"
+#include "page_crc.h"
+#include "storage.h"
+#include EEPROM_LIB_H
+#include "logger.h"
+#include "bench_client.h"
+
+#define LIVE_DATA_SIZE        131U  //LOG_ENTRY_SIZE is reduced when unit testing
+#define BENCH_ITERATIONS      500U
+#define TEST_PAGE             2U    //The VE table
+#define RC_OK                 0x00U
+#define RC_REALTIME           0x01U
+#define RC_CRC_ERR            0x82U
+#define RC_UKWN_ERR           0x83U
+#define RC_RANGE_ERR          0x84U
+
+static uint8_t response[1024];
+
+/** 'p', 'M' and 'd' all have the CAN ID at byte 1 and the page at byte 2 */
+static uint16_t pageCommand(uint8_t *pRequest, char command, uint16_t offset, uint16_t length)
+{
+  pRequest[0] = (uint8_t)command;
+  pRequest[1] = 0U;
+  pRequest[2] = TEST_PAGE;
+  pRequest[3] = lowByte(offset);
+  pRequest[4] = highByte(offset);
+  pRequest[5] = lowByte(length);
+  pRequest[6] = highByte(length);
+  return 7U;
+}
+
+static uint16_t liveDataCommand(uint8_t *pRequest, uint16_t offset, uint16_t length)
+{
+  uint16_t requestLength = pageCommand(pRequest, 'r', offset, length);
+  pRequest[2] = 0x30U; //Output channels
+  return requestLength;
+}
+
+static void test_signature(void)
+{
+  const uint8_t request[] = { 'Q' };
+  int32_t length = exchange(request, sizeof(request), response, sizeof(response));
+  TEST_ASSERT_GREATER_THAN(1, length);
+  TEST_ASSERT_EQUAL_UINT8(RC_OK, response[0]);
+  TEST_ASSERT_EQUAL_MEMORY("speeduino", &response[1], 9U);
+}
+
+static void test_live_data(void)
+{
+  uint8_t request[7];
+  int32_t length = exchange(request, liveDataCommand(request, 0U, LIVE_DATA_SIZE), response, sizeof(response));
+  TEST_ASSERT_EQUAL_INT32(LIVE_DATA_SIZE + 1U, length);
+  TEST_ASSERT_EQUAL_UINT8(RC_OK, response[0]);
+}
+
+static void test_page_write_read_crc(void)
+{
+  uint8_t request[7U + 64U];
+  uint16_t requestLength = pageCommand(request, 'M', 10U, 64U);
+  for(uint8_t i = 0; i < 64U; i++) { request[requestLength + i] = (uint8_t)(i * 3U); }
+  TEST_ASSERT_EQUAL_INT32(1, exchange(request, requestLength + 64U, response, sizeof(response)));
+  TEST_ASSERT_EQUAL_UINT8(RC_OK, response[0]);
+
+  //Read the whole page back, in 2 parts as it is bigger than the AVR serial buffer
+  uint8_t page[288];
+  uint16_t pageSize = getPageSize(TEST_PAGE);
+  uint16_t half = pageSize / 2U;
+  TEST_ASSERT_EQUAL_INT32(half + 1U, exchange(request, pageCommand(request, 'p', 0U, half), response, sizeof(response)));
+  memcpy(page, &response[1], half);
+  TEST_ASSERT_EQUAL_INT32(pageSize - half + 1U, exchange(request, pageCommand(request, 'p', half, pageSize - half), response, sizeof(response)));
+  memcpy(&page[half], &response[1], pageSize - half);
+  for(uint8_t i = 0; i < 64U; i++) { TEST_ASSERT_EQUAL_UINT8((uint8_t)(i * 3U), page[10U + i]); }
+
+  //The CRC must be of the page as it was read
+  FastCRC32 crc;
+  TEST_ASSERT_EQUAL_INT32(5, exchange(request, pageCommand(request, 'd', 0U, 0U), response, sizeof(response)));
+  uint32_t pageCrc = ((uint32_t)response[1] << 24U) | ((uint32_t)response[2] << 16U) | ((uint32_t)response[3] << 8U) | response[4];
+  TEST_ASSERT_EQUAL_HEX32(crc.crc32(page, pageSize), pageCrc);
+}
+
+/** 'W' and 'P' carry the CAN ID at byte 1, the same as 'M' and 'p', then the range count */
+static void test_batched_page_write_read(void)
+{
+  const uint8_t write[] = { 'W', 0U, 2U, TEST_PAGE, 0U, 0U, 2U, 0U, 0xAAU, 0xBBU, veSetPage, 100U, 0U, 1U, 0U, 0xCCU };
+  TEST_ASSERT_EQUAL_INT32(1, exchange(write, sizeof(write), response, sizeof(response)));
+  TEST_ASSERT_EQUAL_UINT8(RC_OK, response[0]);
+  TEST_ASSERT_EQUAL_UINT8(0xAAU, getPageValue(TEST_PAGE, 0U));
+  TEST_ASSERT_EQUAL_UINT8(0xBBU, getPageValue(TEST_PAGE, 1U));
+  TEST_ASSERT_EQUAL_UINT8(0xCCU, getPageValue(veSetPage, 100U));
+
+  const uint8_t read[] = { 'P', 0U, 2U, veSetPage, 100U, 0U, 1U, 0U, TEST_PAGE, 0U, 0U, 2U, 0U };
+  TEST_ASSERT_EQUAL_INT32(4, exchange(read, sizeof(read), response, sizeof(response)));
+  const uint8_t expected[] = { RC_OK, 0xCCU, 0xAAU, 0xBBU };
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, response, sizeof(expected));
+}
+
+static void test_batched_page_write_rejected(void)
+{
+  //One bad range rejects the whole batch
+  const uint8_t badRange[] = { 'W', 0U, 2U, TEST_PAGE, 0U, 0U, 1U, 0U, 0x11U, TEST_PAGE, 0xFFU, 0xFFU, 1U, 0U, 0x22U };
+  TEST_ASSERT_EQUAL_INT32(1, exchange(badRange, sizeof(badRange), response, sizeof(response)));
+  TEST_ASSERT_EQUAL_UINT8(RC_RANGE_ERR, response[0]);
+  TEST_ASSERT_NOT_EQUAL(0x11U, getPageValue(TEST_PAGE, 0U));
+
+  //As does a range that claims more data than the packet holds
+  const uint8_t shortData[] = { 'W', 0U, 1U, TEST_PAGE, 0U, 0U, 4U, 0U, 0x11U, 0x22U };
+  TEST_ASSERT_EQUAL_INT32(1, exchange(shortData, sizeof(shortData), response, sizeof(response)));
+  TEST_ASSERT_EQUAL_UINT8(RC_RANGE_ERR, response[0]);
+  TEST_ASSERT_NOT_EQUAL(0x11U, getPageValue(TEST_PAGE, 0U));
+
+  //And a packet too short to hold the range count
+  const uint8_t truncated[] = { 'W', 0U };
+  TEST_ASSERT_EQUAL_INT32(1, exchange(truncated, sizeof(truncated), response, sizeof(response)));
+  TEST_ASSERT_EQUAL_UINT8(RC_RANGE_ERR, response[0]);
+}
+
+static void test_batched_page_read_rejected(void)
+{
+  const uint8_t truncated[] = { 'P', 0U };
+  TEST_ASSERT_EQUAL_INT32(1, exchange(truncated, sizeof(truncated), response, sizeof(response)));
+  TEST_ASSERT_EQUAL_UINT8(RC_RANGE_ERR, response[0]);
+
+  //2 ranges declared, only 1 sent
+  const uint8_t missingRange[] = { 'P', 0U, 2U, TEST_PAGE, 0U, 0U, 2U, 0U };
+  TEST_ASSERT_EQUAL_INT32(1, exchange(missingRange, sizeof(missingRange), response, sizeof(response)));
+  TEST_ASSERT_EQUAL_UINT8(RC_RANGE_ERR, response[0]);
+
+  const uint8_t pastEnd[] = { 'P', 0U, 1U, TEST_PAGE, 0x1FU, 0x01U, 2U, 0U }; //Offset 287 is the last byte of the page
+  TEST_ASSERT_EQUAL_INT32(1, exchange(pastEnd, sizeof(pastEnd), response, sizeof(response)));
+  TEST_ASSERT_EQUAL_UINT8(RC_RANGE_ERR, response[0]);
+}
+
+/** A burn only writes the bytes changed since the last one */
+static void test_burn_changed_bytes(void)
+{
+  //Start with everything burned
+  writeAllConfig();
+  while(isEepromWritePending()) { writeAllDirtyConfig(); }
+  TEST_ASSERT_FALSE(isPageDirty(veSetPage));
+  TEST_ASSERT_FALSE(isPageDirty(TEST_PAGE));
+
+  //A stale byte outside of the changed range is not read back or rewritten
+  EEPROM.data[EEPROM_CONFIG2_START + 100U] = (uint8_t)(EEPROM.data[EEPROM_CONFIG2_START + 100U] + 1U);
+  const uint8_t stale = EEPROM.data[EEPROM_CONFIG2_START + 100U];
+
+  uint8_t request[8];
+  uint16_t requestLength = pageCommand(request, 'M', 3U, 1U);
+  request[2] = veSetPage;
+  request[requestLength] = (uint8_t)(getPageValue(veSetPage, 3U) + 1U);
+  TEST_ASSERT_EQUAL_INT32(1, exchange(request, requestLength + 1U, response, sizeof(response)));
+  TEST_ASSERT_TRUE(isPageDirty(veSetPage));
+
+  deferEEPROMWritesUntil = 0U;
+  const uint8_t burn[] = { 'b', 0U, veSetPage };
+  TEST_ASSERT_EQUAL_INT32(1, exchange(burn, sizeof(burn), response, sizeof(response)));
+  TEST_ASSERT_FALSE(isEepromWritePending());
+  TEST_ASSERT_FALSE(isPageDirty(veSetPage));
+  TEST_ASSERT_EQUAL_UINT8(request[requestLength], EEPROM.data[EEPROM_CONFIG2_START + 3U]);
+  TEST_ASSERT_EQUAL_UINT8(stale, EEPROM.data[EEPROM_CONFIG2_START + 100U]);
+
+  //Writing back an unchanged value leaves nothing to burn
+  TEST_ASSERT_EQUAL_INT32(1, exchange(request, requestLength + 1U, response, sizeof(response)));
+  TEST_ASSERT_FALSE(isPageDirty(veSetPage));
+}
+
+/** Config changed directly in its struct (e.g. by a decoder) is saved by the next burn of its page */
+static void test_burn_changed_bytes_only(void)
+{
+  writeAllConfig();
+  while(isEepromWritePending()) { writeAllDirtyConfig(); }
+  TEST_ASSERT_FALSE(isPageDirty(ignSetPage));
+  TEST_ASSERT_FALSE(isPageDirty(boostvvtPage2));
+
+  //Stale bytes either side of the edited ones. A burn of the whole page would overwrite them
+  const uint16_t capsAddress = EEPROM_CONFIG4_START + offsetof(config4, bootloaderCaps);
+  const uint16_t filterAddress = EEPROM_CONFIG15_START + offsetof(config15, ADCFILTER_PSI); //After the boost table on its page
+  EEPROM.data[capsAddress - 1U] = (uint8_t)~EEPROM.data[capsAddress - 1U];
+  EEPROM.data[capsAddress + 1U] = (uint8_t)~EEPROM.data[capsAddress + 1U];
+  EEPROM.data[filterAddress - 1U] = (uint8_t)~EEPROM.data[filterAddress - 1U];
+  const uint8_t staleBefore = EEPROM.data[capsAddress - 1U];
+  const uint8_t staleAfter = EEPROM.data[capsAddress + 1U];
+  const uint8_t staleFilter = EEPROM.data[filterAddress - 1U];
+
+  //As the init time corrections do
+  configPage4.bootloaderCaps = (uint8_t)(configPage4.bootloaderCaps + 1U);
+  markConfigDirty(ignSetPage, &configPage4.bootloaderCaps, sizeof(configPage4.bootloaderCaps));
+  configPage15.ADCFILTER_PSI = (uint8_t)(configPage15.ADCFILTER_PSI + 1U);
+  markConfigDirty(boostvvtPage2, &configPage15.ADCFILTER_PSI, 1U);
+  TEST_ASSERT_TRUE(isPageDirty(ignSetPage));
+  TEST_ASSERT_TRUE(isPageDirty(boostvvtPage2));
+
+  deferEEPROMWritesUntil = 0U;
+  EEPROM.reads = 0U;
+  EEPROM.writes = 0U;
+  const uint8_t burnIgn[] = { 'b', 0U, ignSetPage };
+  TEST_ASSERT_EQUAL_INT32(1, exchange(burnIgn, sizeof(burnIgn), response, sizeof(response)));
+  const uint8_t burnBoost[] = { 'b', 0U, boostvvtPage2 };
+  TEST_ASSERT_EQUAL_INT32(1, exchange(burnBoost, sizeof(burnBoost), response, sizeof(response)));
+  TEST_ASSERT_FALSE(isEepromWritePending());
+
+  //One byte read and written on each page, nothing else
+  TEST_ASSERT_EQUAL_UINT32(2U, EEPROM.reads);
+  TEST_ASSERT_EQUAL_UINT32(2U, EEPROM.writes);
+  TEST_ASSERT_EQUAL_UINT8(configPage4.bootloaderCaps, EEPROM.data[capsAddress]);
+  TEST_ASSERT_EQUAL_UINT8(configPage15.ADCFILTER_PSI, EEPROM.data[filterAddress]);
+  TEST_ASSERT_EQUAL_UINT8(staleBefore, EEPROM.data[capsAddress - 1U]);
+  TEST_ASSERT_EQUAL_UINT8(staleAfter, EEPROM.data[capsAddress + 1U]);
+  TEST_ASSERT_EQUAL_UINT8(staleFilter, EEPROM.data[filterAddress - 1U]);
+
+  //Put the EEPROM back in step with the pages for the tests that follow
+  writeAllConfig();
+  while(isEepromWritePending()) { writeAllDirtyConfig(); }
+}
+
+static void test_crc_error(void)
+{
+  const uint8_t request[] = { 'Q' };
+  sendCorruptRequest(request, sizeof(request));
+  TEST_ASSERT_EQUAL_INT32(1, receiveResponse(response, sizeof(response), 1000U));
+  TEST_ASSERT_EQUAL_UINT8(RC_CRC_ERR, response[0]);
+}
+
+static void test_unknown_command(void)
+{
+  const uint8_t request[] = { '#' };
+  TEST_ASSERT_EQUAL_INT32(1, exchange(request, sizeof(request), response, sizeof(response)));
+  TEST_ASSERT_EQUAL_UINT8(RC_UKWN_ERR, response[0]);
+}
+
+static void test_tooth_log(void)
+{
+  const uint8_t start[] = { 'H' };
+  TEST_ASSERT_EQUAL_INT32(1, exchange(start, sizeof(start), response, sizeof(response)));
+
+  for(uint8_t i = 0; i < TOOTH_LOG_SIZE; i++) { toothHistory[toothHistoryBuffer][i] = 1000UL + i; }
+  toothHistoryIndex = TOOTH_LOG_SIZE;
+
+  //127 entries of 4 bytes, more than the serial TX buffer holds, so the reply is sent in parts
+  TEST_ASSERT_EQUAL_UINT(127U, TOOTH_LOG_SIZE);
+  const uint8_t request[] = { 'T' };
+  TEST_ASSERT_EQUAL_INT32(509, exchange(request, sizeof(request), response, sizeof(response)));
+  TEST_ASSERT_EQUAL_UINT8(RC_OK, response[0]);
+  for(uint8_t i = 0; i < TOOTH_LOG_SIZE; i++)
+  {
+    const uint8_t *pEntry = &response[1U + (i * 4U)];
+    TEST_ASSERT_EQUAL_UINT32(1000UL + i, ((uint32_t)pEntry[0] << 24U) | ((uint32_t)pEntry[1] << 16U) | ((uint32_t)pEntry[2] << 8U) | pEntry[3]);
+  }
+
+  const uint8_t stop[] = { 'h' };
+  TEST_ASSERT_EQUAL_INT32(1, exchange(stop, sizeof(stop), response, sizeof(response)));
+}
+
+static void test_live_data_stream(void)
+{
+  //10mS interval, 2 ranges: 4 bytes at 0 and 2 bytes at 0 (LOG_ENTRY_SIZE is reduced when unit testing, so there is nothing past byte 0 to subscribe to)
+  const uint8_t subscribe[] = { 'l', 10U, 0U, 2U, 0U, 0U, 4U, 0U, 0U, 0U, 2U, 0U };
+  TEST_ASSERT_EQUAL_INT32(1, exchange(subscribe, sizeof(subscribe), response, sizeof(response)));
+  TEST_ASSERT_EQUAL_UINT8(RC_OK, response[0]);
+
+  uint32_t firstFrame = 0U;
+  for(uint8_t frame = 0; frame < 10U; frame++)
+  {
+    TEST_ASSERT_EQUAL_INT32(7, receiveResponse(response, sizeof(response), 100U));
+    TEST_ASSERT_EQUAL_UINT8(RC_REALTIME, response[0]);
+    if(frame == 0U) { firstFrame = millis(); }
+  }
+  //9 intervals between the first and last frame
+  TEST_ASSERT_UINT32_WITHIN(20U, 90U, millis() - firstFrame);
+
+  //Frames already on the way are skipped until the reply to the cancel arrives
+  const uint8_t cancel[] = { 'l', 0U, 0U, 0U };
+  sendRequest(cancel, sizeof(cancel));
+  int32_t length;
+  do { length = receiveResponse(response, sizeof(response), 100U); } while( (length > 1) && (response[0] == RC_REALTIME) );
+  TEST_ASSERT_EQUAL_INT32(1, length);
+  TEST_ASSERT_EQUAL_UINT8(RC_OK, response[0]);
+  TEST_ASSERT_EQUAL_INT32(-1, receiveResponse(response, sizeof(response), 30U));
+
+  //A request too short to hold the interval and range count is rejected
+  const uint8_t truncated[] = { 'l', 10U };
+  TEST_ASSERT_EQUAL_INT32(1, exchange(truncated, sizeof(truncated), response, sizeof(response)));
+  TEST_ASSERT_EQUAL_UINT8(RC_RANGE_ERR, response[0]);
+  TEST_ASSERT_EQUAL_INT32(-1, receiveResponse(response, sizeof(response), 30U));
+}
+
+/** Time iterations of one request and print the throughput */
+static void benchCommand(const char *name, const uint8_t *pRequest, uint16_t requestLength)
+{
+  resetTraffic();
+  uint32_t start = micros();
+  for(uint16_t i = 0; i < BENCH_ITERATIONS; i++)
+  {
+    TEST_ASSERT_GREATER_THAN(0, exchange(pRequest, requestLength, response, sizeof(response)));
+  }
+  uint32_t elapsed = micros() - start;
+  const benchTraffic &traffic = getTraffic();
+
+  char message[160];
+  (void)snprintf(message, sizeof(message), "%-18s %8lu cmd/s %10lu bytes/s  latency mean %5lu uS max %6lu uS",
+    name,
+    (unsigned long)(((uint64_t)traffic.requests * 1000000U) / elapsed),
+    (unsigned long)(((uint64_t)(traffic.bytesSent + traffic.bytesReceived) * 1000000U) / elapsed),
+    (unsigned long)(traffic.totalLatency / traffic.requests),
+    (unsigned long)traffic.maxLatency);
+  TEST_MESSAGE(message);
+}
+
+static void test_throughput(void)
+{
+  uint8_t request[7U + 128U];
+
+  benchCommand("'r' live data", request, liveDataCommand(request, 0U, LIVE_DATA_SIZE));
+  benchCommand("'p' 128 bytes", request, pageCommand(request, 'p', 0U, 128U));
+  uint16_t requestLength = pageCommand(request, 'M', 0U, 128U);
+  memset(&request[requestLength], 0x55, 128U);
+  benchCommand("'M' 128 bytes", request, requestLength + 128U);
+  benchCommand("'d' page CRC", request, pageCommand(request, 'd', 0U, 0U));
+
+  const uint8_t start[] = { 'H' };
+  (void)exchange(start, sizeof(start), response, sizeof(response));
+  const uint8_t toothLog[] = { 'T' };
+  benchCommand("'T' tooth log", toothLog, sizeof(toothLog));
+  TEST_ASSERT_EQUAL_UINT32(BENCH_ITERATIONS * (2U + 509U + 4U), getTraffic().bytesReceived); //Every reply is the whole log, plus the framing
+  const uint8_t stop[] = { 'h' };
+  (void)exchange(stop, sizeof(stop), response, sizeof(response));
+}
+
+void testComms(void)
+{
+  if(!startBenchClient())
+  {
+    TEST_MESSAGE("No pseudo terminals on this host, skipping the comms bench");
+    return;
+  }
+
+  RUN_TEST(test_signature);
+  RUN_TEST(test_live_data);
+  RUN_TEST(test_page_write_read_crc);
+  RUN_TEST(test_batched_page_write_read);
+  RUN_TEST(test_batched_page_write_rejected);
+  RUN_TEST(test_batched_page_read_rejected);
+  RUN_TEST(test_burn_changed_bytes);
+  RUN_TEST(test_burn_changed_bytes_only);
+  RUN_TEST(test_crc_error);
+  RUN_TEST(test_unknown_command);
+  RUN_TEST(test_tooth_log);
+  RUN_TEST(test_live_data_stream);
+  RUN_TEST(test_throughput);
+}
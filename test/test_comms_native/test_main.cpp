@@ -0,0 +1,11 @@
+#include <unity.h>
+
+extern void testComms(void);
+
+int main(void) {
+  UNITY_BEGIN();
+
+  testComms();
+
+  return UNITY_END();
+}
@@ -0,0 +1,9 @@
+//No interrupts on the host, so an atomic block is just a block
+#ifndef BENCH_UTIL_ATOMIC_H
+#define BENCH_UTIL_ATOMIC_H
+
+#define ATOMIC_RESTORESTATE 0
+#define ATOMIC_FORCEON 0
+#define ATOMIC_BLOCK(type) for(uint8_t atomicBlockOnce = 1U; atomicBlockOnce != 0U; atomicBlockOnce = 0U)
+
+#endif
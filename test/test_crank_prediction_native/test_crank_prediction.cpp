@@ -0,0 +1,194 @@
+/*
+Replays trigger streams with a known speed profile through the crank speed predictor, and compares the angle error of
+the predicted schedule times against the constant speed model (Time per degree from the last full revolution, as used
+by angleToTimeMicroSecPerDegree()).
+*/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unity.h>
+#include "crank_prediction.h"
+#include "crank_prediction.cpp"
+
+#define TOOTH_ANGLE 10U  //36 tooth wheel
+#define TOOTH_COUNT 36U
+
+/** A constant acceleration from startRpm to endRpm over the given number of revolutions */
+struct speedProfile {
+  const char *name;
+  double startRpm;
+  double endRpm;
+  double revolutions;
+  uint8_t loopTeeth;  //Number of teeth between each main loop sample
+  double jitter;      //Random timing error (uS) added to each tooth
+};
+
+struct predictionErrors {
+  double meanError;
+  double maxError;
+  uint32_t count;
+};
+
+/** Time (uS) that the crank reaches the given angle, under constant angular acceleration */
+static double profileTime(const speedProfile &profile, double angle)
+{
+  double startSpeed = profile.startRpm * 6.0 / 1000000.0; //Degrees per uS
+  double endSpeed = profile.endRpm * 6.0 / 1000000.0;
+  double totalAngle = profile.revolutions * 360.0;
+  double acceleration = ((endSpeed * endSpeed) - (startSpeed * startSpeed)) / (2.0 * totalAngle);
+  if(fabs(acceleration) < 1e-15) { return angle / startSpeed; }
+  return (sqrt((startSpeed * startSpeed) + (2.0 * acceleration * angle)) - startSpeed) / acceleration;
+}
+
+/** The angle error (degrees) of a schedule time, measured at the speed the crank is turning when the event is due */
+static double angleError(const speedProfile &profile, double fromAngle, uint16_t angle, uint32_t predictedTime)
+{
+  double actualTime = profileTime(profile, fromAngle + angle) - profileTime(profile, fromAngle);
+  double degreesPerMicro = 1.0 / (profileTime(profile, fromAngle + angle + 0.5) - profileTime(profile, fromAngle + angle - 0.5));
+  return fabs(((double)predictedTime - actualTime) * degreesPerMicro);
+}
+
+static void addError(predictionErrors &errors, double error)
+{
+  errors.meanError += error;
+  if(error > errors.maxError) { errors.maxError = error; }
+  errors.count++;
+}
+
+/** Run a profile, predicting the time to events scheduleAngle degrees after each sampled tooth */
+static void replayProfile(const speedProfile &profile, uint16_t scheduleAngle, predictionErrors &predicted, predictionErrors &constantSpeed)
+{
+  crankSpeedPrediction prediction;
+  resetCrankSpeedPrediction(prediction);
+  predicted = predictionErrors { 0.0, 0.0, 0U };
+  constantSpeed = predictionErrors { 0.0, 0.0, 0U };
+  srand(1);
+
+  uint32_t toothCount = (uint32_t)(profile.revolutions * TOOTH_COUNT);
+  uint32_t toothTimes[TOOTH_COUNT + 1U] = { 0U }; //Enough history for the last revolution
+  uint16_t angleTotal = 0U;
+  for(uint32_t tooth = 0U; tooth < toothCount; tooth++)
+  {
+    double jitter = (profile.jitter * 2.0 * ((double)rand() / RAND_MAX)) - profile.jitter;
+    uint32_t toothTime = 10000U + (uint32_t)lround(profileTime(profile, (double)tooth * TOOTH_ANGLE) + jitter);
+    for(uint8_t history = TOOTH_COUNT; history > 0U; history--) { toothTimes[history] = toothTimes[history - 1U]; }
+    toothTimes[0] = toothTime;
+    angleTotal += TOOTH_ANGLE;
+
+    //Only sample on some teeth, the main loop does not see every tooth. The events must stay within the profile
+    bool isSampled = (tooth > 0U) && ((tooth % profile.loopTeeth) == 0U);
+    if( isSampled && addCrankSpeedSample(prediction, toothTime, angleTotal) && (tooth > (TOOTH_COUNT * 2U))
+        && ((double)(tooth * TOOTH_ANGLE + scheduleAngle) < (profile.revolutions * 360.0)) )
+    {
+      double fromAngle = (double)tooth * TOOTH_ANGLE;
+      addError(predicted, angleError(profile, fromAngle, scheduleAngle, predictAngleToTime(prediction, scheduleAngle)));
+
+      uint32_t revolutionTime = toothTime - toothTimes[TOOTH_COUNT];
+      uint32_t constantSpeedTime = (uint32_t)lround((double)revolutionTime * scheduleAngle / 360.0);
+      addError(constantSpeed, angleError(profile, fromAngle, scheduleAngle, constantSpeedTime));
+    }
+  }
+
+  if(predicted.count > 0U) { predicted.meanError /= predicted.count; }
+  if(constantSpeed.count > 0U) { constantSpeed.meanError /= constantSpeed.count; }
+}
+
+static void reportProfile(const speedProfile &profile, uint16_t scheduleAngle, const predictionErrors &predicted, const predictionErrors &constantSpeed)
+{
+  char message[200];
+  snprintf(message, sizeof(message), "%s, %u deg ahead: predicted mean %.3f max %.3f deg, constant speed mean %.3f max %.3f deg",
+           profile.name, scheduleAngle, predicted.meanError, predicted.maxError, constantSpeed.meanError, constantSpeed.maxError);
+  TEST_MESSAGE(message);
+}
+
+static const speedProfile profiles[] = {
+  { "Steady 3000rpm",               3000.0, 3000.0, 20.0, 1U, 0.0 },
+  { "Accel 1000-4000rpm in 0.5s",   1000.0, 4000.0, 20.8, 1U, 0.0 },
+  { "Accel 1000-4000rpm, jitter",   1000.0, 4000.0, 20.8, 3U, 2.0 },
+  { "Decel 5000-1500rpm in 1s",     5000.0, 1500.0, 54.2, 2U, 0.0 },
+  { "Cranking 150-600rpm in 1s",     150.0,  600.0,  6.25, 1U, 0.0 },
+};
+
+static void test_prediction_steady_speed(void)
+{
+  predictionErrors predicted, constantSpeed;
+  replayProfile(profiles[0], 360U, predicted, constantSpeed);
+  reportProfile(profiles[0], 360U, predicted, constantSpeed);
+  TEST_ASSERT_GREATER_THAN_UINT32(0U, predicted.count);
+  TEST_ASSERT_TRUE(predicted.maxError < 0.1);
+}
+
+static void test_prediction_acceleration(void)
+{
+  static const uint16_t scheduleAngles[] = { 90U, 360U, 720U };
+  for(uint8_t profile = 1U; profile < (sizeof(profiles) / sizeof(profiles[0])); profile++)
+  {
+    for(uint8_t angle = 0U; angle < (sizeof(scheduleAngles) / sizeof(scheduleAngles[0])); angle++)
+    {
+      predictionErrors predicted, constantSpeed;
+      replayProfile(profiles[profile], scheduleAngles[angle], predicted, constantSpeed);
+      reportProfile(profiles[profile], scheduleAngles[angle], predicted, constantSpeed);
+      TEST_ASSERT_GREATER_THAN_UINT32(0U, predicted.count);
+      TEST_ASSERT_TRUE(predicted.meanError < (constantSpeed.meanError / 2.0));
+    }
+  }
+}
+
+static void test_prediction_time_to_angle(void)
+{
+  //Accelerating at a constant rate from 1000rpm
+  const speedProfile &profile = profiles[1];
+  crankSpeedPrediction prediction;
+  resetCrankSpeedPrediction(prediction);
+  uint32_t toothTime = 0U;
+  uint16_t angleTotal = 0U;
+  for(uint8_t tooth = 1U; tooth <= 30U; tooth++)
+  {
+    toothTime = (uint32_t)lround(profileTime(profile, tooth * TOOTH_ANGLE));
+    angleTotal += TOOTH_ANGLE;
+    addCrankSpeedSample(prediction, toothTime, angleTotal);
+  }
+  TEST_ASSERT_TRUE(isCrankSpeedPredictionValid(prediction));
+  TEST_ASSERT_LESS_THAN_INT32(0, prediction.periodRate);
+
+  //Angle reached 20mS after the last tooth. The speed changes by over 10% in that time, so the linear model is not exact
+  double actualAngle = 0.0;
+  while( (profileTime(profile, 300.0 + actualAngle) - toothTime) < 20000.0 ) { actualAngle += 0.01; }
+  TEST_ASSERT_INT_WITHIN(2, (int)lround(actualAngle), predictTimeToAngle(prediction, 20000U));
+  TEST_ASSERT_INT_WITHIN(400, 20000U, predictAngleToTime(prediction, (uint16_t)lround(actualAngle)));
+}
+
+static void test_prediction_windows(void)
+{
+  crankSpeedPrediction prediction;
+  resetCrankSpeedPrediction(prediction);
+
+  //Steady 1000uS per 10 degree tooth. Only some of the teeth are seen, the windows are made from the angle totals
+  TEST_ASSERT_FALSE(addCrankSpeedSample(prediction, 0U, 0U));
+  TEST_ASSERT_FALSE(addCrankSpeedSample(prediction, 4000U, 40U));
+  TEST_ASSERT_FALSE(addCrankSpeedSample(prediction, 10000U, 100U)); //First window complete
+  TEST_ASSERT_FALSE(addCrankSpeedSample(prediction, 10000U, 100U)); //Same tooth again
+  TEST_ASSERT_TRUE(addCrankSpeedSample(prediction, 19000U, 190U));  //Second window complete
+  TEST_ASSERT_EQUAL_UINT8(3U, prediction.windowCount);
+  TEST_ASSERT_EQUAL_INT32(0, prediction.periodRate);
+  TEST_ASSERT_EQUAL_UINT32(36000U, predictAngleToTime(prediction, 360U));
+  TEST_ASSERT_EQUAL_UINT16(36U, predictTimeToAngle(prediction, 3600U));
+
+  //A tooth with no angle (Eg after sync loss) starts again
+  TEST_ASSERT_FALSE(addCrankSpeedSample(prediction, 20000U, 190U));
+  TEST_ASSERT_EQUAL_UINT8(1U, prediction.windowCount);
+
+  //Speed halves between windows, too big a step to follow. The rate restarts, but the speed is still used
+  TEST_ASSERT_FALSE(addCrankSpeedSample(prediction, 29000U, 280U));
+  TEST_ASSERT_FALSE(addCrankSpeedSample(prediction, 47000U, 370U));
+  TEST_ASSERT_EQUAL_UINT8(2U, prediction.windowCount);
+  TEST_ASSERT_EQUAL_UINT32(20000U, predictAngleToTime(prediction, 100U));
+}
+
+void testCrankPrediction(void)
+{
+  RUN_TEST(test_prediction_steady_speed);
+  RUN_TEST(test_prediction_acceleration);
+  RUN_TEST(test_prediction_time_to_angle);
+  RUN_TEST(test_prediction_windows);
+}
@@ -0,0 +1,11 @@
+#include <unity.h>
+
+extern void testCrankPrediction(void);
+
+int main(void) {
+  UNITY_BEGIN();
+
+  testCrankPrediction();
+
+  return UNITY_END();
+}
@@ -0,0 +1,109 @@
+#include <decoders.h>
+#include <globals.h>
+#include <unity.h>
+#include "gap_pattern.h"
+#include "trigger_patterns.h"
+#include "schedule_calcs.h"
+#include "../../test_utils.h"
+
+static gapPattern loadPattern(uint8_t index)
+{
+  gapPattern pattern;
+  memcpy_P(&pattern, &gapPatterns[index], sizeof(pattern));
+  return pattern;
+}
+
+static void test_gap_classify(void)
+{
+  TEST_ASSERT_EQUAL(GAP_SHORT, classifyGap(100, 300));
+  TEST_ASSERT_EQUAL(GAP_SHORT, classifyGap(100, 200));
+  TEST_ASSERT_EQUAL(GAP_EQUAL, classifyGap(100, 100));
+  TEST_ASSERT_EQUAL(GAP_EQUAL, classifyGap(120, 100));
+  TEST_ASSERT_EQUAL(GAP_EQUAL, classifyGap(80, 100));
+  TEST_ASSERT_EQUAL(GAP_LONG, classifyGap(200, 100));
+  TEST_ASSERT_EQUAL(GAP_VERY_LONG, classifyGap(300, 100));
+}
+
+static void test_gap_builtin_patterns_compile(void)
+{
+  gapPatternLookup lookup;
+  for(uint8_t index = 0; index < gapPatternCount; index++)
+  {
+    TEST_ASSERT_TRUE(compileGapPattern(loadPattern(index), lookup));
+    TEST_ASSERT_GREATER_THAN(0, lookup.syncTeeth);
+  }
+}
+
+static void test_gap_36_2_2_2_symbols(void)
+{
+  gapPatternLookup lookup;
+  gapPattern pattern = loadPattern(GAP_PATTERN_36_2_2_2);
+  compileGapPattern(pattern, lookup);
+
+  TEST_ASSERT_EQUAL(10, lookup.minGap);
+  TEST_ASSERT_EQUAL(30, lookup.maxGap);
+  TEST_ASSERT_EQUAL(GAP_EQUAL, getGapToothSymbol(lookup, 0));     //30 degree gap after a 30 degree gap
+  TEST_ASSERT_EQUAL(GAP_SHORT, getGapToothSymbol(lookup, 1));
+  TEST_ASSERT_EQUAL(GAP_EQUAL, getGapToothSymbol(lookup, 5));
+  TEST_ASSERT_EQUAL(GAP_VERY_LONG, getGapToothSymbol(lookup, 13));
+  TEST_ASSERT_EQUAL(GAP_SHORT, getGapToothSymbol(lookup, 14));
+  TEST_ASSERT_EQUAL(GAP_VERY_LONG, getGapToothSymbol(lookup, 29));
+
+  //Equal, very long, short can only be the tooth after the 2nd gap
+  TEST_ASSERT_EQUAL(14, lookup.signatureTooth[(GAP_EQUAL << 4) | (GAP_VERY_LONG << 2) | GAP_SHORT]);
+  //Equal, equal, very long occurs before both tooth 13 and 29
+  TEST_ASSERT_EQUAL(GAP_NO_TOOTH, lookup.signatureTooth[(GAP_EQUAL << 4) | (GAP_EQUAL << 2) | GAP_VERY_LONG]);
+  //All equal is most of the wheel
+  TEST_ASSERT_EQUAL(GAP_NO_TOOTH, lookup.signatureTooth[(GAP_EQUAL << 4) | (GAP_EQUAL << 2) | GAP_EQUAL]);
+}
+
+static const uint16_t symmetricAngles[] PROGMEM = { 0, 10, 20, 30, 40, 50, 60, 70, 80, 90, 100, 110, 120, 130, 140, 150, 160,
+                                                    180, 190, 200, 210, 220, 230, 240, 250, 260, 270, 280, 290, 300, 310, 320, 330, 340 };
+static void test_gap_symmetric_pattern(void)
+{
+  //36-1-1 with the gaps 180 degrees apart. Every signature occurs twice per revolution
+  gapPattern pattern = { 360, _countof(symmetricAngles), 0, symmetricAngles, nullptr };
+  gapPatternLookup lookup;
+  TEST_ASSERT_FALSE(compileGapPattern(pattern, lookup));
+  TEST_ASSERT_EQUAL(0, lookup.syncTeeth);
+}
+
+static const uint16_t unorderedAngles[] PROGMEM = { 0, 90, 80, 270 };
+static void test_gap_invalid_pattern(void)
+{
+  gapPattern pattern = { 360, _countof(unorderedAngles), 0, unorderedAngles, nullptr };
+  gapPatternLookup lookup;
+  TEST_ASSERT_FALSE(compileGapPattern(pattern, lookup));
+}
+
+static void test_gap_end_teeth_36_2_2_2(void)
+{
+  configPage9.trigGapPattern = GAP_PATTERN_36_2_2_2;
+  configPage4.sparkMode = IGN_MODE_WASTED;
+  configPage4.triggerAngle = 0;
+  triggerSetup_GapPattern();
+
+  ignition1EndAngle = 360 - 10;
+  triggerSetEndTeeth_GapPattern();
+  TEST_ASSERT_EQUAL(29, ignition1EndTooth); //Tooth before the one at 330 degrees
+
+  ignition1EndAngle = 135; //In the first gap, after the tooth at 120 degrees
+  triggerSetEndTeeth_GapPattern();
+  TEST_ASSERT_EQUAL(12, ignition1EndTooth);
+
+  ignition1EndAngle = 5;
+  triggerSetEndTeeth_GapPattern();
+  TEST_ASSERT_EQUAL(30, ignition1EndTooth); //Wraps back to the last tooth
+}
+
+void testGapPattern()
+{
+  SET_UNITY_FILENAME() {
+    RUN_TEST(test_gap_classify);
+    RUN_TEST(test_gap_builtin_patterns_compile);
+    RUN_TEST(test_gap_36_2_2_2_symbols);
+    RUN_TEST(test_gap_symmetric_pattern);
+    RUN_TEST(test_gap_invalid_pattern);
+    RUN_TEST(test_gap_end_teeth_36_2_2_2);
+  }
+}
@@ -0,0 +1,328 @@
+#include <Arduino.h>
+#include <decoders.h>
+#include <globals.h>
+#include <unity.h>
+#include "trigger_replay.h"
+#include "trigger_patterns.h"
+#include "../../test_utils.h"
+
+//Wheel definitions. All angles are in tenths of a crank degree, with 0 being TDC #1 (Approximately, the trigger angle is not modelled)
+#define NO_SECONDARY { 0, 0, 0, 0, nullptr, 0, nullptr, 0 }
+
+static void configureCommon(uint8_t pattern)
+{
+  configPage4.TrigPattern = pattern;
+  configPage4.TrigEdge = 0; //Rising
+  configPage4.TrigEdgeSec = 0; //Rising
+  configPage4.TrigSpeed = CRANK_SPEED;
+  configPage4.triggerFilter = TRIGGER_FILTER_OFF;
+  configPage4.useResync = 0;
+  configPage4.StgCycles = 0;
+  configPage2.perToothIgn = false;
+  configPage2.nCylinders = 4;
+  configPage2.strokes = FOUR_STROKE;
+  configPage2.injLayout = INJ_PAIRED;
+  configPage4.sparkMode = IGN_MODE_WASTED;
+  configPage6.vvtEnabled = 0;
+  configPage10.vvt2Enabled = 0;
+}
+
+//36-1 crank wheel, no cam
+static const uint8_t missing36_1[] = { 35 };
+static void configure36_1(void)
+{
+  configureCommon(DECODER_MISSING_TOOTH);
+  configPage4.triggerTeeth = 36;
+  configPage4.triggerMissingTeeth = 1;
+  configPage4.trigPatternSec = SEC_TRIGGER_SINGLE;
+}
+static const replay_pattern pattern36_1 = {
+  "36-1", configure36_1,
+  { 3600, 36, 0, 0, missing36_1, 1, nullptr, 0 },
+  NO_SECONDARY
+};
+
+//60-2 crank wheel with a single cam tooth, running sequential
+static const uint8_t missing60_2[] = { 58, 59 };
+static const replay_edge singleCamTooth[] = { { 1000, HIGH }, { 1200, LOW } };
+static void configure60_2(void)
+{
+  configureCommon(DECODER_MISSING_TOOTH);
+  configPage4.triggerTeeth = 60;
+  configPage4.triggerMissingTeeth = 2;
+  configPage4.trigPatternSec = SEC_TRIGGER_SINGLE;
+  configPage4.sparkMode = IGN_MODE_SEQUENTIAL;
+  configPage2.injLayout = INJ_SEQUENTIAL;
+}
+static const replay_pattern pattern60_2 = {
+  "60-2+cam", configure60_2,
+  { 3600, 60, 0, 0, missing60_2, 2, nullptr, 0 },
+  { 7200, 0, 0, 0, nullptr, 0, singleCamTooth, _countof(singleCamTooth) }
+};
+
+//12 tooth crank wheel with a single cam tooth
+static void configureDualWheel(void)
+{
+  configureCommon(DECODER_DUAL_WHEEL);
+  configPage4.triggerTeeth = 12;
+}
+static const replay_pattern patternDualWheel = {
+  "Dual wheel 12/1", configureDualWheel,
+  { 3600, 12, 0, 0, nullptr, 0, nullptr, 0 },
+  { 7200, 0, 0, 0, nullptr, 0, singleCamTooth, _countof(singleCamTooth) }
+};
+
+//4 cylinder distributor, one tooth per cylinder
+static void configureDistributor(void)
+{
+  configureCommon(DECODER_BASIC_DISTRIBUTOR);
+}
+static const replay_pattern patternDistributor = {
+  "Distributor 4cyl", configureDistributor,
+  { 7200, 4, 0, 0, nullptr, 0, nullptr, 0 },
+  NO_SECONDARY
+};
+
+//36-2-2-2 (H4): 13 teeth - missing 2 - 16 teeth - missing 2 - 1 tooth - missing 2
+static const uint8_t missing36_222[] = { 13, 14, 31, 32, 34, 35 };
+static void configure36_222(void)
+{
+  configureCommon(DECODER_36_2_2_2);
+  configPage4.triggerTeeth = 36;
+}
+static const replay_pattern pattern36_222 = {
+  "36-2-2-2 H4", configure36_222,
+  { 3600, 36, 0, 0, missing36_222, _countof(missing36_222), nullptr, 0 },
+  NO_SECONDARY
+};
+
+//4G63: 2 crank teeth of 70 degrees per revolution, both edges used. 2 cam teeth of different lengths (Only the falling edges are used)
+static const replay_edge cam4G63[] = { { 2300, HIGH }, { 4000, LOW }, { 6100, HIGH }, { 6800, LOW } };
+static void configure4G63(void)
+{
+  configureCommon(DECODER_4G63);
+}
+static const replay_pattern pattern4G63 = {
+  "4G63", configure4G63,
+  { 3600, 2, 1050, 700, nullptr, 0, nullptr, 0 },
+  { 7200, 0, 0, 0, nullptr, 0, cam4G63, _countof(cam4G63) }
+};
+
+//Miata 99-05: 4 crank teeth per revolution at 70/110 degree spacing. 1 and 2 cam pulses before teeth 1 and 6
+static const replay_edge crankMiata9905[] = { { 1000, HIGH }, { 1050, LOW }, { 1700, HIGH }, { 1750, LOW }, { 2800, HIGH }, { 2850, LOW }, { 3500, HIGH }, { 3550, LOW } };
+static const replay_edge camMiata9905[] = { { 300, HIGH }, { 400, LOW }, { 3800, HIGH }, { 3900, LOW }, { 4100, HIGH }, { 4200, LOW } };
+static void configureMiata9905(void)
+{
+  configureCommon(DECODER_MIATA_9905);
+}
+static const replay_pattern patternMiata9905 = {
+  "Miata 99-05", configureMiata9905,
+  { 3600, 0, 0, 0, nullptr, 0, crankMiata9905, _countof(crankMiata9905) },
+  { 7200, 0, 0, 0, nullptr, 0, camMiata9905, _countof(camMiata9905) }
+};
+
+//Nissan 360 (4 cylinder): 360 slots per cam revolution. The inner windows are 16, 12, 8 and 4 slots long (Signal is low in the window)
+static const replay_edge windowsNissan360[] = { { 310, HIGH }, { 1790, LOW }, { 2030, HIGH }, { 3590, LOW }, { 3750, HIGH }, { 5390, LOW }, { 5470, HIGH }, { 7190, LOW } };
+static void configureNissan360(void)
+{
+  configureCommon(DECODER_NISSAN_360);
+}
+static const replay_pattern patternNissan360 = {
+  "Nissan 360", configureNissan360,
+  { 7200, 360, 0, 0, nullptr, 0, nullptr, 0 },
+  { 7200, 0, 0, 0, nullptr, 0, windowsNissan360, _countof(windowsNissan360) }
+};
+
+//Subaru 6/7: 3 crank teeth per 180 degrees. 7 cam teeth in groups of 3, 1, 2, 1 (Falling edge is used)
+static const replay_edge crankSubaru67[] = { { 830, HIGH }, { 880, LOW }, { 1150, HIGH }, { 1200, LOW }, { 1700, HIGH }, { 1750, LOW } };
+static const replay_edge camSubaru67[] = { { 150, HIGH }, { 200, LOW }, { 350, HIGH }, { 400, LOW }, { 550, HIGH }, { 600, LOW },
+                                           { 1950, HIGH }, { 2000, LOW },
+                                           { 3750, HIGH }, { 3800, LOW }, { 3950, HIGH }, { 4000, LOW },
+                                           { 5550, HIGH }, { 5600, LOW } };
+static void configureSubaru67(void)
+{
+  configureCommon(DECODER_SUBARU_67);
+}
+static const replay_pattern patternSubaru67 = {
+  "Subaru 6/7", configureSubaru67,
+  { 1800, 0, 0, 0, nullptr, 0, crankSubaru67, _countof(crankSubaru67) },
+  { 7200, 0, 0, 0, nullptr, 0, camSubaru67, _countof(camSubaru67) }
+};
+
+//The generic gap pattern decoder, replaying the same wheels as the dedicated decoders above
+static void configureGap36_222(void)
+{
+  configureCommon(DECODER_GAP_PATTERN);
+  configPage9.trigGapPattern = GAP_PATTERN_36_2_2_2;
+}
+static const replay_pattern patternGap36_222 = {
+  "Gap 36-2-2-2", configureGap36_222,
+  { 3600, 36, 0, 0, missing36_222, _countof(missing36_222), nullptr, 0 },
+  NO_SECONDARY
+};
+
+static const uint8_t missing36_2_1[] = { 16, 34, 35 };
+static void configureGap36_21(void)
+{
+  configureCommon(DECODER_GAP_PATTERN);
+  configPage9.trigGapPattern = GAP_PATTERN_36_2_1;
+}
+static const replay_pattern patternGap36_21 = {
+  "Gap 36-2-1", configureGap36_21,
+  { 3600, 36, 0, 0, missing36_2_1, _countof(missing36_2_1), nullptr, 0 },
+  NO_SECONDARY
+};
+
+static void configureGap60_2(void)
+{
+  configureCommon(DECODER_GAP_PATTERN);
+  configPage9.trigGapPattern = GAP_PATTERN_60_2_CAM;
+  configPage4.sparkMode = IGN_MODE_SEQUENTIAL;
+  configPage2.injLayout = INJ_SEQUENTIAL;
+}
+static const replay_pattern patternGap60_2 = {
+  "Gap 60-2+cam", configureGap60_2,
+  { 3600, 60, 0, 0, missing60_2, 2, nullptr, 0 },
+  { 7200, 0, 0, 0, nullptr, 0, singleCamTooth, _countof(singleCamTooth) }
+};
+
+//12+1 at cam speed: 12 teeth 60 degrees apart, plus an extra tooth 30 degrees after #12
+static const replay_edge cam12_1[] = { {    0, HIGH }, {   50, LOW }, {  600, HIGH }, {  650, LOW }, { 1200, HIGH }, { 1250, LOW },
+                                       { 1800, HIGH }, { 1850, LOW }, { 2400, HIGH }, { 2450, LOW }, { 3000, HIGH }, { 3050, LOW },
+                                       { 3600, HIGH }, { 3650, LOW }, { 4200, HIGH }, { 4250, LOW }, { 4800, HIGH }, { 4850, LOW },
+                                       { 5400, HIGH }, { 5450, LOW }, { 6000, HIGH }, { 6050, LOW }, { 6600, HIGH }, { 6650, LOW },
+                                       { 6900, HIGH }, { 6950, LOW } };
+static void configureGap12_1(void)
+{
+  configureCommon(DECODER_GAP_PATTERN);
+  configPage9.trigGapPattern = GAP_PATTERN_12_1_CAM_SPEED;
+  configPage4.sparkMode = IGN_MODE_SEQUENTIAL;
+  configPage2.injLayout = INJ_SEQUENTIAL;
+}
+static const replay_pattern patternGap12_1 = {
+  "Gap 12+1 cam speed", configureGap12_1,
+  { 7200, 0, 0, 0, nullptr, 0, cam12_1, _countof(cam12_1) },
+  NO_SECONDARY
+};
+
+static replay_result runReplay(const replay_pattern &pattern, uint16_t rpm, int16_t rpmPerSec, uint16_t noiseMicros, uint16_t cycles)
+{
+  const replay_params params = { rpm, rpmPerSec, noiseMicros, cycles };
+  replay_result result = replayTriggerPattern(pattern, params);
+  reportReplayResult(pattern, params, result);
+  return result;
+}
+
+//A steady state run must gain sync and then never lose it
+static void assertSteadySync(const replay_result &result)
+{
+  TEST_ASSERT_GREATER_THAN(0, result.edges);
+  TEST_ASSERT_GREATER_THAN(0, result.syncTeeth);
+  TEST_ASSERT_EQUAL(0, result.syncLosses);
+}
+
+static void test_replay_36_1_3000rpm(void)
+{
+  assertSteadySync(runReplay(pattern36_1, 3000, 0, 0, 10));
+}
+
+static void test_replay_36_1_noise(void)
+{
+  //+-10uS is < 2% of the tooth gap at 3000rpm, which the 1.5x gap detection must tolerate
+  assertSteadySync(runReplay(pattern36_1, 3000, 0, 10, 10));
+}
+
+static void test_replay_60_2_8000rpm(void)
+{
+  assertSteadySync(runReplay(pattern60_2, 8000, 0, 0, 20));
+}
+
+static void test_replay_60_2_accel(void)
+{
+  //2000 -> ~7800rpm in 0.4 seconds
+  assertSteadySync(runReplay(pattern60_2, 2000, 15000, 0, 16));
+}
+
+static void test_replay_dual_wheel(void)
+{
+  assertSteadySync(runReplay(patternDualWheel, 6000, 0, 0, 10));
+}
+
+static void test_replay_distributor(void)
+{
+  assertSteadySync(runReplay(patternDistributor, 6000, 0, 0, 10));
+}
+
+static void test_replay_36_2_2_2(void)
+{
+  assertSteadySync(runReplay(pattern36_222, 6000, 0, 0, 10));
+}
+
+static void test_replay_nissan360(void)
+{
+  //2 degrees per tooth limits the speed that can be replayed in real time
+  assertSteadySync(runReplay(patternNissan360, 3000, 0, 0, 6));
+}
+
+static void test_replay_subaru67(void)
+{
+  assertSteadySync(runReplay(patternSubaru67, 6000, 0, 0, 10));
+}
+
+static void test_replay_miata9905(void)
+{
+  assertSteadySync(runReplay(patternMiata9905, 6000, 0, 0, 10));
+}
+
+static void test_replay_4G63(void)
+{
+  //The cam is high over the crank tooth at 285-355 and falls part way through the tooth at 645-715, which is what the decoder syncs on.
+  //Sync is gained on the cam falling edge at 400 degrees in the 2nd cycle (12 primary edges), allow up to 2 full cycles
+  replay_result result = runReplay(pattern4G63, 6000, 0, 0, 10);
+  assertSteadySync(result);
+  TEST_ASSERT_LESS_OR_EQUAL(16, result.syncTeeth);
+  TEST_ASSERT_EQUAL(0, result.decoderSyncLosses);
+}
+
+static void test_replay_gap_36_2_2_2(void)
+{
+  //Same conditions as test_replay_36_2_2_2, so the two decoders can be compared directly
+  assertSteadySync(runReplay(patternGap36_222, 6000, 0, 0, 10));
+}
+
+static void test_replay_gap_36_2_1_accel(void)
+{
+  assertSteadySync(runReplay(patternGap36_21, 2000, 15000, 10, 16));
+}
+
+static void test_replay_gap_60_2_8000rpm(void)
+{
+  //Same conditions as test_replay_60_2_8000rpm
+  assertSteadySync(runReplay(patternGap60_2, 8000, 0, 0, 20));
+}
+
+static void test_replay_gap_12_1(void)
+{
+  assertSteadySync(runReplay(patternGap12_1, 6000, 0, 0, 10));
+}
+
+void testTriggerReplay(void)
+{
+  SET_UNITY_FILENAME() {
+    RUN_TEST(test_replay_36_1_3000rpm);
+    RUN_TEST(test_replay_36_1_noise);
+    RUN_TEST(test_replay_60_2_8000rpm);
+    RUN_TEST(test_replay_60_2_accel);
+    RUN_TEST(test_replay_dual_wheel);
+    RUN_TEST(test_replay_distributor);
+    RUN_TEST(test_replay_36_2_2_2);
+    RUN_TEST(test_replay_nissan360);
+    RUN_TEST(test_replay_subaru67);
+    RUN_TEST(test_replay_miata9905);
+    RUN_TEST(test_replay_4G63);
+    RUN_TEST(test_replay_gap_36_2_2_2);
+    RUN_TEST(test_replay_gap_36_2_1_accel);
+    RUN_TEST(test_replay_gap_60_2_8000rpm);
+    RUN_TEST(test_replay_gap_12_1);
+  }
+}
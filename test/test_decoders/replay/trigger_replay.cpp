@@ -0,0 +1,253 @@
+#include <Arduino.h>
+#include <inttypes.h>
+#include <decoders.h>
+#include <globals.h>
+#include <init.h>
+#include <unity.h>
+#include "trigger_replay.h"
+
+#define REPLAY_CYCLE_ANGLE    7200UL  //720 degrees, in tenths of a degree
+#define REPLAY_LEAD_IN        2000UL  //Time (uS) between the setup and the first edge
+#define REPLAY_LATE_TOLERANCE 8U      //An edge replayed more than this many uS after its target time is counted as late
+#define REPLAY_RPM_INTERVAL   16U     //Number of primary edges between each getRPM() call (Emulates the main loop)
+#define REPLAY_MIN_RPM        50.0f
+
+//Replay pins. These are driven as outputs so that the READ_xxx_TRIGGER() macros see the synthesised signal
+#define REPLAY_PIN_PRI        19
+#define REPLAY_PIN_SEC        18
+#define REPLAY_PIN_THIRD      3
+
+struct wheel_cursor {
+  const replay_wheel *pWheel;
+  uint16_t index;       //Edge index within the current span
+  uint32_t spanStart;   //Absolute angle of the start of the current span
+  uint32_t angle;       //Absolute angle of the edge the cursor points at
+  uint8_t level;        //Pin level after the edge
+};
+
+static inline uint16_t edgesPerSpan(const replay_wheel &wheel)
+{
+  return wheel.teeth > 0U ? (uint16_t)(wheel.teeth * 2U) : wheel.edgeCount;
+}
+
+static bool isMissingTooth(const replay_wheel &wheel, uint16_t position)
+{
+  for (uint8_t i = 0; i < wheel.missingCount; ++i)
+  {
+    if (wheel.pMissing[i] == position) { return true; }
+  }
+  return false;
+}
+
+//Load the angle and level of the edge at the cursor index. Returns false if there is no edge there (ie a missing tooth)
+static bool loadEdge(wheel_cursor &cursor)
+{
+  const replay_wheel &wheel = *cursor.pWheel;
+  if (wheel.teeth > 0U)
+  {
+    uint16_t position = cursor.index >> 1U;
+    if (isMissingTooth(wheel, position)) { return false; }
+
+    uint16_t pitch = wheel.span / wheel.teeth;
+    uint16_t width = (wheel.width == 0U) ? (pitch >> 1U) : wheel.width;
+    bool isFalling = (cursor.index & 1U) == 1U;
+    cursor.angle = cursor.spanStart + wheel.offset + ((uint32_t)position * pitch) + (isFalling ? width : 0U);
+    cursor.level = isFalling ? LOW : HIGH;
+  }
+  else
+  {
+    cursor.angle = cursor.spanStart + wheel.pEdges[cursor.index].angle;
+    cursor.level = wheel.pEdges[cursor.index].level;
+  }
+  return true;
+}
+
+static void advanceCursor(wheel_cursor &cursor)
+{
+  do
+  {
+    ++cursor.index;
+    if (cursor.index >= edgesPerSpan(*cursor.pWheel))
+    {
+      cursor.index = 0;
+      cursor.spanStart += cursor.pWheel->span;
+    }
+  } while (!loadEdge(cursor));
+}
+
+//Initialise the cursor to the first edge of the wheel and return the pin level prior to that edge
+static uint8_t startCursor(wheel_cursor &cursor, const replay_wheel &wheel)
+{
+  cursor.pWheel = &wheel;
+  cursor.index = 0;
+  cursor.spanStart = 0;
+  if (!loadEdge(cursor)) { advanceCursor(cursor); }
+  return cursor.level == HIGH ? LOW : HIGH;
+}
+
+static inline bool isHandledEdge(uint8_t edgeMode, uint8_t level)
+{
+  return (edgeMode == CHANGE)
+      || ((edgeMode == RISING) && (level == HIGH))
+      || ((edgeMode == FALLING) && (level == LOW));
+}
+
+//Equivalent of the stalled engine path in the main loop, so that each run starts from the same (unsynced) state
+static void resetDecoderState(void)
+{
+  currentStatus.RPM = 0;
+  currentStatus.hasSync = false;
+  BIT_CLEAR(currentStatus.status3, BIT_STATUS3_HALFSYNC);
+  BIT_CLEAR(currentStatus.engine, BIT_ENGINE_CRANK);
+  currentStatus.startRevolutions = 0;
+  toothLastToothTime = 0;
+  toothLastSecToothTime = 0;
+  toothLastMinusOneToothTime = 0;
+  toothLastMinusOneSecToothTime = 0;
+  toothSystemCount = 0;
+  secondaryToothCount = 0;
+  revolutionOne = false;
+}
+
+static void setupReplayPins(void)
+{
+  pinTrigger = REPLAY_PIN_PRI;
+  pinTrigger2 = REPLAY_PIN_SEC;
+  pinTrigger3 = REPLAY_PIN_THIRD;
+
+  //Selects the handlers and edges for the configured pattern. The interrupts are not needed as the handlers are called directly
+  initialiseTriggers();
+  detachInterrupt(digitalPinToInterrupt(pinTrigger));
+  detachInterrupt(digitalPinToInterrupt(pinTrigger2));
+  detachInterrupt(digitalPinToInterrupt(pinTrigger3));
+
+  pinMode(pinTrigger, OUTPUT);
+  pinMode(pinTrigger2, OUTPUT);
+#if defined(CORE_AVR)
+  triggerPri_pin_port = portInputRegister(digitalPinToPort(pinTrigger));
+  triggerPri_pin_mask = digitalPinToBitMask(pinTrigger);
+  triggerSec_pin_port = portInputRegister(digitalPinToPort(pinTrigger2));
+  triggerSec_pin_mask = digitalPinToBitMask(pinTrigger2);
+#endif
+}
+
+//The cost (in nS) of the micros() calls used to time each handler
+static uint32_t measureTimingOverhead(void)
+{
+  const uint8_t samples = 64U;
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < samples; ++i)
+  {
+    uint32_t start = micros();
+    total += micros() - start;
+  }
+  return (total * 1000UL) / samples;
+}
+
+static inline uint32_t timeHandler(void (*pHandler)(void))
+{
+  uint32_t start = micros();
+  pHandler();
+  return micros() - start;
+}
+
+replay_result replayTriggerPattern(const replay_pattern &pattern, const replay_params &params)
+{
+  replay_result result;
+  memset(&result, 0, sizeof(result));
+
+  pattern.configure();
+  resetDecoderState();
+  setupReplayPins();
+
+  bool hasSecondary = pattern.secondary.span > 0U;
+  wheel_cursor primary;
+  wheel_cursor secondary;
+  digitalWrite(pinTrigger, startCursor(primary, pattern.primary));
+  if (hasSecondary) { digitalWrite(pinTrigger2, startCursor(secondary, pattern.secondary)); }
+  else { digitalWrite(pinTrigger2, LOW); }
+
+  const uint32_t endAngle = params.cycles * REPLAY_CYCLE_ANGLE;
+  const uint32_t overheadNs = measureTimingOverhead();
+  const uint8_t startSyncLossCounter = currentStatus.syncLossCounter;
+  float rpm = params.rpm;
+  float simMicros = 0.0f;
+  uint32_t lastAngle = 0;
+  uint32_t totalMicros = 0;
+  uint16_t primaryEdges = 0;
+  bool isSynced = false;
+  randomSeed(1);
+
+  const uint32_t startTime = micros() + REPLAY_LEAD_IN;
+  while (true)
+  {
+    bool isPrimary = !hasSecondary || (primary.angle <= secondary.angle);
+    wheel_cursor &cursor = isPrimary ? primary : secondary;
+    if (cursor.angle >= endAngle) { break; }
+
+    //Move the simulated engine forward to this edge. The engine turns 6 degrees per second per RPM
+    float edgeMicros = ((float)(cursor.angle - lastAngle) * (MICROS_PER_SEC / 60.0f)) / rpm;
+    simMicros += edgeMicros;
+    rpm += ((float)params.rpmPerSec * edgeMicros) / MICROS_PER_SEC;
+    if (rpm < REPLAY_MIN_RPM) { rpm = REPLAY_MIN_RPM; }
+    lastAngle = cursor.angle;
+
+    int32_t jitter = 0;
+    if (params.noiseMicros > 0U) { jitter = random(-(long)params.noiseMicros, (long)params.noiseMicros + 1L); }
+    uint32_t targetTime = startTime + (uint32_t)simMicros + jitter;
+
+    if ((int32_t)(micros() - targetTime) > (int32_t)REPLAY_LATE_TOLERANCE) { result.lateEdges++; }
+    while ((int32_t)(micros() - targetTime) < 0) { /* Wait for the edge */ }
+
+    digitalWrite(isPrimary ? pinTrigger : pinTrigger2, cursor.level);
+    uint8_t edgeMode = isPrimary ? primaryTriggerEdge : secondaryTriggerEdge;
+    if (isHandledEdge(edgeMode, cursor.level))
+    {
+      uint32_t handlerMicros = timeHandler(isPrimary ? triggerHandler : triggerSecondaryHandler);
+      totalMicros += handlerMicros;
+      if (handlerMicros > result.maxEdgeMicros) { result.maxEdgeMicros = handlerMicros; }
+      result.edges++;
+
+      if (isPrimary)
+      {
+        primaryEdges++;
+        if ((primaryEdges % REPLAY_RPM_INTERVAL) == 0U) { currentStatus.RPM = getRPM(); }
+      }
+
+      if (currentStatus.hasSync == true)
+      {
+        if (result.syncTeeth == 0U) { result.syncTeeth = primaryEdges; }
+        isSynced = true;
+      }
+      else if (isSynced == true)
+      {
+        result.syncLosses++;
+        isSynced = false;
+      }
+    }
+
+    advanceCursor(cursor);
+  }
+
+  if (result.edges > 0U)
+  {
+    uint32_t totalNs = totalMicros * 1000UL;
+    uint32_t overheadTotalNs = overheadNs * result.edges;
+    result.nsPerEdge = (totalNs > overheadTotalNs ? totalNs - overheadTotalNs : 0UL) / result.edges;
+  }
+  result.decoderSyncLosses = (uint8_t)(currentStatus.syncLossCounter - startSyncLossCounter);
+  result.finalRPM = getRPM();
+
+  return result;
+}
+
+void reportReplayResult(const replay_pattern &pattern, const replay_params &params, const replay_result &result)
+{
+  char buffer[192];
+  sprintf(buffer, "%s @%" PRIu16 "rpm %" PRId16 "rpm/s +-%" PRIu16 "uS: %" PRIu32 " edges, %" PRIu32 "ns/edge (max %" PRIu32 "uS), sync after %" PRIu16 " teeth, %" PRIu16 " sync losses (%" PRIu16 " decoder), %" PRIu16 " late, %" PRIu16 "rpm",
+    pattern.name, params.rpm, params.rpmPerSec, params.noiseMicros,
+    result.edges, result.nsPerEdge, result.maxEdgeMicros,
+    result.syncTeeth, result.syncLosses, result.decoderSyncLosses,
+    result.lateEdges, result.finalRPM);
+  TEST_MESSAGE(buffer);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+Trigger wheel replay harness.
+
+Synthesises the crank/cam edge stream of a trigger wheel at a given engine speed, acceleration
+and timing noise, drives the trigger input pins to the matching levels and calls the decoder
+handlers that initialiseTriggers() selected for the configured pattern.
+The edges are replayed in real time (micros()), so the decoders run exactly as they would from
+the trigger interrupts.
+
+All angles are in tenths of a crank degree.
+*/
+
+/** A single edge of a non evenly spaced wheel. */
+struct replay_edge {
+  uint16_t angle;   ///< Crank angle of the edge within the wheel span
+  uint8_t level;    ///< Pin level after the edge (HIGH or LOW)
+};
+
+/** Description of the signal on one trigger input.
+ * Either an evenly spaced (optionally missing tooth) wheel, or an explicit list of edges.
+ * The pattern repeats every span tenths of a degree (3600 for a crank wheel, 7200 for a cam wheel)
+ */
+struct replay_wheel {
+  uint16_t span;                ///< Crank angle covered by one repetition of the wheel
+  uint16_t teeth;               ///< Number of tooth positions (including missing teeth) on an evenly spaced wheel. 0 if pEdges is used
+  uint16_t offset;              ///< Angle of the rising edge of the first tooth position on an evenly spaced wheel
+  uint16_t width;               ///< Tooth width on an evenly spaced wheel. 0 = 50% duty
+  const uint8_t *pMissing;      ///< Tooth positions that have no tooth (evenly spaced wheels)
+  uint8_t missingCount;
+  const replay_edge *pEdges;    ///< Edges in ascending angle order, each within [0, span)
+  uint8_t edgeCount;
+};
+
+/** A complete trigger pattern to be replayed */
+struct replay_pattern {
+  const char *name;
+  void (*configure)(void);      ///< Sets the config page values (TrigPattern etc) needed by the decoder
+  replay_wheel primary;
+  replay_wheel secondary;       ///< span==0 if the pattern has no secondary input
+};
+
+/** Engine conditions for a replay run */
+struct replay_params {
+  uint16_t rpm;                 ///< Engine speed at the start of the run
+  int16_t rpmPerSec;            ///< Acceleration (or deceleration) applied over the run
+  uint16_t noiseMicros;         ///< Maximum random timing jitter added to each edge
+  uint16_t cycles;              ///< Number of 720 degree cycles to replay
+};
+
+/** Measurements taken over a replay run */
+struct replay_result {
+  uint32_t edges;               ///< Number of edges passed to the decoder handlers
+  uint32_t nsPerEdge;           ///< Mean execution time of the decoder handlers
+  uint32_t maxEdgeMicros;       ///< Longest single handler execution
+  uint16_t syncTeeth;           ///< Primary edges processed before sync was first declared. 0 if sync was never gained
+  uint16_t syncLosses;          ///< Number of times sync was lost after it was first gained
+  uint16_t decoderSyncLosses;   ///< Increase of currentStatus.syncLossCounter over the run
+  uint16_t lateEdges;           ///< Edges that the harness could not replay on time (Harness overrun, not a decoder fault)
+  uint16_t finalRPM;            ///< RPM reported by the decoder at the end of the run
+};
+
+replay_result replayTriggerPattern(const replay_pattern &pattern, const replay_params &params);
+void reportReplayResult(const replay_pattern &pattern, const replay_params &params, const replay_result &result);
+
+void testTriggerReplay(void);
@@ -9,6 +9,8 @@
 #include "Nissan360/Nissan360.h"
 #include "FordST170/FordST170.h"
 #include "NGC/test_ngc.h"
+#include "gap_pattern/gap_pattern.h"
+#include "replay/trigger_replay.h"
 
 void setup()
 {
@@ -26,6 +28,8 @@ void setup()
     testNissan360();
     testFordST170();
     testNGC();
+    testGapPattern();
+    testTriggerReplay();
 
     UNITY_END(); // stop unit testing
 }
@@ -0,0 +1,21 @@
+/** @file
+ * A minimal host stand in for the Arduino core, just enough to build the flash EEPROM emulation natively.
+ */
+#ifndef FAKE_ARDUINO_H
+#define FAKE_ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define OUTPUT 1
+
+//No real IO on the host
+static inline void pinMode(uint8_t, uint8_t) { }
+static inline void digitalWrite(uint8_t, uint8_t) { }
+
+#endif
@@ -0,0 +1,25 @@
+/** @file
+ * A host stand in for the Arduino SPI library. The flash EEPROM tests never talk to a real SPI flash chip.
+ */
+#ifndef FAKE_SPI_H
+#define FAKE_SPI_H
+
+#include <Arduino.h>
+
+#define SS 10
+#define MSBFIRST 1
+#define SPI_MODE0 0
+
+class SPISettings {
+public:
+  SPISettings(uint32_t, uint8_t, uint8_t) { }
+};
+
+class SPIClass {
+public:
+  void beginTransaction(SPISettings) { }
+  uint8_t transfer(uint8_t) { return 0xFFU; }
+};
+extern SPIClass SPI;
+
+#endif
@@ -0,0 +1 @@
+#include "src/SPIAsEEPROM/SPIAsEEPROM.cpp"
@@ -0,0 +1,177 @@
+/*
+Tests the flash EEPROM emulation (SPIAsEEPROM) against a fake NOR flash in RAM. Random updates are checked against
+a plain copy of the expected EEPROM contents, both with the RAM mirror (As the SPI flash backend) and without it
+(As the memory mapped internal flash backends).
+*/
+#include <unity.h>
+#include "src/SPIAsEEPROM/SPIAsEEPROM.h"
+
+#define FAKE_FLASH_SECTORS      8UL
+#define FAKE_FLASH_SECTOR_SIZE  1024UL
+#define FAKE_EEPROM_PER_SECTOR  31UL   //32 byte sections. 28 writes to each byte before its sector is erased
+#define FAKE_EEPROM_SIZE        (FAKE_FLASH_SECTORS * FAKE_EEPROM_PER_SECTOR)
+#define RANDOM_UPDATES          20000UL
+
+SPIClass SPI;
+
+//Fake NOR flash. Erase sets all bits, writes can only clear them
+static byte fakeFlash[FAKE_FLASH_SECTORS * FAKE_FLASH_SECTOR_SIZE];
+static uint32_t fakeFlashReads;
+static uint32_t fakeFlashWrites;
+static uint32_t fakeFlashBadWrites; //Writes that needed a bit set without an erase
+
+static const EEPROM_Emulation_Config fakeConfig = { FAKE_FLASH_SECTORS, FAKE_FLASH_SECTOR_SIZE, FAKE_EEPROM_PER_SECTOR, 0UL };
+
+class FakeFlash_EEPROM_Class : public FLASH_EEPROM_BaseClass
+{
+  public:
+    FakeFlash_EEPROM_Class(bool useMirror) : FLASH_EEPROM_BaseClass(fakeConfig)
+    {
+      if (useMirror)
+      {
+        _mirror = _mirrorBuffer;
+        _mirrorSize = sizeof(_mirrorBuffer);
+      }
+    }
+
+    int8_t readFlashBytes(uint32_t address, byte *buf, uint32_t length)
+    {
+      fakeFlashReads++;
+      memcpy(buf, &fakeFlash[address], length);
+      return 0;
+    }
+
+    int8_t writeFlashBytes(uint32_t address, byte *buf, uint32_t length)
+    {
+      fakeFlashWrites++;
+      for (uint32_t i = 0; i < length; i++)
+      {
+        if ((buf[i] & ~fakeFlash[address + i]) != 0U) { fakeFlashBadWrites++; }
+        fakeFlash[address + i] &= buf[i];
+      }
+      return 0;
+    }
+
+    int8_t eraseFlashSector(uint32_t address, uint32_t length)
+    {
+      memset(&fakeFlash[address], 0xFF, length);
+      return 0;
+    }
+
+  private:
+    byte _mirrorBuffer[FLASH_EEPROM_MIRROR_SIZE];
+};
+
+static byte expected[FAKE_EEPROM_SIZE];
+
+/** Fixed sequence, so that a failure can be repeated */
+static uint32_t randomState;
+static uint32_t nextRandom(void)
+{
+  randomState = (randomState * 1103515245UL) + 12345UL;
+  return (randomState >> 8U) & 0xFFFFFFUL;
+}
+
+static void resetFakeFlash(void)
+{
+  memset(fakeFlash, 0x00, sizeof(fakeFlash)); //Unformatted
+  fakeFlashReads = 0;
+  fakeFlashWrites = 0;
+  fakeFlashBadWrites = 0;
+  memset(expected, 0xFF, sizeof(expected));
+  randomState = 1UL;
+}
+
+static void assertEEPROMContents(FakeFlash_EEPROM_Class &eeprom)
+{
+  for (uint16_t address = 0; address < FAKE_EEPROM_SIZE; address++)
+  {
+    TEST_ASSERT_EQUAL_HEX8_MESSAGE(expected[address], eeprom.read(address), "EEPROM byte does not match");
+  }
+}
+
+static void randomUpdates(bool useMirror)
+{
+  resetFakeFlash();
+  FakeFlash_EEPROM_Class eeprom(useMirror);
+  TEST_ASSERT_TRUE(eeprom.initialize(true));
+  TEST_ASSERT_EQUAL_UINT16(FAKE_EEPROM_SIZE, eeprom.length());
+  assertEEPROMContents(eeprom);
+
+  for (uint32_t i = 0; i < RANDOM_UPDATES; i++)
+  {
+    uint16_t address = nextRandom() % FAKE_EEPROM_SIZE;
+    //Mostly small values, so that some updates write the value already stored
+    byte value = (byte)(nextRandom() % 8U);
+    if ((nextRandom() % 4U) == 0U) { value = (byte)nextRandom(); }
+
+    eeprom.update(address, value);
+    expected[address] = value;
+
+    uint16_t checkAddress = nextRandom() % FAKE_EEPROM_SIZE;
+    TEST_ASSERT_EQUAL_HEX8_MESSAGE(expected[checkAddress], eeprom.read(checkAddress), "EEPROM byte does not match");
+
+    //As after a read of the whole tune from flash
+    if ((i % 1000UL) == 999UL) { eeprom.clearMirror(); }
+  }
+
+  assertEEPROMContents(eeprom);
+  TEST_ASSERT_EQUAL_UINT32(0, fakeFlashBadWrites);
+
+  //Power cycle. A new instance only has the flash to go on
+  FakeFlash_EEPROM_Class restarted(useMirror);
+  TEST_ASSERT_TRUE(restarted.initialize(true));
+  assertEEPROMContents(restarted);
+}
+
+static void test_flashEEPROM_randomUpdates_mirror(void)
+{
+  randomUpdates(true);
+}
+
+static void test_flashEEPROM_randomUpdates_noMirror(void)
+{
+  randomUpdates(false);
+}
+
+static void test_flashEEPROM_mirror_bulkRead(void)
+{
+  resetFakeFlash();
+  FakeFlash_EEPROM_Class eeprom(true);
+  TEST_ASSERT_TRUE(eeprom.initialize(true));
+
+  //A whole sector fits in a single bulk read
+  fakeFlashReads = 0;
+  for (uint16_t address = 0; address < FAKE_EEPROM_PER_SECTOR; address++) { (void)eeprom.read(address); }
+  TEST_ASSERT_EQUAL_UINT32(1, fakeFlashReads);
+
+  //Writing the value already held does not touch the flash
+  eeprom.update(3, 0x55);
+  fakeFlashReads = 0;
+  fakeFlashWrites = 0;
+  eeprom.update(3, 0x55);
+  TEST_ASSERT_EQUAL_UINT32(0, fakeFlashReads);
+  TEST_ASSERT_EQUAL_UINT32(0, fakeFlashWrites);
+  TEST_ASSERT_EQUAL_HEX8(0x55, eeprom.read(3));
+}
+
+static void test_flashEEPROM_noMirror_readsFlash(void)
+{
+  resetFakeFlash();
+  FakeFlash_EEPROM_Class eeprom(false);
+  TEST_ASSERT_TRUE(eeprom.initialize(true));
+  eeprom.update(3, 0x55);
+
+  //Address translation, then the value
+  fakeFlashReads = 0;
+  TEST_ASSERT_EQUAL_HEX8(0x55, eeprom.read(3));
+  TEST_ASSERT_EQUAL_UINT32(2, fakeFlashReads);
+}
+
+void testFlashEEPROM(void)
+{
+  RUN_TEST(test_flashEEPROM_randomUpdates_mirror);
+  RUN_TEST(test_flashEEPROM_randomUpdates_noMirror);
+  RUN_TEST(test_flashEEPROM_mirror_bulkRead);
+  RUN_TEST(test_flashEEPROM_noMirror_readsFlash);
+}
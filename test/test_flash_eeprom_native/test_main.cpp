@@ -0,0 +1,11 @@
+#include <unity.h>
+
+extern void testFlashEEPROM(void);
+
+int main(void) {
+  UNITY_BEGIN();
+
+  testFlashEEPROM();
+
+  return UNITY_END();
+}
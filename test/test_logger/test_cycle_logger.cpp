@@ -0,0 +1,158 @@
+#include <unity.h>
+#include "globals.h"
+#include "cycle_logger.h"
+#include "decoders.h"
+#include "logger.h"
+#include "init.h"
+
+static void test_cycleLog_inactive(void)
+{
+  resetCycleLog(CYCLE_LOG_PER_TEETH, 1U);
+  captureCycleLogTooth();
+
+  cycleLogEntry entry;
+  TEST_ASSERT_FALSE(readCycleLogEntry(entry));
+
+  //Activating with the logger off is ignored
+  resetCycleLog(CYCLE_LOG_OFF, 1U);
+  setCycleLogActive(true);
+  TEST_ASSERT_FALSE(isCycleLogActive());
+}
+
+static void test_cycleLog_per_teeth(void)
+{
+  resetCycleLog(CYCLE_LOG_PER_TEETH, 3U);
+  setCycleLogActive(true);
+  currentStatus.RPM = 4500U;
+  currentStatus.MAP = 87;
+  currentStatus.PW1 = 6200U;
+  currentStatus.advance = -4;
+  currentStatus.knockCount = 2U;
+  currentStatus.knockRetard = 3U;
+  currentStatus.status2 = 0x42U;
+  toothLastToothTime = 123456UL;
+
+  cycleLogEntry entry;
+  captureCycleLogTooth();
+  captureCycleLogTooth();
+  TEST_ASSERT_FALSE(readCycleLogEntry(entry));
+  captureCycleLogTooth();
+  TEST_ASSERT_TRUE(readCycleLogEntry(entry));
+  TEST_ASSERT_FALSE(readCycleLogEntry(entry));
+
+  TEST_ASSERT_EQUAL_UINT32(123456UL, entry.toothTime);
+  TEST_ASSERT_EQUAL_UINT16(4500U, entry.RPM);
+  TEST_ASSERT_EQUAL_UINT16(87U, entry.MAP);
+  TEST_ASSERT_EQUAL_UINT16(6200U, entry.PW1);
+  TEST_ASSERT_EQUAL_INT8(-4, entry.advance);
+  TEST_ASSERT_EQUAL_UINT8(2U, entry.knockCount);
+  TEST_ASSERT_EQUAL_UINT8(3U, entry.knockRetard);
+  TEST_ASSERT_EQUAL_UINT8(0x42U, entry.status2);
+  setCycleLogActive(false);
+}
+
+static void test_cycleLog_per_cycle(void)
+{
+  configPage2.strokes = FOUR_STROKE;
+  currentStatus.startRevolutions = 10U;
+  resetCycleLog(CYCLE_LOG_PER_CYCLE, 0U);
+  setCycleLogActive(true);
+
+  cycleLogEntry entry;
+  captureCycleLogTooth();
+  currentStatus.startRevolutions = 11U;
+  captureCycleLogTooth();
+  TEST_ASSERT_FALSE(readCycleLogEntry(entry));
+
+  //1 snapshot on the tooth that completes the cycle, none on the following teeth
+  currentStatus.startRevolutions = 12U;
+  captureCycleLogTooth();
+  captureCycleLogTooth();
+  TEST_ASSERT_TRUE(readCycleLogEntry(entry));
+  TEST_ASSERT_EQUAL_UINT16(12U, entry.revolution);
+  TEST_ASSERT_FALSE(readCycleLogEntry(entry));
+
+  configPage2.strokes = TWO_STROKE;
+  currentStatus.startRevolutions = 13U;
+  captureCycleLogTooth();
+  TEST_ASSERT_TRUE(readCycleLogEntry(entry));
+  TEST_ASSERT_EQUAL_UINT16(13U, entry.revolution);
+  configPage2.strokes = FOUR_STROKE;
+  setCycleLogActive(false);
+}
+
+static void test_cycleLog_overrun(void)
+{
+  resetCycleLog(CYCLE_LOG_PER_TEETH, 1U);
+  setCycleLogActive(true);
+
+  //1 slot is always kept free to tell a full buffer from an empty one
+  for(uint8_t tooth = 0U; tooth < CYCLE_LOG_BUFFER_SIZE + 2U; tooth++)
+  {
+    currentStatus.startRevolutions = tooth;
+    captureCycleLogTooth();
+  }
+  TEST_ASSERT_EQUAL_UINT16(3U, getCycleLogOverruns());
+
+  //The oldest snapshots are kept
+  cycleLogEntry entry;
+  for(uint8_t tooth = 0U; tooth < CYCLE_LOG_BUFFER_SIZE - 1U; tooth++)
+  {
+    TEST_ASSERT_TRUE(readCycleLogEntry(entry));
+    TEST_ASSERT_EQUAL_UINT16(tooth, entry.revolution);
+  }
+  TEST_ASSERT_FALSE(readCycleLogEntry(entry));
+  setCycleLogActive(false);
+}
+
+#if defined(CORE_AVR)
+//A cycle log started at key on must survive the stalled engine path in the main loop, which calls initialiseTriggers() on every pass
+static void test_cycleLog_stall(void)
+{
+  configPage4.TrigPattern = DECODER_MISSING_TOOTH;
+  configPage4.triggerTeeth = 36;
+  configPage4.triggerMissingTeeth = 1;
+  configPage4.TrigEdge = 0; //Rising
+  configPage4.TrigSpeed = CRANK_SPEED;
+  configPage4.triggerFilter = TRIGGER_FILTER_OFF;
+  configPage6.vvtEnabled = 0;
+  configPage10.vvt2Enabled = 0;
+  currentStatus.toothLogEnabled = false;
+  currentStatus.compositeTriggerUsed = 0U;
+  pinTrigger = 19; //INT2
+  pinTrigger2 = 18; //INT3
+  pinTrigger3 = 3; //INT5
+  initialiseTriggers();
+
+  startCycleLogger(CYCLE_LOG_PER_TEETH, 1U);
+  initialiseTriggers(); //The stall path
+
+  //AVR external interrupts also fire when the pin is an output, which stands in for the crank signal
+  pinMode(pinTrigger, OUTPUT);
+  for(uint8_t tooth = 0U; tooth < 3U; tooth++)
+  {
+    digitalWrite(pinTrigger, LOW);
+    delayMicroseconds(1000);
+    digitalWrite(pinTrigger, HIGH);
+    delayMicroseconds(1000);
+  }
+  stopCycleLogger();
+  detachInterrupt(digitalPinToInterrupt(pinTrigger));
+  detachInterrupt(digitalPinToInterrupt(pinTrigger2));
+  detachInterrupt(digitalPinToInterrupt(pinTrigger3));
+
+  cycleLogEntry entry;
+  TEST_ASSERT_TRUE(readCycleLogEntry(entry));
+}
+#endif
+
+void testCycleLogger(void)
+{
+  RUN_TEST(test_cycleLog_inactive);
+  RUN_TEST(test_cycleLog_per_teeth);
+  RUN_TEST(test_cycleLog_per_cycle);
+  RUN_TEST(test_cycleLog_overrun);
+#if defined(CORE_AVR)
+  RUN_TEST(test_cycleLog_stall);
+#endif
+}
@@ -0,0 +1,177 @@
+#include <unity.h>
+#include "globals.h"
+#include "logger.h"
+#include "errors.h"
+#include "decoders.h"
+
+#define LIVE_DATA_SIZE      131U  //LOG_ENTRY_SIZE is reduced when unit testing
+#define LIVE_DATA_FREE_RAM  28U
+#define LIVE_DATA_ERRORS    75U
+
+static void setupLiveData(void)
+{
+  currentStatus.RPM = 0x1234;
+  currentStatus.coolant = 50;
+  currentStatus.fuelTemp = -10;
+  currentStatus.AEamount = 300;
+  currentStatus.boostDuty = 5600;
+  currentStatus.loopsPerSecond = 70000;
+  currentStatus.canin[15] = 0xBEEF;
+  currentStatus.knockRetard = 99;
+  currentStatus.toothLogOverruns = 3;
+}
+
+static void test_getTSLogEntries_fields(void)
+{
+  setupLiveData();
+  byte liveData[LIVE_DATA_SIZE];
+  getTSLogEntries(0, LIVE_DATA_SIZE, liveData);
+
+  TEST_ASSERT_EQUAL_UINT8(0x34, liveData[14]);
+  TEST_ASSERT_EQUAL_UINT8(0x12, liveData[15]);
+  TEST_ASSERT_EQUAL_UINT8(50 + CALIBRATION_TEMPERATURE_OFFSET, liveData[7]);
+  TEST_ASSERT_EQUAL_UINT8(-10 + CALIBRATION_TEMPERATURE_OFFSET, liveData[116]);
+  TEST_ASSERT_EQUAL_UINT8(150, liveData[16]);
+  TEST_ASSERT_EQUAL_UINT8(56, liveData[31]);
+  TEST_ASSERT_EQUAL_UINT16(60000, word(liveData[27], liveData[26]));
+  TEST_ASSERT_EQUAL_UINT8(0xEF, liveData[72]);
+  TEST_ASSERT_EQUAL_UINT8(0xBE, liveData[73]);
+  TEST_ASSERT_EQUAL_UINT8(99, liveData[129]);
+  TEST_ASSERT_EQUAL_UINT8(3, liveData[130]);
+}
+
+static void test_getTSLogEntries_matches_single_bytes(void)
+{
+  setupLiveData();
+  byte liveData[LIVE_DATA_SIZE];
+
+  //Start and end part way through 2 byte fields
+  getTSLogEntries(15, 20, liveData);
+  for(uint16_t byteNum = 15; byteNum < 35U; byteNum++)
+  {
+    if( (byteNum == LIVE_DATA_FREE_RAM) || (byteNum == LIVE_DATA_FREE_RAM+1U) || (byteNum == LIVE_DATA_ERRORS) ) { continue; }
+    TEST_ASSERT_EQUAL_UINT8(getTSLogEntry(byteNum), liveData[byteNum - 15U]);
+  }
+}
+
+static void test_getTSLogEntries_past_end(void)
+{
+  setupLiveData();
+  byte liveData[4] = { 1, 1, 1, 1 };
+  getTSLogEntries(LIVE_DATA_SIZE - 1U, sizeof(liveData), liveData);
+
+  TEST_ASSERT_EQUAL_UINT8(3, liveData[0]);
+  TEST_ASSERT_EQUAL_UINT8(0, liveData[1]);
+  TEST_ASSERT_EQUAL_UINT8(0, liveData[3]);
+  TEST_ASSERT_EQUAL_UINT8(0, getTSLogEntry(LIVE_DATA_SIZE));
+}
+
+static void test_getPassiveTSLogEntry(void)
+{
+  setupLiveData();
+  currentStatus.freeRAM = 0x4321;
+
+  //Same values as TunerStudio sees, except that free RAM is not measured again
+  TEST_ASSERT_EQUAL_UINT8(getTSLogEntry(14), getPassiveTSLogEntry(14));
+  TEST_ASSERT_EQUAL_UINT8(getTSLogEntry(116), getPassiveTSLogEntry(116));
+  TEST_ASSERT_EQUAL_UINT8(0x21, getPassiveTSLogEntry(LIVE_DATA_FREE_RAM));
+  TEST_ASSERT_EQUAL_UINT8(0x43, getPassiveTSLogEntry(LIVE_DATA_FREE_RAM+1U));
+  TEST_ASSERT_EQUAL_UINT16(0x4321, currentStatus.freeRAM);
+  TEST_ASSERT_EQUAL_UINT8(getFirstError(), getPassiveTSLogEntry(LIVE_DATA_ERRORS));
+}
+
+static void test_is2ByteEntry(void)
+{
+  TEST_ASSERT_TRUE(is2ByteEntry(14));   //RPM
+  TEST_ASSERT_FALSE(is2ByteEntry(15));  //RPM high byte
+  TEST_ASSERT_TRUE(is2ByteEntry(72));   //canin[15]
+  TEST_ASSERT_FALSE(is2ByteEntry(7));   //coolant
+  TEST_ASSERT_TRUE(is2ByteEntry(125));  //actualDwell
+  TEST_ASSERT_FALSE(is2ByteEntry(LIVE_DATA_SIZE));
+}
+
+static void test_readyPartialToothLog(void)
+{
+  BIT_CLEAR(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY);
+  toothHistoryBuffer = 0U;
+  toothHistoryIndex = TOOTH_LOG_SIZE - 1U;
+
+  //The partial buffer is handed over and logging continues at the start of the other one
+  TEST_ASSERT_EQUAL_UINT8(TOOTH_LOG_SIZE - 1U, readyPartialToothLog());
+  TEST_ASSERT_TRUE(BIT_CHECK(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY));
+  TEST_ASSERT_EQUAL_UINT8(0U, getToothLogReadyBuffer());
+  TEST_ASSERT_EQUAL_UINT8(1U, toothHistoryBuffer);
+  TEST_ASSERT_EQUAL_UINT(0U, toothHistoryIndex);
+
+  //A buffer that is already ready is left alone
+  toothHistoryIndex = 0U;
+  TEST_ASSERT_EQUAL_UINT8(TOOTH_LOG_SIZE, readyPartialToothLog());
+  TEST_ASSERT_EQUAL_UINT8(0U, getToothLogReadyBuffer());
+}
+
+/** Stands in for the decoder. Every tooth is valid */
+static void fakeTriggerHandler(void)
+{
+  BIT_SET(decoderState, BIT_DECODER_VALID_TRIGGER);
+}
+
+static void logTeeth(uint8_t teeth, unsigned long firstGap)
+{
+  for(uint8_t tooth = 0; tooth < teeth; tooth++)
+  {
+    curGap = firstGap + tooth;
+    loggerPrimaryISR();
+  }
+}
+
+static void test_toothLog_bufferSwap(void)
+{
+  void (*savedTriggerHandler)(void) = triggerHandler;
+  triggerHandler = fakeTriggerHandler;
+  primaryTriggerEdge = CHANGE;
+  currentStatus.toothLogEnabled = true;
+  currentStatus.compositeTriggerUsed = 0;
+  currentStatus.toothLogOverruns = 0;
+  BIT_CLEAR(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY);
+  toothHistoryBuffer = 0U;
+  toothHistoryIndex = 0U;
+
+  //A full buffer is handed over to comms and logging carries on in the other one
+  logTeeth(TOOTH_LOG_SIZE, 1000UL);
+  TEST_ASSERT_TRUE(BIT_CHECK(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY));
+  TEST_ASSERT_EQUAL_UINT8(0U, getToothLogReadyBuffer());
+  TEST_ASSERT_EQUAL_UINT8(1U, toothHistoryBuffer);
+  TEST_ASSERT_EQUAL_UINT(0U, toothHistoryIndex);
+  TEST_ASSERT_EQUAL_UINT32(1000UL, toothHistory[0][0]);
+  TEST_ASSERT_EQUAL_UINT32(1000UL + TOOTH_LOG_SIZE - 1U, toothHistory[0][TOOTH_LOG_SIZE - 1U]);
+  TEST_ASSERT_EQUAL_UINT8(0U, currentStatus.toothLogOverruns);
+
+  //The ready buffer has not been sent, so the next one is refilled rather than handed over
+  logTeeth(TOOTH_LOG_SIZE, 2000UL);
+  TEST_ASSERT_EQUAL_UINT8(1U, currentStatus.toothLogOverruns);
+  TEST_ASSERT_EQUAL_UINT8(0U, getToothLogReadyBuffer());
+  TEST_ASSERT_EQUAL_UINT(0U, toothHistoryIndex);
+  TEST_ASSERT_EQUAL_UINT32(1000UL, toothHistory[0][0]);
+
+  //Once comms has sent it, the buffers swap again
+  BIT_CLEAR(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY);
+  logTeeth(TOOTH_LOG_SIZE, 3000UL);
+  TEST_ASSERT_TRUE(BIT_CHECK(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY));
+  TEST_ASSERT_EQUAL_UINT8(1U, getToothLogReadyBuffer());
+  TEST_ASSERT_EQUAL_UINT32(3000UL, toothHistory[1][0]);
+  TEST_ASSERT_EQUAL_UINT8(1U, currentStatus.toothLogOverruns);
+
+  currentStatus.toothLogEnabled = false;
+  triggerHandler = savedTriggerHandler;
+}
+
+void testLogger(void)
+{
+  RUN_TEST(test_getTSLogEntries_fields);
+  RUN_TEST(test_getTSLogEntries_matches_single_bytes);
+  RUN_TEST(test_getTSLogEntries_past_end);
+  RUN_TEST(test_getPassiveTSLogEntry);
+  RUN_TEST(test_is2ByteEntry);
+  RUN_TEST(test_readyPartialToothLog);
+  RUN_TEST(test_toothLog_bufferSwap);
+}
@@ -0,0 +1,11 @@
+#include <unity.h>
+
+extern void testMAPSampling(void);
+
+int main(void) {
+  UNITY_BEGIN();
+
+  testMAPSampling();
+
+  return UNITY_END();
+}
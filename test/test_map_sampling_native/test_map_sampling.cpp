@@ -0,0 +1,159 @@
+/*
+Checks that the crank angle triggered MAP sampling takes 1 sample per cylinder at the set angle, and only publishes
+complete cycles
+*/
+#include <unity.h>
+#include "map_sampling.h"
+#include "map_sampling.cpp"
+
+static uint8_t conversionCount;
+static uint16_t fakeMAP;
+static bool completeConversions;
+
+//Stands in for the board layer. The conversion completes straight away, with the next fake reading
+void startMAPAngleConversion(void)
+{
+  conversionCount++;
+  if(completeConversions == true)
+  {
+    storeMAPAngleSample(fakeMAP, (uint16_t)(fakeMAP + 100U));
+    fakeMAP++;
+  }
+}
+
+static void resetFake(void)
+{
+  conversionCount = 0U;
+  fakeMAP = 100U;
+  completeConversions = true;
+  configureMAPAngleSampling(false, 0U, 0U, 0U);
+}
+
+/** Pass the teeth of an evenly spaced wheel covering start to end (Degrees) */
+static void runTeeth(int16_t start, int16_t end, int16_t toothAngle)
+{
+  for(int16_t angle = start; angle < end; angle += toothAngle) { sampleMAPAtTooth(angle); }
+}
+
+static void test_mapAngle_disabled(void)
+{
+  resetFake();
+  configureMAPAngleSampling(false, 4U, 720U, 450U);
+  TEST_ASSERT_FALSE(isMAPAngleSamplingActive());
+  runTeeth(0, 720, 10);
+  TEST_ASSERT_EQUAL_UINT8(0U, conversionCount);
+
+  //Invalid cylinder counts are treated as disabled
+  configureMAPAngleSampling(true, 0U, 720U, 450U);
+  TEST_ASSERT_FALSE(isMAPAngleSamplingActive());
+  configureMAPAngleSampling(true, MAP_ANGLE_MAX_CYLINDERS + 1U, 720U, 450U);
+  TEST_ASSERT_FALSE(isMAPAngleSamplingActive());
+}
+
+static void test_mapAngle_one_per_cylinder(void)
+{
+  resetFake();
+  configureMAPAngleSampling(true, 4U, 720U, 455U);
+  TEST_ASSERT_TRUE(isMAPAngleSamplingActive());
+
+  //Samples at 455, 635, 95 and 275. With 10 degree teeth these are taken on the teeth at 460, 640, 100 and 280
+  runTeeth(0, 460, 10);
+  TEST_ASSERT_EQUAL_UINT8(0U, conversionCount);
+  sampleMAPAtTooth(460);
+  TEST_ASSERT_EQUAL_UINT8(1U, conversionCount);
+  runTeeth(470, 640, 10);
+  TEST_ASSERT_EQUAL_UINT8(1U, conversionCount);
+  sampleMAPAtTooth(640);
+  TEST_ASSERT_EQUAL_UINT8(2U, conversionCount);
+
+  //Teeth outside of the cycle are wrapped into it
+  runTeeth(650, 1180, 10);
+  TEST_ASSERT_EQUAL_UINT8(4U, conversionCount);
+
+  mapAngleCycle cycle;
+  TEST_ASSERT_TRUE(readMAPAngleCycle(cycle));
+  TEST_ASSERT_EQUAL_UINT8(4U, cycle.cylinders);
+  TEST_ASSERT_EQUAL_UINT16(100U, cycle.mapADC[0]);
+  TEST_ASSERT_EQUAL_UINT16(103U, cycle.mapADC[3]);
+  TEST_ASSERT_EQUAL_UINT16(203U, cycle.emapADC[3]);
+  TEST_ASSERT_FALSE(readMAPAngleCycle(cycle));
+
+  //Negative angles (Eg a negative trigger angle) are wrapped as well
+  runTeeth(-260, 460, 10);
+  TEST_ASSERT_EQUAL_UINT8(8U, conversionCount);
+  TEST_ASSERT_TRUE(readMAPAngleCycle(cycle));
+  TEST_ASSERT_EQUAL_UINT16(104U, cycle.mapADC[0]);
+}
+
+static void test_mapAngle_coarse_wheel(void)
+{
+  resetFake();
+  //2 stroke single cylinder on a 4 tooth wheel. The sample is taken on the first tooth after the angle
+  configureMAPAngleSampling(true, 1U, 360U, 100U);
+  runTeeth(0, 360, 90);
+  TEST_ASSERT_EQUAL_UINT8(1U, conversionCount);
+  runTeeth(360, 720, 90);
+  TEST_ASSERT_EQUAL_UINT8(2U, conversionCount);
+
+  uint16_t mapADC;
+  uint16_t emapADC;
+  TEST_ASSERT_TRUE(readLatestMAPAngleSample(mapADC, emapADC));
+  TEST_ASSERT_EQUAL_UINT16(101U, mapADC);
+  TEST_ASSERT_EQUAL_UINT16(201U, emapADC);
+  TEST_ASSERT_FALSE(readLatestMAPAngleSample(mapADC, emapADC));
+}
+
+static void test_mapAngle_incomplete_cycle(void)
+{
+  resetFake();
+  configureMAPAngleSampling(true, 2U, 720U, 0U);
+
+  //Sync is gained part way through the cycle. Nothing is sampled until cylinder 1 comes around
+  runTeeth(400, 720, 10);
+  TEST_ASSERT_EQUAL_UINT8(0U, conversionCount);
+
+  //A conversion that does not complete leaves the cycle incomplete, so it is not published
+  completeConversions = false;
+  sampleMAPAtTooth(0);
+  completeConversions = true;
+  runTeeth(10, 720, 10);
+  TEST_ASSERT_EQUAL_UINT8(2U, conversionCount);
+  mapAngleCycle cycle;
+  TEST_ASSERT_FALSE(readMAPAngleCycle(cycle));
+
+  runTeeth(0, 720, 10);
+  TEST_ASSERT_TRUE(readMAPAngleCycle(cycle));
+  TEST_ASSERT_EQUAL_UINT16(101U, cycle.mapADC[0]);
+  TEST_ASSERT_EQUAL_UINT16(102U, cycle.mapADC[1]);
+}
+
+static void test_mapAngle_reconfigure(void)
+{
+  resetFake();
+  configureMAPAngleSampling(true, 4U, 720U, 90U);
+  runTeeth(0, 180, 10);
+  TEST_ASSERT_EQUAL_UINT8(1U, conversionCount);
+
+  //The same settings do not restart the cycle
+  configureMAPAngleSampling(true, 4U, 720U, 90U);
+  runTeeth(180, 720, 10);
+  mapAngleCycle cycle;
+  TEST_ASSERT_TRUE(readMAPAngleCycle(cycle));
+
+  //New settings restart it from cylinder 1
+  configureMAPAngleSampling(true, 6U, 720U, 90U);
+  runTeeth(0, 720, 10);
+  TEST_ASSERT_EQUAL_UINT8(10U, conversionCount);
+  TEST_ASSERT_TRUE(readMAPAngleCycle(cycle));
+  TEST_ASSERT_EQUAL_UINT8(6U, cycle.cylinders);
+  TEST_ASSERT_EQUAL_UINT16(104U, cycle.mapADC[0]);
+}
+
+void testMAPSampling(void)
+{
+  RUN_TEST(test_mapAngle_disabled);
+  RUN_TEST(test_mapAngle_one_per_cylinder);
+  RUN_TEST(test_mapAngle_coarse_wheel);
+  RUN_TEST(test_mapAngle_incomplete_cycle);
+  RUN_TEST(test_mapAngle_reconfigure);
+}
@@ -0,0 +1,47 @@
+#include <unity.h>
+#include "globals.h"
+#include "pages.h"
+#include "page_crc.h"
+
+static void test_page_crc_cached(void)
+{
+  invalidateAllPageCRC32();
+  uint32_t crc = calculatePageCRC32(veSetPage);
+
+  //Without a change, the cached value is returned even though the page has changed underneath it
+  configPage2.aseTaperTime ^= 0x55;
+  TEST_ASSERT_EQUAL_UINT32(crc, calculatePageCRC32(veSetPage));
+
+  invalidatePageCRC32(veSetPage);
+  TEST_ASSERT_NOT_EQUAL(crc, calculatePageCRC32(veSetPage));
+
+  configPage2.aseTaperTime ^= 0x55;
+  invalidateAllPageCRC32();
+  TEST_ASSERT_EQUAL_UINT32(crc, calculatePageCRC32(veSetPage));
+}
+
+static void test_page_crc_setPageValue(void)
+{
+  invalidateAllPageCRC32();
+  uint32_t crc = calculatePageCRC32(ignMapPage);
+  uint32_t otherCrc = calculatePageCRC32(ignSetPage);
+  byte value = getPageValue(ignMapPage, 5);
+
+  //Writing a new value updates the CRC of that page only
+  setPageValue(ignMapPage, 5, value + 1U);
+  TEST_ASSERT_NOT_EQUAL(crc, calculatePageCRC32(ignMapPage));
+  TEST_ASSERT_EQUAL_UINT32(otherCrc, calculatePageCRC32(ignSetPage));
+
+  setPageValue(ignMapPage, 5, value);
+  TEST_ASSERT_EQUAL_UINT32(crc, calculatePageCRC32(ignMapPage));
+
+  //Rewriting the same value keeps the cached CRC
+  setPageValue(ignMapPage, 5, value);
+  TEST_ASSERT_EQUAL_UINT32(crc, calculatePageCRC32(ignMapPage));
+}
+
+void testPageCrc(void)
+{
+  RUN_TEST(test_page_crc_cached);
+  RUN_TEST(test_page_crc_setPageValue);
+}
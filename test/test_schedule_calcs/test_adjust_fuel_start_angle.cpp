@@ -0,0 +1,122 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "test_calcs_common.h"
+#include "schedule_calcs.h"
+#include "../test_utils.h"
+
+static void nullInjCallback(void) {};
+
+void test_adjust_fuel_start_angle_pending_below_minrevolutions()
+{
+    auto counter = decltype(+FUEL4_COUNTER){0};
+    auto compare = decltype(+FUEL4_COMPARE){0};
+    FuelSchedule schedule(counter, compare, nullInjCallback, nullInjCallback);
+
+    setEngineSpeed(4000, 720);
+    schedule.Status = PENDING;
+    currentStatus.startRevolutions = 0;
+
+    schedule.compare = 101;
+    schedule.counter = 100;
+
+    // Should do nothing.
+    adjustFuelStartAngle(schedule, 0, 400, 380);
+
+    TEST_ASSERT_EQUAL(101, schedule.compare);
+    TEST_ASSERT_EQUAL(100, schedule.counter);
+}
+
+void test_adjust_fuel_start_angle_pending_above_minrevolutions()
+{
+    auto counter = decltype(+FUEL4_COUNTER){0};
+    auto compare = decltype(+FUEL4_COMPARE){0};
+    FuelSchedule schedule(counter, compare, nullInjCallback, nullInjCallback);
+
+    setEngineSpeed(4000, 720);
+    schedule.Status = PENDING;
+    currentStatus.startRevolutions = 2000;
+
+    schedule.compare = 101;
+    schedule.counter = 100;
+    schedule.duration = 5000;
+    constexpr uint16_t newCrankAngle = 380;
+    constexpr uint16_t startAngle = 400;
+
+    adjustFuelStartAngle(schedule, 0, startAngle, newCrankAngle);
+
+    COMPARE_TYPE expected = schedule.counter+uS_TO_TIMER_COMPARE(angleToTimeMicroSecPerDegree(startAngle-newCrankAngle));
+    TEST_ASSERT_EQUAL(expected, schedule.compare);
+    TEST_ASSERT_EQUAL(expected, schedule.startCompare);
+    TEST_ASSERT_EQUAL((COMPARE_TYPE)(expected+uS_TO_TIMER_COMPARE(5000UL)), schedule.endCompare);
+    TEST_ASSERT_EQUAL(100, schedule.counter);
+}
+
+void test_adjust_fuel_start_angle_channel_offset()
+{
+    auto counter = decltype(+FUEL4_COUNTER){0};
+    auto compare = decltype(+FUEL4_COMPARE){0};
+    FuelSchedule schedule(counter, compare, nullInjCallback, nullInjCallback);
+
+    setEngineSpeed(4000, 720);
+    schedule.Status = PENDING;
+    currentStatus.startRevolutions = 2000;
+
+    schedule.compare = 101;
+    schedule.counter = 100;
+    // Start angle has wrapped past 0 but the crank angle has not. Relative to the channel TDC they are 30 degrees apart
+    adjustFuelStartAngle(schedule, 540, 10, 700);
+
+    TEST_ASSERT_EQUAL(schedule.counter+uS_TO_TIMER_COMPARE(angleToTimeMicroSecPerDegree(30)), schedule.compare);
+}
+
+void test_adjust_fuel_start_angle_passed()
+{
+    auto counter = decltype(+FUEL4_COUNTER){0};
+    auto compare = decltype(+FUEL4_COMPARE){0};
+    FuelSchedule schedule(counter, compare, nullInjCallback, nullInjCallback);
+
+    setEngineSpeed(4000, 720);
+    schedule.Status = PENDING;
+    currentStatus.startRevolutions = 2000;
+
+    schedule.compare = 101;
+    schedule.counter = 100;
+
+    // The crank is already past the start angle. The existing compare must be left to fire
+    adjustFuelStartAngle(schedule, 0, 400, 410);
+
+    TEST_ASSERT_EQUAL(101, schedule.compare);
+}
+
+void test_adjust_fuel_start_angle_running()
+{
+    auto counter = decltype(+FUEL4_COUNTER){0};
+    auto compare = decltype(+FUEL4_COMPARE){0};
+    FuelSchedule schedule(counter, compare, nullInjCallback, nullInjCallback);
+
+    setEngineSpeed(4000, 720);
+    schedule.Status = RUNNING;
+    currentStatus.startRevolutions = 2000;
+
+    schedule.compare = 101;
+    schedule.counter = 100;
+    schedule.endCompare = 100;
+
+    // The injector is already open, the pulse width must not be changed
+    adjustFuelStartAngle(schedule, 0, 400, 380);
+
+    TEST_ASSERT_EQUAL(101, schedule.compare);
+    TEST_ASSERT_EQUAL(100, schedule.endCompare);
+}
+
+void test_adjust_fuel_start_angle()
+{
+  SET_UNITY_FILENAME() {
+
+    RUN_TEST(test_adjust_fuel_start_angle_pending_below_minrevolutions);
+    RUN_TEST(test_adjust_fuel_start_angle_pending_above_minrevolutions);
+    RUN_TEST(test_adjust_fuel_start_angle_channel_offset);
+    RUN_TEST(test_adjust_fuel_start_angle_passed);
+    RUN_TEST(test_adjust_fuel_start_angle_running);
+  }
+}
@@ -5,6 +5,7 @@
 extern void test_calc_ign_timeout();
 extern void test_calc_inj_timeout();
 extern void test_adjust_crank_angle();
+extern void test_adjust_fuel_start_angle();
 
 void setup()
 {
@@ -16,6 +17,7 @@ void setup()
   test_calc_ign_timeout();
   test_calc_inj_timeout();
   test_adjust_crank_angle();
+  test_adjust_fuel_start_angle();
   
   UNITY_END(); // stop unit testing
 
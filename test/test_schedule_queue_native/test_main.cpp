@@ -0,0 +1,13 @@
+#include <unity.h>
+
+extern void testScheduleQueue(void);
+extern void testScheduleQueueSimulation(void);
+
+int main(void) {
+  UNITY_BEGIN();
+
+  testScheduleQueue();
+  testScheduleQueueSimulation();
+
+  return UNITY_END();
+}
@@ -0,0 +1,281 @@
+/*
+Compares the edge timing of channels multiplexed onto one compare unit (ScheduleQueue) against a model of the existing
+per channel scheduler (One compare unit per channel). Both run the same channel ISR, modelled on fuelScheduleISR(),
+the queued channels through their virtual compare registers.
+
+A single CPU is simulated at timer tick resolution. Every ISR costs SIM_ISR_ENTRY_TICKS before its first callback
+and SIM_CALLBACK_TICKS per callback. The queue pays an extra SIM_QUEUE_EVENT_TICKS per channel handler it runs.
+While an ISR is running, any other compare matches are latched and serviced afterwards, as the hardware does.
+*/
+#include <stdio.h>
+#include <unity.h>
+#include "schedule_queue.h"
+
+#define SIM_CHANNELS            12U
+#define SIM_ISR_ENTRY_TICKS     1U
+#define SIM_CALLBACK_TICKS      1U
+#define SIM_QUEUE_EVENT_TICKS   1U
+#define SIM_MAIN_LOOP_TICKS     50U   //How often the schedules are set (Emulates the main loop)
+#define SIM_MIN_TIMEOUT         25U   //Schedules are not set less than this many ticks before they are due
+
+struct sim_params {
+  const char *name;
+  uint16_t cycleTicks;    //Ticks per 720 degree cycle
+  uint16_t durationTicks; //Injector pulse width / dwell
+  uint8_t cycles;
+};
+
+struct sim_result {
+  uint32_t edges;
+  uint32_t totalError;
+  uint16_t maxError;
+  uint16_t missedSchedules; //Schedules that could not be set in time
+};
+
+//As ScheduleStatus (scheduler.h), which needs the board headers
+enum sim_status { SIM_OFF, SIM_PENDING, SIM_RUNNING };
+
+static uint32_t simTime;  //Absolute time in ticks
+static uint16_t simCounter;
+static uint16_t simCompare;
+static bool isQueueTimerEnabled;
+static void queueTimerEnable(void) { isQueueTimerEnabled = true; }
+static void queueTimerDisable(void) { isQueueTimerEnabled = false; }
+
+static ScheduleQueue<SIM_CHANNELS, uint16_t, uint16_t> simQueue(simCounter, simCompare, queueTimerDisable, queueTimerEnable);
+
+//Target times of the schedule currently set on each channel and the errors measured against them
+static uint32_t targetStart[SIM_CHANNELS];
+static uint32_t targetEnd[SIM_CHANNELS];
+static sim_result *pResult;
+
+static void spendTicks(uint16_t ticks)
+{
+  simTime += ticks;
+  simCounter = (uint16_t)simTime;
+}
+
+static void recordEdge(uint32_t target)
+{
+  uint16_t error = (simTime > target) ? (uint16_t)(simTime - target) : (uint16_t)(target - simTime);
+  pResult->edges++;
+  pResult->totalError += error;
+  if (error > pResult->maxError) { pResult->maxError = error; }
+  spendTicks(SIM_CALLBACK_TICKS);
+}
+
+//A channel schedule, on either backend
+struct channel_model {
+  sim_status Status;
+  volatile uint16_t compare;  //Compare register of the per channel backend
+  uint16_t duration;
+  bool isEnabled;
+  bool isFlagged;     //Compare match latched, ISR waiting to run
+};
+static channel_model channels[SIM_CHANNELS];
+
+//As fuelScheduleISR(). Returns false once the channel is off
+static bool channelISR(uint8_t channel, volatile uint16_t &compare)
+{
+  channel_model &model = channels[channel];
+  if (model.Status == SIM_PENDING)
+  {
+    recordEdge(targetStart[channel]);
+    model.Status = SIM_RUNNING;
+    compare = (uint16_t)(simCounter + model.duration);
+    return true;
+  }
+  if (model.Status == SIM_RUNNING) { recordEdge(targetEnd[channel]); }
+  model.Status = SIM_OFF;
+  return false;
+}
+
+//Latch the compare matches of all per channel compare units that occurred between the two times
+static void latchChannelMatches(uint32_t fromTime, uint32_t toTime)
+{
+  for (uint8_t channel = 0; channel < SIM_CHANNELS; ++channel)
+  {
+    channel_model &model = channels[channel];
+    uint16_t ticksToMatch = (uint16_t)(model.compare - (uint16_t)fromTime);
+    if (model.isEnabled && (ticksToMatch > 0U) && (ticksToMatch <= (toTime - fromTime))) { model.isFlagged = true; }
+  }
+}
+
+static void perChannelISR(uint8_t channel)
+{
+  channel_model &model = channels[channel];
+  uint32_t startTime = simTime;
+  spendTicks(SIM_ISR_ENTRY_TICKS);
+  if (channelISR(channel, model.compare) == false) { model.isEnabled = false; }
+  latchChannelMatches(startTime, simTime);
+}
+
+//The queued channel ISRs, as fuelScheduleN on a ScheduleQueue (See scheduler.cpp)
+template <uint8_t channel>
+static void queueHandler(void)
+{
+  spendTicks(SIM_QUEUE_EVENT_TICKS);
+  if (channelISR(channel, simQueue.compare(channel)) == false) { simQueue.disable(channel); }
+}
+
+typedef void (*sim_handler)(void);
+static const sim_handler queueHandlers[SIM_CHANNELS] = {
+  queueHandler<0>, queueHandler<1>, queueHandler<2>, queueHandler<3>, queueHandler<4>, queueHandler<5>,
+  queueHandler<6>, queueHandler<7>, queueHandler<8>, queueHandler<9>, queueHandler<10>, queueHandler<11> };
+
+//As _setFuelScheduleRunning(), with interrupts off
+static void setChannelSchedule(bool useQueue, uint8_t channel, uint16_t timeout, uint16_t duration)
+{
+  channel_model &model = channels[channel];
+  model.duration = duration;
+  model.Status = SIM_PENDING;
+  if (useQueue)
+  {
+    simQueue.compare(channel) = (uint16_t)(simCounter + timeout);
+    simQueue.enable(channel);
+  }
+  else
+  {
+    model.compare = (uint16_t)(simCounter + timeout);
+    model.isEnabled = true;
+  }
+}
+
+static sim_result runSimulation(const sim_params &params, bool useQueue)
+{
+  sim_result result = { 0, 0, 0, 0 };
+  pResult = &result;
+
+  simTime = 1000;
+  simCounter = (uint16_t)simTime;
+  simQueue.reset();
+  for (uint8_t channel = 0; channel < SIM_CHANNELS; ++channel)
+  {
+    simQueue.setHandler(channel, queueHandlers[channel]);
+    channels[channel].Status = SIM_OFF;
+    channels[channel].isEnabled = false;
+    channels[channel].isFlagged = false;
+  }
+
+  //Cylinders are evenly spaced over the cycle. Each channel is set up once per cycle, half a cycle before it is due
+  const uint16_t channelSpacing = params.cycleTicks / SIM_CHANNELS;
+  uint8_t nextCycle[SIM_CHANNELS] = { 0 };
+  const uint32_t firstStart = simTime + params.cycleTicks;
+  const uint32_t endTime = firstStart + ((uint32_t)(params.cycles + 1U) * params.cycleTicks); //Allow the last cycle to complete
+
+  uint32_t nextMainLoop = simTime;
+  while (simTime < endTime)
+  {
+    if (simTime >= nextMainLoop)
+    {
+      nextMainLoop += SIM_MAIN_LOOP_TICKS;
+      for (uint8_t channel = 0; channel < SIM_CHANNELS; ++channel)
+      {
+        if (nextCycle[channel] >= params.cycles) { continue; }
+        uint32_t start = firstStart + ((uint32_t)nextCycle[channel] * params.cycleTicks) + ((uint32_t)channel * channelSpacing);
+        if (start < (simTime + SIM_MIN_TIMEOUT))
+        {
+          //Too late to set this one, move on to the next cycle
+          result.missedSchedules++;
+          nextCycle[channel]++;
+          continue;
+        }
+        if ( ((start - simTime) > (params.cycleTicks / 2U)) || (channels[channel].Status != SIM_OFF) ) { continue; }
+        targetStart[channel] = start;
+        targetEnd[channel] = start + params.durationTicks;
+        setChannelSchedule(useQueue, channel, (uint16_t)(start - simTime), params.durationTicks);
+        nextCycle[channel]++;
+      }
+    }
+
+    spendTicks(1);
+    if (useQueue)
+    {
+      if (isQueueTimerEnabled && (simCounter == simCompare))
+      {
+        spendTicks(SIM_ISR_ENTRY_TICKS);
+        simQueue.service();
+      }
+    }
+    else
+    {
+      latchChannelMatches(simTime - 1U, simTime);
+      //Lowest channel has the highest priority. Run all pending ISRs back to back
+      bool isAnyFlagged = true;
+      while (isAnyFlagged)
+      {
+        isAnyFlagged = false;
+        for (uint8_t channel = 0; channel < SIM_CHANNELS; ++channel)
+        {
+          if (channels[channel].isFlagged)
+          {
+            channels[channel].isFlagged = false;
+            perChannelISR(channel);
+            isAnyFlagged = true;
+            break;
+          }
+        }
+      }
+    }
+  }
+  return result;
+}
+
+static void reportResult(const sim_params &params, const char *backend, const sim_result &result)
+{
+  char buffer[160];
+  snprintf(buffer, sizeof(buffer), "%s %s: %lu edges, mean error %lu.%02lu ticks, max error %u ticks, %u missed",
+    params.name, backend, (unsigned long)result.edges,
+    (unsigned long)(result.totalError / result.edges), (unsigned long)(((result.totalError % result.edges) * 100U) / result.edges),
+    (unsigned)result.maxError, (unsigned)result.missedSchedules);
+  TEST_MESSAGE(buffer);
+}
+
+static void compareBackends(const sim_params &params)
+{
+  sim_result perChannel = runSimulation(params, false);
+  sim_result queued = runSimulation(params, true);
+  reportResult(params, "per channel", perChannel);
+  reportResult(params, "queue", queued);
+
+  //Every edge must be generated
+  const uint32_t expectedEdges = (uint32_t)SIM_CHANNELS * params.cycles * 2U;
+  TEST_ASSERT_EQUAL_UINT32(expectedEdges, perChannel.edges);
+  TEST_ASSERT_EQUAL_UINT32(expectedEdges, queued.edges);
+  TEST_ASSERT_EQUAL(0, queued.missedSchedules);
+
+  //The queue services coincident channels in a single ISR, so the worst case should be no worse than the per channel
+  //ISRs queued back to back, allowing for the extra queue handling of each channel
+  TEST_ASSERT_LESS_OR_EQUAL(perChannel.maxError + (SIM_QUEUE_EVENT_TICKS * SIM_CHANNELS), queued.maxError);
+  //Each edge is late by the queue handling at most twice: an end is set from the counter in the start handler (As
+  //fuelScheduleISR() does), so it also carries the handling of the start
+  TEST_ASSERT_LESS_OR_EQUAL(perChannel.totalError + (queued.edges * SIM_QUEUE_EVENT_TICKS * 2U), queued.totalError);
+}
+
+static void test_queue_sim_v12_ignition(void)
+{
+  //7000rpm, 4uS ticks. 3ms dwell, so 2 coils are charging at once at times
+  const sim_params params = { "V12 ignition 7000rpm", 4286U, 750U, 20U };
+  compareBackends(params);
+}
+
+static void test_queue_sim_v12_injection(void)
+{
+  //6000rpm, 16uS ticks. 12ms pulse width, ~70% duty with 10 injectors open at times
+  const sim_params params = { "V12 injection 6000rpm", 1250U, 750U, 20U };
+  compareBackends(params);
+}
+
+static void test_queue_sim_v12_coincident(void)
+{
+  //Duration is exactly 2 channels, so every end coincides with the start of a later channel
+  const sim_params params = { "V12 coincident edges", 1200U, 200U, 20U };
+  compareBackends(params);
+}
+
+void testScheduleQueueSimulation(void)
+{
+  RUN_TEST(test_queue_sim_v12_ignition);
+  RUN_TEST(test_queue_sim_v12_injection);
+  RUN_TEST(test_queue_sim_v12_coincident);
+}
@@ -0,0 +1,242 @@
+#include <unity.h>
+#include "schedule_queue.h"
+
+//Fake timer. The counter only moves when the tests advance it
+static uint16_t counter;
+static uint16_t compare;
+static bool isTimerEnabled;
+static void timerEnable(void) { isTimerEnabled = true; }
+static void timerDisable(void) { isTimerEnabled = false; }
+
+static ScheduleQueue<4, uint16_t, uint16_t> queue(counter, compare, timerDisable, timerEnable);
+
+//Record of the handlers that have run
+struct handler_record {
+  uint8_t channel;
+  uint16_t counter;
+};
+static handler_record records[128];
+static uint8_t recordCount;
+
+//Ticks each handler spends, and the time it sets for the next match of its channel (0 to disable the channel)
+static uint16_t handlerTicks;
+static uint16_t nextMatch[4];
+
+template <uint8_t channel>
+static void recordHandler(void)
+{
+  if (recordCount < (sizeof(records)/sizeof(records[0])))
+  {
+    records[recordCount].channel = channel;
+    records[recordCount].counter = counter;
+    ++recordCount;
+  }
+  counter += handlerTicks;
+  if (nextMatch[channel] == 0U) { queue.disable(channel); }
+  else
+  {
+    //As the schedule ISRs, the next match is set from the counter
+    queue.compare(channel) = counter + nextMatch[channel];
+    nextMatch[channel] = 0U;
+  }
+}
+
+static void setup(uint16_t startCounter)
+{
+  counter = startCounter;
+  recordCount = 0;
+  handlerTicks = 0;
+  queue.reset();
+  queue.setHandler(0, recordHandler<0>);
+  queue.setHandler(1, recordHandler<1>);
+  queue.setHandler(2, recordHandler<2>);
+  queue.setHandler(3, recordHandler<3>);
+  for (uint8_t channel = 0; channel < 4U; ++channel) { nextMatch[channel] = 0U; }
+}
+
+static void setChannel(uint8_t channel, uint16_t timeout)
+{
+  queue.compare(channel) = counter + timeout;
+  queue.enable(channel);
+}
+
+//Advance the counter one tick at a time, calling the ISR on a compare match
+static void runFor(uint16_t ticks)
+{
+  while (ticks > 0U)
+  {
+    ++counter;
+    --ticks;
+    if (isTimerEnabled && (counter == compare)) { queue.service(); }
+  }
+}
+
+static void assertRecord(uint8_t index, uint8_t channel, uint16_t expectedCounter)
+{
+  TEST_ASSERT_GREATER_THAN(index, recordCount);
+  TEST_ASSERT_EQUAL(channel, records[index].channel);
+  TEST_ASSERT_EQUAL_UINT16(expectedCounter, records[index].counter);
+}
+
+static void test_queue_single_channel(void)
+{
+  setup(1000);
+  setChannel(0, 100);
+  TEST_ASSERT_TRUE(queue.isEnabled(0));
+  TEST_ASSERT_TRUE(isTimerEnabled);
+  TEST_ASSERT_EQUAL_UINT16(1100, compare);
+
+  runFor(200);
+  TEST_ASSERT_EQUAL(1, recordCount);
+  assertRecord(0, 0, 1100);
+  TEST_ASSERT_FALSE(queue.isEnabled(0));
+  TEST_ASSERT_FALSE(isTimerEnabled);
+}
+
+static void test_queue_earliest_first(void)
+{
+  setup(1000);
+  setChannel(0, 300);
+  setChannel(1, 100);
+  setChannel(2, 200);
+  TEST_ASSERT_EQUAL_UINT16(1100, compare);
+
+  runFor(400);
+  TEST_ASSERT_EQUAL(3, recordCount);
+  assertRecord(0, 1, 1100);
+  assertRecord(1, 2, 1200);
+  assertRecord(2, 0, 1300);
+  TEST_ASSERT_FALSE(isTimerEnabled);
+}
+
+static void test_queue_start_then_end(void)
+{
+  //As a schedule: the start sets the end from the counter
+  setup(1000);
+  nextMatch[0] = 50;
+  setChannel(0, 100);
+
+  runFor(200);
+  TEST_ASSERT_EQUAL(2, recordCount);
+  assertRecord(0, 0, 1100);
+  assertRecord(1, 0, 1150);
+}
+
+static void test_queue_coincident(void)
+{
+  //Both run from a single compare match, lowest channel first
+  setup(1000);
+  setChannel(3, 100);
+  setChannel(1, 100);
+
+  runFor(100);
+  TEST_ASSERT_EQUAL(2, recordCount);
+  assertRecord(0, 1, 1100);
+  assertRecord(1, 3, 1100);
+}
+
+static void test_queue_disable(void)
+{
+  setup(1000);
+  setChannel(0, 100);
+  setChannel(1, 200);
+  queue.disable(0);
+
+  runFor(300);
+  TEST_ASSERT_EQUAL(1, recordCount);
+  assertRecord(0, 1, 1200);
+  TEST_ASSERT_FALSE(isTimerEnabled);
+}
+
+static void test_queue_replace_compare(void)
+{
+  //A pending channel that is set again only runs at the new time, as with a hardware compare register
+  setup(1000);
+  setChannel(0, 100);
+  runFor(50);
+  setChannel(0, 100);
+
+  runFor(200);
+  TEST_ASSERT_EQUAL(1, recordCount);
+  assertRecord(0, 0, 1150);
+}
+
+static void test_queue_counter_wrap(void)
+{
+  setup(65500);
+  setChannel(0, 100);
+  TEST_ASSERT_EQUAL_UINT16(64, compare);
+
+  runFor(200);
+  TEST_ASSERT_EQUAL(1, recordCount);
+  assertRecord(0, 0, 64);
+}
+
+static void test_queue_full_period(void)
+{
+  //A compare equal to the counter matches one full timer period later, as the hardware does (Plus a tick)
+  setup(1000);
+  setChannel(0, 0);
+  runFor(65535);
+  runFor(1);
+  TEST_ASSERT_EQUAL(0, recordCount);
+  runFor(1);
+  TEST_ASSERT_EQUAL(1, recordCount);
+  assertRecord(0, 0, 1001);
+}
+
+static void test_queue_long_wait_other_channels(void)
+{
+  //A channel waiting most of a timer period is not lost while others run
+  setup(1000);
+  setChannel(0, 65000);
+  for (uint8_t i = 0; i < 110U; ++i)
+  {
+    setChannel(1, 300);
+    runFor(600);
+  }
+  TEST_ASSERT_EQUAL(111, recordCount);
+  assertRecord(108, 0, (uint16_t)(1000U + 65000U));
+}
+
+static void test_queue_min_ticks(void)
+{
+  //The compare is never set to the next tick. A channel that close runs minTicks after it was enabled
+  setup(1000);
+  setChannel(0, 1);
+  TEST_ASSERT_EQUAL_UINT16(1000 + queue.minTicks, compare);
+
+  runFor(10);
+  TEST_ASSERT_EQUAL(1, recordCount);
+  assertRecord(0, 0, 1000 + queue.minTicks);
+}
+
+static void test_queue_due_during_service(void)
+{
+  //A channel that becomes due while another handler is running is run by the same service() call
+  setup(1000);
+  handlerTicks = 20;
+  setChannel(0, 100);
+  setChannel(1, 110);
+
+  runFor(100);
+  TEST_ASSERT_EQUAL(2, recordCount);
+  assertRecord(0, 0, 1100);
+  assertRecord(1, 1, 1120);
+  TEST_ASSERT_FALSE(isTimerEnabled);
+}
+
+void testScheduleQueue(void)
+{
+  RUN_TEST(test_queue_single_channel);
+  RUN_TEST(test_queue_earliest_first);
+  RUN_TEST(test_queue_start_then_end);
+  RUN_TEST(test_queue_coincident);
+  RUN_TEST(test_queue_disable);
+  RUN_TEST(test_queue_replace_compare);
+  RUN_TEST(test_queue_counter_wrap);
+  RUN_TEST(test_queue_full_period);
+  RUN_TEST(test_queue_long_wait_other_channels);
+  RUN_TEST(test_queue_min_ticks);
+  RUN_TEST(test_queue_due_during_service);
+}
@@ -0,0 +1,11 @@
+#include <unity.h>
+
+extern void testSensorChannel(void);
+
+int main(void) {
+  UNITY_BEGIN();
+
+  testSensorChannel();
+
+  return UNITY_END();
+}
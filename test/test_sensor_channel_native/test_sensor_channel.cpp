@@ -0,0 +1,138 @@
+/*
+Checks each stage of the sensor channel: priming, decimation, the range check and faults, the median and the filter
+*/
+#include <unity.h>
+#include "sensor_channel.h"
+#include "sensor_channel.cpp"
+
+static sensorChannel channel;
+
+static sensorChannelConfig makeConfig(uint8_t decimation, bool median, uint8_t filterAlpha)
+{
+  sensorChannelConfig config = { decimation, median, filterAlpha, 0U, 0U, 0U };
+  return config;
+}
+
+static void test_sensorChannel_primes_with_first_sample(void)
+{
+  sensorChannelConfig config = makeConfig(2U, true, 200U);
+  channel.value = 0U;
+  sensorChannelReset(channel);
+
+  //The first sample is used as is, even with decimation and a heavy filter
+  TEST_ASSERT_EQUAL_UINT8(SENSOR_SAMPLE_VALID, sensorChannelUpdate(channel, config, 500U));
+  TEST_ASSERT_EQUAL_UINT16(500U, channel.value);
+
+  //A reset keeps the value until the next sample
+  sensorChannelReset(channel);
+  TEST_ASSERT_EQUAL_UINT16(500U, channel.value);
+  TEST_ASSERT_EQUAL_UINT8(SENSOR_SAMPLE_VALID, sensorChannelUpdate(channel, config, 300U));
+  TEST_ASSERT_EQUAL_UINT16(300U, channel.value);
+}
+
+static void test_sensorChannel_decimation(void)
+{
+  sensorChannelConfig config = makeConfig(2U, false, 0U);
+  sensorChannelReset(channel);
+  sensorChannelUpdate(channel, config, 100U);
+
+  //4 samples are averaged into each reading
+  TEST_ASSERT_EQUAL_UINT8(SENSOR_SAMPLE_PENDING, sensorChannelUpdate(channel, config, 200U));
+  TEST_ASSERT_EQUAL_UINT8(SENSOR_SAMPLE_PENDING, sensorChannelUpdate(channel, config, 300U));
+  TEST_ASSERT_EQUAL_UINT8(SENSOR_SAMPLE_PENDING, sensorChannelUpdate(channel, config, 400U));
+  TEST_ASSERT_EQUAL_UINT16(100U, channel.value);
+  TEST_ASSERT_EQUAL_UINT8(SENSOR_SAMPLE_VALID, sensorChannelUpdate(channel, config, 500U));
+  TEST_ASSERT_EQUAL_UINT16(350U, channel.value);
+
+  //Out of range settings are limited to 8 samples
+  config.decimation = 7U;
+  for(uint8_t x = 0U; x < 7U; x++) { TEST_ASSERT_EQUAL_UINT8(SENSOR_SAMPLE_PENDING, sensorChannelUpdate(channel, config, 1023U)); }
+  TEST_ASSERT_EQUAL_UINT8(SENSOR_SAMPLE_VALID, sensorChannelUpdate(channel, config, 1023U));
+  TEST_ASSERT_EQUAL_UINT16(1023U, channel.value);
+}
+
+static void test_sensorChannel_median(void)
+{
+  sensorChannelConfig config = makeConfig(0U, true, 0U);
+  sensorChannelReset(channel);
+  sensorChannelUpdate(channel, config, 400U);
+
+  //A single spike is removed
+  sensorChannelUpdate(channel, config, 1000U);
+  TEST_ASSERT_EQUAL_UINT16(400U, channel.value);
+  TEST_ASSERT_EQUAL_UINT16(1000U, channel.reading);
+  sensorChannelUpdate(channel, config, 410U);
+  TEST_ASSERT_EQUAL_UINT16(410U, channel.value);
+  sensorChannelUpdate(channel, config, 410U);
+
+  //A step is followed after 2 readings
+  sensorChannelUpdate(channel, config, 800U);
+  TEST_ASSERT_EQUAL_UINT16(410U, channel.value);
+  sensorChannelUpdate(channel, config, 800U);
+  TEST_ASSERT_EQUAL_UINT16(800U, channel.value);
+}
+
+static void test_sensorChannel_filter(void)
+{
+  sensorChannelConfig config = makeConfig(0U, false, 128U);
+  sensorChannelReset(channel);
+  sensorChannelUpdate(channel, config, 0U);
+
+  //Same result as ADC_FILTER()
+  sensorChannelUpdate(channel, config, 1000U);
+  TEST_ASSERT_EQUAL_UINT16(500U, channel.value);
+  sensorChannelUpdate(channel, config, 1000U);
+  TEST_ASSERT_EQUAL_UINT16(750U, channel.value);
+
+  config.filterAlpha = 0U;
+  sensorChannelUpdate(channel, config, 20U);
+  TEST_ASSERT_EQUAL_UINT16(20U, channel.value);
+}
+
+static void test_sensorChannel_faults(void)
+{
+  sensorChannelConfig config = makeConfig(0U, false, 0U);
+  config.faultLow = 10U;
+  config.faultHigh = 1000U;
+  config.faultSamples = 3U;
+  sensorChannelReset(channel);
+  sensorChannelUpdate(channel, config, 500U);
+
+  //Out of range readings are discarded, and the third in a row faults the channel once
+  TEST_ASSERT_EQUAL_UINT8(SENSOR_SAMPLE_REJECTED, sensorChannelUpdate(channel, config, 5U));
+  TEST_ASSERT_EQUAL_UINT8(SENSOR_SAMPLE_REJECTED, sensorChannelUpdate(channel, config, 5U));
+  TEST_ASSERT_FALSE(channel.faulty);
+  TEST_ASSERT_EQUAL_UINT8(SENSOR_SAMPLE_FAULT_LOW, sensorChannelUpdate(channel, config, 5U));
+  TEST_ASSERT_TRUE(channel.faulty);
+  TEST_ASSERT_EQUAL_UINT8(SENSOR_SAMPLE_REJECTED, sensorChannelUpdate(channel, config, 1020U));
+  TEST_ASSERT_EQUAL_UINT16(500U, channel.value);
+
+  //A good reading clears the fault
+  TEST_ASSERT_EQUAL_UINT8(SENSOR_SAMPLE_VALID, sensorChannelUpdate(channel, config, 600U));
+  TEST_ASSERT_FALSE(channel.faulty);
+  TEST_ASSERT_EQUAL_UINT8(0U, channel.errorCount);
+  TEST_ASSERT_EQUAL_UINT16(600U, channel.value);
+
+  config.faultSamples = 1U;
+  TEST_ASSERT_EQUAL_UINT8(SENSOR_SAMPLE_FAULT_HIGH, sensorChannelUpdate(channel, config, 1010U));
+
+  //With no fault samples, readings are still discarded but the channel never faults
+  config.faultSamples = 0U;
+  sensorChannelUpdate(channel, config, 600U);
+  for(uint16_t x = 0U; x < 300U; x++) { TEST_ASSERT_EQUAL_UINT8(SENSOR_SAMPLE_REJECTED, sensorChannelUpdate(channel, config, 0U)); }
+  TEST_ASSERT_EQUAL_UINT8(UINT8_MAX, channel.errorCount);
+
+  //The range check is off when the limits are not in order
+  config.faultLow = 1000U;
+  config.faultHigh = 10U;
+  TEST_ASSERT_EQUAL_UINT8(SENSOR_SAMPLE_VALID, sensorChannelUpdate(channel, config, 0U));
+}
+
+void testSensorChannel(void)
+{
+  RUN_TEST(test_sensorChannel_primes_with_first_sample);
+  RUN_TEST(test_sensorChannel_decimation);
+  RUN_TEST(test_sensorChannel_median);
+  RUN_TEST(test_sensorChannel_filter);
+  RUN_TEST(test_sensorChannel_faults);
+}
@@ -5,6 +5,7 @@ typedef uint8_t byte;
 #include "test_table2d.h"
 #include "table2d.h"
 #include "../test_utils.h"
+#include "../timer.hpp"
 
 
 static constexpr uint8_t TEST_TABLE2D_SIZE = 9;
@@ -22,27 +23,17 @@ static int16_t table2d_axis_s16[TEST_TABLE2D_SIZE] = {
     123, 2539, 5531, 7537, 11329, 16363, 21323, 26357, 32029,
 };
 
-static table2D table2d_u8_u8;
-static table2D table2d_u8_s16;
-static table2D table2d_s16_u8;
-static table2D table2d_s16_s16;
-
-template <typename dataT, typename axisT>
-void setup_test_subject(table2D &table, dataT *data, axisT *axis)
-{
-    table.valueSize = sizeof(dataT)*CHAR_BIT;
-    table.axisSize = sizeof(axisT)*CHAR_BIT;
-    table.xSize = TEST_TABLE2D_SIZE;
-    table.values = data;
-    table.axisX = axis;
-}
+static table2D_u8_u8 table2d_u8_u8;
+static table2D_u8_s16 table2d_u8_s16;
+static table2D_s16_u8 table2d_s16_u8;
+static table2D_s16_s16 table2d_s16_s16;
 
 static void setup_test_subjects(void)
 {
-    setup_test_subject(table2d_u8_u8, table2d_data_u8, table2d_axis_u8);
-    setup_test_subject(table2d_u8_s16, table2d_data_u8, table2d_axis_s16);
-    setup_test_subject(table2d_s16_u8, table2d_data_s16, table2d_axis_u8);
-    setup_test_subject(table2d_s16_s16, table2d_data_s16, table2d_axis_s16);
+    construct2dTable(table2d_u8_u8, TEST_TABLE2D_SIZE, table2d_data_u8, table2d_axis_u8);
+    construct2dTable(table2d_u8_s16, TEST_TABLE2D_SIZE, table2d_data_u8, table2d_axis_s16);
+    construct2dTable(table2d_s16_u8, TEST_TABLE2D_SIZE, table2d_data_s16, table2d_axis_u8);
+    construct2dTable(table2d_s16_s16, TEST_TABLE2D_SIZE, table2d_data_s16, table2d_axis_s16);
 }
 
 
@@ -146,6 +137,43 @@ void test_table2d_all_decrementing(void)
 }
 
 
+static void table2dLookupPerfLoop(int16_t x, uint32_t &checkSum)
+{
+    // Alternate between the tables so the input changes on every call (I.e. the lookup cache is never hit)
+    checkSum += table2D_getValue(&table2d_u8_u8, x & 0xFF);
+    checkSum += table2D_getValue(&table2d_s16_s16, x);
+}
+
+void test_table2dLookup_perf(void)
+{
+    // Benchmark: sweep both tables across their full axis range.
+    // Reports the lookups/second for comparison between builds & platforms.
+    setup_test_subjects();
+
+#if defined(ARDUINO_ARCH_AVR)
+    constexpr uint16_t iters = 1;
+#else
+    constexpr uint16_t iters = 200;
+#endif
+    constexpr int16_t xStep = 37;
+    constexpr int16_t xFrom = 0;
+    constexpr int16_t xTo = 32700;
+    constexpr uint32_t lookups = (uint32_t)iters * 2U * ((((xTo - xFrom) + xStep) - 1) / xStep);
+
+    timer lookupTimer;
+    uint32_t checkSum = 0;
+    measure_executiontime<int16_t, uint32_t&>(iters, xFrom, xTo, xStep, lookupTimer, checkSum, table2dLookupPerfLoop);
+
+    char buffer[96];
+    const uint32_t durationMicros = lookupTimer.duration_micros() == 0U ? 1U : lookupTimer.duration_micros();
+    sprintf(buffer, "2D table lookups: %" PRIu32 " in %" PRIu32 "uS = %" PRIu32 " lookups/sec",
+            lookups, durationMicros, (uint32_t)(((uint64_t)lookups * MICROS_PER_SEC) / durationMicros));
+    TEST_MESSAGE(buffer);
+
+    // Only here to force the compiler to run the loop above
+    TEST_ASSERT_NOT_EQUAL(0, checkSum);
+}
+
 void testTable2d()
 {
   SET_UNITY_FILENAME() {
@@ -155,5 +183,6 @@ void testTable2d()
     RUN_TEST(test_table2dLookup_overMax);
     RUN_TEST(test_table2dLookup_underMin);
     RUN_TEST(test_table2d_all_decrementing); 
+    RUN_TEST(test_table2dLookup_perf);
   }
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "tests_tables.h"
 #include "table3d.h"
 #include "../test_utils.h"
+#include "../timer.hpp"
 
 TEST_DATA_P table3d_value_t values[] = {
  //0    1    2   3     4    5    6    7    8    9   10   11   12   13    14   15
@@ -72,6 +73,11 @@ void testTables()
   RUN_TEST(test_tableLookup_underMinX);
   RUN_TEST(test_tableLookup_underMinY);
   RUN_TEST(test_tableLookup_roundUp);
+  RUN_TEST(test_tableLookup_binPosition);
+  RUN_TEST(test_tableLookup_axisChanged);
+  RUN_TEST(test_tableLookup_sharedAxis);
+  RUN_TEST(test_tableLookup_sharedAxisMismatch);
+  RUN_TEST(test_tableLookup_perf);
   //RUN_TEST(test_all_incrementing);
 
   }  
@@ -198,4 +204,174 @@ void test_all_incrementing(void)
       tempVE = newVE;
     }
   }
-}
\ No newline at end of file
+}
+
+void test_tableLookup_binPosition(void)
+{
+  // The position within a bin is calculated using a cached reciprocal of the bin width
+  // instead of a division. Check that it matches the division to within 1 for every
+  // position in bins of very different widths (both sides of the 256 wide threshold).
+  static const table3d_axis_t xAxis[] = { 0, 2, 7, 100, 256, 257, 400, 1000, 1001, 3000, 3255, 6000, 9999, 15000, 24000, 32000 };
+  static table3d16RpmLoad positionTable;
+  {
+    table_axis_iterator itX = positionTable.axisX.begin();
+    const table3d_axis_t *pX = xAxis;
+    while (!itX.at_end()) { *itX = *pX; ++pX; ++itX; }
+    table_axis_iterator itY = positionTable.axisY.begin();
+    table3d_axis_t y = 0;
+    while (!itY.at_end()) { *itY = y; y += 10; ++itY; }
+  }
+  {
+    // Alternate columns of 0 & 255, so each bin is a ramp from one to the other. All rows are the same.
+    // The lookups are on a Y axis value, so only the X position affects the result
+    table_value_iterator itZ = positionTable.values.begin();
+    while (!itZ.at_end())
+    {
+      table_row_iterator itRow = *itZ;
+      uint8_t column = 0;
+      while (!itRow.at_end()) { *itRow = (column & 1U) ? 255U : 0U; ++column; ++itRow; }
+      ++itZ;
+    }
+  }
+  invalidate_cache(&positionTable.get_value_cache);
+
+  for (uint8_t bin = 0; bin < _countof(xAxis)-1U; ++bin)
+  {
+    const table3d_axis_t binMin = xAxis[bin];
+    const uint16_t binWidth = (uint16_t)(xAxis[bin+1U] - binMin);
+    // Step through large bins to keep the run time reasonable
+    const uint16_t step = (binWidth / 64U) + 1U;
+    for (uint16_t position = 1U; position < binWidth; position += step)
+    {
+      uint16_t binFraction = (uint16_t)(((uint32_t)position << 8U) / binWidth);
+      if ((bin & 1U) == 1U) { binFraction = 256U - binFraction; } // Ramp down
+      const uint8_t expected = (uint8_t)((255U * binFraction) >> 8U);
+      const uint8_t actual = get3DTableValue(&positionTable, 10, binMin + (table3d_axis_t)position);
+      TEST_ASSERT_UINT8_WITHIN(1, expected, actual);
+    }
+  }
+}
+
+void test_tableLookup_axisChanged(void)
+{
+  // Changing the axis (E.g. via the tuning software) must not leave a stale bin reciprocal behind
+  setup_TestTable();
+  TEST_ASSERT_EQUAL(69, get3DTableValue(&testTable, 53, 2250));
+
+  // Double the width of the bin that was just used (2000-2500 => 2000-3000). The lookup is
+  // now 25% of the way through it. The axis is stored in reverse, so 2500 is at [15-6]
+  testTable.axisX.axis[_countof(tempXAxis) - 1U - 6U] = 3000;
+  invalidate_cache(&testTable.get_value_cache);
+  TEST_ASSERT_EQUAL(68, get3DTableValue(&testTable, 53, 2250));
+
+  // Restore the table for the other tests
+  setup_TestTable();
+}
+
+// A second table with the same axes as testTable, but different values
+static table3d16RpmLoad sharedTable;
+
+static void setup_SharedTable(void)
+{
+  populate_table_P(sharedTable, tempXAxis, tempYAxis, values);
+  // Shift the values, so a lookup into the wrong table would be detected
+  table_value_iterator itZ = sharedTable.values.begin();
+  while (!itZ.at_end())
+  {
+    table_row_iterator itRow = *itZ;
+    while (!itRow.at_end()) { *itRow = *itRow + 20U; ++itRow; }
+    ++itZ;
+  }
+  invalidate_cache(&sharedTable.get_value_cache);
+}
+
+void test_tableLookup_sharedAxis(void)
+{
+  // Tables with the same axes share the axis search, but the results must be the same as
+  // separate lookups
+  setup_TestTable();
+  setup_SharedTable();
+  static table3DSharedAxisCache sharedCache;
+
+  TEST_ASSERT_EQUAL(69, get3DTableValue(&testTable, 53, 2250, &sharedCache));
+  TEST_ASSERT_EQUAL(89, get3DTableValue(&sharedTable, 53, 2250, &sharedCache));
+  TEST_ASSERT_TRUE(sharedTable.get_value_cache.isAxisShared);
+  TEST_ASSERT_EQUAL(testTable.get_value_cache.lastXBinMax, sharedTable.get_value_cache.lastXBinMax);
+  TEST_ASSERT_EQUAL(testTable.get_value_cache.lastYBinMax, sharedTable.get_value_cache.lastYBinMax);
+
+  // Sweep the whole table (Including outside the axis limits), alternating between the tables
+  for (table3d_axis_t rpm = xMin - 100; rpm < xMax + 100; rpm += 97)
+  {
+    for (table3d_axis_t load = yMin - 4; load < yMax + 4; load += 3)
+    {
+      const table3d_value_t shared1 = get3DTableValue(&testTable, load, rpm, &sharedCache);
+      const table3d_value_t shared2 = get3DTableValue(&sharedTable, load, rpm, &sharedCache);
+      invalidate_cache(&testTable.get_value_cache);
+      invalidate_cache(&sharedTable.get_value_cache);
+      TEST_ASSERT_EQUAL(get3DTableValue(&testTable, load, rpm), shared1);
+      TEST_ASSERT_EQUAL(get3DTableValue(&sharedTable, load, rpm), shared2);
+    }
+  }
+}
+
+void test_tableLookup_sharedAxisMismatch(void)
+{
+  // A table whose axes don't match must not use the shared axis search
+  setup_TestTable();
+  setup_SharedTable();
+  static table3DSharedAxisCache sharedCache;
+
+  // As per test_tableLookup_axisChanged
+  sharedTable.axisX.axis[_countof(tempXAxis) - 1U - 6U] = 3000;
+  invalidate_cache(&sharedTable.get_value_cache);
+
+  TEST_ASSERT_EQUAL(69, get3DTableValue(&testTable, 53, 2250, &sharedCache));
+  TEST_ASSERT_EQUAL(88, get3DTableValue(&sharedTable, 53, 2250, &sharedCache));
+  TEST_ASSERT_FALSE(sharedTable.get_value_cache.isAxisShared);
+
+  // Put the axis back: the tables must be compared again
+  sharedTable.axisX.axis[_countof(tempXAxis) - 1U - 6U] = 2500;
+  invalidate_cache(&sharedTable.get_value_cache);
+  TEST_ASSERT_EQUAL(69, get3DTableValue(&testTable, 53, 2250, &sharedCache));
+  TEST_ASSERT_EQUAL(89, get3DTableValue(&sharedTable, 53, 2250, &sharedCache));
+  TEST_ASSERT_TRUE(sharedTable.get_value_cache.isAxisShared);
+}
+
+static void tableLookupPerfLoop(table3d_axis_t rpm, uint32_t &checkSum)
+{
+  for (table3d_axis_t load = yMin - 4; load < yMax + 4; load += 3)
+  {
+    checkSum += get3DTableValue(&testTable, load, rpm);
+  }
+}
+
+void test_tableLookup_perf(void)
+{
+  // Benchmark: sweep the whole table, so that (almost) every lookup has to interpolate.
+  // Reports the lookups/second for comparison between builds & platforms.
+  setup_TestTable();
+
+#if defined(ARDUINO_ARCH_AVR)
+  constexpr uint16_t iters = 2;
+#else
+  constexpr uint16_t iters = 2000;
+#endif
+  constexpr table3d_axis_t rpmStep = 23;
+  constexpr table3d_axis_t rpmFrom = xMin - 200;
+  constexpr table3d_axis_t rpmTo = xMax + 200;
+  constexpr uint32_t lookupsPerRpm = (((yMax + 4) - (yMin - 4)) + 2) / 3;
+  constexpr uint32_t lookups = (uint32_t)iters * ((((rpmTo - rpmFrom) + rpmStep) - 1) / rpmStep) * lookupsPerRpm;
+
+  timer lookupTimer;
+  uint32_t checkSum = 0;
+  measure_executiontime<table3d_axis_t, uint32_t&>(iters, rpmFrom, rpmTo, rpmStep, lookupTimer, checkSum, tableLookupPerfLoop);
+
+  char buffer[96];
+  const uint32_t durationMicros = lookupTimer.duration_micros() == 0U ? 1U : lookupTimer.duration_micros();
+  sprintf(buffer, "3D table lookups: %" PRIu32 " in %" PRIu32 "uS = %" PRIu32 " lookups/sec",
+          lookups, durationMicros, (uint32_t)(((uint64_t)lookups * MICROS_PER_SEC) / durationMicros));
+  TEST_MESSAGE(buffer);
+
+  // Only here to force the compiler to run the loop above
+  TEST_ASSERT_NOT_EQUAL(0, checkSum);
+}
@@ -8,4 +8,9 @@ void test_tableLookup_overMaxY(void);
 void test_tableLookup_underMinX(void);
 void test_tableLookup_underMinY(void);
 void test_tableLookup_roundUp(void);
+void test_tableLookup_binPosition(void);
+void test_tableLookup_axisChanged(void);
+void test_tableLookup_sharedAxis(void);
+void test_tableLookup_sharedAxisMismatch(void);
+void test_tableLookup_perf(void);
 void test_all_incrementing(void);
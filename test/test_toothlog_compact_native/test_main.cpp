@@ -0,0 +1,11 @@
+#include <unity.h>
+
+extern void testCompactToothLog(void);
+
+int main(void) {
+  UNITY_BEGIN();
+
+  testCompactToothLog();
+
+  return UNITY_END();
+}
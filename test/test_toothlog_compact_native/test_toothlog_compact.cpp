@@ -0,0 +1,177 @@
+#include <unity.h>
+#include "toothlog_compact.h"
+#include "toothlog_compact.cpp"
+
+#define TEST_LOG_SIZE 127U
+
+static uint32_t toothTimes[TEST_LOG_SIZE];
+static uint8_t compositeFlags[TEST_LOG_SIZE];
+static uint8_t encoded[TOOTH_LOG_COMPACT_MAX_SIZE(TEST_LOG_SIZE)];
+static uint32_t decodedTimes[TEST_LOG_SIZE];
+static uint8_t decodedFlags[TEST_LOG_SIZE];
+
+/** A 36-1 wheel at 3000rpm: 925uS between teeth, with a double gap at the missing tooth */
+static void fillToothLog(void)
+{
+  for(uint8_t entry = 0U; entry < TEST_LOG_SIZE; entry++)
+  {
+    toothTimes[entry] = ((entry % 35U) == 34U) ? 1850U : (925U + (entry & 3U));
+  }
+}
+
+/** Composite log timestamps from near the micros() rollover. A 36-1 crank logged on both edges at 3000rpm, with a cam tooth
+ * once per cycle. The status bits are laid out as COMPOSITE_LOG_PRI (0) to COMPOSITE_ENGINE_CYCLE (5) in globals.h
+ */
+static void fillCompositeLog(void)
+{
+  uint32_t time = UINT32_MAX - 10000U;
+  uint8_t flags = 0x10U; //Sync
+  for(uint8_t entry = 0U; entry < TEST_LOG_SIZE; entry++)
+  {
+    uint32_t gap = 462U + (entry & 1U); //Timer jitter
+    if((entry % 70U) == 20U)
+    {
+      //Cam edge, part way between two crank edges
+      flags = (uint8_t)((flags ^ 0x02U) | 0x08U);
+      gap = 200U;
+    }
+    else
+    {
+      flags = (uint8_t)((flags ^ 0x01U) & ~0x08U);
+      if((entry % 70U) == 21U) { gap = 262U; }
+      if((entry % 35U) == 34U) { gap += 925U; } //Missing tooth
+      if((entry % 70U) == 69U) { flags ^= 0x20U; } //Next revolution
+    }
+    time += gap;
+    toothTimes[entry] = time;
+    compositeFlags[entry] = flags;
+  }
+}
+
+/** Status bits that change in no particular pattern */
+static void fillCompositeFlagsArbitrary(void)
+{
+  for(uint8_t entry = 0U; entry < TEST_LOG_SIZE; entry++) { compositeFlags[entry] = (uint8_t)((entry * 7U) & 0x3FU); }
+}
+
+static void test_compact_tooth_log_round_trip(void)
+{
+  fillToothLog();
+  uint8_t entries = TEST_LOG_SIZE;
+  uint16_t length = encodeCompactToothLog(toothTimes, nullptr, entries, encoded, sizeof(encoded));
+
+  TEST_ASSERT_EQUAL_UINT8(TEST_LOG_SIZE, entries);
+  TEST_ASSERT_EQUAL_UINT8(TOOTH_LOG_COMPACT_VERSION, encoded[0]);
+  TEST_ASSERT_EQUAL_INT16(TEST_LOG_SIZE, decodeCompactToothLog(encoded, length, decodedTimes, decodedFlags, TEST_LOG_SIZE));
+  TEST_ASSERT_EQUAL_UINT32_ARRAY(toothTimes, decodedTimes, TEST_LOG_SIZE);
+
+  //Steady gaps are a single byte each, against 4 bytes raw
+  TEST_ASSERT_LESS_THAN(TEST_LOG_SIZE * 4U / 3U, length);
+}
+
+static void test_compact_composite_log_round_trip(void)
+{
+  fillCompositeLog();
+  uint8_t entries = TEST_LOG_SIZE;
+  uint16_t length = encodeCompactToothLog(toothTimes, compositeFlags, entries, encoded, sizeof(encoded));
+
+  TEST_ASSERT_EQUAL_UINT8(TEST_LOG_SIZE, entries);
+  TEST_ASSERT_EQUAL_UINT8(TOOTH_LOG_COMPACT_VERSION | TOOTH_LOG_COMPACT_COMPOSITE, encoded[0]);
+  TEST_ASSERT_EQUAL_INT16(TEST_LOG_SIZE, decodeCompactToothLog(encoded, length, decodedTimes, decodedFlags, TEST_LOG_SIZE));
+  TEST_ASSERT_EQUAL_UINT32_ARRAY(toothTimes, decodedTimes, TEST_LOG_SIZE);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(compositeFlags, decodedFlags, TEST_LOG_SIZE);
+
+  //5 bytes per entry raw, at least 4 times smaller
+  TEST_ASSERT_LESS_OR_EQUAL(TEST_LOG_SIZE * 5U / 4U, length);
+}
+
+static void test_compact_composite_log_arbitrary_flags(void)
+{
+  //The worst case for the status bits, one literal per entry
+  fillCompositeLog();
+  fillCompositeFlagsArbitrary();
+  uint8_t entries = TEST_LOG_SIZE;
+  uint16_t length = encodeCompactToothLog(toothTimes, compositeFlags, entries, encoded, sizeof(encoded));
+
+  TEST_ASSERT_EQUAL_UINT8(TEST_LOG_SIZE, entries);
+  TEST_ASSERT_EQUAL_INT16(TEST_LOG_SIZE, decodeCompactToothLog(encoded, length, decodedTimes, decodedFlags, TEST_LOG_SIZE));
+  TEST_ASSERT_EQUAL_UINT32_ARRAY(toothTimes, decodedTimes, TEST_LOG_SIZE);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(compositeFlags, decodedFlags, TEST_LOG_SIZE);
+}
+
+static void test_compact_composite_log_long_run(void)
+{
+  //More entries than a single run can hold
+  static uint32_t times[200];
+  static uint8_t flags[200];
+  static uint8_t longEncoded[TOOTH_LOG_COMPACT_MAX_SIZE(200U)];
+  static uint32_t longDecodedTimes[200];
+  static uint8_t longDecodedFlags[200];
+  for(uint8_t entry = 0U; entry < 200U; entry++)
+  {
+    times[entry] = 1000UL * entry;
+    flags[entry] = (uint8_t)(0x10U | (entry & 1U));
+  }
+  uint8_t entries = 200U;
+  uint16_t length = encodeCompactToothLog(times, flags, entries, longEncoded, sizeof(longEncoded));
+
+  TEST_ASSERT_EQUAL_UINT8(200U, entries);
+  TEST_ASSERT_EQUAL_INT16(200, decodeCompactToothLog(longEncoded, length, longDecodedTimes, longDecodedFlags, 200U));
+  TEST_ASSERT_EQUAL_UINT32_ARRAY(times, longDecodedTimes, 200U);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(flags, longDecodedFlags, 200U);
+}
+
+static void test_compact_log_large_changes(void)
+{
+  //Big jumps in both directions (Eg noise, or the engine stopping) still round trip
+  const uint32_t times[] = { 0xFFFFFFFFU, 0U, 0x80000000U, 1U, 0x7FFFFFFFU, 12345U };
+  uint8_t entries = sizeof(times) / sizeof(times[0]);
+  uint16_t length = encodeCompactToothLog(times, nullptr, entries, encoded, sizeof(encoded));
+
+  TEST_ASSERT_EQUAL_INT16(entries, decodeCompactToothLog(encoded, length, decodedTimes, nullptr, TEST_LOG_SIZE));
+  TEST_ASSERT_EQUAL_UINT32_ARRAY(times, decodedTimes, entries);
+}
+
+static void test_compact_log_split(void)
+{
+  //A buffer too small for the whole log takes as many entries as fit, and the rest can be sent as another log
+  fillCompositeLog();
+  fillCompositeFlagsArbitrary();
+  uint8_t firstEntries = TEST_LOG_SIZE;
+  uint16_t firstLength = encodeCompactToothLog(toothTimes, compositeFlags, firstEntries, encoded, 100U);
+  TEST_ASSERT_LESS_OR_EQUAL(100U, firstLength);
+  TEST_ASSERT_LESS_THAN(TEST_LOG_SIZE, firstEntries);
+  TEST_ASSERT_GREATER_THAN(20U, firstEntries);
+  TEST_ASSERT_EQUAL_INT16(firstEntries, decodeCompactToothLog(encoded, firstLength, decodedTimes, decodedFlags, TEST_LOG_SIZE));
+
+  uint8_t secondEntries = TEST_LOG_SIZE - firstEntries;
+  uint16_t secondLength = encodeCompactToothLog(&toothTimes[firstEntries], &compositeFlags[firstEntries], secondEntries, encoded, sizeof(encoded));
+  TEST_ASSERT_EQUAL_UINT8(TEST_LOG_SIZE - firstEntries, secondEntries);
+  TEST_ASSERT_EQUAL_INT16(secondEntries, decodeCompactToothLog(encoded, secondLength, &decodedTimes[firstEntries], &decodedFlags[firstEntries], TEST_LOG_SIZE));
+
+  TEST_ASSERT_EQUAL_UINT32_ARRAY(toothTimes, decodedTimes, TEST_LOG_SIZE);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(compositeFlags, decodedFlags, TEST_LOG_SIZE);
+}
+
+static void test_compact_log_invalid(void)
+{
+  fillToothLog();
+  uint8_t entries = 10U;
+  uint16_t length = encodeCompactToothLog(toothTimes, nullptr, entries, encoded, sizeof(encoded));
+
+  TEST_ASSERT_EQUAL_INT16(-1, decodeCompactToothLog(encoded, length - 1U, decodedTimes, nullptr, TEST_LOG_SIZE)); //Truncated
+  TEST_ASSERT_EQUAL_INT16(-1, decodeCompactToothLog(encoded, length, decodedTimes, nullptr, 9U)); //Too many entries
+  encoded[0] = TOOTH_LOG_COMPACT_VERSION + 1U;
+  TEST_ASSERT_EQUAL_INT16(-1, decodeCompactToothLog(encoded, length, decodedTimes, nullptr, TEST_LOG_SIZE)); //Unknown version
+}
+
+void testCompactToothLog(void)
+{
+  RUN_TEST(test_compact_tooth_log_round_trip);
+  RUN_TEST(test_compact_composite_log_round_trip);
+  RUN_TEST(test_compact_composite_log_arbitrary_flags);
+  RUN_TEST(test_compact_composite_log_long_run);
+  RUN_TEST(test_compact_log_large_changes);
+  RUN_TEST(test_compact_log_split);
+  RUN_TEST(test_compact_log_invalid);
+}
@@ -0,0 +1,11 @@
+#include <unity.h>
+
+extern void testTriggerCapture(void);
+
+int main(void) {
+  UNITY_BEGIN();
+
+  testTriggerCapture();
+
+  return UNITY_END();
+}
@@ -0,0 +1,119 @@
+/*
+Tests the input capture timestamps against a fake board: a free running timer with one capture register, and a
+micros() clock. The fake hardware latches the timer on the edge, the fake ISR runs some time later (The latency).
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <unity.h>
+#include "trigger_capture.h"
+
+//Fake board. All times are in uS
+static uint32_t fakeTime;           //Absolute time
+static volatile uint32_t fakeCounter;
+static volatile uint32_t fakeCapture;
+static uint8_t fakeUsPerTickShift;
+
+static void setFakeTime(uint32_t time)
+{
+  fakeTime = time;
+  fakeCounter = (fakeTime >> fakeUsPerTickShift) & 0xFFFFU; //16 bit timer
+}
+
+static void fakeEdge(uint32_t time)
+{
+  setFakeTime(time);
+  fakeCapture = fakeCounter;
+}
+
+static unsigned long fakeMicros(void) { return fakeTime; }
+
+static triggerCapture fakeBoardCapture(uint8_t usPerTickShift)
+{
+  fakeUsPerTickShift = usPerTickShift;
+  triggerCapture capture = { &fakeCounter, &fakeCapture, 0xFFFFU, usPerTickShift };
+  return capture;
+}
+
+static void test_capture_not_available(void)
+{
+  triggerCapture capture = { nullptr, nullptr, 0xFFFFU, 0U };
+  setFakeTime(123456UL);
+  TEST_ASSERT_EQUAL_UINT32(123456UL, captureEdgeTime(capture, fakeMicros()));
+}
+
+static void test_capture_removes_latency(void)
+{
+  triggerCapture capture = fakeBoardCapture(0U);
+  fakeEdge(1000000UL);
+  setFakeTime(1000000UL + 87U); //ISR delayed by another interrupt
+  TEST_ASSERT_EQUAL_UINT32(1000000UL, captureEdgeTime(capture, fakeMicros()));
+}
+
+static void test_capture_counter_wrap(void)
+{
+  //The 16 bit counter wraps between the edge and the ISR
+  triggerCapture capture = fakeBoardCapture(0U);
+  fakeEdge(0x1FFF0UL);
+  setFakeTime(0x20010UL);
+  TEST_ASSERT_LESS_THAN_UINT32(fakeCapture, fakeCounter);
+  TEST_ASSERT_EQUAL_UINT32(0x1FFF0UL, captureEdgeTime(capture, fakeMicros()));
+}
+
+static void test_capture_4us_ticks(void)
+{
+  //Eg a timer running at the same 4uS tick as the AVR schedule timers. Resolution is limited to the tick
+  triggerCapture capture = fakeBoardCapture(2U);
+  fakeEdge(40000UL);
+  setFakeTime(40000UL + 100U);
+  TEST_ASSERT_EQUAL_UINT32(40000UL, captureEdgeTime(capture, fakeMicros()));
+}
+
+/*
+A 36-1 wheel at 6000rpm with a varying ISR latency (0-100uS, eg the tooth arrives while a schedule or serial ISR is running).
+The tooth gaps measured from micros() on ISR entry include the latency change between the 2 teeth, the captured times do not.
+*/
+static void test_capture_latency_jitter(void)
+{
+  static const uint32_t toothGap = 277U; //10 degrees at 6000rpm
+  triggerCapture capture = fakeBoardCapture(0U);
+  srand(1);
+
+  uint32_t edgeTime = 5000UL;
+  unsigned long lastEntryTime = 0UL;
+  unsigned long lastCaptureTime = 0UL;
+  uint32_t maxEntryError = 0U;
+  uint32_t maxCaptureError = 0U;
+  for(uint16_t tooth = 0U; tooth < 1000U; tooth++)
+  {
+    edgeTime += toothGap;
+    fakeEdge(edgeTime);
+    setFakeTime(edgeTime + (uint32_t)(rand() % 101));
+
+    unsigned long entryTime = fakeMicros();
+    unsigned long captureTime = captureEdgeTime(capture, fakeMicros());
+    if(tooth > 0U)
+    {
+      uint32_t entryError = labs((long)(entryTime - lastEntryTime) - (long)toothGap);
+      uint32_t captureError = labs((long)(captureTime - lastCaptureTime) - (long)toothGap);
+      if(entryError > maxEntryError) { maxEntryError = entryError; }
+      if(captureError > maxCaptureError) { maxCaptureError = captureError; }
+    }
+    lastEntryTime = entryTime;
+    lastCaptureTime = captureTime;
+  }
+
+  char msg[96];
+  snprintf(msg, sizeof(msg), "Max tooth gap error: micros() on entry %luuS, input capture %luuS", (unsigned long)maxEntryError, (unsigned long)maxCaptureError);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_EQUAL_UINT32(0U, maxCaptureError);
+  TEST_ASSERT_GREATER_THAN_UINT32(50U, maxEntryError);
+}
+
+void testTriggerCapture(void)
+{
+  RUN_TEST(test_capture_not_available);
+  RUN_TEST(test_capture_removes_latency);
+  RUN_TEST(test_capture_counter_wrap);
+  RUN_TEST(test_capture_4us_ticks);
+  RUN_TEST(test_capture_latency_jitter);
+}
@@ -119,34 +119,36 @@ static inline void populate_table_P(table3d_t &table,
       ++itZ;
     }
   }
+  invalidate_cache(&table.get_value_cache);
 }
 
 
 // Populate a 2d table with constant values
-static inline void populate_2dtable(table2D *pTable, uint8_t value, uint8_t bin) {
+template <typename TValue, typename TAxis>
+static inline void populate_2dtable(table2D_t<TValue, TAxis> *pTable, typename table2D_t<TValue, TAxis>::value_t value, typename table2D_t<TValue, TAxis>::axis_t bin) {
   for (uint8_t index=0; index<pTable->xSize; ++index) {
-    ((uint8_t*)pTable->values)[index] = value;
-    ((uint8_t*)pTable->axisX)[index] = bin;
+    pTable->values[index] = value;
+    pTable->axisX[index] = bin;
   }
   pTable->cacheTime = UINT8_MAX;
 }
 
-template <typename TValue, typename TBin>
-static inline void populate_2dtable(table2D *pTable, const TValue values[], const TBin bins[]) {
-  memcpy(pTable->axisX, bins, pTable->xSize * sizeof(TBin));
+template <typename TValue, typename TAxis>
+static inline void populate_2dtable(table2D_t<TValue, TAxis> *pTable, const typename table2D_t<TValue, TAxis>::value_t values[], const typename table2D_t<TValue, TAxis>::axis_t bins[]) {
+  memcpy(pTable->axisX, bins, pTable->xSize * sizeof(TAxis));
   memcpy(pTable->values, values, pTable->xSize * sizeof(TValue));
   pTable->cacheTime = UINT8_MAX;
 }
 
 // Populate a 2d table (from PROGMEM if available)
 // You would typically declare the 2 source arrays using TEST_DATA_P
-template <typename TValue, typename TBin>
-static inline void populate_2dtable_P(table2D *pTable, const TValue values[], const TBin bins[]) {
+template <typename TValue, typename TAxis>
+static inline void populate_2dtable_P(table2D_t<TValue, TAxis> *pTable, const typename table2D_t<TValue, TAxis>::value_t values[], const typename table2D_t<TValue, TAxis>::axis_t bins[]) {
 #if defined(PROGMEM)
-  memcpy_P(pTable->axisX, bins, pTable->xSize * sizeof(TBin));
+  memcpy_P(pTable->axisX, bins, pTable->xSize * sizeof(TAxis));
   memcpy_P(pTable->values, values, pTable->xSize * sizeof(TValue));
   pTable->cacheTime = UINT8_MAX;
 #else
-  populate_2dtable(pTable, values, bins)
+  populate_2dtable(pTable, values, bins);
 #endif
 }
\ No newline at end of file
@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+"""Convert a binary Speeduino SD card log (.sdl) to CSV.
+
+The binary format is described in speeduino/SD_logger.h. The CSV output matches
+the firmware's own CSV logs: a Time column (Seconds) followed by every field.
+
+Usage: sd_log_to_csv.py LOG0001.sdl [output.csv]
+"""
+import csv
+import struct
+import sys
+
+MAGIC = b"SPDL"
+SUPPORTED_VERSIONS = (1, 2)
+RECORD_MARKER = 0xA5
+FLAG_UNSIGNED = 0x01
+TIME_MS = 0
+TIME_US = 1
+
+
+class LogFormatError(Exception):
+    pass
+
+
+def read_header(data):
+    if len(data) < 8 or data[0:4] != MAGIC:
+        raise LogFormatError("Not a binary Speeduino log")
+    version, field_count, record_size = struct.unpack_from("<BBH", data, 4)
+    if version not in SUPPORTED_VERSIONS:
+        raise LogFormatError("Unsupported log version %d" % version)
+    if record_size != 5 + (field_count * 2):
+        raise LogFormatError("Record size %d does not match %d fields" % (record_size, field_count))
+
+    pos = 8
+    time_unit = TIME_MS
+    if version >= 2:
+        if pos >= len(data):
+            raise LogFormatError("Truncated header")
+        time_unit = data[pos]
+        pos += 1
+        if time_unit not in (TIME_MS, TIME_US):
+            raise LogFormatError("Unknown time unit %d" % time_unit)
+
+    fields = []
+    for _ in range(field_count):
+        if pos + 4 > len(data):
+            raise LogFormatError("Truncated header")
+        divisor, flags, name_length = struct.unpack_from("<HBB", data, pos)
+        pos += 4
+        name = data[pos:pos + name_length].decode("ascii", errors="replace")
+        pos += name_length
+        fields.append((name, divisor if divisor else 1, bool(flags & FLAG_UNSIGNED)))
+    return fields, record_size, time_unit, pos
+
+
+def format_value(raw, divisor):
+    if divisor == 1:
+        return str(raw)
+    return ("%f" % (raw / divisor)).rstrip("0").rstrip(".")
+
+
+def format_time(time, time_unit):
+    if time_unit == TIME_US:
+        return "%d.%06d" % (time // 1000000, time % 1000000)
+    return "%d.%03d" % (time // 1000, time % 1000)
+
+
+def is_record(data, pos, record_size):
+    """A record starts with the marker and is followed by another record, the end of the data or the end of the log (No
+    record starts in the next record_size bytes). A 0xA5 value inside a record is not mistaken for the start of one, nor
+    is a record that was cut short"""
+    if pos + record_size > len(data) or data[pos] != RECORD_MARKER:
+        return False
+    following = pos + record_size
+    return (following == len(data) or data[following] == RECORD_MARKER
+            or RECORD_MARKER not in data[following:following + record_size])
+
+
+def find_next_record(data, pos, record_size):
+    """Find the next record after a gap, -1 if there are no more"""
+    pos = data.find(bytes((RECORD_MARKER,)), pos)
+    while 0 <= pos and not is_record(data, pos, record_size):
+        pos = data.find(bytes((RECORD_MARKER,)), pos + 1)
+    return pos
+
+
+def read_records(data, fields, record_size, time_unit, pos, stats):
+    value_format = "<" + "".join("H" if unsigned else "h" for _, _, unsigned in fields)
+    wraps = 0
+    last_time = 0
+    while pos + record_size <= len(data):
+        if not is_record(data, pos, record_size):
+            # Older firmware could cut a record short when its ring buffer was full, leaving the records after it out of
+            # step. The last record is followed by the unused part of the preallocated file, which has no records in it
+            pos = find_next_record(data, pos + 1, record_size)
+            if pos < 0:
+                break
+            stats["gaps"] += 1
+            continue
+        (time,) = struct.unpack_from("<I", data, pos + 1)
+        # uS times wrap after about 71 minutes
+        if time < last_time:
+            wraps += 1
+        last_time = time
+        values = struct.unpack_from(value_format, data, pos + 5)
+        row = [format_time(time + (wraps << 32), time_unit)]
+        row.extend(format_value(raw, divisor) for raw, (_, divisor, _) in zip(values, fields))
+        yield row
+        pos += record_size
+
+
+def convert(data, out, stats):
+    fields, record_size, time_unit, pos = read_header(data)
+    writer = csv.writer(out, lineterminator="\n")
+    writer.writerow(["Time"] + [name for name, _, _ in fields])
+    count = 0
+    for row in read_records(data, fields, record_size, time_unit, pos, stats):
+        writer.writerow(row)
+        count += 1
+    return count
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        sys.stderr.write(__doc__)
+        return 2
+    with open(argv[1], "rb") as f:
+        data = f.read()
+    stats = {"gaps": 0}
+    try:
+        if len(argv) == 3:
+            with open(argv[2], "w", newline="") as out:
+                count = convert(data, out, stats)
+        else:
+            count = convert(data, sys.stdout, stats)
+    except LogFormatError as e:
+        sys.stderr.write("%s: %s\n" % (argv[1], e))
+        return 1
+    sys.stderr.write("%d records\n" % count)
+    if stats["gaps"]:
+        sys.stderr.write("Resynced after %d damaged records\n" % stats["gaps"])
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))